@@ -2,7 +2,7 @@
 
 precision mediump float;
 
-in vec2 v_UV;
+in highp vec2 v_UV;
 in vec4 v_Color;
 
 uniform sampler2D u_Texture;
@@ -6,13 +6,26 @@ uniform sampler2D u_DepthMap;
 uniform sampler2D u_NormalMap;
 uniform sampler2D u_DecalMap;
 
-uniform mat4 u_InvMMatrix;
-uniform mat4 u_InvVP;
+layout(std140) uniform CameraBlock {
+    highp mat4 u_VMatrix;
+    highp mat4 u_PMatrix;
+    highp mat4 u_VPMatrix;
+    highp mat4 u_InvVPMatrix;
+    highp vec3 u_ViewPosition;
+    highp float u_NearPlane;
+    highp vec3 u_ViewDirection;
+    highp float u_FarPlane;
+    highp mat3 u_InvVRotMatrix;
+};
 
 uniform int u_BufferWidth;
 uniform int u_BufferHeight;
 
-uniform vec4 u_Color;
+flat in highp vec4 v_InvMRow0;
+flat in highp vec4 v_InvMRow1;
+flat in highp vec4 v_InvMRow2;
+flat in vec4 v_Color;
+flat in highp vec4 v_UVTransform;
 
 layout(location = 0) out vec4 outColor;
 
@@ -23,17 +36,23 @@ void main() {
 
     float depth = texelFetch(u_DepthMap, texelPos, 0).r;
 
-    vec4 p = u_InvVP * (vec4(screenUV, depth, 1.0) * 2.0 - 1.0);
+    vec4 p = u_InvVPMatrix * (vec4(screenUV, depth, 1.0) * 2.0 - 1.0);
     vec4 worldPos = p / p.w;
 
-    vec4 mpos = u_InvMMatrix * worldPos;
-    if (any(greaterThan(abs(mpos.xyz), vec3(0.5)))) discard;
+    vec3 mpos = vec3(dot(v_InvMRow0, worldPos),
+                     dot(v_InvMRow1, worldPos),
+                     dot(v_InvMRow2, worldPos));
+    if (any(greaterThan(abs(mpos), vec3(0.5)))) discard;
 
-    vec3 mup = normalize(transpose(mat3(u_InvMMatrix)) * vec3(0.0, 1.0, 0.0));
+    /* second row of the inverse rotation, i.e. the transposed inverse
+     * applied to the up vector
+     */
+    vec3 mup = normalize(v_InvMRow1.xyz);
     vec3 normal = 2.0 * texelFetch(u_NormalMap, texelPos, 0).xyz - 1.0;
     if (dot(normal, mup) < 0.70710678118) discard;
 
-    vec2 decalUV = mpos.xz + 0.5;
-    vec4 decalColor = u_Color * texture(u_DecalMap, decalUV);
+    highp vec2 decalUV = v_UVTransform.xy +
+                         v_UVTransform.zw * (mpos.xz + 0.5);
+    vec4 decalColor = v_Color * texture(u_DecalMap, decalUV);
     outColor = decalColor;
 }
@@ -1,12 +1,44 @@
 #version 300 es
 
-uniform mat4 u_MVPMatrix;
-
-uniform float u_NearPlane;
-uniform float u_FarPlane;
+layout(std140) uniform CameraBlock {
+    highp mat4 u_VMatrix;
+    highp mat4 u_PMatrix;
+    highp mat4 u_VPMatrix;
+    highp mat4 u_InvVPMatrix;
+    highp vec3 u_ViewPosition;
+    highp float u_NearPlane;
+    highp vec3 u_ViewDirection;
+    highp float u_FarPlane;
+    highp mat3 u_InvVRotMatrix;
+};
 
 layout(location = 0) in vec3 a_Position;
 
+/* per-instance, the first three rows of the model matrix and its inverse */
+layout(location = 1) in vec4 a_MRow0;
+layout(location = 2) in vec4 a_MRow1;
+layout(location = 3) in vec4 a_MRow2;
+layout(location = 4) in vec4 a_InvMRow0;
+layout(location = 5) in vec4 a_InvMRow1;
+layout(location = 6) in vec4 a_InvMRow2;
+layout(location = 7) in vec4 a_Color;
+/* (offset, scale) into u_DecalMap */
+layout(location = 8) in vec4 a_UVTransform;
+
+flat out vec4 v_InvMRow0;
+flat out vec4 v_InvMRow1;
+flat out vec4 v_InvMRow2;
+flat out vec4 v_Color;
+flat out vec4 v_UVTransform;
+
 void main() {
-    gl_Position = u_MVPMatrix * vec4(a_Position, 1.0);
+    vec4 p = vec4(a_Position, 1.0);
+    vec4 worldPos = vec4(dot(a_MRow0, p), dot(a_MRow1, p), dot(a_MRow2, p), 1.0);
+    gl_Position = u_VPMatrix * worldPos;
+
+    v_InvMRow0 = a_InvMRow0;
+    v_InvMRow1 = a_InvMRow1;
+    v_InvMRow2 = a_InvMRow2;
+    v_Color = a_Color;
+    v_UVTransform = a_UVTransform;
 }
@@ -1,14 +1,22 @@
 #version 300 es
 
-uniform mat4 u_VPMatrix;
-uniform mat3 u_invVRotMatrix;
-
-uniform vec2 u_InvDiv;
+layout(std140) uniform CameraBlock {
+    highp mat4 u_VMatrix;
+    highp mat4 u_PMatrix;
+    highp mat4 u_VPMatrix;
+    highp mat4 u_InvVPMatrix;
+    highp vec3 u_ViewPosition;
+    highp float u_NearPlane;
+    highp vec3 u_ViewDirection;
+    highp float u_FarPlane;
+    highp mat3 u_InvVRotMatrix;
+};
 
 layout(location = 0) in vec3 a_VertexPos;
 layout(location = 1) in vec4 a_PosSize;
 layout(location = 2) in vec2 a_BaseUV;
 layout(location = 3) in vec4 a_Color;
+layout(location = 4) in vec2 a_UVSize;
 
 out vec3 v_Position;
 out vec2 v_UV;
@@ -16,8 +24,8 @@ out vec4 v_Color;
 out vec2 v_screenUV;
 
 void main() {
-    v_UV = a_BaseUV - u_InvDiv * a_VertexPos.xy;
-    vec3 offset = (u_invVRotMatrix * a_PosSize.w * a_VertexPos.xyz);
+    v_UV = a_BaseUV - a_UVSize * a_VertexPos.xy;
+    vec3 offset = (u_InvVRotMatrix * a_PosSize.w * a_VertexPos.xyz);
     vec3 pos = a_PosSize.xyz + offset;
     v_Position = pos;
 
@@ -1,3 +1,5 @@
+#version 300 es
+
 precision mediump float;
 
 uniform sampler2D u_AlbedoMap;
@@ -15,25 +17,87 @@ struct PointLight {
     float b; // linear term
     float c; // constant term
 };
-uniform PointLight u_PointLights[4]; // Point Lights
-uniform int u_NumberOfPointLights;
 
 struct DirectionalLight {
     vec3 direction;
     vec3 color;
 };
-uniform DirectionalLight u_DirectionalLight;
-uniform bool u_DirectionalLightOn;
 
-uniform vec3 u_AmbientLight;
+const int MAX_NUMBER_OF_POINT_LIGHTS = 256;
+const uint CLUSTER_INDEX_TEXTURE_WIDTH = 1024u;
+
+layout(std140) uniform LightBlock {
+    PointLight u_PointLights[MAX_NUMBER_OF_POINT_LIGHTS]; // Point Lights
+    DirectionalLight u_DirectionalLight;
+    vec3 u_AmbientLight;
+    int u_NumberOfPointLights;
+    bool u_DirectionalLightOn;
+    highp uvec4 u_ClusterDims;
+    highp vec4 u_ClusterDepthParams; // slice scale, slice bias
+};
 
-uniform vec3 u_ViewPosition;
+// (offset, count) into u_ClusterLightIndices per cluster
+uniform highp usampler2D u_ClusterGrid;
+uniform highp usampler2D u_ClusterLightIndices;
+
+layout(std140) uniform CameraBlock {
+    highp mat4 u_VMatrix;
+    highp mat4 u_PMatrix;
+    highp mat4 u_VPMatrix;
+    highp mat4 u_InvVPMatrix;
+    highp vec3 u_ViewPosition;
+    highp float u_NearPlane;
+    highp vec3 u_ViewDirection;
+    highp float u_FarPlane;
+    highp mat3 u_InvVRotMatrix;
+};
 
-varying vec3 v_Position;
+layout(std140) uniform ModelBlock {
+    highp mat4 u_MMatrix;
+    highp mat4 u_InvMMatrix;
+    highp mat3 u_InvTposMMatrix;
+    highp uint u_NodeData;
+};
 
-varying vec3 v_Normal;
-varying vec2 v_TexCoordinate;
-varying mat3 v_InverseTBN;
+in vec3 v_Position;
+in vec3 v_Normal;
+in vec2 v_TexCoordinate;
+in mat3 v_InverseTBN;
+
+// Returns the (offset, count) of the lights affecting the cluster that
+// contains the given world space position
+highp uvec2 getCluster(highp vec3 position) {
+    highp vec4 clip = u_VPMatrix * vec4(position, 1.0);
+    highp vec2 ndc = clip.xy / clip.w;
+    highp float depth = -(u_VMatrix * vec4(position, 1.0)).z;
+
+    highp vec3 dims = vec3(u_ClusterDims.xyz);
+    highp vec2 tile = clamp(
+        floor((0.5 * ndc + 0.5) * dims.xy),
+        vec2(0.0),
+        dims.xy - 1.0
+    );
+    highp float slice = clamp(
+        floor(log(max(depth, 1e-4)) * u_ClusterDepthParams.x +
+              u_ClusterDepthParams.y),
+        0.0,
+        dims.z - 1.0
+    );
+
+    ivec2 texel = ivec2(
+        int(tile.x) + int(tile.y) * int(u_ClusterDims.x),
+        int(slice)
+    );
+    return texelFetch(u_ClusterGrid, texel, 0).xy;
+}
+
+int getLightIndex(highp uint i) {
+    ivec2 texel = ivec2(
+        int(i % CLUSTER_INDEX_TEXTURE_WIDTH),
+        int(i / CLUSTER_INDEX_TEXTURE_WIDTH)
+    );
+    return int(texelFetch(u_ClusterLightIndices, texel, 0).r);
+}
 
 const float PI = 3.14159265359;
 
@@ -49,29 +113,32 @@ vec3 CalculateDirectionalLight(DirectionalLight light,
                                float metallic,
                                float roughness);
 
+layout(location = 0) out vec3 outColor;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec4 outMetadata;
+
 // The entry point for our fragment shader.
 void main()
 {
-    vec4 albedo = u_Albedo * texture2D(u_AlbedoMap, v_TexCoordinate);
+    vec4 albedo = u_Albedo * texture(u_AlbedoMap, v_TexCoordinate);
 
     // vec3 normal = normalize(v_InverseTBN *
-    //                 ((2.0 * texture2D(u_NormalMap, v_TexCoordinate).rgb) - 1.0));
+    //                 ((2.0 * texture(u_NormalMap, v_TexCoordinate).rgb) - 1.0));
     vec3 normal = v_Normal;
 
-    float metallic = u_Metallic * texture2D(u_MetallicMap, v_TexCoordinate).r;
-    float roughness = 1.0 - u_Roughness * texture2D(u_RoughnessMap, v_TexCoordinate).r;
+    float metallic = u_Metallic * texture(u_MetallicMap, v_TexCoordinate).r;
+    float roughness = 1.0 - u_Roughness * texture(u_RoughnessMap, v_TexCoordinate).r;
 
     vec3 lightContribution = u_AmbientLight;
-    // Add point lights
-    for (int i = 0; i < 4; ++i) {
-        // Constant loop count work-around
-        if (i < u_NumberOfPointLights) {
-            lightContribution += calculatePointLight(u_PointLights[i],
-                                                     albedo.rgb,
-                                                     normal,
-                                                     metallic,
-                                                     roughness);
-        }
+    // Add point lights affecting this cluster
+    highp uvec2 cluster = getCluster(v_Position);
+    for (highp uint i = 0u; i < cluster.y; ++i) {
+        int lightIndex = getLightIndex(cluster.x + i);
+        lightContribution += calculatePointLight(u_PointLights[lightIndex],
+                                                 albedo.rgb,
+                                                 normal,
+                                                 metallic,
+                                                 roughness);
     }
 
     if (u_DirectionalLightOn) {
@@ -125,7 +192,13 @@ void main()
 
     float n = 8.0;
     vec3 compressed_color = floor(dithered_color * (n - 1.0) + 0.5) / (n - 1.0);
-    gl_FragColor = vec4(compressed_color, rawColor.a);
+    outColor = compressed_color;
+    outNormal = 0.5 * normal + 0.5;
+
+    outMetadata.r = float(u_NodeData % uint(256)) / 255.0;
+    outMetadata.g = float((u_NodeData / uint(256)) % uint(256)) / 255.0;
+    outMetadata.b = float((u_NodeData / uint(65536)) % uint(256)) / 255.0;
+    outMetadata.a = float((u_NodeData / uint(16777216))) / 255.0;
 }
 
 vec3 fresnelSchlick(float cosTheta, vec3 F0) {
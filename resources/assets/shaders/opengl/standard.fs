@@ -17,30 +17,88 @@ struct PointLight {
     float b; // linear term
     float c; // constant term
 };
-uniform PointLight u_PointLights[4]; // Point Lights
-uniform int u_NumberOfPointLights;
 
 struct DirectionalLight {
     vec3 direction;
     vec3 color;
 };
-uniform DirectionalLight u_DirectionalLight;
-uniform bool u_DirectionalLightOn;
 
-uniform vec3 u_AmbientLight;
-
-uniform vec3 u_ViewPosition;
+const int MAX_NUMBER_OF_POINT_LIGHTS = 256;
+const uint CLUSTER_INDEX_TEXTURE_WIDTH = 1024u;
+
+layout(std140) uniform LightBlock {
+    PointLight u_PointLights[MAX_NUMBER_OF_POINT_LIGHTS]; // Point Lights
+    DirectionalLight u_DirectionalLight;
+    vec3 u_AmbientLight;
+    int u_NumberOfPointLights;
+    bool u_DirectionalLightOn;
+    highp uvec4 u_ClusterDims;
+    highp vec4 u_ClusterDepthParams; // slice scale, slice bias
+};
 
-uniform uint u_NodeData;
-uniform bool u_Selected;
+// (offset, count) into u_ClusterLightIndices per cluster
+uniform highp usampler2D u_ClusterGrid;
+uniform highp usampler2D u_ClusterLightIndices;
+
+layout(std140) uniform CameraBlock {
+    highp mat4 u_VMatrix;
+    highp mat4 u_PMatrix;
+    highp mat4 u_VPMatrix;
+    highp mat4 u_InvVPMatrix;
+    highp vec3 u_ViewPosition;
+    highp float u_NearPlane;
+    highp vec3 u_ViewDirection;
+    highp float u_FarPlane;
+    highp mat3 u_InvVRotMatrix;
+};
 
-uniform mat4 u_VPMatrix;
+layout(std140) uniform ModelBlock {
+    highp mat4 u_MMatrix;
+    highp mat4 u_InvMMatrix;
+    highp mat3 u_InvTposMMatrix;
+    highp uint u_NodeData;
+};
 
 in vec3 v_Position;
 in vec3 v_Normal;
 in vec2 v_TexCoordinate;
 in mat3 v_InverseTBN;
 
+// Returns the (offset, count) of the lights affecting the cluster that
+// contains the given world space position
+highp uvec2 getCluster(highp vec3 position) {
+    highp vec4 clip = u_VPMatrix * vec4(position, 1.0);
+    highp vec2 ndc = clip.xy / clip.w;
+    highp float depth = -(u_VMatrix * vec4(position, 1.0)).z;
+
+    highp vec3 dims = vec3(u_ClusterDims.xyz);
+    highp vec2 tile = clamp(
+        floor((0.5 * ndc + 0.5) * dims.xy),
+        vec2(0.0),
+        dims.xy - 1.0
+    );
+    highp float slice = clamp(
+        floor(log(max(depth, 1e-4)) * u_ClusterDepthParams.x +
+              u_ClusterDepthParams.y),
+        0.0,
+        dims.z - 1.0
+    );
+
+    ivec2 texel = ivec2(
+        int(tile.x) + int(tile.y) * int(u_ClusterDims.x),
+        int(slice)
+    );
+    return texelFetch(u_ClusterGrid, texel, 0).xy;
+}
+
+int getLightIndex(highp uint i) {
+    ivec2 texel = ivec2(
+        int(i % CLUSTER_INDEX_TEXTURE_WIDTH),
+        int(i / CLUSTER_INDEX_TEXTURE_WIDTH)
+    );
+    return int(texelFetch(u_ClusterLightIndices, texel, 0).r);
+}
+
 const float PI = 3.14159265359;
 
 vec3 calculatePointLight(PointLight light,
@@ -70,16 +128,15 @@ void main() {
     float roughness = u_Roughness * texture(u_RoughnessMap, v_TexCoordinate).r;
 
     vec3 lightContribution = u_AmbientLight;
-    // Add point lights
-    for (int i = 0; i < 4; ++i) {
-        // Constant loop count work-around
-        if (i < u_NumberOfPointLights) {
-            lightContribution += calculatePointLight(u_PointLights[i],
-                                                     albedo.rgb,
-                                                     normal,
-                                                     metallic,
-                                                     roughness);
-        }
+    // Add point lights affecting this cluster
+    highp uvec2 cluster = getCluster(v_Position);
+    for (highp uint i = 0u; i < cluster.y; ++i) {
+        int lightIndex = getLightIndex(cluster.x + i);
+        lightContribution += calculatePointLight(u_PointLights[lightIndex],
+                                                 albedo.rgb,
+                                                 normal,
+                                                 metallic,
+                                                 roughness);
     }
 
     if (u_DirectionalLightOn) {
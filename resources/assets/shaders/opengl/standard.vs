@@ -1,36 +1,61 @@
 #version 300 es
 
-uniform mat4 u_MMatrix;
-uniform mat4 u_MVPMatrix;
-uniform mat4 u_MVMatrix;
-uniform mat3 u_InvTposMMatrix;
-
-uniform float u_NearPlane;
-uniform float u_FarPlane;
-
-layout(location = 0) in vec3 a_Position;
-layout(location = 1) in vec3 a_Normal;
+layout(std140) uniform CameraBlock {
+    highp mat4 u_VMatrix;
+    highp mat4 u_PMatrix;
+    highp mat4 u_VPMatrix;
+    highp mat4 u_InvVPMatrix;
+    highp vec3 u_ViewPosition;
+    highp float u_NearPlane;
+    highp vec3 u_ViewDirection;
+    highp float u_FarPlane;
+    highp mat3 u_InvVRotMatrix;
+};
+
+layout(std140) uniform ModelBlock {
+    highp mat4 u_MMatrix;
+    highp mat4 u_InvMMatrix;
+    highp mat3 u_InvTposMMatrix;
+    highp uint u_NodeData;
+};
+
+// w holds the sign of the bitangent
+layout(location = 0) in vec4 a_Position;
+// normal and tangent are octahedral encoded
+layout(location = 1) in vec2 a_Normal;
 layout(location = 2) in vec2 a_TexCoordinate;
-layout(location = 3) in vec3 a_Tangent;
-layout(location = 4) in vec3 a_Bitangent;
+layout(location = 3) in vec2 a_Tangent;
 
 out vec3 v_Position;
 out vec3 v_Normal;
 out vec2 v_TexCoordinate;
 out mat3 v_InverseTBN;
 
+vec3 octahedralDecode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0) {
+        vec2 s = vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+        v.xy = (1.0 - abs(e.yx)) * s;
+    }
+    return normalize(v);
+}
+
 void main() {
-    v_Position = vec3(u_MMatrix * vec4(a_Position, 1.0));
+    vec3 normal = octahedralDecode(a_Normal);
+    vec3 tangent = octahedralDecode(a_Tangent);
+    vec3 bitangent = cross(normal, tangent) * a_Position.w;
+
+    v_Position = vec3(u_MMatrix * vec4(a_Position.xyz, 1.0));
 
     v_TexCoordinate = a_TexCoordinate;
 
-    v_Normal = u_InvTposMMatrix * a_Normal;
+    v_Normal = u_InvTposMMatrix * normal;
 
-    vec3 t = normalize(u_InvTposMMatrix * a_Tangent);
-    vec3 b = normalize(u_InvTposMMatrix * a_Bitangent);
-    vec3 n = normalize(u_InvTposMMatrix * a_Normal);
+    vec3 t = normalize(u_InvTposMMatrix * tangent);
+    vec3 b = normalize(u_InvTposMMatrix * bitangent);
+    vec3 n = normalize(u_InvTposMMatrix * normal);
 
     v_InverseTBN = mat3(t,b,n);
 
-    gl_Position = u_MVPMatrix * vec4(a_Position, 1.0);
+    gl_Position = u_VPMatrix * vec4(v_Position, 1.0);
 }
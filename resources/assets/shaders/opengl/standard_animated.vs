@@ -1,42 +1,93 @@
 #version 300 es
 
-uniform mat4 u_MMatrix;
-uniform mat4 u_MVPMatrix;
-uniform mat4 u_MVMatrix;
-uniform mat3 u_InvTposMMatrix;
+layout(std140) uniform CameraBlock {
+    highp mat4 u_VMatrix;
+    highp mat4 u_PMatrix;
+    highp mat4 u_VPMatrix;
+    highp mat4 u_InvVPMatrix;
+    highp vec3 u_ViewPosition;
+    highp float u_NearPlane;
+    highp vec3 u_ViewDirection;
+    highp float u_FarPlane;
+    highp mat3 u_InvVRotMatrix;
+};
 
-uniform mat4 u_Bones[100];
+layout(std140) uniform ModelBlock {
+    highp mat4 u_MMatrix;
+    highp mat4 u_InvMMatrix;
+    highp mat3 u_InvTposMMatrix;
+    highp uint u_NodeData;
+};
 
-uniform float u_NearPlane;
-uniform float u_FarPlane;
+// Three texels per bone holding the rows of its 3x4 matrix
+uniform highp sampler2D u_BonePalettes;
+// First bone of the palette of this draw, negative for the bind pose
+uniform int u_BoneOffset;
 
-layout(location = 0) in vec3 a_Position;
-layout(location = 1) in vec3 a_Normal;
+const int BONE_TEXTURE_WIDTH = 1024;
+
+// w holds the sign of the bitangent
+layout(location = 0) in vec4 a_Position;
+// normal and tangent are octahedral encoded
+layout(location = 1) in vec2 a_Normal;
 layout(location = 2) in vec2 a_TexCoordinate;
-layout(location = 3) in vec3 a_Tangent;
-layout(location = 4) in vec3 a_Bitangent;
-layout(location = 5) in uvec4 a_BoneIDs;
-layout(location = 6) in vec4 a_BoneWeights;
+layout(location = 3) in vec2 a_Tangent;
+layout(location = 4) in uvec4 a_BoneIDs;
+layout(location = 5) in vec4 a_BoneWeights;
 
 out vec3 v_Position;
 out vec3 v_Normal;
 out vec2 v_TexCoordinate;
 out mat3 v_InverseTBN;
 
+vec3 octahedralDecode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0) {
+        vec2 s = vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+        v.xy = (1.0 - abs(e.yx)) * s;
+    }
+    return normalize(v);
+}
+
+highp vec4 boneTexel(int i) {
+    return texelFetch(
+        u_BonePalettes,
+        ivec2(i % BONE_TEXTURE_WIDTH, i / BONE_TEXTURE_WIDTH),
+        0
+    );
+}
+
+mat4 getBone(uint id) {
+    int i = 3 * (u_BoneOffset + int(id));
+    highp vec4 r0 = boneTexel(i);
+    highp vec4 r1 = boneTexel(i + 1);
+    highp vec4 r2 = boneTexel(i + 2);
+    return mat4(
+        vec4(r0.x, r1.x, r2.x, 0.0),
+        vec4(r0.y, r1.y, r2.y, 0.0),
+        vec4(r0.z, r1.z, r2.z, 0.0),
+        vec4(r0.w, r1.w, r2.w, 1.0)
+    );
+}
+
 void main() {
     mat4 boneTransform = mat4(1.0);
     float weightSum = a_BoneWeights[0] + a_BoneWeights[1] + a_BoneWeights[2] + a_BoneWeights[3];
-    if (weightSum > 0.0) {
-        boneTransform  = u_Bones[a_BoneIDs[0]] * a_BoneWeights[0];
-        boneTransform += u_Bones[a_BoneIDs[1]] * a_BoneWeights[1];
-        boneTransform += u_Bones[a_BoneIDs[2]] * a_BoneWeights[2];
-        boneTransform += u_Bones[a_BoneIDs[3]] * a_BoneWeights[3];
+    if (weightSum > 0.0 && u_BoneOffset >= 0) {
+        boneTransform  = getBone(a_BoneIDs[0]) * a_BoneWeights[0];
+        boneTransform += getBone(a_BoneIDs[1]) * a_BoneWeights[1];
+        boneTransform += getBone(a_BoneIDs[2]) * a_BoneWeights[2];
+        boneTransform += getBone(a_BoneIDs[3]) * a_BoneWeights[3];
     }
 
     mat3 invtposBone = inverse(transpose(mat3(boneTransform)));
 
-    vec4 bonedPos = boneTransform * vec4(a_Position, 1.0);
-    vec3 bonedNormal = invtposBone * a_Normal;
+    vec3 normal = octahedralDecode(a_Normal);
+    vec3 tangent = octahedralDecode(a_Tangent);
+    vec3 bitangent = cross(normal, tangent) * a_Position.w;
+
+    vec4 bonedPos = boneTransform * vec4(a_Position.xyz, 1.0);
+    vec3 bonedNormal = invtposBone * normal;
 
     v_Position = vec3(u_MMatrix * bonedPos);
 
@@ -44,11 +95,11 @@ void main() {
 
     v_Normal = u_InvTposMMatrix * bonedNormal;
 
-    vec3 t = normalize(u_InvTposMMatrix * invtposBone * a_Tangent);
-    vec3 b = normalize(u_InvTposMMatrix * invtposBone * a_Bitangent);
-    vec3 n = normalize(u_InvTposMMatrix * invtposBone * a_Normal);
+    vec3 t = normalize(u_InvTposMMatrix * invtposBone * tangent);
+    vec3 b = normalize(u_InvTposMMatrix * invtposBone * bitangent);
+    vec3 n = normalize(u_InvTposMMatrix * invtposBone * normal);
 
     v_InverseTBN = mat3(t,b,n);
 
-    gl_Position = u_MVPMatrix * bonedPos;
+    gl_Position = u_VPMatrix * vec4(v_Position, 1.0);
 }
@@ -1,12 +1,23 @@
 #version 300 es
 
-uniform mat4 u_MMatrix;
-uniform mat4 u_MVPMatrix;
-uniform mat4 u_MVMatrix;
-uniform mat3 u_InvTposMMatrix;
+layout(std140) uniform CameraBlock {
+    highp mat4 u_VMatrix;
+    highp mat4 u_PMatrix;
+    highp mat4 u_VPMatrix;
+    highp mat4 u_InvVPMatrix;
+    highp vec3 u_ViewPosition;
+    highp float u_NearPlane;
+    highp vec3 u_ViewDirection;
+    highp float u_FarPlane;
+    highp mat3 u_InvVRotMatrix;
+};
 
-uniform float u_NearPlane;
-uniform float u_FarPlane;
+layout(std140) uniform ModelBlock {
+    highp mat4 u_MMatrix;
+    highp mat4 u_InvMMatrix;
+    highp mat3 u_InvTposMMatrix;
+    highp uint u_NodeData;
+};
 
 layout(location = 0) in vec3 a_Position;
 
@@ -17,5 +28,5 @@ void main()
 {
     v_Position = vec3(u_MMatrix * vec4(a_Position, 1.0));
 
-    gl_Position = (u_MVPMatrix * vec4(a_Position, 1.0));
+    gl_Position = u_VPMatrix * vec4(v_Position, 1.0);
 }
@@ -0,0 +1,149 @@
+#include "capture_renderer.h"
+
+#include "src/backend/capture/render_capture.h"
+#include "src/util/log.h"
+#include "src/util/serialization_util.h"
+
+using namespace prt3;
+
+CaptureRenderer::CaptureRenderer(
+    RenderBackend * backend,
+    char const * capture_path
+)
+ : m_backend{backend},
+   m_out{capture_path, std::ios::binary} {
+    if (!m_out) {
+        PRT3ERROR("Failed to open capture file %s.\n", capture_path);
+    }
+    write_stream(m_out, RENDER_CAPTURE_MAGIC);
+    write_stream(m_out, RENDER_CAPTURE_VERSION);
+}
+
+CaptureRenderer::~CaptureRenderer() {
+    delete m_backend;
+}
+
+void CaptureRenderer::render(
+    RenderData & render_data,
+    bool editor
+) {
+    /* recorded before rendering since backends may modify the data */
+    write_stream(m_out, RenderCaptureRecord::frame);
+    write_stream(m_out, editor);
+    rendercapture::write_render_data(m_out, render_data);
+
+    m_backend->render(render_data, editor);
+}
+
+void CaptureRenderer::upload_model(
+    ModelHandle handle,
+    Model const & model,
+    std::vector<ResourceID> & mesh_resource_ids
+) {
+    m_backend->upload_model(handle, model, mesh_resource_ids);
+
+    write_stream(m_out, RenderCaptureRecord::upload_model);
+    write_stream(m_out, handle);
+    rendercapture::write_model(m_out, model);
+    write_stream(m_out, static_cast<uint32_t>(mesh_resource_ids.size()));
+    write_stream_n(m_out, mesh_resource_ids.data(), mesh_resource_ids.size());
+}
+
+void CaptureRenderer::free_model(
+    ModelHandle handle,
+    std::vector<ResourceID> const & mesh_resource_ids
+) {
+    write_stream(m_out, RenderCaptureRecord::free_model);
+    write_stream(m_out, handle);
+    write_stream(m_out, static_cast<uint32_t>(mesh_resource_ids.size()));
+    write_stream_n(m_out, mesh_resource_ids.data(), mesh_resource_ids.size());
+
+    m_backend->free_model(handle, mesh_resource_ids);
+}
+
+ResourceID CaptureRenderer::upload_pos_mesh(
+    glm::vec3 const * vertices,
+    size_t n
+) {
+    ResourceID id = m_backend->upload_pos_mesh(vertices, n);
+
+    write_stream(m_out, RenderCaptureRecord::upload_pos_mesh);
+    write_stream(m_out, id);
+    write_stream(m_out, static_cast<uint32_t>(n));
+    write_stream_n(m_out, vertices, n);
+
+    return id;
+}
+
+void CaptureRenderer::update_pos_mesh(
+    ResourceID id,
+    glm::vec3 const * vertices,
+    size_t n
+) {
+    write_stream(m_out, RenderCaptureRecord::update_pos_mesh);
+    write_stream(m_out, id);
+    write_stream(m_out, static_cast<uint32_t>(n));
+    write_stream_n(m_out, vertices, n);
+
+    m_backend->update_pos_mesh(id, vertices, n);
+}
+
+void CaptureRenderer::free_pos_mesh(ResourceID id) {
+    write_stream(m_out, RenderCaptureRecord::free_pos_mesh);
+    write_stream(m_out, id);
+
+    m_backend->free_pos_mesh(id);
+}
+
+void CaptureRenderer::set_postprocessing_chains(
+    PostProcessingChain const & scene_chain,
+    PostProcessingChain const & editor_chain
+) {
+    write_stream(m_out, RenderCaptureRecord::set_postprocessing_chains);
+    rendercapture::write_chain(m_out, scene_chain);
+    rendercapture::write_chain(m_out, editor_chain);
+
+    m_backend->set_postprocessing_chains(scene_chain, editor_chain);
+}
+
+ResourceID CaptureRenderer::upload_material(Material const & material) {
+    ResourceID id = m_backend->upload_material(material);
+
+    write_stream(m_out, RenderCaptureRecord::upload_material);
+    write_stream(m_out, id);
+    rendercapture::write_material(m_out, material);
+
+    return id;
+}
+
+void CaptureRenderer::free_material(ResourceID id) {
+    write_stream(m_out, RenderCaptureRecord::free_material);
+    write_stream(m_out, id);
+
+    m_backend->free_material(id);
+}
+
+ResourceID CaptureRenderer::upload_texture(TextureData const & data) {
+    ResourceID id = m_backend->upload_texture(data);
+
+    write_stream(m_out, RenderCaptureRecord::upload_texture);
+    write_stream(m_out, id);
+    rendercapture::write_texture(m_out, data);
+
+    return id;
+}
+
+void CaptureRenderer::update_texture(ResourceID id, TextureData const & data) {
+    write_stream(m_out, RenderCaptureRecord::update_texture);
+    write_stream(m_out, id);
+    rendercapture::write_texture(m_out, data);
+
+    m_backend->update_texture(id, data);
+}
+
+void CaptureRenderer::free_texture(ResourceID id) {
+    write_stream(m_out, RenderCaptureRecord::free_texture);
+    write_stream(m_out, id);
+
+    m_backend->free_texture(id);
+}
@@ -0,0 +1,102 @@
+#ifndef PRT3_CAPTURE_RENDERER_H
+#define PRT3_CAPTURE_RENDERER_H
+
+#include "src/backend/render_backend.h"
+
+#include <fstream>
+#include <vector>
+
+namespace prt3 {
+
+/* Forwards every call to another backend and records frames and resource
+ * uploads to a capture file, which can be replayed through any backend
+ * with RenderCaptureReplayer. Changes made to materials through
+ * get_material() are not recorded.
+ */
+class CaptureRenderer : public RenderBackend {
+public:
+    /* takes ownership of backend */
+    CaptureRenderer(RenderBackend * backend, char const * capture_path);
+
+    virtual ~CaptureRenderer();
+
+    virtual void prepare_imgui_rendering()
+    { m_backend->prepare_imgui_rendering(); }
+
+    virtual void render(
+        RenderData & render_data,
+        bool editor
+    );
+
+    virtual void upload_model(
+        ModelHandle handle,
+        Model const & model,
+        std::vector<ResourceID> & mesh_resource_ids
+    );
+
+    virtual void free_model(
+        ModelHandle handle,
+        std::vector<ResourceID> const & mesh_resource_ids
+    );
+
+    virtual ResourceID upload_pos_mesh(
+        glm::vec3 const * vertices,
+        size_t n
+    );
+
+    virtual void update_pos_mesh(
+        ResourceID id,
+        glm::vec3 const * vertices,
+        size_t n
+    );
+
+    virtual void free_pos_mesh(ResourceID id);
+
+    virtual void set_postprocessing_chains(
+        PostProcessingChain const & scene_chain,
+        PostProcessingChain const & editor_chain
+    );
+
+    virtual bool request_selection(int x, int y)
+    { return m_backend->request_selection(x, y); }
+    virtual bool poll_selection(NodeID & id)
+    { return m_backend->poll_selection(id); }
+
+    virtual ResourceID upload_material(Material const & material);
+    virtual void free_material(ResourceID id);
+
+    virtual Material const & get_material(ResourceID id) const
+    { return m_backend->get_material(id); }
+    virtual Material & get_material(ResourceID id)
+    { return m_backend->get_material(id); }
+
+    virtual ResourceID upload_texture(TextureData const & data);
+    virtual void update_texture(ResourceID id, TextureData const & data);
+    virtual void free_texture(ResourceID id);
+
+    void get_texture_metadata(
+        ResourceID id,
+        unsigned int & width,
+        unsigned int & height,
+        unsigned int & channels
+    ) const final {
+        m_backend->get_texture_metadata(id, width, height, channels);
+    }
+
+    void * get_internal_texture_id(ResourceID id) const final
+    { return m_backend->get_internal_texture_id(id); }
+
+    TextureFormatSupport texture_format_support() const final
+    { return m_backend->texture_format_support(); }
+
+    RenderStats render_stats() const final
+    { return m_backend->render_stats(); }
+
+private:
+    RenderBackend * m_backend;
+    std::ofstream m_out;
+};
+
+} // namespace prt3
+
+#endif // PRT3_CAPTURE_RENDERER_H
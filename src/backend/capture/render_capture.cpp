@@ -0,0 +1,317 @@
+#include "render_capture.h"
+
+#include "src/util/serialization_util.h"
+
+#include <type_traits>
+
+using namespace prt3;
+
+template<typename T>
+static void write_vector(std::ostream & out, std::vector<T> const & v) {
+    static_assert(std::is_trivially_copyable<T>::value);
+    uint32_t n = static_cast<uint32_t>(v.size());
+    write_stream(out, n);
+    write_stream_n(out, v.data(), n);
+}
+
+template<typename T>
+static void read_vector(std::istream & in, std::vector<T> & v) {
+    static_assert(std::is_trivially_copyable<T>::value);
+    uint32_t n;
+    read_stream(in, n);
+    v.resize(n);
+    read_stream_n(in, v.data(), n);
+}
+
+/* layouts of captures before version 4 */
+struct DecalAttributesV3 {
+    std::array<glm::vec4, 3> transform;
+    std::array<glm::vec4, 3> inv_transform;
+    glm::vec4 color;
+};
+
+struct ParticleAttributesV3 {
+    glm::vec4 pos_size;
+    glm::vec2 base_uv;
+    std::array<uint8_t, 4> color;
+};
+
+struct ParticleTextureRangeV3 {
+    uint32_t start_index;
+    uint32_t count;
+    glm::vec2 inv_div;
+    ResourceID texture;
+};
+
+static void read_decals_v3(std::istream & in, DecalData & data) {
+    thread_local std::vector<DecalAttributesV3> attributes;
+    read_vector(in, attributes);
+    read_vector(in, data.textures);
+
+    data.attributes.resize(attributes.size());
+    for (size_t i = 0; i < attributes.size(); ++i) {
+        DecalAttributes & attr = data.attributes[i];
+        attr.transform = attributes[i].transform;
+        attr.inv_transform = attributes[i].inv_transform;
+        attr.color = attributes[i].color;
+        attr.uv_transform = glm::vec4{0.0f, 0.0f, 1.0f, 1.0f};
+    }
+}
+
+static void read_particles_v3(std::istream & in, ParticleData & data) {
+    thread_local std::vector<ParticleAttributesV3> attributes;
+    thread_local std::vector<ParticleTextureRangeV3> ranges;
+    read_vector(in, attributes);
+    read_vector(in, ranges);
+
+    data.attributes.resize(attributes.size());
+    data.textures.resize(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        ParticleTextureRangeV3 const & range = ranges[i];
+        data.textures[i].start_index = range.start_index;
+        data.textures[i].count = range.count;
+        data.textures[i].texture = range.texture;
+
+        for (uint32_t j = 0; j < range.count; ++j) {
+            uint32_t index = range.start_index + j;
+            ParticleAttributes & attr = data.attributes[index];
+            attr.pos_size = attributes[index].pos_size;
+            attr.base_uv = attributes[index].base_uv;
+            attr.uv_size = range.inv_div;
+            attr.color = attributes[index].color;
+        }
+    }
+}
+
+void rendercapture::write_render_data(
+    std::ostream & out,
+    RenderData const & data
+) {
+    write_stream(out, data.camera_data);
+
+    SceneRenderData const & scene = data.scene;
+    write_vector(out, scene.mesh_data);
+    write_vector(out, scene.animated_mesh_data);
+
+    /* bones persist between frames on the backend, so only the dirty
+     * palettes are written unless the layout changed
+     */
+    BoneRenderData const & bone_data = scene.bone_data;
+    write_stream(out, bone_data.layout_changed);
+    write_vector(out, bone_data.palettes);
+    write_vector(out, bone_data.dirty_palettes);
+    write_stream(out, static_cast<uint32_t>(bone_data.bones.size()));
+    if (bone_data.layout_changed) {
+        write_stream_n(out, bone_data.bones.data(), bone_data.bones.size());
+    } else {
+        for (uint32_t index : bone_data.dirty_palettes) {
+            BonePalette const & palette = bone_data.palettes[index];
+            write_stream_n(
+                out,
+                bone_data.bones.data() + palette.offset,
+                palette.count
+            );
+        }
+    }
+
+    write_vector(out, scene.selected_mesh_data);
+    write_vector(out, scene.selected_animated_mesh_data);
+    write_vector(out, scene.decal_data.attributes);
+    write_vector(out, scene.decal_data.textures);
+    write_vector(out, scene.canvas_data);
+    write_vector(out, scene.canvas_ranges);
+    write_vector(out, scene.particle_data.attributes);
+    write_vector(out, scene.particle_data.textures);
+
+    LightRenderData const & light_data = scene.light_data;
+    write_vector(out, light_data.point_lights);
+    write_stream(out, light_data.directional_light);
+    write_stream(out, light_data.directional_light_on);
+    write_stream(out, light_data.ambient_light);
+
+    write_vector(out, data.editor_data.line_data);
+}
+
+void rendercapture::read_render_data(
+    std::istream & in,
+    uint32_t version,
+    RenderData & data
+) {
+    read_stream(in, data.camera_data);
+
+    SceneRenderData & scene = data.scene;
+    read_vector(in, scene.mesh_data);
+    read_vector(in, scene.animated_mesh_data);
+
+    BoneRenderData & bone_data = scene.bone_data;
+    read_stream(in, bone_data.layout_changed);
+    read_vector(in, bone_data.palettes);
+    read_vector(in, bone_data.dirty_palettes);
+    uint32_t n_bones;
+    read_stream(in, n_bones);
+    bone_data.bones.resize(n_bones);
+    if (bone_data.layout_changed) {
+        read_stream_n(in, bone_data.bones.data(), n_bones);
+    } else {
+        for (uint32_t index : bone_data.dirty_palettes) {
+            BonePalette const & palette = bone_data.palettes[index];
+            read_stream_n(
+                in,
+                bone_data.bones.data() + palette.offset,
+                palette.count
+            );
+        }
+    }
+
+    read_vector(in, scene.selected_mesh_data);
+    read_vector(in, scene.selected_animated_mesh_data);
+    if (version >= 4) {
+        read_vector(in, scene.decal_data.attributes);
+        read_vector(in, scene.decal_data.textures);
+    } else {
+        read_decals_v3(in, scene.decal_data);
+    }
+    read_vector(in, scene.canvas_data);
+    read_vector(in, scene.canvas_ranges);
+    if (version >= 4) {
+        read_vector(in, scene.particle_data.attributes);
+        read_vector(in, scene.particle_data.textures);
+    } else {
+        read_particles_v3(in, scene.particle_data);
+    }
+
+    LightRenderData & light_data = scene.light_data;
+    read_vector(in, light_data.point_lights);
+    read_stream(in, light_data.directional_light);
+    read_stream(in, light_data.directional_light_on);
+    read_stream(in, light_data.ambient_light);
+
+    read_vector(in, data.editor_data.line_data);
+}
+
+void rendercapture::write_model(std::ostream & out, Model const & model) {
+    write_stream(out, model.is_animated());
+    write_vector(out, model.vertex_buffer());
+    if (model.is_animated()) {
+        write_vector(out, model.vertex_bone_buffer());
+    }
+    write_vector(out, model.index_buffer());
+
+    write_stream(out, static_cast<uint32_t>(model.meshes().size()));
+    for (Model::Mesh const & mesh : model.meshes()) {
+        write_stream(out, mesh.start_index);
+        write_stream(out, mesh.num_indices);
+        write_stream(out, mesh.start_bone);
+        write_stream(out, mesh.num_bones);
+        write_stream(out, mesh.material_index);
+        write_stream(out, mesh.node_index);
+        write_vector(out, mesh.lods);
+    }
+}
+
+void rendercapture::read_model(std::istream & in, Model & model) {
+    bool animated;
+    read_stream(in, animated);
+    read_vector(in, model.vertex_buffer());
+    if (animated) {
+        read_vector(in, model.vertex_bone_buffer());
+        /* backends only check whether there are any animations */
+        model.animations().resize(1);
+    }
+    read_vector(in, model.index_buffer());
+
+    uint32_t n_meshes;
+    read_stream(in, n_meshes);
+    model.meshes().resize(n_meshes);
+    for (Model::Mesh & mesh : model.meshes()) {
+        read_stream(in, mesh.start_index);
+        read_stream(in, mesh.num_indices);
+        read_stream(in, mesh.start_bone);
+        read_stream(in, mesh.num_bones);
+        read_stream(in, mesh.material_index);
+        read_stream(in, mesh.node_index);
+        read_vector(in, mesh.lods);
+    }
+}
+
+void rendercapture::write_material(
+    std::ostream & out,
+    Material const & material
+) {
+    write_string(out, material.name);
+    write_stream(out, material.albedo);
+    write_stream(out, material.metallic);
+    write_stream(out, material.roughness);
+    write_stream(out, material.ao);
+    write_stream(out, material.emissive);
+    write_stream(out, material.twosided);
+    write_stream(out, material.transparent);
+    write_stream(out, material.albedo_map);
+    write_stream(out, material.normal_map);
+    write_stream(out, material.metallic_map);
+    write_stream(out, material.roughness_map);
+    write_stream(out, material.ambient_occlusion_map);
+}
+
+void rendercapture::read_material(std::istream & in, Material & material) {
+    read_string(in, material.name);
+    read_stream(in, material.albedo);
+    read_stream(in, material.metallic);
+    read_stream(in, material.roughness);
+    read_stream(in, material.ao);
+    read_stream(in, material.emissive);
+    read_stream(in, material.twosided);
+    read_stream(in, material.transparent);
+    read_stream(in, material.albedo_map);
+    read_stream(in, material.normal_map);
+    read_stream(in, material.metallic_map);
+    read_stream(in, material.roughness_map);
+    read_stream(in, material.ambient_occlusion_map);
+}
+
+void rendercapture::write_texture(std::ostream & out, TextureData const & data) {
+    write_stream(out, data.width);
+    write_stream(out, data.height);
+    write_stream(out, data.channels);
+    write_stream(out, data.n_levels);
+    write_stream(out, data.format);
+    write_stream_n(out, data.data, texture_data_size(data));
+}
+
+void rendercapture::read_texture(
+    std::istream & in,
+    uint32_t version,
+    TextureData & data
+) {
+    read_stream(in, data.width);
+    read_stream(in, data.height);
+    read_stream(in, data.channels);
+    if (version >= 3) {
+        read_stream(in, data.n_levels);
+        read_stream(in, data.format);
+    }
+    size_t size = texture_data_size(data);
+    data.data = new unsigned char[size];
+    read_stream_n(in, data.data, size);
+}
+
+void rendercapture::write_chain(
+    std::ostream & out,
+    PostProcessingChain const & chain
+) {
+    write_stream(out, static_cast<uint32_t>(chain.passes.size()));
+    for (PostProcessingPass const & pass : chain.passes) {
+        write_string(out, pass.fragment_shader_path);
+        write_stream(out, pass.downscale_factor);
+    }
+}
+
+void rendercapture::read_chain(std::istream & in, PostProcessingChain & chain) {
+    uint32_t n_passes;
+    read_stream(in, n_passes);
+    chain.passes.resize(n_passes);
+    for (PostProcessingPass & pass : chain.passes) {
+        read_string(in, pass.fragment_shader_path);
+        read_stream(in, pass.downscale_factor);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef PRT3_RENDER_CAPTURE_H
+#define PRT3_RENDER_CAPTURE_H
+
+#include "src/engine/rendering/material.h"
+#include "src/engine/rendering/model.h"
+#include "src/engine/rendering/postprocessing_chain.h"
+#include "src/engine/rendering/render_data.h"
+#include "src/engine/rendering/texture.h"
+
+#include <cstdint>
+#include <iostream>
+
+namespace prt3 {
+
+/* A capture file starts with RENDER_CAPTURE_MAGIC and
+ * RENDER_CAPTURE_VERSION, followed by records that each start with a
+ * RenderCaptureRecord tag. Resource ids in the file are the ids that the
+ * captured backend returned, a replay maps them to the ids of the backend
+ * that replays the capture.
+ */
+constexpr uint32_t RENDER_CAPTURE_MAGIC = 0x43523350; // "P3RC"
+constexpr uint32_t RENDER_CAPTURE_VERSION = 4;
+/* the oldest version that can be replayed */
+constexpr uint32_t RENDER_CAPTURE_MIN_VERSION = 2;
+
+enum class RenderCaptureRecord : uint8_t {
+    frame,
+    upload_model,
+    free_model,
+    upload_pos_mesh,
+    update_pos_mesh,
+    free_pos_mesh,
+    upload_material,
+    free_material,
+    upload_texture,
+    free_texture,
+    set_postprocessing_chains,
+    update_texture
+};
+
+namespace rendercapture {
+
+void write_render_data(std::ostream & out, RenderData const & data);
+/* decals and particles of captures before version 4 are converted to the
+ * current layout, with untransformed texture coordinates
+ */
+void read_render_data(std::istream & in, uint32_t version, RenderData & data);
+
+/* only the data that backends upload is stored */
+void write_model(std::ostream & out, Model const & model);
+void read_model(std::istream & in, Model & model);
+
+void write_material(std::ostream & out, Material const & material);
+void read_material(std::istream & in, Material & material);
+
+void write_texture(std::ostream & out, TextureData const & data);
+/* data.data is allocated with new[]. Captures before version 3 only store
+ * the first mip level, uncompressed.
+ */
+void read_texture(std::istream & in, uint32_t version, TextureData & data);
+
+void write_chain(std::ostream & out, PostProcessingChain const & chain);
+void read_chain(std::istream & in, PostProcessingChain & chain);
+
+} // namespace rendercapture
+
+} // namespace prt3
+
+#endif
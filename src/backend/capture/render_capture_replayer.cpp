@@ -0,0 +1,276 @@
+#include "render_capture_replayer.h"
+
+#include "src/util/log.h"
+#include "src/util/serialization_util.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace prt3;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double elapsed_ms(Clock::time_point start) {
+    std::chrono::duration<double, std::milli> duration = Clock::now() - start;
+    return duration.count();
+}
+
+static ResourceID remap(
+    std::unordered_map<ResourceID, ResourceID> const & ids,
+    ResourceID id
+) {
+    auto it = ids.find(id);
+    return it != ids.end() ? it->second : NO_RESOURCE;
+}
+
+static void read_ids(std::istream & in, std::vector<ResourceID> & ids) {
+    uint32_t n;
+    read_stream(in, n);
+    ids.resize(n);
+    read_stream_n(in, ids.data(), n);
+}
+
+RenderCaptureReplayer::RenderCaptureReplayer(RenderBackend & backend)
+ : m_backend{backend} {}
+
+bool RenderCaptureReplayer::open(char const * path) {
+    m_in.open(path, std::ios::binary);
+    if (!m_in) {
+        PRT3ERROR("Failed to open capture file %s.\n", path);
+        return false;
+    }
+
+    uint32_t magic;
+    read_stream(m_in, magic);
+    read_stream(m_in, m_version);
+    if (!m_in || magic != RENDER_CAPTURE_MAGIC) {
+        PRT3ERROR("%s is not a render capture.\n", path);
+        return false;
+    }
+    /* Version 1 was written both with and without levels of detail in
+     * models and mesh data, so it can not be parsed reliably. Versions
+     * before 3 store textures without their mip chain and versions before
+     * 4 store decals and particles in an older layout, both of which are
+     * converted on read.
+     */
+    if (m_version < RENDER_CAPTURE_MIN_VERSION ||
+        m_version > RENDER_CAPTURE_VERSION) {
+        PRT3ERROR("Unsupported render capture version %u.\n", m_version);
+        return false;
+    }
+
+    return true;
+}
+
+bool RenderCaptureReplayer::replay_next() {
+    Clock::time_point read_start = Clock::now();
+    double resource_time = 0.0;
+
+    while (true) {
+        RenderCaptureRecord record;
+        read_stream(m_in, record);
+        if (!m_in) {
+            return false;
+        }
+        if (record == RenderCaptureRecord::frame) {
+            break;
+        }
+
+        Clock::time_point resource_start = Clock::now();
+        replay_record(record);
+        resource_time += elapsed_ms(resource_start);
+    }
+
+    bool editor;
+    read_stream(m_in, editor);
+    rendercapture::read_render_data(m_in, m_version, m_render_data);
+    remap_render_data();
+    double read_time = elapsed_ms(read_start) - resource_time;
+
+    Clock::time_point render_start = Clock::now();
+    m_backend.render(m_render_data, editor);
+    double render_time = elapsed_ms(render_start);
+
+    add_frame_time(m_stats.read, read_time);
+    add_frame_time(m_stats.resources, resource_time);
+    add_frame_time(m_stats.render, render_time);
+    ++m_stats.n_frames;
+
+    return true;
+}
+
+void RenderCaptureReplayer::replay_record(RenderCaptureRecord record) {
+    switch (record) {
+        case RenderCaptureRecord::upload_model: {
+            ModelHandle handle;
+            read_stream(m_in, handle);
+            Model model;
+            rendercapture::read_model(m_in, model);
+            std::vector<ResourceID> captured_ids;
+            read_ids(m_in, captured_ids);
+
+            std::vector<ResourceID> ids;
+            m_backend.upload_model(handle, model, ids);
+            for (size_t i = 0; i < captured_ids.size() && i < ids.size(); ++i) {
+                m_mesh_ids[captured_ids[i]] = ids[i];
+            }
+            break;
+        }
+        case RenderCaptureRecord::free_model: {
+            ModelHandle handle;
+            read_stream(m_in, handle);
+            std::vector<ResourceID> ids;
+            read_ids(m_in, ids);
+            for (ResourceID & id : ids) {
+                ResourceID captured_id = id;
+                id = remap(m_mesh_ids, captured_id);
+                m_mesh_ids.erase(captured_id);
+            }
+            m_backend.free_model(handle, ids);
+            break;
+        }
+        case RenderCaptureRecord::upload_pos_mesh: {
+            ResourceID captured_id;
+            read_stream(m_in, captured_id);
+            uint32_t n;
+            read_stream(m_in, n);
+            std::vector<glm::vec3> vertices(n);
+            read_stream_n(m_in, vertices.data(), n);
+            m_mesh_ids[captured_id] =
+                m_backend.upload_pos_mesh(vertices.data(), n);
+            break;
+        }
+        case RenderCaptureRecord::update_pos_mesh: {
+            ResourceID captured_id;
+            read_stream(m_in, captured_id);
+            uint32_t n;
+            read_stream(m_in, n);
+            std::vector<glm::vec3> vertices(n);
+            read_stream_n(m_in, vertices.data(), n);
+            m_backend.update_pos_mesh(
+                remap(m_mesh_ids, captured_id),
+                vertices.data(),
+                n
+            );
+            break;
+        }
+        case RenderCaptureRecord::free_pos_mesh: {
+            ResourceID captured_id;
+            read_stream(m_in, captured_id);
+            m_backend.free_pos_mesh(remap(m_mesh_ids, captured_id));
+            m_mesh_ids.erase(captured_id);
+            break;
+        }
+        case RenderCaptureRecord::upload_material: {
+            ResourceID captured_id;
+            read_stream(m_in, captured_id);
+            Material material;
+            rendercapture::read_material(m_in, material);
+            material.albedo_map = remap(m_texture_ids, material.albedo_map);
+            material.normal_map = remap(m_texture_ids, material.normal_map);
+            material.metallic_map =
+                remap(m_texture_ids, material.metallic_map);
+            material.roughness_map =
+                remap(m_texture_ids, material.roughness_map);
+            material.ambient_occlusion_map =
+                remap(m_texture_ids, material.ambient_occlusion_map);
+            m_material_ids[captured_id] = m_backend.upload_material(material);
+            break;
+        }
+        case RenderCaptureRecord::free_material: {
+            ResourceID captured_id;
+            read_stream(m_in, captured_id);
+            m_backend.free_material(remap(m_material_ids, captured_id));
+            m_material_ids.erase(captured_id);
+            break;
+        }
+        case RenderCaptureRecord::upload_texture: {
+            ResourceID captured_id;
+            read_stream(m_in, captured_id);
+            TextureData data;
+            rendercapture::read_texture(m_in, m_version, data);
+            m_texture_ids[captured_id] = m_backend.upload_texture(data);
+            delete[] data.data;
+            break;
+        }
+        case RenderCaptureRecord::update_texture: {
+            ResourceID captured_id;
+            read_stream(m_in, captured_id);
+            TextureData data;
+            rendercapture::read_texture(m_in, m_version, data);
+            m_backend.update_texture(remap(m_texture_ids, captured_id), data);
+            delete[] data.data;
+            break;
+        }
+        case RenderCaptureRecord::free_texture: {
+            ResourceID captured_id;
+            read_stream(m_in, captured_id);
+            m_backend.free_texture(remap(m_texture_ids, captured_id));
+            m_texture_ids.erase(captured_id);
+            break;
+        }
+        case RenderCaptureRecord::set_postprocessing_chains: {
+            PostProcessingChain scene_chain;
+            PostProcessingChain editor_chain;
+            rendercapture::read_chain(m_in, scene_chain);
+            rendercapture::read_chain(m_in, editor_chain);
+            m_backend.set_postprocessing_chains(scene_chain, editor_chain);
+            break;
+        }
+        default: {
+            PRT3ERROR("Invalid render capture record %d.\n",
+                      static_cast<int>(record));
+            m_in.setstate(std::ios::failbit);
+            break;
+        }
+    }
+}
+
+void RenderCaptureReplayer::remap_render_data() {
+    auto remap_mesh = [this](MeshRenderData & data) {
+        data.mesh_id = remap(m_mesh_ids, data.mesh_id);
+        data.material_id = remap(m_material_ids, data.material_id);
+    };
+
+    SceneRenderData & scene = m_render_data.scene;
+    for (MeshRenderData & data : scene.mesh_data) {
+        remap_mesh(data);
+    }
+    for (MeshRenderData & data : scene.selected_mesh_data) {
+        remap_mesh(data);
+    }
+    for (AnimatedMeshRenderData & data : scene.animated_mesh_data) {
+        remap_mesh(data.mesh_data);
+    }
+    for (AnimatedMeshRenderData & data : scene.selected_animated_mesh_data) {
+        remap_mesh(data.mesh_data);
+    }
+
+    for (DecalData::TextureRange & range : scene.decal_data.textures) {
+        range.texture = remap(m_texture_ids, range.texture);
+    }
+    for (ParticleData::TextureRange & range : scene.particle_data.textures) {
+        range.texture = remap(m_texture_ids, range.texture);
+    }
+    for (RenderRect2D & rect : scene.canvas_data) {
+        rect.texture = remap(m_texture_ids, rect.texture);
+    }
+
+    for (WireframeRenderData & data : m_render_data.editor_data.line_data) {
+        data.mesh_id = remap(m_mesh_ids, data.mesh_id);
+    }
+}
+
+void RenderCaptureReplayer::add_frame_time(
+    RenderReplayStats::Phase & phase,
+    double time
+) {
+    if (m_stats.n_frames == 0) {
+        phase.min = time;
+        phase.max = time;
+    } else {
+        phase.min = std::min(phase.min, time);
+        phase.max = std::max(phase.max, time);
+    }
+    phase.total += time;
+}
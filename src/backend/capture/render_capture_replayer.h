@@ -0,0 +1,65 @@
+#ifndef PRT3_RENDER_CAPTURE_REPLAYER_H
+#define PRT3_RENDER_CAPTURE_REPLAYER_H
+
+#include "src/backend/render_backend.h"
+#include "src/backend/capture/render_capture.h"
+
+#include <fstream>
+#include <unordered_map>
+
+namespace prt3 {
+
+/* CPU time in milliseconds spent in each phase of a replay */
+struct RenderReplayStats {
+    struct Phase {
+        double total = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+    };
+
+    uint32_t n_frames = 0;
+    /* reading records from the capture file */
+    Phase read;
+    /* uploading and freeing resources */
+    Phase resources;
+    /* RenderBackend::render() */
+    Phase render;
+};
+
+/* Replays a capture recorded by CaptureRenderer through a backend. Ids in
+ * the capture are mapped to the ids returned by the replaying backend.
+ */
+class RenderCaptureReplayer {
+public:
+    RenderCaptureReplayer(RenderBackend & backend);
+
+    bool open(char const * path);
+
+    /* replays records up to and including the next frame, returns false at
+     * the end of the capture
+     */
+    bool replay_next();
+
+    RenderReplayStats const & stats() const { return m_stats; }
+
+private:
+    RenderBackend & m_backend;
+    std::ifstream m_in;
+    uint32_t m_version = 0;
+
+    RenderData m_render_data;
+
+    std::unordered_map<ResourceID, ResourceID> m_mesh_ids;
+    std::unordered_map<ResourceID, ResourceID> m_material_ids;
+    std::unordered_map<ResourceID, ResourceID> m_texture_ids;
+
+    RenderReplayStats m_stats;
+
+    void replay_record(RenderCaptureRecord record);
+    void remap_render_data();
+    void add_frame_time(RenderReplayStats::Phase & phase, double time);
+};
+
+} // namespace prt3
+
+#endif
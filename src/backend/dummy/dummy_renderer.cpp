@@ -23,10 +23,6 @@ ResourceID DummyRenderer::upload_pos_mesh(
     return id;
 }
 
-NodeID DummyRenderer::get_selected(int, int) {
-    return NO_NODE;
-}
-
 ResourceID DummyRenderer::upload_material(Material const & material) {
     ResourceID id = m_materials.size();
     m_materials[id] = material;
@@ -54,6 +50,12 @@ ResourceID DummyRenderer::upload_texture(TextureData const & data) {
     return id;
 }
 
+void DummyRenderer::update_texture(ResourceID id, TextureData const & data) {
+    m_texture_metadata.at(id).width = data.width;
+    m_texture_metadata.at(id).height = data.height;
+    m_texture_metadata.at(id).channels = data.channels;
+}
+
 void DummyRenderer::get_texture_metadata(
     ResourceID id,
     unsigned int & width,
@@ -52,7 +52,8 @@ public:
         PostProcessingChain const &
     ) {}
 
-    virtual NodeID get_selected(int x, int y);
+    virtual bool request_selection(int, int) { return false; }
+    virtual bool poll_selection(NodeID &) { return false; }
 
     virtual ResourceID upload_material(Material const & material);
     virtual void free_material(ResourceID);
@@ -61,6 +62,7 @@ public:
     virtual Material & get_material(ResourceID id);
 
     virtual ResourceID upload_texture(TextureData const & data);
+    virtual void update_texture(ResourceID id, TextureData const & data);
     virtual void free_texture(ResourceID id) {
         m_texture_metadata.erase(id);
     };
@@ -76,6 +78,10 @@ public:
         return reinterpret_cast<void *>(static_cast<intptr_t>(id));
     }
 
+    TextureFormatSupport texture_format_support() const final { return {}; }
+
+    RenderStats render_stats() const final { return {}; }
+
 private:
     struct TextureMetadata {
         unsigned int width;
@@ -0,0 +1,131 @@
+#include "gl_bone_palettes.h"
+
+#include <algorithm>
+
+using namespace prt3;
+
+void GLBonePalettes::init() {
+    clean_up();
+
+    static_assert(sizeof(BoneMatrix) == TEXELS_PER_BONE * 4 * sizeof(float));
+
+    GL_CHECK(glGenTextures(1, &m_texture));
+    allocate_texture(1);
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void GLBonePalettes::clean_up() {
+    if (m_texture != 0) {
+        GL_CHECK(glDeleteTextures(1, &m_texture));
+        m_texture = 0;
+        m_texture_height = 0;
+    }
+}
+
+void GLBonePalettes::allocate_texture(GLsizei height) {
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_texture));
+    GL_CHECK(glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        GL_RGBA32F,
+        TEXTURE_WIDTH,
+        height,
+        0,
+        GL_RGBA,
+        GL_FLOAT,
+        nullptr
+    ));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    m_texture_height = height;
+}
+
+void GLBonePalettes::upload_bones(
+    BoneRenderData const & bone_data,
+    uint32_t first,
+    uint32_t count
+) {
+    /* the range may start and end partway through a row */
+    GLsizei texel = static_cast<GLsizei>(first) * TEXELS_PER_BONE;
+    GLsizei end = texel + static_cast<GLsizei>(count) * TEXELS_PER_BONE;
+    float const * data = &bone_data.bones[first][0][0];
+
+    while (texel < end) {
+        GLsizei x = texel % TEXTURE_WIDTH;
+        GLsizei y = texel / TEXTURE_WIDTH;
+        GLsizei n;
+        GLsizei rows;
+        if (x == 0 && end - texel >= TEXTURE_WIDTH) {
+            rows = (end - texel) / TEXTURE_WIDTH;
+            n = TEXTURE_WIDTH;
+        } else {
+            rows = 1;
+            n = std::min(TEXTURE_WIDTH - x, end - texel);
+        }
+
+        GL_CHECK(glTexSubImage2D(
+            GL_TEXTURE_2D,
+            0,
+            x,
+            y,
+            n,
+            rows,
+            GL_RGBA,
+            GL_FLOAT,
+            data
+        ));
+
+        texel += n * rows;
+        data += 4 * n * rows;
+    }
+}
+
+void GLBonePalettes::upload(BoneRenderData const & bone_data) {
+    GLsizei n_texels =
+        static_cast<GLsizei>(bone_data.bones.size()) * TEXELS_PER_BONE;
+    GLsizei height = (n_texels + TEXTURE_WIDTH - 1) / TEXTURE_WIDTH;
+
+    bool upload_all = bone_data.layout_changed;
+    if (height > m_texture_height) {
+        /* grow geometrically to avoid reallocating as animations are added */
+        GLsizei new_height = m_texture_height;
+        while (new_height < height) {
+            new_height *= 2;
+        }
+        allocate_texture(new_height);
+        upload_all = true;
+    } else {
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_texture));
+    }
+
+    if (upload_all) {
+        if (!bone_data.bones.empty()) {
+            upload_bones(
+                bone_data,
+                0,
+                static_cast<uint32_t>(bone_data.bones.size())
+            );
+        }
+    } else {
+        /* dirty palettes are in ascending order and palettes are packed
+         * back to back, so runs of neighbours are merged into one upload
+         */
+        auto const & dirty = bone_data.dirty_palettes;
+        size_t i = 0;
+        while (i < dirty.size()) {
+            BonePalette const & first = bone_data.palettes[dirty[i]];
+            uint32_t count = first.count;
+            size_t j = i + 1;
+            while (j < dirty.size() && dirty[j] == dirty[j - 1] + 1) {
+                count += bone_data.palettes[dirty[j]].count;
+                ++j;
+            }
+            upload_bones(bone_data, first.offset, count);
+            i = j;
+        }
+    }
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+}
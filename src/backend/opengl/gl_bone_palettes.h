@@ -0,0 +1,44 @@
+#ifndef PRT3_GL_BONE_PALETTES_H
+#define PRT3_GL_BONE_PALETTES_H
+
+#include "src/backend/opengl/gl_utility.h"
+#include "src/engine/rendering/render_data.h"
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GLES3/gl3.h>
+
+namespace prt3 {
+
+/* Keeps the bone matrices of all animations in a single RGBA32F texture
+ * that is TEXTURE_WIDTH texels wide. Each bone occupies three consecutive
+ * texels holding the rows of its 3x4 matrix. Draws select their palette
+ * with a bone offset rather than uploading matrices per draw.
+ */
+class GLBonePalettes {
+public:
+    static constexpr GLsizei TEXTURE_WIDTH = 1024;
+    static constexpr GLsizei TEXELS_PER_BONE = 3;
+
+    static constexpr unsigned int TEXTURE_UNIT = 6;
+
+    void init();
+    void clean_up();
+
+    /* uploads the palettes that changed since the previous call */
+    void upload(BoneRenderData const & bone_data);
+
+    GLuint texture() const { return m_texture; }
+
+private:
+    GLuint m_texture = 0;
+    GLsizei m_texture_height = 0;
+
+    void allocate_texture(GLsizei height);
+    void upload_bones(BoneRenderData const & bone_data,
+                      uint32_t first,
+                      uint32_t count);
+};
+
+} // namespace prt3
+
+#endif
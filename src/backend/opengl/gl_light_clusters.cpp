@@ -0,0 +1,129 @@
+#include "gl_light_clusters.h"
+
+using namespace prt3;
+
+static void set_nearest_filtering() {
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+void GLLightClusters::init() {
+    clean_up();
+
+    static_assert(sizeof(LightClusters::Cluster) == 2 * sizeof(GLuint));
+
+    GL_CHECK(glGenTextures(1, &m_grid_texture));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_grid_texture));
+    GL_CHECK(glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        GL_RG32UI,
+        LightClusters::DIM_X * LightClusters::DIM_Y,
+        LightClusters::DIM_Z,
+        0,
+        GL_RG_INTEGER,
+        GL_UNSIGNED_INT,
+        nullptr
+    ));
+    set_nearest_filtering();
+
+    GL_CHECK(glGenTextures(1, &m_index_texture));
+    allocate_index_texture(1);
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void GLLightClusters::clean_up() {
+    if (m_grid_texture != 0) {
+        GL_CHECK(glDeleteTextures(1, &m_grid_texture));
+        GL_CHECK(glDeleteTextures(1, &m_index_texture));
+        m_grid_texture = 0;
+        m_index_texture = 0;
+        m_index_texture_height = 0;
+    }
+}
+
+void GLLightClusters::allocate_index_texture(GLsizei height) {
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_index_texture));
+    GL_CHECK(glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        GL_R16UI,
+        INDEX_TEXTURE_WIDTH,
+        height,
+        0,
+        GL_RED_INTEGER,
+        GL_UNSIGNED_SHORT,
+        nullptr
+    ));
+    set_nearest_filtering();
+    m_index_texture_height = height;
+}
+
+void GLLightClusters::upload(LightClusters const & light_clusters) {
+    auto const & clusters = light_clusters.clusters();
+    auto const & indices = light_clusters.light_indices();
+
+    GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_grid_texture));
+    GL_CHECK(glTexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        0,
+        0,
+        LightClusters::DIM_X * LightClusters::DIM_Y,
+        LightClusters::DIM_Z,
+        GL_RG_INTEGER,
+        GL_UNSIGNED_INT,
+        clusters.data()
+    ));
+
+    GLsizei n = static_cast<GLsizei>(indices.size());
+    GLsizei full_rows = n / INDEX_TEXTURE_WIDTH;
+    GLsizei remainder = n % INDEX_TEXTURE_WIDTH;
+    GLsizei height = full_rows + (remainder > 0 ? 1 : 0);
+
+    if (height > m_index_texture_height) {
+        /* grow geometrically to avoid reallocating every frame */
+        GLsizei new_height = m_index_texture_height;
+        while (new_height < height) {
+            new_height *= 2;
+        }
+        allocate_index_texture(new_height);
+    } else {
+        GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_index_texture));
+    }
+
+    if (full_rows > 0) {
+        GL_CHECK(glTexSubImage2D(
+            GL_TEXTURE_2D,
+            0,
+            0,
+            0,
+            INDEX_TEXTURE_WIDTH,
+            full_rows,
+            GL_RED_INTEGER,
+            GL_UNSIGNED_SHORT,
+            indices.data()
+        ));
+    }
+    if (remainder > 0) {
+        GL_CHECK(glTexSubImage2D(
+            GL_TEXTURE_2D,
+            0,
+            0,
+            full_rows,
+            remainder,
+            1,
+            GL_RED_INTEGER,
+            GL_UNSIGNED_SHORT,
+            indices.data() + full_rows * INDEX_TEXTURE_WIDTH
+        ));
+    }
+
+    GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+}
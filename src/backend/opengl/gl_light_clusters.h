@@ -0,0 +1,44 @@
+#ifndef PRT3_GL_LIGHT_CLUSTERS_H
+#define PRT3_GL_LIGHT_CLUSTERS_H
+
+#include "src/backend/opengl/gl_utility.h"
+#include "src/engine/rendering/light_clusters.h"
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GLES3/gl3.h>
+
+namespace prt3 {
+
+/* Uploads the cluster grid and light index list of LightClusters into
+ * integer textures, since WebGL 2 lacks storage buffers.
+ *
+ * The grid is an RG32UI texture of DIM_X * DIM_Y by DIM_Z texels holding
+ * (offset, count) per cluster. The index list is an R16UI texture that is
+ * INDEX_TEXTURE_WIDTH texels wide and grows in height as needed.
+ */
+class GLLightClusters {
+public:
+    static constexpr GLsizei INDEX_TEXTURE_WIDTH = 1024;
+
+    static constexpr unsigned int GRID_TEXTURE_UNIT = 4;
+    static constexpr unsigned int INDEX_TEXTURE_UNIT = 5;
+
+    void init();
+    void clean_up();
+
+    void upload(LightClusters const & light_clusters);
+
+    GLuint grid_texture() const { return m_grid_texture; }
+    GLuint index_texture() const { return m_index_texture; }
+
+private:
+    GLuint m_grid_texture = 0;
+    GLuint m_index_texture = 0;
+    GLsizei m_index_texture_height = 0;
+
+    void allocate_index_texture(GLsizei height);
+};
+
+} // namespace prt3
+
+#endif
@@ -4,6 +4,8 @@
 #include "src/backend/opengl/gl_utility.h"
 #include "src/util/log.h"
 
+#include <algorithm>
+
 using namespace prt3;
 
 GLMesh::GLMesh() {
@@ -12,29 +14,54 @@ GLMesh::GLMesh() {
 
 void GLMesh::init(GLuint vao,
                   uint32_t start_index,
-                  uint32_t num_indices) {
+                  uint32_t num_indices,
+                  GLenum index_type) {
     m_vao = vao;
     m_start_index = start_index;
     m_num_indices = num_indices;
+    m_index_type = index_type;
+    m_n_lods = 0;
+    m_position_transform = glm::mat4{1.0f};
 
     m_initialized = true;
 }
 
-void GLMesh::draw_elements_triangles() const {
-    GL_CHECK(glBindVertexArray(m_vao));
+void GLMesh::add_lod(uint32_t start_index, uint32_t num_indices) {
+    if (m_n_lods < m_lods.size()) {
+        m_lods[m_n_lods] = {start_index, num_indices};
+        ++m_n_lods;
+    }
+}
+
+void GLMesh::draw_elements_triangles(
+    GLStateCache & state,
+    uint32_t lod
+) const {
+    uint32_t start_index = m_start_index;
+    uint32_t num_indices = m_num_indices;
+    if (lod > 0 && m_n_lods > 0) {
+        IndexRange const & range = m_lods[std::min(lod, m_n_lods) - 1];
+        start_index = range.start_index;
+        num_indices = range.num_indices;
+    }
+
+    size_t index_size = m_index_type == GL_UNSIGNED_SHORT ?
+        sizeof(GLushort) : sizeof(GLuint);
+
+    state.bind_vertex_array(m_vao);
     GL_CHECK(glDrawElements(
-        GL_TRIANGLES, m_num_indices, GL_UNSIGNED_INT,
-        reinterpret_cast<void*>(m_start_index * sizeof(GLuint))
+        GL_TRIANGLES, num_indices, m_index_type,
+        reinterpret_cast<void*>(start_index * index_size)
     ));
 }
 
-void GLMesh::draw_array_lines() const {
-    GL_CHECK(glBindVertexArray(m_vao));
+void GLMesh::draw_array_lines(GLStateCache & state) const {
+    state.bind_vertex_array(m_vao);
     GL_CHECK(glDrawArrays(GL_LINES, m_start_index, m_num_indices));
 }
 
-void GLMesh::draw_array_triangles() const {
-    GL_CHECK(glBindVertexArray(m_vao));
+void GLMesh::draw_array_triangles(GLStateCache & state) const {
+    state.bind_vertex_array(m_vao);
     GL_CHECK(glDrawArrays(GL_TRIANGLES, m_start_index, m_num_indices));
 }
 
@@ -2,12 +2,15 @@
 #define PRT3_GL_MESH_H
 
 #include "src/backend/opengl/gl_material.h"
+#include "src/backend/opengl/gl_state_cache.h"
+#include "src/engine/rendering/model.h"
 #include "src/engine/rendering/render_data.h"
 #include "src/engine/rendering/postprocessing_chain.h"
 
 #define GL_GLEXT_PROTOTYPES 1
 #include <GLES3/gl3.h>
 
+#include <array>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -18,15 +21,34 @@ class GLMesh {
 public:
     GLMesh();
 
+    /* start_index is in units of index_type */
     void init(
         GLuint vao,
         uint32_t start_index,
-        uint32_t num_indices
+        uint32_t num_indices,
+        GLenum index_type = GL_UNSIGNED_INT
     );
 
-    void draw_elements_triangles() const;
-    void draw_array_lines() const;
-    void draw_array_triangles() const;
+    /* maps the vertex positions of the mesh into model space, positions
+     * may be quantized
+     */
+    void set_position_transform(glm::mat4 const & transform)
+    { m_position_transform = transform; }
+    glm::mat4 const & position_transform() const
+    { return m_position_transform; }
+
+    /* adds a coarser level of detail, in order from finest to coarsest */
+    void add_lod(uint32_t start_index, uint32_t num_indices);
+
+    /* levels of detail that the mesh does not have fall back to the
+     * coarsest one it has
+     */
+    void draw_elements_triangles(
+        GLStateCache & state,
+        uint32_t lod = 0
+    ) const;
+    void draw_array_lines(GLStateCache & state) const;
+    void draw_array_triangles(GLStateCache & state) const;
 
 private:
     bool m_initialized = false;
@@ -36,6 +58,17 @@ private:
 
     uint32_t m_start_index;
     uint32_t m_num_indices;
+    GLenum m_index_type = GL_UNSIGNED_INT;
+
+    glm::mat4 m_position_transform{1.0f};
+
+    struct IndexRange {
+        uint32_t start_index;
+        uint32_t num_indices;
+    };
+
+    std::array<IndexRange, Model::MAX_LODS - 1> m_lods;
+    uint32_t m_n_lods = 0;
 };
 
 } // namespace prt3
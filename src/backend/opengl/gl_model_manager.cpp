@@ -2,6 +2,8 @@
 
 #include "src/backend/opengl/gl_utility.h"
 
+#include <algorithm>
+#include <cstring>
 #include <unordered_set>
 
 using namespace prt3;
@@ -11,11 +13,103 @@ GLModelManager::GLModelManager(GLMaterialManager & material_manager)
 
 }
 
+/* largest number of vertices that a mesh can address with 16-bit indices */
+static constexpr uint32_t MAX_SHORT_INDEX_VERTICES = 1u << 16;
+
+struct MeshIndexLayout {
+    GLenum type;
+    uint32_t base_vertex;
+    uint32_t start_index;
+    uint32_t lod_start_indices[Model::MAX_LODS - 1];
+};
+
+/* appends indices as index_type and returns where they start, in units
+ * of index_type
+ */
+static uint32_t append_indices(
+    std::vector<uint8_t> & data,
+    uint32_t const * indices,
+    uint32_t num_indices,
+    GLenum index_type,
+    uint32_t base_vertex
+) {
+    if (index_type == GL_UNSIGNED_SHORT) {
+        uint32_t start_index = static_cast<uint32_t>(data.size() / sizeof(GLushort));
+        data.resize(data.size() + num_indices * sizeof(GLushort));
+        GLushort * dst = reinterpret_cast<GLushort*>(
+            data.data() + start_index * sizeof(GLushort)
+        );
+        for (uint32_t i = 0; i < num_indices; ++i) {
+            dst[i] = static_cast<GLushort>(indices[i] - base_vertex);
+        }
+        return start_index;
+    }
+
+    /* 32-bit indices have to be aligned to their size */
+    data.resize((data.size() + sizeof(GLuint) - 1) & ~(sizeof(GLuint) - 1));
+    uint32_t start_index = static_cast<uint32_t>(data.size() / sizeof(GLuint));
+    data.resize(data.size() + num_indices * sizeof(GLuint));
+    std::memcpy(
+        data.data() + start_index * sizeof(GLuint),
+        indices,
+        num_indices * sizeof(GLuint)
+    );
+    return start_index;
+}
+
 void GLModelManager::upload_model(
     ModelHandle handle,
     Model const & model,
     std::vector<ResourceID> & mesh_resource_ids
 ) {
+    /* Meshes whose vertices fit in a 16-bit range are drawn with 16-bit
+     * indices relative to their first vertex. Model::optimize_meshes keeps
+     * the vertices of each mesh together, which is what makes this work
+     * for models with more vertices than that.
+     */
+    std::vector<uint32_t> const & indices = model.index_buffer();
+    thread_local std::vector<uint8_t> index_data;
+    index_data.clear();
+
+    std::vector<MeshIndexLayout> layouts(model.meshes().size());
+    size_t mesh_index = 0;
+    for (Model::Mesh const & mesh : model.meshes()) {
+        uint32_t min_vertex = ~uint32_t{0};
+        uint32_t max_vertex = 0;
+        for (uint32_t level = 0; level < mesh.n_lods(); ++level) {
+            Model::LOD range = mesh.lod(level);
+            for (uint32_t i = 0; i < range.num_indices; ++i) {
+                uint32_t index = indices[range.start_index + i];
+                min_vertex = std::min(min_vertex, index);
+                max_vertex = std::max(max_vertex, index);
+            }
+        }
+
+        MeshIndexLayout & layout = layouts[mesh_index];
+        bool short_indices = mesh.num_indices > 0 &&
+            max_vertex - min_vertex < MAX_SHORT_INDEX_VERTICES;
+        layout.type = short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        layout.base_vertex = short_indices ? min_vertex : 0;
+
+        for (uint32_t level = 0; level < mesh.n_lods(); ++level) {
+            Model::LOD range = mesh.lod(level);
+            uint32_t start_index = append_indices(
+                index_data,
+                indices.data() + range.start_index,
+                range.num_indices,
+                layout.type,
+                layout.base_vertex
+            );
+            if (level == 0) {
+                layout.start_index = start_index;
+            } else {
+                layout.lod_start_indices[level - 1] = start_index;
+            }
+        }
+
+        ++mesh_index;
+    }
+
     // upload model buffers
     GLuint vao;
     GLuint vbo;
@@ -28,33 +122,48 @@ void GLModelManager::upload_model(
 
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vbo));
 
-    if (!model.is_animated()) {
-        bind_vertex_buffer(model);
-    } else {
-        bind_boned_vertex_buffer(model);
-    }
+    PackedVertexFormat format = model.packed_vertices() != nullptr ?
+        model.packed_vertex_format() : choose_packed_vertex_format(model);
+    bind_vertex_buffer(model, format);
 
     GL_CHECK(glGenBuffers(1, &ebo));
 
     GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo));
     GL_CHECK(glBufferData(
         GL_ELEMENT_ARRAY_BUFFER,
-        model.index_buffer().size() * sizeof(uint32_t),
-        model.index_buffer().data(),
+        index_data.size(),
+        index_data.data(),
         GL_STATIC_DRAW
     ));
 
-    m_model_buffer_handles[handle] = {vao, vbo, ebo};
+    ModelBufferHandles & buffers = m_model_buffer_handles[handle];
+    buffers = {vao, vbo, ebo, {}};
 
     // Create gl meshes
     mesh_resource_ids.resize(model.meshes().size());
-    size_t mesh_index = 0;
+    mesh_index = 0;
     for (Model::Mesh const & mesh : model.meshes()) {
         ResourceID id = m_next_mesh_id;
         ++m_next_mesh_id;
 
+        MeshIndexLayout const & layout = layouts[mesh_index];
+
+        GLuint mesh_vao = vao;
+        if (layout.base_vertex != 0) {
+            GL_CHECK(glGenVertexArrays(1, &mesh_vao));
+            GL_CHECK(glBindVertexArray(mesh_vao));
+            GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+            bind_vertex_attributes(format, layout.base_vertex);
+            GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo));
+            buffers.mesh_vaos.push_back(mesh_vao);
+        }
+
         GLMesh & gl_mesh = m_meshes[id];
-        gl_mesh.init(vao, mesh.start_index, mesh.num_indices);
+        gl_mesh.init(mesh_vao, layout.start_index, mesh.num_indices, layout.type);
+        gl_mesh.set_position_transform(format.position_transform);
+        for (size_t i = 0; i < mesh.lods.size(); ++i) {
+            gl_mesh.add_lod(layout.lod_start_indices[i], mesh.lods[i].num_indices);
+        }
 
         mesh_resource_ids[mesh_index] = id;
         ++mesh_index;
@@ -74,7 +183,13 @@ void GLModelManager::free_model(
 
     GL_CHECK(glDeleteBuffers(1, &buffers.vbo));
     GL_CHECK(glDeleteBuffers(1, &buffers.ebo));
-    GL_CHECK(glDeleteBuffers(1, &buffers.vao));
+    GL_CHECK(glDeleteVertexArrays(1, &buffers.vao));
+    if (!buffers.mesh_vaos.empty()) {
+        GL_CHECK(glDeleteVertexArrays(
+            static_cast<GLsizei>(buffers.mesh_vaos.size()),
+            buffers.mesh_vaos.data()
+        ));
+    }
 
     m_model_buffer_handles.erase(handle);
 
@@ -124,7 +239,7 @@ ResourceID GLModelManager::upload_pos_mesh(
     ResourceID id = m_next_mesh_id;
     ++m_next_mesh_id;
 
-    m_pos_mesh_buffer_handles[id] = {vao, vbo};
+    m_pos_mesh_buffer_handles[id] = {vao, vbo, n * sizeof(vertices[0])};
 
     GLMesh & gl_mesh = m_meshes[id];
     gl_mesh.init(vao, 0, static_cast<uint32_t>(n));
@@ -139,16 +254,26 @@ void GLModelManager::update_pos_mesh(
     glm::vec3 const * vertices,
     size_t n
 ) {
-    PosMeshBufferHandles buffers = m_pos_mesh_buffer_handles[id];
+    PosMeshBufferHandles & buffers = m_pos_mesh_buffer_handles[id];
 
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, buffers.vbo));
 
+    /* Pos meshes are kept across frames, so they can not be streamed.
+     * Instead the storage is orphaned, so that the update does not wait on
+     * draws of the old contents, at a capacity that only changes when it
+     * has to grow, so that the driver can recycle it.
+     */
+    size_t size = n * sizeof(vertices[0]);
+    if (size > buffers.capacity) {
+        buffers.capacity = std::max(size, 2 * buffers.capacity);
+    }
     GL_CHECK(glBufferData(
         GL_ARRAY_BUFFER,
-        n * sizeof(vertices[0]),
-        vertices,
-        GL_STATIC_DRAW
+        buffers.capacity,
+        nullptr,
+        GL_DYNAMIC_DRAW
     ));
+    GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices));
 
     GLMesh & gl_mesh = m_meshes[id];
     gl_mesh.init(buffers.vao, 0, static_cast<uint32_t>(n));
@@ -158,22 +283,49 @@ void GLModelManager::free_pos_mesh(ResourceID id) {
     PosMeshBufferHandles buffers = m_pos_mesh_buffer_handles[id];
 
     GL_CHECK(glDeleteBuffers(1, &buffers.vbo));
-    GL_CHECK(glDeleteBuffers(1, &buffers.vao));
+    GL_CHECK(glDeleteVertexArrays(1, &buffers.vao));
 
     m_pos_mesh_buffer_handles.erase(id);
     m_meshes.erase(id);
 }
 
-void GLModelManager::bind_vertex_buffer(Model const & model) {
-    std::vector<Model::Vertex> const & vertices = model.vertex_buffer();
-    GL_CHECK(glBufferData(
-        GL_ARRAY_BUFFER,
-        vertices.size() * sizeof(vertices[0]),
-        vertices.data(),
-        GL_STATIC_DRAW
-    ));
+void GLModelManager::bind_vertex_buffer(
+    Model const & model,
+    PackedVertexFormat const & format
+) {
+    if (model.packed_vertices() != nullptr) {
+        /* uploaded straight from the model file */
+        GL_CHECK(glBufferData(
+            GL_ARRAY_BUFFER,
+            model.packed_vertices_size(),
+            model.packed_vertices(),
+            GL_STATIC_DRAW
+        ));
+    } else {
+        thread_local std::vector<uint8_t> data;
+        pack_vertices(model, format, data);
+
+        GL_CHECK(glBufferData(
+            GL_ARRAY_BUFFER,
+            data.size(),
+            data.data(),
+            GL_STATIC_DRAW
+        ));
+    }
+
+    bind_vertex_attributes(format, 0);
+}
+
+void GLModelManager::bind_vertex_attributes(
+    PackedVertexFormat const & format,
+    uint32_t base_vertex
+) {
+    GLShader const & shader = format.boned ?
+        m_material_manager.standard_animated_shader() :
+        m_material_manager.standard_shader();
 
-    GLShader const & shader = m_material_manager.standard_shader();
+    GLsizei stride = static_cast<GLsizei>(format.stride);
+    uintptr_t base = uintptr_t{base_vertex} * format.stride;
 
     static const GLVarString pos_str = "a_Position";
     GLint pos_attr;
@@ -181,11 +333,11 @@ void GLModelManager::bind_vertex_buffer(Model const & model) {
     GL_CHECK(glEnableVertexAttribArray(pos_attr));
     GL_CHECK(glVertexAttribPointer(
         pos_attr,
-        3,
-        GL_FLOAT,
-        GL_FALSE,
-        sizeof(Model::Vertex),
-        reinterpret_cast<void*>(offsetof(Model::Vertex, position))
+        4,
+        format.quantized_positions ? GL_SHORT : GL_FLOAT,
+        format.quantized_positions ? GL_TRUE : GL_FALSE,
+        stride,
+        reinterpret_cast<void*>(base + format.position_offset)
     ));
 
     static const GLVarString normal_str = "a_Normal";
@@ -194,11 +346,11 @@ void GLModelManager::bind_vertex_buffer(Model const & model) {
     GL_CHECK(glEnableVertexAttribArray(normal_attr));
     GL_CHECK(glVertexAttribPointer(
         normal_attr,
-        3,
-        GL_FLOAT,
-        GL_FALSE,
-        sizeof(Model::Vertex),
-        reinterpret_cast<void*>(offsetof(Model::Vertex, normal))
+        2,
+        GL_SHORT,
+        GL_TRUE,
+        stride,
+        reinterpret_cast<void*>(base + format.normal_offset)
     ));
 
     static const GLVarString tex_coord_str = "a_TexCoordinate";
@@ -208,10 +360,10 @@ void GLModelManager::bind_vertex_buffer(Model const & model) {
     GL_CHECK(glVertexAttribPointer(
         texcoord_attr,
         2,
-        GL_FLOAT,
+        GL_HALF_FLOAT,
         GL_FALSE,
-        sizeof(Model::Vertex),
-        reinterpret_cast<void*>(offsetof(Model::Vertex, texture_coordinate))
+        stride,
+        reinterpret_cast<void*>(base + format.texture_coordinate_offset)
     ));
 
     static const GLVarString tan_str = "a_Tangent";
@@ -221,129 +373,44 @@ void GLModelManager::bind_vertex_buffer(Model const & model) {
         GL_CHECK(glEnableVertexAttribArray(tan_attr));
         GL_CHECK(glVertexAttribPointer(
             tan_attr,
-            3,
-            GL_FLOAT,
-            GL_FALSE,
-            sizeof(Model::Vertex),
-            reinterpret_cast<void*>(offsetof(Model::Vertex, tangent))
-        ));
-    }
-
-    static const GLVarString bitan_str = "a_Bitangent";
-    GLint bitan_attr;
-    GL_CHECK(bitan_attr = shader.get_attrib_loc(bitan_str));
-    if (bitan_attr != -1) {
-        GL_CHECK(glEnableVertexAttribArray(bitan_attr));
-        GL_CHECK(glVertexAttribPointer(
-            bitan_attr, 3, GL_FLOAT, GL_FALSE,
-            sizeof(Model::Vertex),
-            reinterpret_cast<void*>(offsetof(Model::Vertex, bitangent))
-        ));
-    }
-}
-
-void GLModelManager::bind_boned_vertex_buffer(Model const & model) {
-    thread_local std::vector<Model::BonedVertex> boned_vertices;
-    boned_vertices.resize(model.vertex_buffer().size());
-
-    std::vector<Model::Vertex> const & vertices = model.vertex_buffer();
-    std::vector<Model::BoneData> const & bone_data = model.vertex_bone_buffer();
-
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        boned_vertices[i].vertex_data = vertices[i];
-        boned_vertices[i].bone_data = bone_data[i];
-    }
-
-    GL_CHECK(glBufferData(
-        GL_ARRAY_BUFFER,
-        boned_vertices.size() * sizeof(boned_vertices[0]),
-        boned_vertices.data(),
-        GL_STATIC_DRAW
-    ));
-
-    GLuint shader_program =
-        m_material_manager.standard_animated_shader().shader();
-
-    GLint pos_attr;
-    GL_CHECK(pos_attr = glGetAttribLocation(shader_program, "a_Position"));
-    GL_CHECK(glEnableVertexAttribArray(pos_attr));
-    GL_CHECK(glVertexAttribPointer(
-        pos_attr,
-        3,
-        GL_FLOAT,
-        GL_FALSE,
-        sizeof(Model::BonedVertex),
-        reinterpret_cast<void*>(0)
-    ));
-
-    GLint normal_attr;
-    GL_CHECK(normal_attr = glGetAttribLocation(shader_program, "a_Normal"));
-    GL_CHECK(glEnableVertexAttribArray(normal_attr));
-    GL_CHECK(glVertexAttribPointer(
-        normal_attr,
-        3,
-        GL_FLOAT,
-        GL_FALSE,
-        sizeof(Model::BonedVertex),
-        reinterpret_cast<void*>(12)
-    ));
-
-    GLint texcoord_attr;
-    GL_CHECK(texcoord_attr = glGetAttribLocation(shader_program, "a_TexCoordinate"));
-    GL_CHECK(glEnableVertexAttribArray(texcoord_attr));
-    GL_CHECK(glVertexAttribPointer(
-        texcoord_attr,
-        2,
-        GL_FLOAT,
-        GL_FALSE,
-        sizeof(Model::BonedVertex),
-        reinterpret_cast<void*>(24)
-    ));
-
-    GLint tan_attr;
-    GL_CHECK(tan_attr = glGetAttribLocation(shader_program, "a_Tangent"));
-    if (tan_attr != -1) {
-        GL_CHECK(glEnableVertexAttribArray(tan_attr));
-        GL_CHECK(glVertexAttribPointer(
-            tan_attr,
-            3,
-            GL_FLOAT,
-            GL_FALSE,
-            sizeof(Model::BonedVertex),
-            reinterpret_cast<void*>(32)
+            2,
+            GL_SHORT,
+            GL_TRUE,
+            stride,
+            reinterpret_cast<void*>(base + format.tangent_offset)
         ));
     }
 
-    GLint bitan_attr;
-    GL_CHECK(bitan_attr = glGetAttribLocation(shader_program, "a_Bitangent"));
-    if (bitan_attr != -1) {
-        GL_CHECK(glEnableVertexAttribArray(bitan_attr));
-        GL_CHECK(glVertexAttribPointer(
-            bitan_attr, 3, GL_FLOAT, GL_FALSE,
-            sizeof(Model::BonedVertex),
-            reinterpret_cast<void*>(44)
-        ));
+    if (!format.boned) {
+        return;
     }
 
+    static const GLVarString bone_id_str = "a_BoneIDs";
     GLint bone_id_attr;
-    GL_CHECK(bone_id_attr = glGetAttribLocation(shader_program, "a_BoneIDs"));
+    GL_CHECK(bone_id_attr = shader.get_attrib_loc(bone_id_str));
     if (bone_id_attr != -1) {
         GL_CHECK(glEnableVertexAttribArray(bone_id_attr));
         GL_CHECK(glVertexAttribIPointer(
-            bone_id_attr, 4, GL_UNSIGNED_INT,
-            sizeof(Model::BonedVertex),
-            reinterpret_cast<void*>(56)
+            bone_id_attr,
+            4,
+            format.wide_bone_ids ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE,
+            stride,
+            reinterpret_cast<void*>(base + format.bone_ids_offset)
         ));
     }
 
+    static const GLVarString bone_weights_str = "a_BoneWeights";
     GLint bone_weights_attr;
-    GL_CHECK(bone_weights_attr = glGetAttribLocation(shader_program, "a_BoneWeights"));
+    GL_CHECK(bone_weights_attr = shader.get_attrib_loc(bone_weights_str));
     if (bone_weights_attr != -1) {
         GL_CHECK(glEnableVertexAttribArray(bone_weights_attr));
         GL_CHECK(glVertexAttribPointer(
-            bone_weights_attr, 4, GL_FLOAT, GL_FALSE,
-            sizeof(Model::BonedVertex),
-            reinterpret_cast<void*>(72)
+            bone_weights_attr,
+            4,
+            GL_UNSIGNED_BYTE,
+            GL_TRUE,
+            stride,
+            reinterpret_cast<void*>(base + format.bone_weights_offset)
         ));
     }
 }
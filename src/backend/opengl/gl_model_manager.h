@@ -4,11 +4,13 @@
 #include "src/backend/opengl/gl_mesh.h"
 #include "src/backend/opengl/gl_material_manager.h"
 #include "src/engine/rendering/model_manager.h"
+#include "src/engine/rendering/packed_vertex.h"
 
 #define GL_GLEXT_PROTOTYPES 1
 #include <GLES3/gl3.h>
 
 #include <unordered_map>
+#include <vector>
 
 namespace prt3 {
 
@@ -48,11 +50,16 @@ private:
         GLuint vao;
         GLuint vbo;
         GLuint ebo;
+        /* meshes with 16-bit indices relative to their first vertex have
+         * their own vertex arrays, since there is no base vertex draw
+         */
+        std::vector<GLuint> mesh_vaos;
     };
 
     struct PosMeshBufferHandles {
         GLuint vao;
         GLuint vbo;
+        size_t capacity; // in bytes
     };
     GLMaterialManager & m_material_manager;
 
@@ -65,8 +72,15 @@ private:
     std::unordered_map<ResourceID, GLMesh> m_meshes;
     ResourceID m_next_mesh_id = 0;
 
-    void bind_vertex_buffer(Model const & model);
-    void bind_boned_vertex_buffer(Model const & model);
+    void bind_vertex_buffer(
+        Model const & model,
+        PackedVertexFormat const & format
+    );
+
+    void bind_vertex_attributes(
+        PackedVertexFormat const & format,
+        uint32_t base_vertex
+    );
 };
 
 } // namespace prt3
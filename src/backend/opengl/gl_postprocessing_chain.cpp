@@ -39,29 +39,109 @@ void GLPostProcessingChain::set_chain(
         GL_STATIC_DRAW
     ));
 
-    m_framebuffers.resize(chain.passes.size());
-    m_color_textures.resize(chain.passes.size());
-    m_color_textures[0] = source_buffers.color_texture();
+    /* Build the graph. The selection pass of the renderer is declared
+     * as well, so that it is culled if no pass samples its output.
+     */
+    m_graph.clear();
+
+    RenderGraphResourceID source_color = m_graph.import_resource();
+    RenderGraphResourceID backbuffer = m_graph.import_resource();
+    m_graph.mark_output(backbuffer);
+
+    auto const & source_uniforms = source_buffers.uniform_names();
+    std::vector<RenderGraphResourceID> source_resources;
+    RenderGraphResourceID selection = 0;
+    for (UniformName const & uniform_name : source_uniforms) {
+        source_resources.push_back(m_graph.import_resource());
+        if (uniform_name.value == source_buffers.selected_texture()) {
+            selection = source_resources.back();
+        }
+    }
 
-    for (size_t i = 0; i < chain.passes.size() - 1; ++i) {
-        int width = static_cast<int>(window_width / chain.passes[i].downscale_factor);
-        int height = static_cast<int>(window_height / chain.passes[i].downscale_factor);
+    RenderGraphPassID selection_pass = m_graph.add_pass();
+    m_graph.write(selection_pass, selection);
+
+    std::vector<GLuint> shaders;
+    std::vector<RenderGraphPassID> pass_ids;
+    std::vector<RenderGraphResourceID> inputs;
+    std::vector<RenderGraphResourceID> outputs;
+
+    RenderGraphResourceID previous = source_color;
+    for (size_t i = 0; i < chain.passes.size(); ++i) {
+        GLuint shader = glshaderutility::create_shader(
+            "assets/shaders/opengl/passthrough.vs",
+            chain.passes[i].fragment_shader_path.c_str()
+        );
+        shaders.push_back(shader);
+
+        RenderGraphPassID pass = m_graph.add_pass();
+        pass_ids.push_back(pass);
+
+        /* only buffers that the shader samples are dependencies */
+        GLint loc;
+        GL_CHECK(loc = glGetUniformLocation(shader, "u_PreviousColorBuffer"));
+        if (loc != -1) {
+            m_graph.read(pass, previous);
+        }
+        inputs.push_back(previous);
+
+        for (size_t j = 0; j < source_uniforms.size(); ++j) {
+            GL_CHECK(loc = glGetUniformLocation(
+                shader,
+                source_uniforms[j].name.data()
+            ));
+            if (loc != -1) {
+                m_graph.read(pass, source_resources[j]);
+            }
+        }
+
+        RenderGraphResourceID output;
+        if (i + 1 == chain.passes.size()) {
+            output = backbuffer;
+        } else {
+            RenderGraphTextureDesc desc;
+            desc.width = static_cast<uint32_t>(
+                window_width / chain.passes[i].downscale_factor
+            );
+            desc.height = static_cast<uint32_t>(
+                window_height / chain.passes[i].downscale_factor
+            );
+            desc.format = GL_RGB;
+            output = m_graph.create_texture(desc);
+        }
+        m_graph.write(pass, output);
+        outputs.push_back(output);
+
+        previous = output;
+    }
+
+    m_graph.compile();
+
+    m_uses_selection = m_graph.pass_active(selection_pass);
+
+    /* allocate physical textures */
+    auto const & physical_textures = m_graph.physical_textures();
+    m_framebuffers.resize(physical_textures.size());
+    m_color_textures.resize(physical_textures.size());
+
+    for (size_t i = 0; i < physical_textures.size(); ++i) {
+        RenderGraphTextureDesc const & desc = physical_textures[i];
 
         GLuint & framebuffer = m_framebuffers[i];
         GL_CHECK(glGenFramebuffers(1, &framebuffer));
         GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
 
-        GLuint & color_texture = m_color_textures[i+1];
+        GLuint & color_texture = m_color_textures[i];
         GL_CHECK(glGenTextures(1, &color_texture));
         GL_CHECK(glBindTexture(GL_TEXTURE_2D, color_texture));
         GL_CHECK(glTexImage2D(
             GL_TEXTURE_2D,
             0,
-            GL_RGB,
-            width,
-            height,
+            desc.format,
+            desc.width,
+            desc.height,
             0,
-            GL_RGB,
+            desc.format,
             GL_UNSIGNED_BYTE,
             0
         ));
@@ -85,25 +165,32 @@ void GLPostProcessingChain::set_chain(
             assert(false && "Failed to create framebuffer!");
         }
     }
-    m_framebuffers.back() = 0;
 
-    for (size_t i = 0; i < m_framebuffers.size(); ++i) {
+    /* create the active passes, the screen quad vao is still bound */
+    for (size_t i = 0; i < chain.passes.size(); ++i) {
+        if (!m_graph.pass_active(pass_ids[i])) {
+            GL_CHECK(glDeleteProgram(shaders[i]));
+            continue;
+        }
+
         int width = static_cast<int>(window_width / chain.passes[i].downscale_factor);
         int height = static_cast<int>(window_height / chain.passes[i].downscale_factor);
 
+        uint32_t input = m_graph.physical_texture(inputs[i]);
+        GLuint input_texture = input == RenderGraph::NO_PHYSICAL_TEXTURE ?
+            source_buffers.color_texture() : m_color_textures[input];
 
-        GLuint shader = glshaderutility::create_shader(
-            "assets/shaders/opengl/passthrough.vs",
-            chain.passes[i].fragment_shader_path.c_str()
-        );
+        uint32_t output = m_graph.physical_texture(outputs[i]);
+        GLuint target_framebuffer = output == RenderGraph::NO_PHYSICAL_TEXTURE ?
+            0 : m_framebuffers[output];
 
         m_passes.emplace_back(
-            shader,
+            shaders[i],
             width,
             height,
             source_buffers,
-            m_color_textures[i],
-            m_framebuffers[i]
+            input_texture,
+            target_framebuffer
         );
     }
 }
@@ -112,42 +199,34 @@ void GLPostProcessingChain::render(
     CameraRenderData const & camera_data,
     uint32_t frame
 ) {
-    for (GLPostProcessingPass pass : m_passes) {
+    for (GLPostProcessingPass & pass : m_passes) {
         pass.render(camera_data, frame, m_screen_quad_vao);
     }
 }
 
 void GLPostProcessingChain::clear_chain() {
-    if (m_passes.empty()) {
-        return;
-    }
-
     for (GLPostProcessingPass & pass: m_passes) {
         GL_CHECK(glDeleteProgram(pass.shader().shader()));
     }
+    m_passes.clear();
+    m_uses_selection = false;
 
-    if (m_framebuffers.size() == 1) {
-        m_framebuffers.resize(0);
-        m_color_textures.resize(0);
-        return;
+    if (!m_framebuffers.empty()) {
+        GL_CHECK(glDeleteFramebuffers(
+            m_framebuffers.size(),
+            m_framebuffers.data()
+        ));
+        GL_CHECK(glDeleteTextures(
+            m_color_textures.size(),
+            m_color_textures.data()
+        ));
     }
+    m_framebuffers.clear();
+    m_color_textures.clear();
 
-    GL_CHECK(glDeleteFramebuffers(
-        m_framebuffers.size() - 1,
-        &m_framebuffers[0]
-    ));
-
-    GL_CHECK(glDeleteTextures(
-        m_color_textures.size() - 1,
-        &m_color_textures[1]
-    ));
-
-    m_framebuffers.resize(0);
-    m_color_textures.resize(0);
-
-    if (m_screen_quad_vbo == 0) {
+    if (m_screen_quad_vbo != 0) {
         GL_CHECK(glDeleteBuffers(1, &m_screen_quad_vbo));
-        GL_CHECK(glDeleteBuffers(1, &m_screen_quad_vao));
+        GL_CHECK(glDeleteVertexArrays(1, &m_screen_quad_vao));
         m_screen_quad_vbo = 0;
         m_screen_quad_vao = 0;
     }
@@ -5,6 +5,7 @@
 #include "src/engine/rendering/postprocessing_pass.h"
 #include "src/backend/opengl/gl_postprocessing_pass.h"
 #include "src/backend/opengl/gl_source_buffers.h"
+#include "src/engine/rendering/render_graph.h"
 
 #define GL_GLEXT_PROTOTYPES 1
 #include <GLES3/gl3.h>
@@ -28,10 +29,19 @@ public:
 
     bool empty() const { return m_passes.empty(); }
 
+    /* whether any active pass samples the selection buffer */
+    bool uses_selection() const { return m_uses_selection; }
+
     GLuint screen_quad_vao() const { return m_screen_quad_vao; };
 
 private:
+    /* passes that were not culled by the render graph */
     std::vector<GLPostProcessingPass> m_passes;
+    bool m_uses_selection = false;
+
+    RenderGraph m_graph;
+
+    /* one per physical texture of the graph */
     std::vector<GLuint> m_framebuffers;
     std::vector<GLuint> m_color_textures;
 
@@ -49,8 +49,9 @@ void GLPostProcessingPass::render(
 
     GLenum tex_offset = 0;
     {
-        static GLVarString prev_color_buffer = "u_PreviousColorBuffer";
-        GLint loc = m_shader.get_uniform_loc(prev_color_buffer);
+        GLint loc = m_shader.get_uniform_loc(
+            uniform_id_previous_color_buffer
+        );
         if (loc != -1) {
             GL_CHECK(glUniform1i(loc, tex_offset));
             GL_CHECK(glActiveTexture(GL_TEXTURE0 + tex_offset));
@@ -69,40 +70,46 @@ void GLPostProcessingPass::render(
         }
     }
 
-    // TODO: utilize uniform loc cache in GLShader
-    glshaderutility::set_vec3(
-        m_shader.shader(),
-        "u_ViewPosition",
-        camera_data.view_position
-    );
-
-    glshaderutility::set_vec3(
-        m_shader.shader(),
-        "u_ViewDirection",
-        camera_data.view_direction
-    );
+    GLShader const & s = m_shader;
+    GL_CHECK(glUniform3fv(
+        s.get_uniform_loc(uniform_id_view_position),
+        1,
+        &camera_data.view_position[0]
+    ));
+    GL_CHECK(glUniform3fv(
+        s.get_uniform_loc(uniform_id_view_direction),
+        1,
+        &camera_data.view_direction[0]
+    ));
 
     glm::mat4 inv_v_matrix = glm::inverse(camera_data.view_matrix);
     glm::mat4 inv_p_matrix = glm::inverse(camera_data.projection_matrix);
-    glshaderutility::set_mat4(m_shader.shader(), "u_InvVMatrix", inv_v_matrix);
-    glshaderutility::set_mat4(m_shader.shader(), "u_InvPMatrix", inv_p_matrix);
+    GL_CHECK(glUniformMatrix4fv(
+        s.get_uniform_loc(uniform_id_inv_v_matrix),
+        1,
+        GL_FALSE,
+        &inv_v_matrix[0][0]
+    ));
+    GL_CHECK(glUniformMatrix4fv(
+        s.get_uniform_loc(uniform_id_inv_p_matrix),
+        1,
+        GL_FALSE,
+        &inv_p_matrix[0][0]
+    ));
 
-    glshaderutility::set_float(
-        m_shader.shader(),
-        "u_NearPlane",
+    GL_CHECK(glUniform1f(
+        s.get_uniform_loc(uniform_id_near_plane),
         camera_data.near_plane
-    );
-
-    glshaderutility::set_float(
-        m_shader.shader(),
-        "u_FarPlane",
+    ));
+    GL_CHECK(glUniform1f(
+        s.get_uniform_loc(uniform_id_far_plane),
         camera_data.far_plane
-    );
+    ));
 
-    glshaderutility::set_float(m_shader.shader(), "u_PixelUnitX", 1.0f / w);
-    glshaderutility::set_float(m_shader.shader(), "u_PixelUnitY", 1.0f / h);
+    GL_CHECK(glUniform1f(s.get_uniform_loc(uniform_id_pixel_unit_x), 1.0f / w));
+    GL_CHECK(glUniform1f(s.get_uniform_loc(uniform_id_pixel_unit_y), 1.0f / h));
 
-    glshaderutility::set_uint(m_shader.shader(), "u_Frame", frame);
+    GL_CHECK(glUniform1ui(s.get_uniform_loc(uniform_id_frame), frame));
 
     GL_CHECK(glBindVertexArray(screen_quad_vao));
     GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 6));
@@ -14,11 +14,22 @@
 #include <emscripten/emscripten.h>
 #include <emscripten/html5.h>
 
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 #include <cassert>
 #include <cstring>
 
+/* Not part of GLES 3, but provided by emscripten on top of WebGL 2, which
+ * does not support mapping buffers for reading.
+ */
+extern "C" void glGetBufferSubData(
+    GLenum target,
+    GLintptr offset,
+    GLsizeiptr size,
+    void * data
+);
+
 using namespace prt3;
 
 GLRenderer::GLRenderer(
@@ -54,6 +65,9 @@ GLRenderer::GLRenderer(
 
     m_texture_manager.init();
     m_material_manager.init();
+    m_uniform_buffers.init();
+    m_light_cluster_textures.init();
+    m_bone_palettes.init();
 
     ImGui_ImplGlfw_InitForOpenGL(m_window, false);
     ImGui_ImplOpenGL3_Init("#version 300 es");
@@ -131,36 +145,58 @@ GLRenderer::GLRenderer(
     std::array<glm::vec3, 36> decal_vertices;
     insert_box(glm::vec3{-0.5f}, glm::vec3{0.5f}, decal_vertices.data());
 
-    m_decal_mesh = m_model_manager.upload_pos_mesh(
+    GL_CHECK(glGenVertexArrays(1, &m_decal_vao));
+    GL_CHECK(glBindVertexArray(m_decal_vao));
+
+    GL_CHECK(glGenBuffers(1, &m_decal_vbo));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, m_decal_vbo));
+    GL_CHECK(glBufferData(
+        GL_ARRAY_BUFFER,
+        sizeof(decal_vertices),
         decal_vertices.data(),
-        decal_vertices.size()
-    );
+        GL_STATIC_DRAW
+    ));
+    GL_CHECK(glEnableVertexAttribArray(0));
+    GL_CHECK(glVertexAttribPointer(
+        0,
+        3,
+        GL_FLOAT,
+        GL_FALSE,
+        0,
+        reinterpret_cast<void*>(0)
+    ));
+
+    /* decal attributes, per-instance */
+    for (GLuint i = 1; i <= 8; ++i) {
+        GL_CHECK(glEnableVertexAttribArray(i));
+        GL_CHECK(glVertexAttribDivisor(i, 1));
+    }
+
+    GL_CHECK(glBindVertexArray(0));
+
+    m_vertex_stream.init(GL_ARRAY_BUFFER, 1 << 16);
 
     /* init canvas objects */
     GL_CHECK(glGenVertexArrays(1, &m_canvas_vao));
-    GL_CHECK(glBindVertexArray(m_canvas_vao));
     GL_CHECK(glGenBuffers(1, &m_canvas_vbo));
+    GL_CHECK(glGenBuffers(1, &m_canvas_ebo));
+    GL_CHECK(glBindVertexArray(m_canvas_vao));
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, m_canvas_vbo));
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_canvas_ebo));
 
-    static const GLVarString pos_uv_str = "a_PosUV";
-    GLint pos_uv_attr;
-    GL_CHECK(pos_uv_attr = m_canvas_shader->get_attrib_loc(pos_uv_str));
-    GL_CHECK(glEnableVertexAttribArray(pos_uv_attr));
+    /* locations are given by the layout qualifiers of canvas.vs */
+    GL_CHECK(glEnableVertexAttribArray(0));
     GL_CHECK(glVertexAttribPointer(
-        pos_uv_attr,
+        0,
         4,
         GL_FLOAT,
         GL_FALSE,
         sizeof(CanvasGeometry),
-        0
+        reinterpret_cast<void*>(offsetof(CanvasGeometry, pos_uv))
     ));
-
-    static const GLVarString color_str = "a_Color";
-    GLint color_attr;
-    GL_CHECK(color_attr = m_canvas_shader->get_attrib_loc(color_str));
-    GL_CHECK(glEnableVertexAttribArray(color_attr));
+    GL_CHECK(glEnableVertexAttribArray(1));
     GL_CHECK(glVertexAttribPointer(
-        color_attr,
+        1,
         4,
         GL_FLOAT,
         GL_FALSE,
@@ -172,21 +208,38 @@ GLRenderer::GLRenderer(
     create_particle_buffers();
 
     GL_CHECK(glBindVertexArray(0));
+
+    GL_CHECK(glGenBuffers(1, &m_selection_pbo));
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_selection_pbo));
+    GL_CHECK(glBufferData(GL_PIXEL_PACK_BUFFER, 4, nullptr, GL_STREAM_READ));
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
 }
 
 GLRenderer::~GLRenderer() {
     delete m_selection_shader;
     delete m_animated_selection_shader;
     delete m_transparency_blend_shader;
-    m_model_manager.free_pos_mesh(m_decal_mesh);
+    GL_CHECK(glDeleteVertexArrays(1, &m_decal_vao));
+    GL_CHECK(glDeleteBuffers(1, &m_decal_vbo));
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
 
     /* free canvas objects */
+    GL_CHECK(glDeleteVertexArrays(1, &m_canvas_vao));
     GL_CHECK(glDeleteBuffers(1, &m_canvas_vbo));
-    GL_CHECK(glDeleteBuffers(1, &m_canvas_vao));
+    GL_CHECK(glDeleteBuffers(1, &m_canvas_ebo));
 
     free_particle_buffers();
+    m_vertex_stream.clean_up();
+
+    if (m_selection_fence != 0) {
+        GL_CHECK(glDeleteSync(m_selection_fence));
+    }
+    GL_CHECK(glDeleteBuffers(1, &m_selection_pbo));
+
+    m_uniform_buffers.clean_up();
+    m_light_cluster_textures.clean_up();
+    m_bone_palettes.clean_up();
 
     GL_CHECK(glDeleteProgram(m_decal_shader->shader()));
     GL_CHECK(glDeleteProgram(m_selection_shader->shader()));
@@ -217,22 +270,23 @@ void GLRenderer::set_postprocessing_chains(
     );
 }
 
-NodeID GLRenderer::get_selected(int x, int y) {
+bool GLRenderer::request_selection(int x, int y) {
     int w;
     int h;
     glfwGetWindowSize(m_window, &w, &h);
 
-    GL_CHECK(glFlush());
-    GL_CHECK(glFinish());
+    /* a pending request is superseded by the new one */
+    if (m_selection_fence != 0) {
+        GL_CHECK(glDeleteSync(m_selection_fence));
+        m_selection_fence = 0;
+    }
 
-    GL_CHECK(glBindFramebuffer(
-        GL_FRAMEBUFFER,
-        m_source_buffers.framebuffer()
-    ));
+    m_state.bind_framebuffer(GL_FRAMEBUFFER, m_source_buffers.framebuffer());
 
     GL_CHECK(glReadBuffer(m_source_buffers.node_data_attachment()));
 
-    GLubyte data[4];
+    /* reads into the pixel pack buffer return immediately */
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_selection_pbo));
     GL_CHECK(glReadPixels(
         x / m_downscale_factor,
         (h - y) / m_downscale_factor,
@@ -240,21 +294,49 @@ NodeID GLRenderer::get_selected(int x, int y) {
         1,
         GL_RGBA,
         GL_UNSIGNED_BYTE,
-        &data
+        nullptr
     ));
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+    m_selection_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    return true;
+}
+
+bool GLRenderer::poll_selection(NodeID & id) {
+    if (m_selection_fence == 0) {
+        return false;
+    }
+
+    GLenum status = glClientWaitSync(m_selection_fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+
+    GL_CHECK(glDeleteSync(m_selection_fence));
+    m_selection_fence = 0;
+
+    if (status == GL_WAIT_FAILED) {
+        PRT3ERROR("Failed to wait for selection readback.\n");
+        return false;
+    }
+
+    GLubyte data[4];
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_selection_pbo));
+    GL_CHECK(glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(data), data));
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
 
     uint32_t raw_id = 0;
     memcpy(&raw_id, data, 3);
     raw_id = raw_id & 0x00ffffffu;
 
-    NodeID id;
     if (raw_id == 0x00ffffffu) {
         id = NO_NODE;
     } else {
         memcpy(&id, &raw_id, sizeof(NodeID));
     }
 
-    return id;
+    return true;
 }
 
 void GLRenderer::prepare_imgui_rendering() {
@@ -262,6 +344,17 @@ void GLRenderer::prepare_imgui_rendering() {
     ImGui_ImplGlfw_NewFrame();
 }
 
+static bool same_material(
+    MeshRenderData const & a,
+    MeshRenderData const & b
+) {
+    MaterialOverride const & ao = a.material_override;
+    MaterialOverride const & bo = b.material_override;
+    return a.material_id == b.material_id &&
+           ao.tint_active == bo.tint_active &&
+           (!ao.tint_active || ao.tint == bo.tint);
+}
+
 static bool is_transparent(
     MeshRenderData const & mesh_data,
     GLMaterial const & mat
@@ -275,20 +368,46 @@ void GLRenderer::render(RenderData & render_data, bool editor) {
         m_editor_postprocessing_chain :
         m_scene_postprocessing_chain;
 
+    LightRenderData const & light_data = render_data.scene.light_data;
+    m_light_clusters.assign_lights(
+        render_data.camera_data,
+        light_data.point_lights.data(),
+        light_data.point_lights.size()
+    );
+    m_light_cluster_textures.upload(m_light_clusters);
+    m_bone_palettes.upload(render_data.scene.bone_data);
+
+    /* resources may have been uploaded since the last frame */
+    m_state.invalidate();
+    m_state.begin_frame();
+    m_vertex_stream.begin_frame();
+
+    m_uniform_buffers.update_frame_data(
+        render_data.camera_data,
+        light_data,
+        m_light_clusters
+    );
+    write_model_data(render_data);
+
     render_opaque(render_data, editor);
     render_decals(render_data);
     render_transparent(render_data, editor);
 
-    if (!chain.empty()) {
+    if (chain.uses_selection()) {
         render_selection(render_data);
     }
 
     chain.render(render_data.camera_data, m_frame);
+    m_state.invalidate();
 
-    render_canvas(render_data.scene.canvas_data);
+    render_canvas(
+        render_data.scene.canvas_data,
+        render_data.scene.canvas_ranges
+    );
 
     if (editor) {
         render_imgui();
+        m_state.invalidate();
     }
 
     glfwSwapBuffers(m_window);
@@ -296,16 +415,72 @@ void GLRenderer::render(RenderData & render_data, bool editor) {
     ++m_frame;
 }
 
+void GLRenderer::write_model_data(RenderData const & render_data) {
+    SceneRenderData const & scene = render_data.scene;
+    GLUniformBuffers & ub = m_uniform_buffers;
+    auto const & meshes = m_model_manager.meshes();
+
+    ub.begin_model_data();
+
+    m_model_slots.mesh = 0;
+    for (MeshRenderData const & data : scene.mesh_data) {
+        ub.push_model_data(
+            data.transform,
+            data.node_data,
+            meshes.at(data.mesh_id).position_transform()
+        );
+    }
+
+    m_model_slots.animated_mesh = m_model_slots.mesh + scene.mesh_data.size();
+    for (AnimatedMeshRenderData const & data : scene.animated_mesh_data) {
+        ub.push_model_data(
+            data.mesh_data.transform,
+            data.mesh_data.node_data,
+            meshes.at(data.mesh_data.mesh_id).position_transform()
+        );
+    }
+
+    m_model_slots.selected_mesh =
+        m_model_slots.animated_mesh + scene.animated_mesh_data.size();
+    for (MeshRenderData const & data : scene.selected_mesh_data) {
+        ub.push_model_data(
+            data.transform,
+            data.node_data,
+            meshes.at(data.mesh_id).position_transform()
+        );
+    }
+
+    m_model_slots.selected_animated_mesh =
+        m_model_slots.selected_mesh + scene.selected_mesh_data.size();
+    for (AnimatedMeshRenderData const & data :
+         scene.selected_animated_mesh_data) {
+        ub.push_model_data(
+            data.mesh_data.transform,
+            data.mesh_data.node_data,
+            meshes.at(data.mesh_data.mesh_id).position_transform()
+        );
+    }
+
+    m_model_slots.wireframe = m_model_slots.selected_animated_mesh +
+                              scene.selected_animated_mesh_data.size();
+    for (WireframeRenderData const & data : render_data.editor_data.line_data) {
+        ub.push_model_data(data.transform, NodeData{NO_NODE, false});
+    }
+
+    ub.upload_model_data();
+}
+
 void GLRenderer::render_meshes(
     RenderData const & render_data,
     bool transparent
 ) {
     auto const & materials = m_material_manager.materials();
 
-    static std::unordered_map<GLShader const *, std::vector<MeshRenderData> >
+    /* queues of indices into the mesh data arrays of render_data */
+    static std::unordered_map<GLShader const *, std::vector<uint32_t> >
         shader_queues;
 
-    static std::unordered_map<GLShader const *, std::vector<AnimatedMeshRenderData> >
+    static std::unordered_map<GLShader const *, std::vector<uint32_t> >
         animated_shader_queues;
 
     for (auto & pair : shader_queues) {
@@ -316,30 +491,45 @@ void GLRenderer::render_meshes(
         pair.second.resize(0);
     }
 
-    for (MeshRenderData const & mesh_data : render_data.scene.mesh_data) {
+    auto const & mesh_data_vec = render_data.scene.mesh_data;
+    for (uint32_t i = 0; i < mesh_data_vec.size(); ++i) {
+        MeshRenderData const & mesh_data = mesh_data_vec[i];
         GLMaterial const & mat = materials.at(mesh_data.material_id);
         if (is_transparent(mesh_data, mat) != transparent) {
             continue;
         }
-        GLShader const * shader =
-            &materials.at(mesh_data.material_id).get_shader(
-                false,
-                transparent
-            );
-        shader_queues[shader].push_back(mesh_data);
+        GLShader const * shader = &mat.get_shader(false, transparent);
+        shader_queues[shader].push_back(i);
     }
 
-    for (AnimatedMeshRenderData const & data : render_data.scene.animated_mesh_data) {
-        GLMaterial const & mat = materials.at(data.mesh_data.material_id);
-        if (is_transparent(data.mesh_data, mat) != transparent) {
+    auto const & animated_data_vec = render_data.scene.animated_mesh_data;
+    for (uint32_t i = 0; i < animated_data_vec.size(); ++i) {
+        MeshRenderData const & mesh_data = animated_data_vec[i].mesh_data;
+        GLMaterial const & mat = materials.at(mesh_data.material_id);
+        if (is_transparent(mesh_data, mat) != transparent) {
             continue;
         }
-        GLShader const * shader =
-            &materials.at(data.mesh_data.material_id).get_shader(
-                true,
-                transparent
-            );
-        animated_shader_queues[shader].push_back(data);
+        GLShader const * shader = &mat.get_shader(true, transparent);
+        animated_shader_queues[shader].push_back(i);
+    }
+
+    /* group draws that share a material, so that its state is bound once */
+    for (auto & pair : shader_queues) {
+        std::sort(pair.second.begin(), pair.second.end(),
+            [&mesh_data_vec](uint32_t a, uint32_t b) {
+                return mesh_data_vec[a].material_id <
+                       mesh_data_vec[b].material_id;
+            }
+        );
+    }
+
+    for (auto & pair : animated_shader_queues) {
+        std::sort(pair.second.begin(), pair.second.end(),
+            [&animated_data_vec](uint32_t a, uint32_t b) {
+                return animated_data_vec[a].mesh_data.material_id <
+                       animated_data_vec[b].mesh_data.material_id;
+            }
+        );
     }
 
     auto const & meshes = m_model_manager.meshes();
@@ -349,33 +539,29 @@ void GLRenderer::render_meshes(
 
         GLShader const & shader = *pair.first;
         GLuint shader_id = shader.shader();
-        GL_CHECK(glUseProgram(shader_id));
-
-        // Light data
-        LightRenderData const & light_data = render_data.scene.light_data;
-        bind_light_data(shader, light_data);
-
-        for (MeshRenderData const & mesh_data : pair.second) {
-            GLMaterial const & material = materials.at(mesh_data.material_id);
-
-            bind_material_data(
-                shader,
-                material,
-                mesh_data.material_override
-            );
-
-            bind_transform_and_camera_data(
-                shader,
-                mesh_data.transform,
-                render_data.camera_data
+        m_state.use_program(shader_id);
+        bind_light_cluster_data(shader);
+
+        MeshRenderData const * prev = nullptr;
+        for (uint32_t index : pair.second) {
+            MeshRenderData const & mesh_data = mesh_data_vec[index];
+
+            /* material uniforms persist in the program between draws */
+            if (prev == nullptr || !same_material(*prev, mesh_data)) {
+                bind_material_data(
+                    shader,
+                    materials.at(mesh_data.material_id),
+                    mesh_data.material_override
+                );
+            }
+            prev = &mesh_data;
+
+            m_uniform_buffers.bind_model_data(m_model_slots.mesh + index);
+
+            meshes.at(mesh_data.mesh_id).draw_elements_triangles(
+                m_state,
+                mesh_data.lod
             );
-
-            bind_node_data(
-                shader,
-                mesh_data.node_data
-            );
-
-            meshes.at(mesh_data.mesh_id).draw_elements_triangles();
         }
     }
 
@@ -384,39 +570,36 @@ void GLRenderer::render_meshes(
 
         GLShader const & shader = *pair.first;
         GLuint shader_id = shader.shader();
-        GL_CHECK(glUseProgram(shader_id));
+        m_state.use_program(shader_id);
+        bind_light_cluster_data(shader);
 
-        // Light data
-        LightRenderData const & light_data = render_data.scene.light_data;
-        bind_light_data(shader, light_data);
-
-        for (AnimatedMeshRenderData const & data : pair.second) {
+        MeshRenderData const * prev = nullptr;
+        for (uint32_t index : pair.second) {
+            AnimatedMeshRenderData const & data = animated_data_vec[index];
             MeshRenderData const & mesh_data = data.mesh_data;
-            GLMaterial const & material = materials.at(mesh_data.material_id);
-
-            bind_material_data(
-                shader,
-                material,
-                mesh_data.material_override
-            );
 
-            bind_transform_and_camera_data(
-                shader,
-                mesh_data.transform,
-                render_data.camera_data
-            );
-
-            bind_node_data(
-                shader,
-                mesh_data.node_data
+            if (prev == nullptr || !same_material(*prev, mesh_data)) {
+                bind_material_data(
+                    shader,
+                    materials.at(mesh_data.material_id),
+                    mesh_data.material_override
+                );
+            }
+            prev = &mesh_data;
+
+            m_uniform_buffers.bind_model_data(
+                m_model_slots.animated_mesh + index
             );
 
             bind_bone_data(
                 shader,
-                render_data.scene.bone_data[data.bone_data_index]
+                render_data.scene.bone_data.palettes[data.bone_data_index]
             );
 
-            meshes.at(mesh_data.mesh_id).draw_elements_triangles();
+            meshes.at(mesh_data.mesh_id).draw_elements_triangles(
+                m_state,
+                mesh_data.lod
+            );
         }
     }
 }
@@ -425,7 +608,7 @@ void GLRenderer::bind_viewport_framebuffer(GLuint framebuffer) {
     int w;
     int h;
     glfwGetWindowSize(m_window, &w, &h);
-    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+    m_state.bind_framebuffer(GL_FRAMEBUFFER, framebuffer);
 
     GLint view_w = static_cast<GLint>(w / m_downscale_factor);
     GLint view_h = static_cast<GLint>(h / m_downscale_factor);
@@ -454,12 +637,12 @@ void GLRenderer::render_opaque(
     };
 
     /* capabilities */
-    GL_CHECK(glDepthMask(GL_TRUE));
-    GL_CHECK(glEnable(GL_DEPTH_TEST));
-    GL_CHECK(glEnable(GL_CULL_FACE));
-    GL_CHECK(glCullFace(GL_BACK));
+    m_state.depth_mask(true);
+    m_state.set_depth_test(true);
+    m_state.set_cull_face(true);
+    m_state.cull_face(GL_BACK);
 
-    GL_CHECK(glDisable(GL_BLEND));
+    m_state.set_blend(false);
 
     GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
 
@@ -477,21 +660,17 @@ void GLRenderer::render_opaque(
     GL_CHECK(glPolygonOffset(1.0, 1.0));
 
     GLShader const & shader = m_material_manager.wireframe_shader();
-    GL_CHECK(glUseProgram(shader.shader()));
+    m_state.use_program(shader.shader());
 
     EditorRenderData const & editor_data = render_data.editor_data;
-    for (WireframeRenderData const & data : editor_data.line_data) {
-        bind_transform_and_camera_data(
-            shader,
-            data.transform,
-            render_data.camera_data
-        );
+    for (size_t i = 0; i < editor_data.line_data.size(); ++i) {
+        WireframeRenderData const & data = editor_data.line_data[i];
+        m_uniform_buffers.bind_model_data(m_model_slots.wireframe + i);
 
-        static const GLVarString color_str = "u_Color";
-        GL_CHECK(glUniform4fv(shader.get_uniform_loc(color_str), 1, &data.color[0]));
+        GL_CHECK(glUniform4fv(shader.get_uniform_loc(uniform_id_color), 1, &data.color[0]));
 
         auto const & meshes = m_model_manager.meshes();
-        meshes.at(data.mesh_id).draw_array_lines();
+        meshes.at(data.mesh_id).draw_array_lines(m_state);
     }
 
     GL_CHECK(glDisable(GL_POLYGON_OFFSET_FILL));
@@ -512,8 +691,8 @@ void GLRenderer::render_transparent(
     GLuint framebuffer = m_source_buffers.accum_framebuffer();
 
     // blit the opaque depth buffer
-    GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, opaque_framebuffer));
-    GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer));
+    m_state.bind_framebuffer(GL_READ_FRAMEBUFFER, opaque_framebuffer);
+    m_state.bind_framebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
     GL_CHECK(glBlitFramebuffer(
         0,
         0,
@@ -526,20 +705,20 @@ void GLRenderer::render_transparent(
         GL_DEPTH_BUFFER_BIT,
         GL_NEAREST
     ));
-    GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, 0));
-    GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+    m_state.bind_framebuffer(GL_READ_FRAMEBUFFER, 0);
+    m_state.bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
     bind_viewport_framebuffer(framebuffer);
 
     /* capabilities */
-    GL_CHECK(glDepthMask(GL_FALSE));
-    GL_CHECK(glEnable(GL_DEPTH_TEST));
-    GL_CHECK(glEnable(GL_CULL_FACE));
-    GL_CHECK(glCullFace(GL_BACK));
+    m_state.depth_mask(false);
+    m_state.set_depth_test(true);
+    m_state.set_cull_face(true);
+    m_state.cull_face(GL_BACK);
 
-    GL_CHECK(glEnable(GL_BLEND));
-    GL_CHECK(glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA));
-    GL_CHECK(glBlendEquation(GL_FUNC_ADD));
+    m_state.set_blend(true);
+    m_state.blend_func_separate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+    m_state.blend_equation(GL_FUNC_ADD);
 
     GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
 
@@ -562,28 +741,23 @@ void GLRenderer::render_transparent(
 
     /* resolve transparency buffers onto regular framebuffer */
     GLShader & shader = *m_transparency_blend_shader;
-    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, opaque_framebuffer));
+    m_state.bind_framebuffer(GL_FRAMEBUFFER, opaque_framebuffer);
 
     GL_CHECK(glDrawBuffers(1, attachments));
-    GL_CHECK(glUseProgram(shader.shader()));
-    GL_CHECK(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+    m_state.use_program(shader.shader());
+    m_state.blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    static const GLVarString accum_str = "uAccumulate";
-    GL_CHECK(glUniform1i(shader.get_uniform_loc(accum_str), 0));
-    GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_source_buffers.accum_texture()));
+    GL_CHECK(glUniform1i(shader.get_uniform_loc(uniform_id_accumulate), 0));
+    m_state.bind_texture(0, m_source_buffers.accum_texture());
 
-    static const GLVarString accum_alpha_str = "uAccumulateAlpha";
-    GL_CHECK(glUniform1i(shader.get_uniform_loc(accum_alpha_str), 1));
-    GL_CHECK(glActiveTexture(GL_TEXTURE1));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_source_buffers.accum_alpha_texture()));
+    GL_CHECK(glUniform1i(shader.get_uniform_loc(uniform_id_accumulate_alpha), 1));
+    m_state.bind_texture(1, m_source_buffers.accum_alpha_texture());
 
-    GL_CHECK(glBindVertexArray(chain.screen_quad_vao()));
+    m_state.bind_vertex_array(chain.screen_quad_vao());
     GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 6));
-    GL_CHECK(glBindVertexArray(0));
+    m_state.bind_vertex_array(0);
 }
 
-static constexpr size_t MAX_PARTICLES = 1000;
 
 void GLRenderer::create_particle_buffers() {
     static const GLfloat vertex_data[] = {
@@ -605,15 +779,6 @@ void GLRenderer::create_particle_buffers() {
         GL_STATIC_DRAW
     ));
 
-    GL_CHECK(glGenBuffers(1, &m_particle_attr_vbo));
-    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, m_particle_attr_vbo));
-    GL_CHECK(glBufferData(
-        GL_ARRAY_BUFFER,
-        MAX_PARTICLES * sizeof(ParticleAttributes),
-        NULL,
-        GL_STREAM_DRAW
-    ));
-
     GL_CHECK(glBindVertexArray(0));
 }
 
@@ -621,7 +786,7 @@ void GLRenderer::render_particles(RenderData const & render_data) {
     ParticleData const & data = render_data.scene.particle_data;
 
     /* vertex data */
-    GL_CHECK(glBindVertexArray(m_particle_vao));
+    m_state.bind_vertex_array(m_particle_vao);
 
     GL_CHECK(glEnableVertexAttribArray(0));
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, m_particle_vbo));
@@ -634,26 +799,17 @@ void GLRenderer::render_particles(RenderData const & render_data) {
         reinterpret_cast<void*>(0)
     ));
 
-    /* particle attributes */
-    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, m_particle_attr_vbo));
-    GL_CHECK(glBufferData(
-        GL_ARRAY_BUFFER,
-        MAX_PARTICLES * sizeof(ParticleAttributes),
-        NULL,
-        GL_STREAM_DRAW
-    )); // buffer orphaning
-    GL_CHECK(glBufferSubData(
-        GL_ARRAY_BUFFER,
-        0,
+    /* particle attributes, leaves the stream buffer bound */
+    size_t attr_offset = m_vertex_stream.push(
+        data.attributes.data(),
         data.attributes.size() * sizeof(ParticleAttributes),
-        data.attributes.data()
-    ));
-
-    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, m_particle_attr_vbo));
+        alignof(ParticleAttributes)
+    );
 
     GL_CHECK(glEnableVertexAttribArray(1));
     GL_CHECK(glEnableVertexAttribArray(2));
     GL_CHECK(glEnableVertexAttribArray(3));
+    GL_CHECK(glEnableVertexAttribArray(4));
 
     /* vertex positions, per-vertex */
     GL_CHECK(glVertexAttribDivisor(0, 0));
@@ -661,58 +817,26 @@ void GLRenderer::render_particles(RenderData const & render_data) {
     GL_CHECK(glVertexAttribDivisor(1, 1));
     GL_CHECK(glVertexAttribDivisor(2, 1));
     GL_CHECK(glVertexAttribDivisor(3, 1));
+    GL_CHECK(glVertexAttribDivisor(4, 1));
 
     GLShader & shader = *m_particle_shader;
-    GL_CHECK(glUseProgram(shader.shader()));
-
-    LightRenderData const & light_data = render_data.scene.light_data;
-    bind_light_data(shader, light_data);
-
-    static const GLVarString view_pos_str = "u_ViewPosition";
-    GL_CHECK(glUniform3fv(shader.get_uniform_loc(view_pos_str), 1, &render_data.camera_data.view_position[0]));
-
-    static const GLVarString near_str = "u_NearPlane";
-    GL_CHECK(glUniform1f(shader.get_uniform_loc(near_str), render_data.camera_data.near_plane));
-    static const GLVarString far_str = "u_FarPlane";
-    GL_CHECK(glUniform1f(shader.get_uniform_loc(far_str), render_data.camera_data.far_plane));
-
-    glm::mat4 v_matrix = render_data.camera_data.view_matrix;
-    glm::mat3 u_inv_v_rot{1.0f};
-    for (unsigned i = 0; i < 3; ++i) {
-        for (unsigned j = 0; j < 3; ++j) {
-            u_inv_v_rot[j][i] = v_matrix[i][j];
-        }
-    }
-
-    glm::mat4 vp_matrix = render_data.camera_data.projection_matrix * v_matrix;
-
-    static const GLVarString vpmatrix_str = "u_VPMatrix";
-    GL_CHECK(glUniformMatrix4fv(shader.get_uniform_loc(vpmatrix_str), 1, GL_FALSE, &vp_matrix[0][0]));
+    m_state.use_program(shader.shader());
+    bind_light_cluster_data(shader);
 
-    static const GLVarString ivrmatrix_str = "u_invVRotMatrix";
-    GL_CHECK(glUniformMatrix3fv(shader.get_uniform_loc(ivrmatrix_str), 1, GL_FALSE, &u_inv_v_rot[0][0]));
-
-    static const GLVarString depth_map_str = "u_DepthMap";
-    GL_CHECK(glUniform1i(shader.get_uniform_loc(depth_map_str), 0));
-    GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_source_buffers.depth_texture()));
+    GL_CHECK(glUniform1i(shader.get_uniform_loc(uniform_id_depth_map), 0));
+    m_state.bind_texture(0, m_source_buffers.depth_texture());
 
     for (ParticleData::TextureRange const & range : data.textures) {
-        static const GLVarString tex_str = "u_Texture";
-        GL_CHECK(glUniform1i(shader.get_uniform_loc(tex_str), 1));
-        GL_CHECK(glActiveTexture(GL_TEXTURE1));
+        GL_CHECK(glUniform1i(shader.get_uniform_loc(uniform_id_texture), 1));
 
         GLuint tex_id = range.texture == NO_RESOURCE ?
             m_texture_manager.texture_1x1_0xffffffff() :
             m_texture_manager.get_texture(range.texture);
 
-        GL_CHECK(glBindTexture(GL_TEXTURE_2D, tex_id));
-
-        static const GLVarString inv_div = "u_InvDiv";
-        GL_CHECK(glUniform2fv(shader.get_uniform_loc(inv_div), 1, &range.inv_div[0]));
+        m_state.bind_texture(1, tex_id);
 
         /* base offset */
-        size_t b = sizeof(ParticleAttributes) * range.start_index;
+        size_t b = attr_offset + sizeof(ParticleAttributes) * range.start_index;
         GL_CHECK(glVertexAttribPointer(
             1,
             4,
@@ -739,6 +863,14 @@ void GLRenderer::render_particles(RenderData const & render_data) {
             sizeof(ParticleAttributes),
             reinterpret_cast<void*>(b + offsetof(ParticleAttributes, color))
         ));
+        GL_CHECK(glVertexAttribPointer(
+            4,
+            2,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(ParticleAttributes),
+            reinterpret_cast<void*>(b + offsetof(ParticleAttributes, uv_size))
+        ));
 
         GL_CHECK(glDrawArraysInstanced(
             GL_TRIANGLE_STRIP,
@@ -748,13 +880,12 @@ void GLRenderer::render_particles(RenderData const & render_data) {
         ));
     }
 
-    GL_CHECK(glBindVertexArray(0));
+    m_state.bind_vertex_array(0);
 }
 
 void GLRenderer::free_particle_buffers() {
     GL_CHECK(glDeleteBuffers(1, &m_particle_vbo));
-    GL_CHECK(glDeleteBuffers(1, &m_particle_attr_vbo));
-    GL_CHECK(glDeleteBuffers(1, &m_particle_vao));
+    GL_CHECK(glDeleteVertexArrays(1, &m_particle_vao));
 }
 
 void GLRenderer::render_decals(RenderData const & render_data) {
@@ -763,53 +894,87 @@ void GLRenderer::render_decals(RenderData const & render_data) {
     bind_viewport_framebuffer(framebuffer);
 
     /* capabilities */
-    GL_CHECK(glDepthMask(GL_FALSE));
-    GL_CHECK(glDisable(GL_DEPTH_TEST));
-    GL_CHECK(glEnable(GL_CULL_FACE));
-    GL_CHECK(glCullFace(GL_FRONT));
-    GL_CHECK(glDisable(GL_BLEND));
-    GL_CHECK(glEnable(GL_BLEND));
-    GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-    GL_CHECK(glBlendEquation(GL_FUNC_ADD));
+    m_state.depth_mask(false);
+    m_state.set_depth_test(false);
+    m_state.set_cull_face(true);
+    m_state.cull_face(GL_FRONT);
+    m_state.set_blend(true);
+    m_state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    m_state.blend_equation(GL_FUNC_ADD);
     GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
     GLenum attachment = GL_COLOR_ATTACHMENT0;
     GL_CHECK(glDrawBuffers(1, &attachment));
 
     /* draw */
-    GL_CHECK(glUseProgram(m_decal_shader->shader()));
-    bind_decal_data(*m_decal_shader, render_data.camera_data);
+    m_state.use_program(m_decal_shader->shader());
+    bind_decal_data(*m_decal_shader);
+
+    DecalData const & data = render_data.scene.decal_data;
+    if (data.attributes.empty()) return;
 
-    auto const & decal_data = render_data.scene.decal_data;
-    for (DecalRenderData const & data : decal_data) {
-        static const GLVarString decal_map_str = "u_DecalMap";
+    /* decal attributes, leaves the stream buffer bound */
+    size_t attr_offset = m_vertex_stream.push(
+        data.attributes.data(),
+        data.attributes.size() * sizeof(DecalAttributes),
+        alignof(DecalAttributes)
+    );
+
+    m_state.bind_vertex_array(m_decal_vao);
+
+    for (DecalData::TextureRange const & range : data.textures) {
         bind_texture(
             *m_decal_shader,
-            decal_map_str,
+            uniform_id_decal_map,
             2,
-            m_texture_manager.get_texture(data.texture)
-        );
-
-        bind_transform_and_camera_data(
-            *m_decal_shader,
-            data.transform,
-            render_data.camera_data
+            m_texture_manager.get_texture(range.texture)
         );
 
-        GLShader & shader = *m_decal_shader;
-
-        static const GLVarString inv_mmatrix_str = "u_InvMMatrix";
-        glm::mat4 inv_mmatrix = glm::inverse(data.transform);
-        GL_CHECK(glUniformMatrix4fv(
-            shader.get_uniform_loc(inv_mmatrix_str),
-            1,
+        /* locations are given by the layout qualifiers of decal.vs */
+        size_t b = attr_offset + sizeof(DecalAttributes) * range.start_index;
+        for (GLuint i = 0; i < 3; ++i) {
+            GL_CHECK(glVertexAttribPointer(
+                1 + i,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(DecalAttributes),
+                reinterpret_cast<void*>(
+                    b + offsetof(DecalAttributes, transform) +
+                    i * sizeof(glm::vec4)
+                )
+            ));
+            GL_CHECK(glVertexAttribPointer(
+                4 + i,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(DecalAttributes),
+                reinterpret_cast<void*>(
+                    b + offsetof(DecalAttributes, inv_transform) +
+                    i * sizeof(glm::vec4)
+                )
+            ));
+        }
+        GL_CHECK(glVertexAttribPointer(
+            7,
+            4,
+            GL_FLOAT,
             GL_FALSE,
-            &inv_mmatrix[0][0]
+            sizeof(DecalAttributes),
+            reinterpret_cast<void*>(b + offsetof(DecalAttributes, color))
+        ));
+        GL_CHECK(glVertexAttribPointer(
+            8,
+            4,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(DecalAttributes),
+            reinterpret_cast<void*>(
+                b + offsetof(DecalAttributes, uv_transform)
+            )
         ));
 
-        static const GLVarString color_str = "u_Color";
-        GL_CHECK(glUniform4fv(shader.get_uniform_loc(color_str), 1, &data.color[0]));
-
-        m_model_manager.meshes().at(m_decal_mesh).draw_array_triangles();
+        GL_CHECK(glDrawArraysInstanced(GL_TRIANGLES, 0, 36, range.count));
     }
 }
 
@@ -819,12 +984,12 @@ void GLRenderer::render_selection(RenderData const & render_data) {
     bind_viewport_framebuffer(framebuffer);
 
     /* capabilities */
-    GL_CHECK(glDepthMask(GL_TRUE));
-    GL_CHECK(glEnable(GL_DEPTH_TEST));
-    GL_CHECK(glEnable(GL_CULL_FACE));
-    GL_CHECK(glCullFace(GL_BACK));
+    m_state.depth_mask(true);
+    m_state.set_depth_test(true);
+    m_state.set_cull_face(true);
+    m_state.cull_face(GL_BACK);
 
-    GL_CHECK(glDisable(GL_BLEND));
+    m_state.set_blend(false);
 
     GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
 
@@ -839,108 +1004,211 @@ void GLRenderer::render_selection(RenderData const & render_data) {
     GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
     /* draw */
-    GL_CHECK(glUseProgram(m_selection_shader->shader()));
+    m_state.use_program(m_selection_shader->shader());
 
     auto const & meshes = m_model_manager.meshes();
     auto const & selected_meshes = render_data.scene.selected_mesh_data;
-    for (MeshRenderData const & selected_mesh_data : selected_meshes) {
-        bind_transform_and_camera_data(
-            *m_selection_shader,
-            selected_mesh_data.transform,
-            render_data.camera_data
-        );
-        bind_node_data(
-            *m_selection_shader,
-            selected_mesh_data.node_data
-        );
+    for (size_t i = 0; i < selected_meshes.size(); ++i) {
+        m_uniform_buffers.bind_model_data(m_model_slots.selected_mesh + i);
 
-        meshes.at(selected_mesh_data.mesh_id).draw_elements_triangles();
+        meshes.at(selected_meshes[i].mesh_id).draw_elements_triangles(
+            m_state,
+            selected_meshes[i].lod
+        );
     }
 
-    GL_CHECK(glUseProgram(m_animated_selection_shader->shader()));
-    for (AnimatedMeshRenderData const & data :
-        render_data.scene.selected_animated_mesh_data) {
+    m_state.use_program(m_animated_selection_shader->shader());
+    auto const & selected_animated_meshes =
+        render_data.scene.selected_animated_mesh_data;
+    for (size_t i = 0; i < selected_animated_meshes.size(); ++i) {
+        AnimatedMeshRenderData const & data = selected_animated_meshes[i];
         MeshRenderData const & mesh_data = data.mesh_data;
 
-        bind_transform_and_camera_data(
-            *m_animated_selection_shader,
-            mesh_data.transform,
-            render_data.camera_data
-        );
-        bind_node_data(
-            *m_animated_selection_shader,
-            mesh_data.node_data
+        m_uniform_buffers.bind_model_data(
+            m_model_slots.selected_animated_mesh + i
         );
         bind_bone_data(
             *m_animated_selection_shader,
-            render_data.scene.bone_data[data.bone_data_index]
+            render_data.scene.bone_data.palettes[data.bone_data_index]
         );
 
-        meshes.at(mesh_data.mesh_id).draw_elements_triangles();
+        meshes.at(mesh_data.mesh_id).draw_elements_triangles(
+            m_state,
+            mesh_data.lod
+        );
     }
 }
 
-void GLRenderer::create_canvas_geometry(
-    std::vector<RenderRect2D> const & data
+void GLRenderer::write_canvas_vertices(
+    RenderRect2D const * rects,
+    uint32_t count,
+    uint32_t first
 ) {
+    if (count == 0) return;
+
     thread_local std::vector<CanvasGeometry> geometry;
     geometry.clear();
 
-    for (RenderRect2D const & rect : data) {
+    for (uint32_t i = 0; i < count; ++i) {
+        RenderRect2D const & rect = rects[i];
         glm::vec2 pos = rect.position;
         glm::vec2 dim = rect.dimension;
 
         glm::vec4 v0{ pos.x,         pos.y,         rect.uv0.x, rect.uv0.y };
         glm::vec4 v1{ pos.x + dim.x, pos.y,         rect.uv1.x, rect.uv1.y };
-        glm::vec4 v3{ pos.x,         pos.y + dim.y, rect.uv3.x, rect.uv3.y };
         glm::vec4 v2{ pos.x + dim.x, pos.y + dim.y, rect.uv2.x, rect.uv2.y };
+        glm::vec4 v3{ pos.x,         pos.y + dim.y, rect.uv3.x, rect.uv3.y };
 
         geometry.emplace_back(CanvasGeometry{ v0, rect.color });
         geometry.emplace_back(CanvasGeometry{ v1, rect.color });
         geometry.emplace_back(CanvasGeometry{ v2, rect.color });
-
-        geometry.emplace_back(CanvasGeometry{ v0, rect.color });
-        geometry.emplace_back(CanvasGeometry{ v2, rect.color });
         geometry.emplace_back(CanvasGeometry{ v3, rect.color });
     }
 
-    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, m_canvas_vbo));
-    GL_CHECK(glBufferData(
+    GL_CHECK(glBufferSubData(
         GL_ARRAY_BUFFER,
+        4 * first * sizeof(CanvasGeometry),
         geometry.size() * sizeof(geometry[0]),
-        geometry.data(),
-        GL_DYNAMIC_DRAW
+        geometry.data()
     ));
 }
 
-void GLRenderer::draw_canvas_elements(
-    size_t start,
-    size_t end,
-    GLuint texture_id
+void GLRenderer::update_canvas_geometry(
+    std::vector<RenderRect2D> const & data,
+    std::vector<RenderRect2DRange> const & ranges
 ) {
-    static const GLVarString tex_str = "u_Texture";
-    GL_CHECK(glUniform1i(m_canvas_shader->get_uniform_loc(tex_str), 0));
-    GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture_id));
+    bool fits = ranges.size() == m_canvas_slots.size();
+    for (size_t i = 0; fits && i < ranges.size(); ++i) {
+        fits = ranges[i].count <= m_canvas_slots[i].capacity;
+    }
 
-    GL_CHECK(glBindVertexArray(m_canvas_vao));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, m_canvas_vbo));
+
+    bool changed = false;
+    if (fits) {
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            RenderRect2DRange const & range = ranges[i];
+            CanvasSlot & slot = m_canvas_slots[i];
+            if (slot.hash != range.hash) {
+                write_canvas_vertices(
+                    &data[range.start],
+                    range.count,
+                    slot.first
+                );
+                slot.hash = range.hash;
+                changed = true;
+            }
+        }
+    } else {
+        /* reallocate every slot, with some room for subtrees to grow */
+        m_canvas_slots.resize(ranges.size());
+        uint32_t capacity = 0;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            CanvasSlot & slot = m_canvas_slots[i];
+            slot.hash = ranges[i].hash;
+            slot.first = capacity;
+            slot.capacity = ranges[i].count + ranges[i].count / 4 + 4;
+            capacity += slot.capacity;
+        }
+
+        GL_CHECK(glBufferData(
+            GL_ARRAY_BUFFER,
+            4 * capacity * sizeof(CanvasGeometry),
+            nullptr,
+            GL_DYNAMIC_DRAW
+        ));
+
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            write_canvas_vertices(
+                &data[ranges[i].start],
+                ranges[i].count,
+                m_canvas_slots[i].first
+            );
+        }
+        changed = true;
+    }
+
+    if (!changed) return;
 
-    /* start, end is in render rect counts. We need to convert this to triangle
-     * counts.
+    /* Consecutive rects of a subtree on the same layer, such as the glyphs
+     * of a text, form a run that occupies one contiguous range of vertices.
+     * Runs are sorted by layer, keeping the order of runs within a layer.
      */
-    size_t buf_start = 6 * start;
-    size_t buf_end = 6 * ((end - start) + 1);
-    GL_CHECK(glDrawArrays(GL_TRIANGLES, buf_start, buf_end));
+    struct CanvasRun {
+        uint32_t index; // into data
+        uint32_t count;
+        uint32_t vertex; // first vertex in the buffer
+    };
+    thread_local std::vector<CanvasRun> runs;
+    runs.clear();
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        RenderRect2DRange const & range = ranges[i];
+        for (uint32_t j = 0; j < range.count; ++j) {
+            uint32_t index = range.start + j;
+            if (j == 0 || data[index].layer != data[index - 1].layer) {
+                runs.push_back(CanvasRun{
+                    index,
+                    0,
+                    4 * (m_canvas_slots[i].first + j)
+                });
+            }
+            ++runs.back().count;
+        }
+    }
+
+    std::stable_sort(runs.begin(), runs.end(),
+    [&data] (CanvasRun const & a, CanvasRun const & b)
+        {
+            return data[a.index].layer < data[b.index].layer;
+        }
+    );
+
+    thread_local std::vector<GLuint> indices;
+    indices.clear();
+    m_canvas_groups.clear();
+    for (CanvasRun const & run : runs) {
+        for (uint32_t i = 0; i < run.count; ++i) {
+            ResourceID texture = data[run.index + i].texture;
+            if (m_canvas_groups.empty() ||
+                m_canvas_groups.back().texture != texture) {
+                m_canvas_groups.push_back(CanvasDrawGroup{
+                    static_cast<uint32_t>(indices.size()),
+                    0,
+                    texture
+                });
+            }
+            m_canvas_groups.back().n_indices += 6;
+
+            GLuint v = run.vertex + 4 * i;
+            indices.insert(
+                indices.end(),
+                { v, v + 1, v + 2, v, v + 2, v + 3 }
+            );
+        }
+    }
+
+    /* the element buffer binding is part of the vertex array state */
+    m_state.bind_vertex_array(m_canvas_vao);
+    GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_canvas_ebo));
+    GL_CHECK(glBufferData(
+        GL_ELEMENT_ARRAY_BUFFER,
+        indices.size() * sizeof(indices[0]),
+        indices.data(),
+        GL_DYNAMIC_DRAW
+    ));
 }
 
-void GLRenderer::render_canvas(std::vector<RenderRect2D> & data) {
+void GLRenderer::render_canvas(
+    std::vector<RenderRect2D> const & data,
+    std::vector<RenderRect2DRange> const & ranges
+) {
     if (data.empty()) return;
 
-    GL_CHECK(glDepthMask(GL_FALSE));
-    GL_CHECK(glDisable(GL_DEPTH_TEST));
-    GL_CHECK(glDisable(GL_CULL_FACE));
-    GL_CHECK(glEnable(GL_BLEND));
-    GL_CHECK(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    m_state.depth_mask(false);
+    m_state.set_depth_test(false);
+    m_state.set_cull_face(false);
+    m_state.set_blend(true);
+    m_state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     /* The canvas will be rendered to whatever framebuffer that was already
      * bound.
@@ -951,28 +1219,25 @@ void GLRenderer::render_canvas(std::vector<RenderRect2D> & data) {
     GLenum attachment = fbo == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0;
 
     GL_CHECK(glDrawBuffers(1, &attachment));
-    GL_CHECK(glUseProgram(m_canvas_shader->shader()));
-
-    /* sort canvas data */
-    std::sort(data.begin(), data.end(),
-    [] (RenderRect2D const & a, RenderRect2D const & b)
-        {
-            return (a.layer < b.layer);
-        }
-    );
+    m_state.use_program(m_canvas_shader->shader());
 
-    create_canvas_geometry(data);
+    update_canvas_geometry(data, ranges);
 
-    size_t group_start = 0;
-    for (size_t i = 0; i < data.size(); ++i) {
-        if (i + 1 == data.size() || data[i].texture != data[i + 1].texture) {
-            GLuint tex_id = data[i].texture == NO_RESOURCE ?
-                m_texture_manager.texture_1x1_0xffffffff() :
-                m_texture_manager.get_texture(data[i].texture);
+    GL_CHECK(glUniform1i(m_canvas_shader->get_uniform_loc(uniform_id_texture), 0));
+    m_state.bind_vertex_array(m_canvas_vao);
 
-            draw_canvas_elements(group_start, i, tex_id);
-            group_start = i + 1;
-        }
+    for (CanvasDrawGroup const & group : m_canvas_groups) {
+        GLuint tex_id = group.texture == NO_RESOURCE ?
+            m_texture_manager.texture_1x1_0xffffffff() :
+            m_texture_manager.get_texture(group.texture);
+        m_state.bind_texture(0, tex_id);
+
+        GL_CHECK(glDrawElements(
+            GL_TRIANGLES,
+            group.n_indices,
+            GL_UNSIGNED_INT,
+            reinterpret_cast<void*>(group.first_index * sizeof(GLuint))
+        ));
     }
 }
 
@@ -980,115 +1245,12 @@ void GLRenderer::render_imgui() {
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
-void GLRenderer::bind_light_data(
-    GLShader const & s,
-    LightRenderData const & light_data
-) {
-    static const GLVarString n_point_lights_str = "u_NumberOfPointLights";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(n_point_lights_str), static_cast<int>(light_data.number_of_point_lights)));
-
-    static const GLVarString point_lights_0_pos_str = "u_PointLights[0].position";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(point_lights_0_pos_str), 1, &light_data.point_lights[0].position[0]));
-    static const GLVarString point_lights_0_col_str = "u_PointLights[0].color";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(point_lights_0_col_str), 1, &light_data.point_lights[0].light.color[0]));
-    static const GLVarString point_lights_0_a_str = "u_PointLights[0].a";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_0_a_str), light_data.point_lights[0].light.quadratic_term));
-    static const GLVarString point_lights_0_b_str = "u_PointLights[0].b";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_0_b_str), light_data.point_lights[0].light.linear_term));
-    static const GLVarString point_lights_0_c_str = "u_PointLights[0].c";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_0_c_str), light_data.point_lights[0].light.constant_term));
-
-    static const GLVarString point_lights_1_pos_str = "u_PointLights[1].position";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(point_lights_1_pos_str), 1, &light_data.point_lights[1].position[0]));
-    static const GLVarString point_lights_1_col_str = "u_PointLights[1].color";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(point_lights_1_col_str), 1, &light_data.point_lights[1].light.color[0]));
-    static const GLVarString point_lights_1_a_str = "u_PointLights[1].a";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_1_a_str), light_data.point_lights[1].light.quadratic_term));
-    static const GLVarString point_lights_1_b_str = "u_PointLights[1].b";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_1_b_str), light_data.point_lights[1].light.linear_term));
-    static const GLVarString point_lights_1_c_str = "u_PointLights[1].c";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_1_c_str), light_data.point_lights[1].light.constant_term));
-
-    static const GLVarString point_lights_2_pos_str = "u_PointLights[2].position";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(point_lights_2_pos_str), 1, &light_data.point_lights[2].position[0]));
-    static const GLVarString point_lights_2_col_str = "u_PointLights[2].color";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(point_lights_2_col_str), 1, &light_data.point_lights[2].light.color[0]));
-    static const GLVarString point_lights_2_a_str = "u_PointLights[2].a";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_2_a_str), light_data.point_lights[2].light.quadratic_term));
-    static const GLVarString point_lights_2_b_str = "u_PointLights[2].b";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_2_b_str), light_data.point_lights[2].light.linear_term));
-    static const GLVarString point_lights_2_c_str = "u_PointLights[2].c";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_2_c_str), light_data.point_lights[2].light.constant_term));
-
-    static const GLVarString point_lights_3_pos_str = "u_PointLights[3].position";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(point_lights_3_pos_str), 1, &light_data.point_lights[3].position[0]));
-    static const GLVarString point_lights_3_col_str = "u_PointLights[3].color";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(point_lights_3_col_str), 1, &light_data.point_lights[3].light.color[0]));
-    static const GLVarString point_lights_3_a_str = "u_PointLights[3].a";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_3_a_str), light_data.point_lights[3].light.quadratic_term));
-    static const GLVarString point_lights_3_b_str = "u_PointLights[3].b";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_3_b_str), light_data.point_lights[3].light.linear_term));
-    static const GLVarString point_lights_3_c_str = "u_PointLights[3].c";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(point_lights_3_c_str), light_data.point_lights[3].light.constant_term));
-
-    glm::vec3 dir_light_dir = glm::normalize(light_data.directional_light.direction);
-    static const GLVarString dir_light_dir_str = "u_DirectionalLight.direction";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(dir_light_dir_str), 1, &dir_light_dir[0]));
-    static const GLVarString dir_light_col_str = "u_DirectionalLight.color";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(dir_light_col_str), 1, &light_data.directional_light.color[0]));
-
-    static const GLVarString dir_light_on_str = "u_DirectionalLightOn";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(dir_light_on_str), static_cast<int>(light_data.directional_light_on)));
-
-    static const GLVarString ambient_light_str = "u_AmbientLight";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(ambient_light_str), 1, &light_data.ambient_light.color[0]));
-}
-
-void GLRenderer::bind_transform_and_camera_data(
-    GLShader const & s,
-    glm::mat4 const & transform,
-    CameraRenderData const & data
-) {
-    glm::mat4 m_matrix = transform;
-    glm::mat4 mv_matrix = data.view_matrix * transform;
-    glm::mat4 vp_matrix = data.projection_matrix * data.view_matrix;
-    glm::mat4 mvp_matrix = data.projection_matrix * mv_matrix;
-    glm::mat3 inv_tpos_matrix = glm::inverse(glm::transpose(m_matrix));
-
-    static const GLVarString view_pos_str = "u_ViewPosition";
-    GL_CHECK(glUniform3fv(s.get_uniform_loc(view_pos_str), 1, &data.view_position[0]));
-
-    static const GLVarString mmatrix_str = "u_MMatrix";
-    GL_CHECK(glUniformMatrix4fv(s.get_uniform_loc(mmatrix_str), 1, GL_FALSE, &m_matrix[0][0]));
-    static const GLVarString mvmatrix_str = "u_MVMatrix";
-    static const GLVarString vpmatrix_str = "u_VPMatrix";
-    GL_CHECK(glUniformMatrix4fv(s.get_uniform_loc(vpmatrix_str), 1, GL_FALSE, &vp_matrix[0][0]));
-    GL_CHECK(glUniformMatrix4fv(s.get_uniform_loc(mvmatrix_str), 1, GL_FALSE, &mv_matrix[0][0]));
-    static const GLVarString mvpmatrix_str = "u_MVPMatrix";
-    GL_CHECK(glUniformMatrix4fv(s.get_uniform_loc(mvpmatrix_str), 1, GL_FALSE, &mvp_matrix[0][0]));
-    static const GLVarString inv_tpos_matrix_str = "u_InvTposMMatrix";
-    GL_CHECK(glUniformMatrix3fv(s.get_uniform_loc(inv_tpos_matrix_str), 1, GL_FALSE, &inv_tpos_matrix[0][0]));
-}
-
-void GLRenderer::bind_decal_data(
-    GLShader const & s,
-    CameraRenderData const & data
-) {
-    glm::mat4 inv_vp_matrix = glm::inverse(data.view_matrix) *
-                              glm::inverse(data.projection_matrix);
-
-    static const GLVarString inv_vp_str = "u_InvVP";
-    GL_CHECK(glUniformMatrix4fv(s.get_uniform_loc(inv_vp_str), 1, GL_FALSE, &inv_vp_matrix[0][0]));
+void GLRenderer::bind_decal_data(GLShader const & s) {
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_depth_map), 0));
+    m_state.bind_texture(0, m_source_buffers.depth_texture());
 
-    static const GLVarString depth_map_str = "u_DepthMap";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(depth_map_str), 0));
-    GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_source_buffers.depth_texture()));
-
-    static const GLVarString normal_map_str = "u_NormalMap";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(normal_map_str), 1));
-    GL_CHECK(glActiveTexture(GL_TEXTURE1));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_source_buffers.normal_texture()));
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_normal_map), 1));
+    m_state.bind_texture(1, m_source_buffers.normal_texture());
 
     int w;
     int h;
@@ -1096,28 +1258,30 @@ void GLRenderer::bind_decal_data(
     GLint buffer_width = static_cast<GLint>(w / m_downscale_factor);
     GLint buffer_height = static_cast<GLint>(h / m_downscale_factor);
 
-    static const GLVarString width_str = "u_BufferWidth";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(width_str), buffer_width));
-    static const GLVarString height_str = "u_BufferHeight";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(height_str), buffer_height));
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_buffer_width), buffer_width));
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_buffer_height), buffer_height));
 
 
 }
 
-void GLRenderer::bind_node_data(
-    GLShader const & shader,
-    NodeData node_data
-) {
-    assert(node_data.id <= 0x00ffffffu || node_data.id == NO_NODE);
-
-    uint32_t idu32;
-    memcpy(&idu32, &node_data.id, sizeof(uint32_t));
-    uint32_t packed_data = (idu32 & 0x00ffffffu) |
-                           (node_data.selected ? 0xff000000u : 0x0u);
+void GLRenderer::bind_light_cluster_data(GLShader const & s) {
+    GL_CHECK(glUniform1i(
+        s.get_uniform_loc(uniform_id_cluster_grid),
+        GLLightClusters::GRID_TEXTURE_UNIT
+    ));
+    m_state.bind_texture(
+        GLLightClusters::GRID_TEXTURE_UNIT,
+        m_light_cluster_textures.grid_texture()
+    );
 
-    static const GLVarString node_data_str = "u_NodeData";
-    GLuint u_node_data = static_cast<GLuint>(packed_data);
-    GL_CHECK(glUniform1ui(shader.get_uniform_loc(node_data_str), GLuint(u_node_data)));
+    GL_CHECK(glUniform1i(
+        s.get_uniform_loc(uniform_id_cluster_light_indices),
+        GLLightClusters::INDEX_TEXTURE_UNIT
+    ));
+    m_state.bind_texture(
+        GLLightClusters::INDEX_TEXTURE_UNIT,
+        m_light_cluster_textures.index_texture()
+    );
 }
 
 void GLRenderer::bind_material_data(
@@ -1125,76 +1289,70 @@ void GLRenderer::bind_material_data(
     GLMaterial const & material,
     MaterialOverride const & mat_override
 ) {
-    static const GLVarString albedo_map_str = "u_AlbedoMap";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(albedo_map_str), 0));
-    GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, material.albedo_map()));
-
-    static const GLVarString normal_map_str = "u_NormalMap";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(normal_map_str), 1));
-    GL_CHECK(glActiveTexture(GL_TEXTURE1));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, material.normal_map()));
-
-    static const GLVarString metallic_map_str = "u_MetallicMap";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(metallic_map_str), 2));
-    GL_CHECK(glActiveTexture(GL_TEXTURE2));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, material.metallic_map()));
-
-    static const GLVarString roughness_map_str = "u_RoughnessMap";
-    GL_CHECK(glUniform1i(s.get_uniform_loc(roughness_map_str), 3));
-    GL_CHECK(glActiveTexture(GL_TEXTURE3));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, material.roughness_map()));
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_albedo_map), 0));
+    m_state.bind_texture(0, material.albedo_map());
+
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_normal_map), 1));
+    m_state.bind_texture(1, material.normal_map());
+
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_metallic_map), 2));
+    m_state.bind_texture(2, material.metallic_map());
+
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_roughness_map), 3));
+    m_state.bind_texture(3, material.roughness_map());
 
     glm::vec4 albedo = material.material().albedo;
     if (mat_override.tint_active) {
         albedo = albedo * mat_override.tint;
     }
 
-    static const GLVarString albedo_str = "u_Albedo";
-    GL_CHECK(glUniform4fv(s.get_uniform_loc(albedo_str), 1, &albedo[0]));
-    static const GLVarString metallic_str = "u_Metallic";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(metallic_str), material.material().metallic));
-    static const GLVarString roughness_str = "u_Roughness";
-    GL_CHECK(glUniform1f(s.get_uniform_loc(roughness_str), material.material().roughness));
+    GL_CHECK(glUniform4fv(s.get_uniform_loc(uniform_id_albedo), 1, &albedo[0]));
+    GL_CHECK(glUniform1f(s.get_uniform_loc(uniform_id_metallic), material.material().metallic));
+    GL_CHECK(glUniform1f(s.get_uniform_loc(uniform_id_roughness), material.material().roughness));
 }
 
 void GLRenderer::bind_bone_data(
     GLShader const & s,
-    BoneData const & bone_data
+    BonePalette const & palette
 ) {
-    static const GLVarString bones_str = "u_Bones";
-    GL_CHECK(glUniformMatrix4fv(s.get_uniform_loc(bones_str), bone_data.bones.size(), GL_FALSE, &bone_data.bones[0][0][0]));
+    GL_CHECK(glUniform1i(
+        s.get_uniform_loc(uniform_id_bone_palettes),
+        GLBonePalettes::TEXTURE_UNIT
+    ));
+    m_state.bind_texture(
+        GLBonePalettes::TEXTURE_UNIT,
+        m_bone_palettes.texture()
+    );
+
+    /* a negative offset makes the shader use the bind pose */
+    GLint offset = palette.count > 0 ? static_cast<GLint>(palette.offset) : -1;
+    GL_CHECK(glUniform1i(s.get_uniform_loc(uniform_id_bone_offset), offset));
 }
 
 void GLRenderer::bind_texture(
     GLShader const & s,
-    GLVarString const & uniform_str,
+    GLUniformID uniform,
     unsigned int location,
     GLuint texture
 ) {
-    glUniform1i(s.get_uniform_loc(uniform_str), location);
-    GL_CHECK(glActiveTexture(GL_TEXTURE0 + location));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+    glUniform1i(s.get_uniform_loc(uniform), location);
+    m_state.bind_texture(location, texture);
 }
 
 void GLRenderer::bind_transparency_buffers(
     GLShader const & shader,
     GLuint opaque_framebuffer
 ) {
-    GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, opaque_framebuffer));
+    m_state.bind_framebuffer(GL_FRAMEBUFFER, opaque_framebuffer);
 
     GLenum attachment = GL_COLOR_ATTACHMENT0;
     GL_CHECK(glDrawBuffers(1, &attachment));
-    GL_CHECK(glUseProgram(shader.shader()));
-    GL_CHECK(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
-
-    static const GLVarString accum_str = "uAccumulate";
-    GL_CHECK(glUniform1i(shader.get_uniform_loc(accum_str), 0));
-    GL_CHECK(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_source_buffers.accum_texture()));
-
-    static const GLVarString accum_alpha_str = "uAccumulateAlpha";
-    GL_CHECK(glUniform1i(shader.get_uniform_loc(accum_alpha_str), 1));
-    GL_CHECK(glActiveTexture(GL_TEXTURE1));
-    GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_source_buffers.accum_alpha_texture()));
+    m_state.use_program(shader.shader());
+    m_state.blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    GL_CHECK(glUniform1i(shader.get_uniform_loc(uniform_id_accumulate), 0));
+    m_state.bind_texture(0, m_source_buffers.accum_texture());
+
+    GL_CHECK(glUniform1i(shader.get_uniform_loc(uniform_id_accumulate_alpha), 1));
+    m_state.bind_texture(1, m_source_buffers.accum_alpha_texture());
 }
@@ -3,13 +3,19 @@
 
 #include "src/backend/render_backend.h"
 #include "src/backend/opengl/gl_shader.h"
+#include "src/backend/opengl/gl_bone_palettes.h"
 #include "src/backend/opengl/gl_mesh.h"
 #include "src/backend/opengl/gl_material.h"
 #include "src/backend/opengl/gl_texture_manager.h"
+#include "src/backend/opengl/gl_light_clusters.h"
 #include "src/backend/opengl/gl_material_manager.h"
 #include "src/backend/opengl/gl_model_manager.h"
 #include "src/backend/opengl/gl_postprocessing_chain.h"
 #include "src/backend/opengl/gl_source_buffers.h"
+#include "src/backend/opengl/gl_state_cache.h"
+#include "src/backend/opengl/gl_stream_buffer.h"
+#include "src/backend/opengl/gl_uniform_buffers.h"
+#include "src/engine/rendering/light_clusters.h"
 #include "src/engine/rendering/model_manager.h"
 
 #include "backends/imgui_impl_glfw.h"
@@ -71,7 +77,8 @@ public:
         PostProcessingChain const & editor_chain
     ) final;
 
-    NodeID get_selected(int x, int y) final;
+    bool request_selection(int x, int y) final;
+    bool poll_selection(NodeID & id) final;
 
     ResourceID upload_material(Material const & material) final
     { return m_material_manager.upload_material(material); }
@@ -86,6 +93,8 @@ public:
 
     ResourceID upload_texture(TextureData const & data) final
     { return m_texture_manager.upload_texture(data); }
+    void update_texture(ResourceID id, TextureData const & data) final
+    { m_texture_manager.update_texture(id, data); }
     void free_texture(ResourceID id) final
     { return m_texture_manager.free_texture(id); }
 
@@ -104,6 +113,11 @@ public:
         ));
     }
 
+    TextureFormatSupport texture_format_support() const final
+    { return m_texture_manager.format_support(); }
+
+    RenderStats render_stats() const final { return m_state.frame_stats(); }
+
 private:
     GLFWwindow * m_window;
     float m_downscale_factor;
@@ -116,6 +130,24 @@ private:
     GLPostProcessingChain m_editor_postprocessing_chain;
 
     GLSourceBuffers m_source_buffers;
+    GLUniformBuffers m_uniform_buffers;
+    GLStateCache m_state;
+
+    LightClusters m_light_clusters;
+    GLLightClusters m_light_cluster_textures;
+    GLBonePalettes m_bone_palettes;
+
+    /* first model uniform slot of each render data array, see
+     * write_model_data()
+     */
+    struct ModelSlots {
+        uint32_t mesh;
+        uint32_t animated_mesh;
+        uint32_t selected_mesh;
+        uint32_t selected_animated_mesh;
+        uint32_t wireframe;
+    };
+    ModelSlots m_model_slots;
 
     GLShader * m_decal_shader;
     GLShader * m_selection_shader;
@@ -124,17 +156,47 @@ private:
     GLShader * m_canvas_shader;
     GLShader * m_particle_shader;
 
-    ResourceID m_decal_mesh;
+    /* unit box that decals are instanced from */
+    GLuint m_decal_vao;
+    GLuint m_decal_vbo;
 
+    /* per frame vertex data of particles and decals */
+    GLStreamBuffer m_vertex_stream;
+
+    /* Canvas geometry is retained across frames, with four vertices per
+     * rect. Each canvas subtree owns a slot of the vertex buffer that is
+     * only rewritten when the hash of the subtree changes. Rects are drawn
+     * in layer order through the index buffer.
+     */
     GLuint m_canvas_vao;
     GLuint m_canvas_vbo;
+    GLuint m_canvas_ebo;
+
+    struct CanvasSlot {
+        uint64_t hash;
+        uint32_t first; // in rects
+        uint32_t capacity; // in rects
+    };
+    std::vector<CanvasSlot> m_canvas_slots;
+
+    struct CanvasDrawGroup {
+        uint32_t first_index;
+        uint32_t n_indices;
+        ResourceID texture;
+    };
+    std::vector<CanvasDrawGroup> m_canvas_groups;
 
     GLuint m_particle_vao;
     GLuint m_particle_vbo;
-    GLuint m_particle_attr_vbo;
+
+    /* pixel pack buffer that selections are read back through */
+    GLuint m_selection_pbo;
+    GLsync m_selection_fence = 0;
 
     uint32_t m_frame = 0; // will overflow after a few years
 
+    void write_model_data(RenderData const & render_data);
+
     void render_meshes(RenderData const & render_data, bool transparent);
     void bind_viewport_framebuffer(GLuint framebuffer);
 
@@ -148,9 +210,19 @@ private:
         glm::vec4 color;
     };
 
-    void create_canvas_geometry(std::vector<RenderRect2D> const & data);
-    void draw_canvas_elements(size_t start, size_t end, GLuint texture_id);
-    void render_canvas(std::vector<RenderRect2D> & data);
+    void write_canvas_vertices(
+        RenderRect2D const * rects,
+        uint32_t count,
+        uint32_t first
+    );
+    void update_canvas_geometry(
+        std::vector<RenderRect2D> const & data,
+        std::vector<RenderRect2DRange> const & ranges
+    );
+    void render_canvas(
+        std::vector<RenderRect2D> const & data,
+        std::vector<RenderRect2DRange> const & ranges
+    );
 
     void create_particle_buffers();
     void render_particles(RenderData const & render_data);
@@ -158,26 +230,9 @@ private:
 
     void render_imgui();
 
-    void bind_light_data(
-        GLShader const & shader,
-        LightRenderData const & light_data
-    );
-
-    void bind_transform_and_camera_data(
-        GLShader const & shader,
-        glm::mat4 const & transform,
-        CameraRenderData const & camera_data
-    );
+    void bind_decal_data(GLShader const & s);
 
-    void bind_decal_data(
-        GLShader const & s,
-        CameraRenderData const & data
-    );
-
-    void bind_node_data(
-        GLShader const & shader,
-        NodeData node_id
-    );
+    void bind_light_cluster_data(GLShader const & s);
 
     void bind_material_data(
         GLShader const & shader,
@@ -187,12 +242,12 @@ private:
 
     void bind_bone_data(
         GLShader const & shader,
-        BoneData const & bone_data
+        BonePalette const & palette
     );
 
     void bind_texture(
         GLShader const & s,
-        GLVarString const & uniform_str,
+        GLUniformID uniform,
         unsigned int location,
         GLuint texture
     );
@@ -1,11 +1,20 @@
 #include "gl_shader.h"
 
 #include "src/backend/opengl/gl_shader_utility.h"
+#include "src/backend/opengl/gl_uniform_buffers.h"
+
+#include <cstring>
 
 using namespace prt3;
 
 GLShader::GLShader(GLuint shader)
- : m_shader{shader} {}
+ : m_shader{shader} {
+    resolve_uniform_locs();
+
+    bind_uniform_block("CameraBlock", camera_block_binding);
+    bind_uniform_block("LightBlock", light_block_binding);
+    bind_uniform_block("ModelBlock", model_block_binding);
+}
 
 GLint GLShader::get_uniform_loc(GLVarString const & uniform) const {
     auto search = m_uniform_cache.find(uniform);
@@ -28,3 +37,52 @@ GLint GLShader::get_attrib_loc(GLVarString const & attrib) const {
     }
     return search->second;
 }
+
+void GLShader::resolve_uniform_locs() {
+    m_uniform_locs.fill(-1);
+
+    /* Only walk the active uniforms of the program, rather than querying
+     * every known name, since most shaders use a handful of them.
+     */
+    GLint n_uniforms = 0;
+    GL_CHECK(glGetProgramiv(m_shader, GL_ACTIVE_UNIFORMS, &n_uniforms));
+
+    for (GLint i = 0; i < n_uniforms; ++i) {
+        char name[GLVarString::Size];
+        GLsizei length = 0;
+        GLint size;
+        GLenum type;
+        GL_CHECK(glGetActiveUniform(
+            m_shader,
+            static_cast<GLuint>(i),
+            sizeof(name),
+            &length,
+            &size,
+            &type,
+            name
+        ));
+
+        /* arrays are reported as "u_Name[0]" */
+        char * bracket = strchr(name, '[');
+        if (bracket != nullptr) {
+            *bracket = '\0';
+        }
+
+        for (GLUniformIDType id = 0; id < uniform_id_total_num; ++id) {
+            if (strcmp(name, gl_uniform_names[id]) == 0) {
+                /* members of uniform blocks have no location and stay -1 */
+                GL_CHECK(m_uniform_locs[id] =
+                    glGetUniformLocation(m_shader, name));
+                break;
+            }
+        }
+    }
+}
+
+void GLShader::bind_uniform_block(char const * name, GLuint binding) {
+    GLuint index;
+    GL_CHECK(index = glGetUniformBlockIndex(m_shader, name));
+    if (index != GL_INVALID_INDEX) {
+        GL_CHECK(glUniformBlockBinding(m_shader, index, binding));
+    }
+}
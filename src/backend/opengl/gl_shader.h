@@ -2,11 +2,13 @@
 #define PRT3_GL_SHADER_H
 
 #include "src/backend/opengl/gl_utility.h"
+#include "src/backend/opengl/gl_uniform_id.h"
 #include "src/util/hash_util.h"
 
 #define GL_GLEXT_PROTOTYPES 1
 #include <GLES3/gl3.h>
 
+#include <array>
 #include <unordered_map>
 
 namespace prt3 {
@@ -16,12 +18,18 @@ public:
     GLShader(GLuint shader);
     GLint shader() const { return m_shader; }
 
+    GLint get_uniform_loc(GLUniformID uniform) const
+    { return m_uniform_locs[uniform]; }
     GLint get_uniform_loc(GLVarString const & uniform) const;
     GLint get_attrib_loc(GLVarString const & attrib) const;
 private:
     GLuint m_shader;
+    std::array<GLint, uniform_id_total_num> m_uniform_locs;
     mutable std::unordered_map<GLVarString, GLint> m_uniform_cache;
     mutable std::unordered_map<GLVarString, GLint> m_attrib_cache;
+
+    void resolve_uniform_locs();
+    void bind_uniform_block(char const * name, GLuint binding);
 };
 
 } // namespace prt3
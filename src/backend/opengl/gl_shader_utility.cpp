@@ -2,6 +2,9 @@
 
 #include "src/backend/opengl/gl_utility.h"
 #include "src/util/log.h"
+#include "src/util/virtual_file_system.h"
+
+#include <vector>
 
 using namespace prt3;
 
@@ -12,33 +15,14 @@ GLuint glshaderutility::create_shader(const char* vertexPath,
     std::string vertexCode;
     std::string fragmentCode;
     // std::string geometryCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    std::ifstream gShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    // vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    // fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    // gShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    // try
-    // {
-    // open files
-    vShaderFile.open(vertexPath);
-    fShaderFile.open(fragmentPath);
-    std::stringstream vShaderStream, fShaderStream;
-    // read file's buffer contents into streams
-    vShaderStream << vShaderFile.rdbuf();
-    fShaderStream << fShaderFile.rdbuf();
-    // close file handlers
-    vShaderFile.close();
-    fShaderFile.close();
-    // convert stream into string
-    vertexCode = vShaderStream.str();
-    fragmentCode = fShaderStream.str();
+    // read the files, which may be in an archive
+    std::vector<char> source;
+    VirtualFileSystem::instance().read_file(vertexPath, source);
+    vertexCode.assign(source.begin(), source.end());
+    VirtualFileSystem::instance().read_file(fragmentPath, source);
+    fragmentCode.assign(source.begin(), source.end());
 
     // TODO: error handling
-    // } catch (std::ifstream::failure& e) {
-    //     std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
-    // }
     const char* vShaderCode = vertexCode.c_str();
     const char * fShaderCode = fragmentCode.c_str();
     // 2. compile shaders
@@ -0,0 +1,132 @@
+#include "gl_state_cache.h"
+
+#include <cassert>
+
+using namespace prt3;
+
+GLStateCache::GLStateCache() {
+    invalidate();
+}
+
+void GLStateCache::invalidate() {
+    m_program = UNKNOWN;
+    m_active_texture_unit = UNKNOWN;
+    m_textures.fill(UNKNOWN);
+    m_vao = UNKNOWN;
+    m_read_framebuffer = UNKNOWN;
+    m_draw_framebuffer = UNKNOWN;
+
+    m_blend = toggle_unknown;
+    m_blend_func.fill(UNKNOWN);
+    m_blend_equation = UNKNOWN;
+
+    m_depth_test = toggle_unknown;
+    m_depth_mask = toggle_unknown;
+
+    m_cull_face_enabled = toggle_unknown;
+    m_cull_face = UNKNOWN;
+}
+
+void GLStateCache::begin_frame() {
+    m_frame_stats = m_stats;
+    m_stats = {};
+}
+
+void GLStateCache::use_program(GLuint program) {
+    if (elide(m_program == program)) return;
+
+    GL_CHECK(glUseProgram(program));
+    m_program = program;
+}
+
+void GLStateCache::bind_texture(unsigned int unit, GLuint texture) {
+    assert(unit < N_TEXTURE_UNITS);
+    if (elide(m_textures[unit] == texture)) return;
+
+    if (m_active_texture_unit != unit) {
+        GL_CHECK(glActiveTexture(GL_TEXTURE0 + unit));
+        m_active_texture_unit = unit;
+        ++m_stats.state_changes_issued;
+    }
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture));
+    m_textures[unit] = texture;
+}
+
+void GLStateCache::bind_vertex_array(GLuint vao) {
+    if (elide(m_vao == vao)) return;
+
+    GL_CHECK(glBindVertexArray(vao));
+    m_vao = vao;
+}
+
+void GLStateCache::bind_framebuffer(GLenum target, GLuint framebuffer) {
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+
+    bool redundant = (!read || m_read_framebuffer == framebuffer) &&
+                     (!draw || m_draw_framebuffer == framebuffer);
+    if (elide(redundant)) return;
+
+    GL_CHECK(glBindFramebuffer(target, framebuffer));
+    if (read) m_read_framebuffer = framebuffer;
+    if (draw) m_draw_framebuffer = framebuffer;
+}
+
+void GLStateCache::set_blend(bool enabled) {
+    set_capability(GL_BLEND, m_blend, enabled);
+}
+
+void GLStateCache::blend_func_separate(
+    GLenum src_rgb,
+    GLenum dst_rgb,
+    GLenum src_alpha,
+    GLenum dst_alpha
+) {
+    std::array<GLenum, 4> func = { src_rgb, dst_rgb, src_alpha, dst_alpha };
+    if (elide(m_blend_func == func)) return;
+
+    GL_CHECK(glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha));
+    m_blend_func = func;
+}
+
+void GLStateCache::blend_equation(GLenum mode) {
+    if (elide(m_blend_equation == mode)) return;
+
+    GL_CHECK(glBlendEquation(mode));
+    m_blend_equation = mode;
+}
+
+void GLStateCache::set_depth_test(bool enabled) {
+    set_capability(GL_DEPTH_TEST, m_depth_test, enabled);
+}
+
+void GLStateCache::depth_mask(bool enabled) {
+    Toggle toggle = enabled ? toggle_on : toggle_off;
+    if (elide(m_depth_mask == toggle)) return;
+
+    GL_CHECK(glDepthMask(enabled ? GL_TRUE : GL_FALSE));
+    m_depth_mask = toggle;
+}
+
+void GLStateCache::set_cull_face(bool enabled) {
+    set_capability(GL_CULL_FACE, m_cull_face_enabled, enabled);
+}
+
+void GLStateCache::cull_face(GLenum mode) {
+    if (elide(m_cull_face == mode)) return;
+
+    GL_CHECK(glCullFace(mode));
+    m_cull_face = mode;
+}
+
+void GLStateCache::set_capability(GLenum cap, Toggle & current, bool enabled) {
+    Toggle toggle = enabled ? toggle_on : toggle_off;
+    if (elide(current == toggle)) return;
+
+    if (enabled) {
+        GL_CHECK(glEnable(cap));
+    } else {
+        GL_CHECK(glDisable(cap));
+    }
+    current = toggle;
+}
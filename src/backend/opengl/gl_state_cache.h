@@ -0,0 +1,100 @@
+#ifndef PRT3_GL_STATE_CACHE_H
+#define PRT3_GL_STATE_CACHE_H
+
+#include "src/backend/opengl/gl_utility.h"
+#include "src/backend/render_backend.h"
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <cstdint>
+
+namespace prt3 {
+
+/* Shadows the GL state that the renderer changes most often and skips
+ * calls that would not change it. State changed by code that does not go
+ * through the cache, e.g. imgui or resource uploads, must be followed by a
+ * call to invalidate().
+ */
+class GLStateCache {
+public:
+    static constexpr unsigned int N_TEXTURE_UNITS = 16;
+
+    GLStateCache();
+
+    /* Forgets all tracked state, so that the next call of each kind is
+     * issued regardless of its arguments.
+     */
+    void invalidate();
+
+    /* Stores the counters of the previous frame and resets them */
+    void begin_frame();
+    RenderStats const & frame_stats() const { return m_frame_stats; }
+
+    void use_program(GLuint program);
+    void bind_texture(unsigned int unit, GLuint texture);
+    void bind_vertex_array(GLuint vao);
+    void bind_framebuffer(GLenum target, GLuint framebuffer);
+
+    void set_blend(bool enabled);
+    void blend_func(GLenum sfactor, GLenum dfactor)
+    { blend_func_separate(sfactor, dfactor, sfactor, dfactor); }
+    void blend_func_separate(
+        GLenum src_rgb,
+        GLenum dst_rgb,
+        GLenum src_alpha,
+        GLenum dst_alpha
+    );
+    void blend_equation(GLenum mode);
+
+    void set_depth_test(bool enabled);
+    void depth_mask(bool enabled);
+
+    void set_cull_face(bool enabled);
+    void cull_face(GLenum mode);
+
+private:
+    static constexpr GLuint UNKNOWN = ~GLuint{0};
+
+    enum Toggle : int8_t {
+        toggle_unknown = -1,
+        toggle_off = 0,
+        toggle_on = 1
+    };
+
+    GLuint m_program = UNKNOWN;
+    GLuint m_active_texture_unit = UNKNOWN;
+    std::array<GLuint, N_TEXTURE_UNITS> m_textures;
+    GLuint m_vao = UNKNOWN;
+    GLuint m_read_framebuffer = UNKNOWN;
+    GLuint m_draw_framebuffer = UNKNOWN;
+
+    Toggle m_blend = toggle_unknown;
+    std::array<GLenum, 4> m_blend_func;
+    GLenum m_blend_equation = UNKNOWN;
+
+    Toggle m_depth_test = toggle_unknown;
+    Toggle m_depth_mask = toggle_unknown;
+
+    Toggle m_cull_face_enabled = toggle_unknown;
+    GLenum m_cull_face = UNKNOWN;
+
+    RenderStats m_stats;
+    RenderStats m_frame_stats;
+
+    void set_capability(GLenum cap, Toggle & current, bool enabled);
+
+    bool elide(bool redundant) {
+        if (redundant) {
+            ++m_stats.state_changes_elided;
+        } else {
+            ++m_stats.state_changes_issued;
+        }
+        return redundant;
+    }
+};
+
+} // namespace prt3
+
+#endif
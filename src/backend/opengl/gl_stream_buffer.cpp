@@ -0,0 +1,115 @@
+#include "gl_stream_buffer.h"
+
+#include <algorithm>
+
+using namespace prt3;
+
+void GLStreamBuffer::init(GLenum target, size_t initial_capacity) {
+    clean_up();
+
+    m_target = target;
+    GL_CHECK(glGenBuffers(N_FRAMES, m_buffers.data()));
+    for (size_t i = 0; i < N_FRAMES; ++i) {
+        GL_CHECK(glBindBuffer(m_target, m_buffers[i]));
+        GL_CHECK(glBufferData(
+            m_target,
+            initial_capacity,
+            nullptr,
+            GL_STREAM_DRAW
+        ));
+        m_capacities[i] = initial_capacity;
+    }
+    GL_CHECK(glBindBuffer(m_target, 0));
+
+    m_index = 0;
+    m_head = 0;
+}
+
+void GLStreamBuffer::clean_up() {
+    if (m_buffers[0] != 0) {
+        GL_CHECK(glDeleteBuffers(N_FRAMES, m_buffers.data()));
+        m_buffers = {};
+        m_capacities = {};
+    }
+}
+
+void GLStreamBuffer::begin_frame() {
+    m_index = (m_index + 1) % N_FRAMES;
+    m_head = 0;
+}
+
+void GLStreamBuffer::grow(size_t required) {
+    GLuint buffer = m_buffers[m_index];
+    size_t capacity = std::max<size_t>(2 * m_capacities[m_index], 1);
+    while (capacity < required) {
+        capacity *= 2;
+    }
+
+    /* data pushed earlier in the frame may still be drawn, so it is moved
+     * through a temporary buffer while the storage is reallocated
+     */
+    if (m_head > 0) {
+        GLuint temp;
+        GL_CHECK(glGenBuffers(1, &temp));
+        GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, temp));
+        GL_CHECK(glBufferData(
+            GL_COPY_WRITE_BUFFER,
+            m_head,
+            nullptr,
+            GL_STREAM_COPY
+        ));
+        GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, buffer));
+        GL_CHECK(glCopyBufferSubData(
+            GL_COPY_READ_BUFFER,
+            GL_COPY_WRITE_BUFFER,
+            0,
+            0,
+            m_head
+        ));
+
+        GL_CHECK(glBufferData(
+            GL_COPY_READ_BUFFER,
+            capacity,
+            nullptr,
+            GL_STREAM_DRAW
+        ));
+
+        GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, temp));
+        GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+        GL_CHECK(glCopyBufferSubData(
+            GL_COPY_READ_BUFFER,
+            GL_COPY_WRITE_BUFFER,
+            0,
+            0,
+            m_head
+        ));
+
+        GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+        GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+        GL_CHECK(glDeleteBuffers(1, &temp));
+    } else {
+        GL_CHECK(glBindBuffer(m_target, buffer));
+        GL_CHECK(glBufferData(m_target, capacity, nullptr, GL_STREAM_DRAW));
+    }
+
+    m_capacities[m_index] = capacity;
+}
+
+size_t GLStreamBuffer::push(
+    void const * data,
+    size_t size,
+    size_t alignment
+) {
+    size_t offset = ((m_head + alignment - 1) / alignment) * alignment;
+    if (offset + size > m_capacities[m_index]) {
+        grow(offset + size);
+    }
+
+    GL_CHECK(glBindBuffer(m_target, m_buffers[m_index]));
+    if (size > 0) {
+        GL_CHECK(glBufferSubData(m_target, offset, size, data));
+    }
+
+    m_head = offset + size;
+    return offset;
+}
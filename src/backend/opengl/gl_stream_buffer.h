@@ -0,0 +1,53 @@
+#ifndef PRT3_GL_STREAM_BUFFER_H
+#define PRT3_GL_STREAM_BUFFER_H
+
+#include "src/backend/opengl/gl_utility.h"
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <cstddef>
+
+namespace prt3 {
+
+/* Ring of buffers for data that is regenerated every frame. Each frame
+ * writes into its own buffer, which is not touched again until
+ * N_FRAMES frames later, so uploads never wait on draws that are still in
+ * flight. Within a frame, data is sub-allocated linearly.
+ *
+ * WebGL 2 cannot map buffers persistently, so data is written with
+ * glBufferSubData. The buffer names stay the same when a buffer grows,
+ * which means vertex array objects can keep referring to them.
+ */
+class GLStreamBuffer {
+public:
+    static constexpr size_t N_FRAMES = 3;
+
+    void init(GLenum target, size_t initial_capacity);
+    void clean_up();
+
+    /* moves on to the next buffer of the ring and discards its contents */
+    void begin_frame();
+
+    /* Copies size bytes into the buffer of the current frame and returns
+     * their offset, which is a multiple of alignment. Leaves the buffer
+     * bound to the target.
+     */
+    size_t push(void const * data, size_t size, size_t alignment = 1);
+
+    GLuint buffer() const { return m_buffers[m_index]; }
+
+private:
+    GLenum m_target = GL_ARRAY_BUFFER;
+    std::array<GLuint, N_FRAMES> m_buffers = {};
+    std::array<size_t, N_FRAMES> m_capacities = {};
+    size_t m_index = 0;
+    size_t m_head = 0;
+
+    void grow(size_t required);
+};
+
+} // namespace prt3
+
+#endif
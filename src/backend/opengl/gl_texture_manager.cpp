@@ -1,15 +1,71 @@
 #include "gl_texture_manager.h"
 
 #include "src/backend/opengl/gl_utility.h"
+#include "src/engine/rendering/mipmap.h"
 #include "src/util/log.h"
 
 #include <cassert>
+#include <cstring>
+
+/* S3TC and RGTC are extensions to GLES 3, ETC2 and EAC are core */
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RED_GREEN_RGTC2_EXT
+#define GL_COMPRESSED_RED_GREEN_RGTC2_EXT 0x8DBD
+#endif
 
 using namespace prt3;
 
 GLTextureManager::GLTextureManager() {}
 
+static bool ends_with(char const * s, char const * suffix) {
+    size_t len = std::strlen(s);
+    size_t suffix_len = std::strlen(suffix);
+    return len >= suffix_len &&
+           std::strcmp(s + len - suffix_len, suffix) == 0;
+}
+
+/* WebGL exposes the formats through WEBGL_compressed_texture_s3tc,
+ * EXT_texture_compression_rgtc and WEBGL_compressed_texture_etc, which are
+ * enabled by default for the context, native GLES through the
+ * GL_EXT_texture_compression_* extensions
+ */
+static TextureFormatSupport query_format_support() {
+    TextureFormatSupport support;
+#ifndef __EMSCRIPTEN__
+    support.etc2 = true;
+#endif // __EMSCRIPTEN__
+
+    GLint n_extensions = 0;
+    GL_CHECK(glGetIntegerv(GL_NUM_EXTENSIONS, &n_extensions));
+    for (GLint i = 0; i < n_extensions; ++i) {
+        char const * extension = reinterpret_cast<char const *>(
+            glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i))
+        );
+        if (extension == nullptr) {
+            continue;
+        }
+        if (ends_with(extension, "compressed_texture_s3tc") ||
+            ends_with(extension, "texture_compression_s3tc")) {
+            support.s3tc = true;
+        }
+        if (ends_with(extension, "texture_compression_rgtc")) {
+            support.rgtc = true;
+        }
+        if (ends_with(extension, "compressed_texture_etc")) {
+            support.etc2 = true;
+        }
+    }
+    return support;
+}
+
 void GLTextureManager::init() {
+    m_format_support = query_format_support();
+
     unsigned char data_0xffffffff[4] = { 0xff, 0xff, 0xff, 0xff };
     m_texture_1x1_0xffffffff = upload_texture(data_0xffffffff, 1, 1, GL_RGBA, false);
     unsigned char data_0x000000ff[3] = { 0x00, 0x00, 0xff };
@@ -27,7 +83,49 @@ GLTextureManager::~GLTextureManager() {
     GL_CHECK(glDeleteTextures(1, &m_texture_1x1_0xff));
 }
 
-ResourceID GLTextureManager::upload_texture(TextureData const & data) {
+static GLenum compressed_internal_format(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureFormat::bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TextureFormat::bc5: return GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
+        case TextureFormat::etc2_rgb: return GL_COMPRESSED_RGB8_ETC2;
+        case TextureFormat::etc2_rgba: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+        case TextureFormat::eac_rg11: return GL_COMPRESSED_RG11_EAC;
+        case TextureFormat::uncompressed: break;
+    }
+    assert(false && "Not a compressed format");
+    return 0;
+}
+
+/* compressed textures are cooked with their mip chain */
+static void specify_compressed_texture(TextureData const & data) {
+    GLenum internal_format = compressed_internal_format(data.format);
+    unsigned char const * level_data = data.data;
+    for (int level = 0; level < data.n_levels; ++level) {
+        int w, h;
+        mip_level_dimensions(data.width, data.height, level, w, h);
+        size_t size = texture_level_size(data.format, w, h, data.channels);
+        GL_CHECK(glCompressedTexImage2D(
+            GL_TEXTURE_2D,
+            level,
+            internal_format,
+            w,
+            h,
+            0,
+            static_cast<GLsizei>(size),
+            level_data
+        ));
+        level_data += size;
+    }
+    GL_CHECK(glTexParameteri(
+        GL_TEXTURE_2D,
+        GL_TEXTURE_MAX_LEVEL,
+        data.n_levels - 1
+    ));
+}
+
+/* (re)specifies the image of a texture object, leaves it bound */
+static void specify_texture(GLuint texture_handle, TextureData const & data) {
     // TODO: proper format detection
     GLenum format = 0;
     GLint alignment = 0;
@@ -58,25 +156,63 @@ ResourceID GLTextureManager::upload_texture(TextureData const & data) {
     }
     GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, alignment));
 
-    GLuint texture_handle;
-    GL_CHECK(glGenTextures(1, &texture_handle));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture_handle));
 
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
     GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
 
-    GL_CHECK(glTexImage2D(
+    if (texture_format_is_compressed(data.format)) {
+        specify_compressed_texture(data);
+        return;
+    }
+
+    if (data.n_levels <= 1) {
+        GL_CHECK(glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            format,
+            data.width,
+            data.height,
+            0,
+            format,
+            GL_UNSIGNED_BYTE,
+            data.data
+        ));
+        /* the default, in case the texture had a cooked mip chain before */
+        GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000));
+        GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
+        return;
+    }
+
+    /* cooked textures bring their own mip chain */
+    unsigned char const * level_data = data.data;
+    for (int level = 0; level < data.n_levels; ++level) {
+        int w, h;
+        mip_level_dimensions(data.width, data.height, level, w, h);
+        GL_CHECK(glTexImage2D(
+            GL_TEXTURE_2D,
+            level,
+            format,
+            w,
+            h,
+            0,
+            format,
+            GL_UNSIGNED_BYTE,
+            level_data
+        ));
+        level_data += static_cast<size_t>(w) * h * data.channels;
+    }
+    GL_CHECK(glTexParameteri(
         GL_TEXTURE_2D,
-        0,
-        format,
-        data.width,
-        data.height,
-        0,
-        format,
-        GL_UNSIGNED_BYTE,
-        data.data
+        GL_TEXTURE_MAX_LEVEL,
+        data.n_levels - 1
     ));
-    GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
+}
+
+ResourceID GLTextureManager::upload_texture(TextureData const & data) {
+    GLuint texture_handle;
+    GL_CHECK(glGenTextures(1, &texture_handle));
+    specify_texture(texture_handle, data);
 
     ResourceID id;
     if (m_free_ids.empty()) {
@@ -130,6 +266,18 @@ GLuint GLTextureManager::upload_texture(
     return texture;
 }
 
+void GLTextureManager::update_texture(
+    ResourceID id,
+    TextureData const & data
+) {
+    specify_texture(m_textures.at(id), data);
+
+    TextureMetadata & metadata = m_texture_metadata.at(id);
+    metadata.width = data.width;
+    metadata.height = data.height;
+    metadata.channels = data.channels;
+}
+
 void GLTextureManager::free_texture(ResourceID id) {
     GLuint handle = m_textures.at(id);
     GL_CHECK(glDeleteTextures(1, &handle));
@@ -20,6 +20,8 @@ public:
     void init();
 
     ResourceID upload_texture(TextureData const & data);
+    /* replaces the image of a texture, its id and GL name are kept */
+    void update_texture(ResourceID id, TextureData const & data);
     void free_texture(ResourceID id);
 
     GLuint get_texture(ResourceID id) const { return m_textures.at(id); }
@@ -35,6 +37,11 @@ public:
         channels = md.channels;
     }
 
+    /* the compressed formats that the context can sample, known after
+     * init()
+     */
+    TextureFormatSupport format_support() const { return m_format_support; }
+
     GLuint texture_1x1_0xffffffff() const { return m_texture_1x1_0xffffffff; }
     GLuint texture_1x1_0x0000ff() const { return m_texture_1x1_0x0000ff; }
     GLuint texture_1x1_0xff() const { return m_texture_1x1_0xff; }
@@ -44,6 +51,8 @@ private:
     GLuint m_texture_1x1_0x0000ff;
     GLuint m_texture_1x1_0xff;
 
+    TextureFormatSupport m_format_support;
+
     struct TextureMetadata {
         unsigned int width;
         unsigned int height;
@@ -0,0 +1,231 @@
+#include "gl_uniform_buffers.h"
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+using namespace prt3;
+
+static void store_mat3(glm::mat3 const & mat, glm::vec4 * columns) {
+    for (unsigned int i = 0; i < 3; ++i) {
+        columns[i] = glm::vec4{mat[i], 0.0f};
+    }
+}
+
+void GLUniformBuffers::init() {
+    clean_up();
+
+    GLint alignment = 0;
+    GL_CHECK(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    m_model_alignment = alignment > 0 ? static_cast<size_t>(alignment) : 1;
+    m_model_stride = ((sizeof(GLModelBlock) + m_model_alignment - 1) /
+                      m_model_alignment) * m_model_alignment;
+
+    GL_CHECK(glGenBuffers(1, &m_camera_ubo));
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, m_camera_ubo));
+    GL_CHECK(glBufferData(
+        GL_UNIFORM_BUFFER,
+        sizeof(GLCameraBlock),
+        nullptr,
+        GL_DYNAMIC_DRAW
+    ));
+
+    GL_CHECK(glGenBuffers(1, &m_light_ubo));
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, m_light_ubo));
+    GL_CHECK(glBufferData(
+        GL_UNIFORM_BUFFER,
+        sizeof(GLLightBlock),
+        nullptr,
+        GL_DYNAMIC_DRAW
+    ));
+
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+
+    m_model_stream.init(GL_UNIFORM_BUFFER, 256 * m_model_stride);
+
+    GL_CHECK(glBindBufferBase(
+        GL_UNIFORM_BUFFER,
+        camera_block_binding,
+        m_camera_ubo
+    ));
+    GL_CHECK(glBindBufferBase(
+        GL_UNIFORM_BUFFER,
+        light_block_binding,
+        m_light_ubo
+    ));
+}
+
+void GLUniformBuffers::clean_up() {
+    if (m_camera_ubo != 0) {
+        GL_CHECK(glDeleteBuffers(1, &m_camera_ubo));
+        GL_CHECK(glDeleteBuffers(1, &m_light_ubo));
+        m_model_stream.clean_up();
+
+        m_camera_ubo = 0;
+        m_light_ubo = 0;
+    }
+}
+
+void GLUniformBuffers::update_frame_data(
+    CameraRenderData const & camera_data,
+    LightRenderData const & light_data,
+    LightClusters const & light_clusters
+) {
+    GLCameraBlock camera;
+    camera.view_matrix = camera_data.view_matrix;
+    camera.projection_matrix = camera_data.projection_matrix;
+    camera.view_projection_matrix =
+        camera_data.projection_matrix * camera_data.view_matrix;
+    camera.inv_view_projection_matrix =
+        glm::inverse(camera.view_projection_matrix);
+    camera.view_position = camera_data.view_position;
+    camera.near_plane = camera_data.near_plane;
+    camera.view_direction = camera_data.view_direction;
+    camera.far_plane = camera_data.far_plane;
+    /* inverse of an orthonormal rotation is its transpose */
+    store_mat3(
+        glm::transpose(glm::mat3{camera_data.view_matrix}),
+        camera.inv_view_rotation
+    );
+
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, m_camera_ubo));
+    GL_CHECK(glBufferData(
+        GL_UNIFORM_BUFFER,
+        sizeof(camera),
+        &camera,
+        GL_DYNAMIC_DRAW
+    ));
+
+    /* large enough that it should not live on the stack */
+    static GLLightBlock lights;
+    size_t n_point_lights = std::min(
+        light_data.point_lights.size(),
+        LightRenderData::MAX_NUMBER_OF_POINT_LIGHTS
+    );
+    for (size_t i = 0; i < n_point_lights; ++i) {
+        PointLightRenderData const & pl = light_data.point_lights[i];
+        GLPointLightBlock & block = lights.point_lights[i];
+        block.position = pl.position;
+        block.a = pl.light.quadratic_term;
+        block.color = pl.light.color;
+        block.b = pl.light.linear_term;
+        block.c = pl.light.constant_term;
+    }
+    lights.directional_light_direction =
+        glm::normalize(light_data.directional_light.direction);
+    lights.directional_light_color = light_data.directional_light.color;
+    lights.ambient_light = light_data.ambient_light.color;
+    lights.number_of_point_lights = static_cast<int32_t>(n_point_lights);
+    lights.directional_light_on = light_data.directional_light_on ? 1u : 0u;
+    lights.cluster_dims = glm::uvec4{
+        LightClusters::DIM_X,
+        LightClusters::DIM_Y,
+        LightClusters::DIM_Z,
+        0u
+    };
+    lights.cluster_depth_params = glm::vec4{
+        light_clusters.depth_slice_scale(),
+        light_clusters.depth_slice_bias(),
+        0.0f,
+        0.0f
+    };
+
+    /* only upload the point lights that are in use */
+    size_t lights_end = offsetof(GLLightBlock, point_lights) +
+                        n_point_lights * sizeof(GLPointLightBlock);
+    size_t tail_offset = offsetof(GLLightBlock, directional_light_direction);
+
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, m_light_ubo));
+    GL_CHECK(glBufferData(
+        GL_UNIFORM_BUFFER,
+        sizeof(lights),
+        nullptr,
+        GL_DYNAMIC_DRAW
+    ));
+    if (n_point_lights > 0) {
+        GL_CHECK(glBufferSubData(
+            GL_UNIFORM_BUFFER,
+            0,
+            lights_end,
+            &lights
+        ));
+    }
+    GL_CHECK(glBufferSubData(
+        GL_UNIFORM_BUFFER,
+        tail_offset,
+        sizeof(lights) - tail_offset,
+        reinterpret_cast<unsigned char const *>(&lights) + tail_offset
+    ));
+
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+}
+
+void GLUniformBuffers::begin_model_data() {
+    m_n_model_slots = 0;
+    m_model_stream.begin_frame();
+}
+
+GLModelBlock & GLUniformBuffers::allocate_model_slot(uint32_t & slot) {
+    slot = m_n_model_slots;
+    ++m_n_model_slots;
+
+    size_t required = m_n_model_slots * m_model_stride;
+    if (m_model_staging.size() < required) {
+        m_model_staging.resize(2 * required);
+    }
+
+    return *reinterpret_cast<GLModelBlock *>(
+        m_model_staging.data() + slot * m_model_stride
+    );
+}
+
+uint32_t GLUniformBuffers::push_model_data(
+    glm::mat4 const & transform,
+    NodeData node_data,
+    glm::mat4 const & position_transform
+) {
+    assert(static_cast<uint32_t>(node_data.id) <= 0x00ffffffu ||
+           node_data.id == NO_NODE);
+
+    uint32_t slot;
+    GLModelBlock & block = allocate_model_slot(slot);
+
+    block.m_matrix = transform * position_transform;
+    store_mat3(
+        glm::inverseTranspose(glm::mat3{transform}),
+        block.inv_tpos_m_matrix
+    );
+
+    uint32_t idu32;
+    memcpy(&idu32, &node_data.id, sizeof(uint32_t));
+    block.node_data = (idu32 & 0x00ffffffu) |
+                      (node_data.selected ? 0xff000000u : 0x0u);
+
+    return slot;
+}
+
+void GLUniformBuffers::upload_model_data() {
+    if (m_n_model_slots == 0) {
+        return;
+    }
+
+    m_model_offset = m_model_stream.push(
+        m_model_staging.data(),
+        m_n_model_slots * m_model_stride,
+        m_model_alignment
+    );
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+}
+
+void GLUniformBuffers::bind_model_data(uint32_t slot) const {
+    GL_CHECK(glBindBufferRange(
+        GL_UNIFORM_BUFFER,
+        model_block_binding,
+        m_model_stream.buffer(),
+        m_model_offset + slot * m_model_stride,
+        sizeof(GLModelBlock)
+    ));
+}
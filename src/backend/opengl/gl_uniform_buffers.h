@@ -0,0 +1,124 @@
+#ifndef PRT3_GL_UNIFORM_BUFFERS_H
+#define PRT3_GL_UNIFORM_BUFFERS_H
+
+#include "src/backend/opengl/gl_stream_buffer.h"
+#include "src/backend/opengl/gl_utility.h"
+#include "src/engine/rendering/light_clusters.h"
+#include "src/engine/rendering/render_data.h"
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+/* Uniform block binding points. The block names are bound to these points
+ * by GLShader after linking, since GLSL ES 3.00 lacks layout(binding = N).
+ */
+enum GLUniformBlockBinding : GLuint {
+    camera_block_binding = 0,
+    light_block_binding = 1,
+    model_block_binding = 2
+};
+
+/* std140 mirrors of the uniform blocks declared in the shaders */
+struct GLCameraBlock {
+    glm::mat4 view_matrix;
+    glm::mat4 projection_matrix;
+    glm::mat4 view_projection_matrix;
+    glm::mat4 inv_view_projection_matrix;
+    glm::vec3 view_position;
+    float near_plane;
+    glm::vec3 view_direction;
+    float far_plane;
+    glm::vec4 inv_view_rotation[3]; // mat3, one vec4 per column
+};
+static_assert(sizeof(GLCameraBlock) == 336);
+
+struct GLPointLightBlock {
+    glm::vec3 position;
+    float a; // quadratic term
+    glm::vec3 color;
+    float b; // linear term
+    float c; // constant term
+    float padding[3];
+};
+static_assert(sizeof(GLPointLightBlock) == 48);
+
+struct GLLightBlock {
+    std::array<GLPointLightBlock, LightRenderData::MAX_NUMBER_OF_POINT_LIGHTS>
+        point_lights;
+    glm::vec3 directional_light_direction;
+    float padding0;
+    glm::vec3 directional_light_color;
+    float padding1;
+    glm::vec3 ambient_light;
+    int32_t number_of_point_lights;
+    uint32_t directional_light_on;
+    uint32_t padding2[3];
+    glm::uvec4 cluster_dims; // x, y, z, unused
+    glm::vec4 cluster_depth_params; // slice scale, slice bias, unused
+};
+static_assert(sizeof(GLLightBlock) ==
+    LightRenderData::MAX_NUMBER_OF_POINT_LIGHTS * 48 + 96);
+
+struct GLModelBlock {
+    glm::mat4 m_matrix;
+    glm::mat4 inv_m_matrix;
+    glm::vec4 inv_tpos_m_matrix[3]; // mat3, one vec4 per column
+    uint32_t node_data;
+    uint32_t padding[3];
+};
+static_assert(sizeof(GLModelBlock) == 192);
+
+/* Owns the uniform buffers shared by all shaders. Camera and light data is
+ * uploaded once per frame. Model data is written into a CPU side staging
+ * array, uploaded into a stream buffer in a single call, and bound per draw
+ * with glBindBufferRange.
+ */
+class GLUniformBuffers {
+public:
+    void init();
+    void clean_up();
+
+    void update_frame_data(
+        CameraRenderData const & camera_data,
+        LightRenderData const & light_data,
+        LightClusters const & light_clusters
+    );
+
+    /* Model slots are valid until the next call to begin_model_data() */
+    void begin_model_data();
+    /* position_transform is applied to vertex positions before the
+     * transform, but not to normals
+     */
+    uint32_t push_model_data(
+        glm::mat4 const & transform,
+        NodeData node_data,
+        glm::mat4 const & position_transform = glm::mat4{1.0f}
+    );
+    void upload_model_data();
+
+    void bind_model_data(uint32_t slot) const;
+
+private:
+    GLuint m_camera_ubo = 0;
+    GLuint m_light_ubo = 0;
+
+    GLStreamBuffer m_model_stream;
+    size_t m_model_offset = 0;
+
+    size_t m_model_alignment = 1;
+    size_t m_model_stride = sizeof(GLModelBlock);
+    std::vector<unsigned char> m_model_staging;
+    uint32_t m_n_model_slots = 0;
+
+    GLModelBlock & allocate_model_slot(uint32_t & slot);
+};
+
+} // namespace prt3
+
+#endif
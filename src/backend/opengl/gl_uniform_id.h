@@ -0,0 +1,88 @@
+#ifndef PRT3_GL_UNIFORM_ID_H
+#define PRT3_GL_UNIFORM_ID_H
+
+#include <cstdint>
+
+namespace prt3 {
+
+typedef uint32_t GLUniformIDType;
+
+/* Uniforms that are known at compile time. GLShader resolves the location
+ * of each of these when it is created, so that binding them per draw is an
+ * array lookup. Uniforms that are not listed here, such as source buffers of
+ * postprocessing passes, are looked up by name instead.
+ */
+enum GLUniformID : GLUniformIDType {
+    /* materials */
+    uniform_id_albedo_map,
+    uniform_id_normal_map,
+    uniform_id_metallic_map,
+    uniform_id_roughness_map,
+    uniform_id_albedo,
+    uniform_id_metallic,
+    uniform_id_roughness,
+    /* lighting */
+    uniform_id_cluster_grid,
+    uniform_id_cluster_light_indices,
+    /* animation */
+    uniform_id_bone_palettes,
+    uniform_id_bone_offset,
+    /* misc forward passes */
+    uniform_id_color,
+    uniform_id_texture,
+    uniform_id_depth_map,
+    uniform_id_decal_map,
+    uniform_id_buffer_width,
+    uniform_id_buffer_height,
+    uniform_id_accumulate,
+    uniform_id_accumulate_alpha,
+    /* postprocessing */
+    uniform_id_previous_color_buffer,
+    uniform_id_view_position,
+    uniform_id_view_direction,
+    uniform_id_inv_v_matrix,
+    uniform_id_inv_p_matrix,
+    uniform_id_near_plane,
+    uniform_id_far_plane,
+    uniform_id_pixel_unit_x,
+    uniform_id_pixel_unit_y,
+    uniform_id_frame,
+    uniform_id_total_num
+};
+
+/* Uniform names in GLSL, indexed by GLUniformID */
+constexpr char const * gl_uniform_names[uniform_id_total_num] = {
+    "u_AlbedoMap",
+    "u_NormalMap",
+    "u_MetallicMap",
+    "u_RoughnessMap",
+    "u_Albedo",
+    "u_Metallic",
+    "u_Roughness",
+    "u_ClusterGrid",
+    "u_ClusterLightIndices",
+    "u_BonePalettes",
+    "u_BoneOffset",
+    "u_Color",
+    "u_Texture",
+    "u_DepthMap",
+    "u_DecalMap",
+    "u_BufferWidth",
+    "u_BufferHeight",
+    "uAccumulate",
+    "uAccumulateAlpha",
+    "u_PreviousColorBuffer",
+    "u_ViewPosition",
+    "u_ViewDirection",
+    "u_InvVMatrix",
+    "u_InvPMatrix",
+    "u_NearPlane",
+    "u_FarPlane",
+    "u_PixelUnitX",
+    "u_PixelUnitY",
+    "u_Frame",
+};
+
+} // namespace prt3
+
+#endif
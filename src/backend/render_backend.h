@@ -17,6 +17,12 @@
 
 namespace prt3 {
 
+struct RenderStats {
+    /* GL state changes that were issued or skipped as redundant */
+    uint32_t state_changes_issued = 0;
+    uint32_t state_changes_elided = 0;
+};
+
 class RenderBackend {
 public:
     virtual ~RenderBackend() {};
@@ -57,7 +63,14 @@ public:
         PostProcessingChain const & editor_chain
     ) = 0;
 
-    virtual NodeID get_selected(int x, int y) = 0;
+    /* Starts reading back the node under window position (x, y) of the
+     * last rendered frame. The result is returned by poll_selection() once
+     * it is available, usually a frame later. Returns false if the backend
+     * does not support picking.
+     */
+    virtual bool request_selection(int x, int y) = 0;
+    /* returns true and sets id when a requested selection has completed */
+    virtual bool poll_selection(NodeID & id) = 0;
 
     virtual ResourceID upload_material(Material const & material) = 0;
     virtual void free_material(ResourceID id) = 0;
@@ -66,6 +79,8 @@ public:
     virtual Material & get_material(ResourceID id) = 0;
 
     virtual ResourceID upload_texture(TextureData const & data) = 0;
+    /* replaces the image of an uploaded texture, keeping its id */
+    virtual void update_texture(ResourceID id, TextureData const & data) = 0;
     virtual void free_texture(ResourceID id) = 0;
     virtual void get_texture_metadata(
         ResourceID id,
@@ -76,6 +91,12 @@ public:
 
     virtual void * get_internal_texture_id(ResourceID id) const = 0;
 
+    /* the compressed formats that textures may be uploaded in */
+    virtual TextureFormatSupport texture_format_support() const = 0;
+
+    /* statistics of the most recently rendered frame */
+    virtual RenderStats render_stats() const = 0;
+
 private:
 };
 
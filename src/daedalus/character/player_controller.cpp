@@ -27,8 +27,10 @@ void PlayerController::on_init(prt3::Scene & scene) {
     m_blob_shadow_id = scene.add_node_to_root("");
     scene.add_component<prt3::Decal>(m_blob_shadow_id);
     prt3::Decal & decal = scene.get_component<prt3::Decal>(m_blob_shadow_id);
-    decal.texture_id() =
-        scene.upload_texture("assets/textures/decals/blob_shadow.png");
+    decal.texture_id() = scene.upload_texture(
+        "assets/textures/decals/blob_shadow.png",
+        prt3::TexturePacking::atlas
+    );
     decal.dimensions() = glm::vec3{2.0f, 1.0f, 2.0f};
 }
 
@@ -1,7 +1,9 @@
 #include "game_gui.h"
 
 #include "src/daedalus/game_state/game_state.h"
+#include "src/util/mem.h"
 #include "src/util/serialization_util.h"
+#include "src/util/virtual_file_system.h"
 
 using namespace dds;
 
@@ -9,12 +11,19 @@ using namespace dds;
 #define FONT_ATLAS_META_DATA_PATH "assets/gui/atlas.fpmd" // hard-coded for now
 
 GameGui::GameGui(prt3::Scene & scene) {
-    std::ifstream in{FONT_ATLAS_META_DATA_PATH, std::ios::binary};
-    if(in.fail()){
+    std::vector<char> data;
+    if (!prt3::VirtualFileSystem::instance().read_file(
+            FONT_ATLAS_META_DATA_PATH,
+            data)) {
         return;
     }
+    imemstream in(data.data(), data.size());
 
-    m_atlas.texture = scene.upload_persistent_texture(FONT_ATLAS_PATH);
+    /* drawn by canvas rects, alongside other packed gui textures */
+    m_atlas.texture = scene.upload_persistent_texture(
+        FONT_ATLAS_PATH,
+        prt3::TexturePacking::atlas
+    );
     unsigned width, height, channels;
     scene.get_texture_metadata(m_atlas.texture, width, height, channels);
     glm::vec2 tex_dim{width, height};
@@ -6,18 +6,22 @@
 #include "src/engine/scene/scene.h"
 #include "src/engine/component/collider_component.h"
 #include "src/engine/component/door.h"
+#include "src/engine/component/static_geometry.h"
 #include "src/engine/core/backend_type.h"
 #include "src/engine/core/context.h"
 #include "src/util/file_util.h"
 #include "src/util/geometry_util.h"
 #include "src/util/log.h"
+#include "src/util/mem.h"
 #include "src/util/serialization_util.h"
 #include "src/util/sub_vec.h"
+#include "src/util/virtual_file_system.h"
 
 #include <cinttypes>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <queue>
 #include <string>
 #include <unordered_map>
@@ -27,10 +31,11 @@
 using namespace dds;
 
 Map::Map(char const * path) {
-    std::ifstream in{path, std::ios::binary};
-    if(in.fail()){
+    std::vector<char> data;
+    if (!prt3::VirtualFileSystem::instance().read_file(path, data)) {
         return;
     }
+    imemstream in(data.data(), data.size());
     deserialize(in);
 }
 
@@ -548,6 +553,12 @@ Map Map::parse_map_from_model(char const * path) {
         int32_t parent;
     };
 
+    /* scenes are finished after the models of all rooms have been saved
+     * and loaded back, which is done concurrently
+     */
+    std::vector<std::unique_ptr<prt3::Scene> > room_scenes;
+    std::vector<uint32_t> scene_room_indices;
+
     std::vector<QueueNode> node_queue;
     for (auto const & pair : ctx.num_to_room_node) {
         uint32_t room_index = ctx.num_to_room_index.at(pair.first);
@@ -556,7 +567,9 @@ Map Map::parse_map_from_model(char const * path) {
 
         ctx.model_node_to_scene_node.clear();
 
-        prt3::Scene scene{prt3_context};
+        room_scenes.push_back(std::make_unique<prt3::Scene>(prt3_context));
+        scene_room_indices.push_back(room_index);
+        prt3::Scene & scene = *room_scenes.back();
         // TODO: Implement a scene name instead since root node name can be
         //       overwritten.
         scene.get_node_name(scene.get_root_id()) =
@@ -673,19 +686,53 @@ Map Map::parse_map_from_model(char const * path) {
             /* Mesh exists */
             copy_mesh(ctx, node.mesh_index, model, node_index, material_map);
         }
+    }
+
+    auto room_model_path = [](uint32_t room_index) {
+        return std::string{"assets/models/map/room"} +
+               std::to_string(room_index) +
+               DOT_PRT3_MODEL_EXT;
+    };
+    auto object_model_path = [](uint32_t room_index) {
+        return std::string{"assets/models/map/objects"} +
+               std::to_string(room_index) +
+               DOT_PRT3_MODEL_EXT;
+    };
+
+    /* save models */
+    prt3_context.thread_pool().parallel_for(
+        ctx.models.size(),
+        [&](size_t room_index) {
+            uint32_t index = static_cast<uint32_t>(room_index);
+            prt3::Model & model = ctx.models[room_index];
+            model.save_prt3model(room_model_path(index).c_str());
+            model.set_path(room_model_path(index));
+
+            prt3::Model & obj_model = ctx.object_models[room_index];
+            if (!obj_model.meshes().empty()) {
+                obj_model.save_prt3model(object_model_path(index).c_str());
+                obj_model.set_path(object_model_path(index));
+            }
+        }
+    );
 
-        /* save model */
-        std::string room_model_path;
-        room_model_path = std::string{"assets/models/map/room"} +
-                          std::to_string(room_index) +
-                          DOT_PRT3_MODEL_EXT;
+    std::vector<std::string> model_paths;
+    for (uint32_t room_index = 0; room_index < ctx.models.size(); ++room_index) {
+        model_paths.push_back(room_model_path(room_index));
+        if (!ctx.object_models[room_index].meshes().empty()) {
+            model_paths.push_back(object_model_path(room_index));
+        }
+    }
+    prt3_context.model_manager().upload_models(model_paths);
 
-        model.save_prt3model(room_model_path.c_str());
-        model.set_path(room_model_path);
+    for (size_t scene_index = 0; scene_index < room_scenes.size(); ++scene_index) {
+        prt3::Scene & scene = *room_scenes[scene_index];
+        uint32_t room_index = scene_room_indices[scene_index];
 
         prt3::NodeID room_id = scene.add_node_to_root("room");
-        prt3::ModelHandle handle = scene.upload_model(room_model_path);
+        prt3::ModelHandle handle = scene.upload_model(room_model_path(room_index));
         scene.add_component<prt3::ModelComponent>(room_id, handle);
+        scene.add_component<prt3::StaticGeometry>(room_id);
 
         /* collider */
         scene.add_component<prt3::ColliderComponent>(
@@ -694,17 +741,10 @@ Map Map::parse_map_from_model(char const * path) {
             handle
         );
 
-        /* save object model */
         prt3::Model & obj_model = ctx.object_models[room_index];
         if (!obj_model.meshes().empty()) {
-            std::string obj_model_path;
-            obj_model_path = std::string{"assets/models/map/objects"} +
-                             std::to_string(room_index) +
-                             DOT_PRT3_MODEL_EXT;
-
-            obj_model.save_prt3model(obj_model_path.c_str());
-            obj_model.set_path(obj_model_path);
-            prt3::ModelHandle handle = scene.upload_model(obj_model_path);
+            prt3::ModelHandle handle =
+                scene.upload_model(object_model_path(room_index));
 
             for (auto pair : ctx.object_meshes.at(room_index)) {
                 prt3::NodeID node_id = pair.first;
@@ -717,6 +757,7 @@ Map Map::parse_map_from_model(char const * path) {
 
                 scene.add_component<prt3::Mesh>(node_id, mesh_id);
                 scene.add_component<prt3::MaterialComponent>(node_id, mat_id);
+                scene.add_component<prt3::StaticGeometry>(node_id);
             }
         }
 
@@ -804,7 +845,7 @@ void Map::serialize(std::ofstream & out) {
     }
 }
 
-void Map::deserialize(std::ifstream & in) {
+void Map::deserialize(std::istream & in) {
     size_t n_rooms;
     prt3::read_stream(in, n_rooms);
     m_rooms.resize(n_rooms);
@@ -46,7 +46,7 @@ public:
     static Map parse_map_from_model(char const * path);
 
     void serialize(std::ofstream & out);
-    void deserialize(std::ifstream & in);
+    void deserialize(std::istream & in);
 
     bool has_map_path(MapPathID id) const
     { return m_map_path_cache.has_key(id); }
@@ -52,6 +52,10 @@ struct Animation {
 private:
     std::vector<glm::mat4> transforms;
     std::vector<Transform> local_transforms;
+    /* set whenever transforms are written, cleared once the scene has
+     * collected the pose for rendering
+     */
+    bool pose_changed = true;
 
     friend class AnimationSystem;
     friend class Armature;
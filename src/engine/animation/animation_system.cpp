@@ -55,6 +55,7 @@ void AnimationSystem::init_animation(
         .resize(model.bones().size(), glm::mat4{1.0f});
     m_animations[id].local_transforms
         .resize(model.bones().size(), {});
+    m_animations[id].pose_changed = true;
 }
 
 void AnimationSystem::update_transforms(
@@ -102,6 +103,7 @@ void AnimationSystem::update_transforms(
             animation.local_transforms.data()
         );
     }
+    animation.pose_changed = true;
 }
 
 void AnimationSystem::update(Scene const & scene, float delta_time) {
@@ -147,6 +149,7 @@ void AnimationSystem::update(Scene const & scene, float delta_time) {
                 animation.local_transforms.data()
             );
         }
+        animation.pose_changed = true;
     }
 
     for (Animation & animation : m_animations) {
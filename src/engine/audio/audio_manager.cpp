@@ -1,6 +1,7 @@
 #include "audio_manager.h"
 
 #include "src/util/log.h"
+#include "src/util/virtual_file_system.h"
 
 #include "src/engine/audio/audio_mem_util.h"
 
@@ -272,8 +273,8 @@ AudioID AudioManager::load_audio(char const * path) {
         return it->second;
     }
 
-    FILE * fp = fopen(path, "rb");
-    if(!fp) {
+    std::vector<char> data;
+    if (!VirtualFileSystem::instance().read_file(path, data)) {
         PRT3ERROR("Failed to open Ogg file '%s'.", path);
         return NO_AUDIO;
     }
@@ -287,16 +288,8 @@ AudioID AudioManager::load_audio(char const * path) {
         m_audio_clips.push_back({});
     }
 
-    fseek(fp, 0l, SEEK_END);
-    size_t n_bytes = ftell(fp);
-    fseek(fp, 0l, SEEK_SET);
-
     AudioClip & clip = m_audio_clips[id];
-    clip.data.resize(n_bytes);
-
-    fread(clip.data.data(), 1, n_bytes, fp);
-
-    fclose(fp);
+    clip.data = std::move(data);
 
     m_audio_to_path[id] = path;
     m_path_to_audio[path] = id;
@@ -595,7 +588,10 @@ MidiID AudioManager::load_midi(char const * path) {
         m_midis.push_back({});
     }
 
-    m_midis[id] = tml_load_filename(path);
+    std::vector<char> data;
+    m_midis[id] = VirtualFileSystem::instance().read_file(path, data) ?
+        tml_load_memory(data.data(), static_cast<int>(data.size())) :
+        nullptr;
     if (!m_midis[id])
     {
         PRT3ERROR("Could not load MIDI file: %s\n", path);
@@ -630,7 +626,10 @@ SoundFontID AudioManager::load_sound_font(char const * path) {
         m_sound_fonts.push_back({});
     }
 
-    m_sound_fonts[id] = tsf_load_filename(path);
+    std::vector<char> data;
+    m_sound_fonts[id] = VirtualFileSystem::instance().read_file(path, data) ?
+        tsf_load_memory(data.data(), static_cast<int>(data.size())) :
+        nullptr;
     if (!m_sound_fonts[id])
     {
         PRT3ERROR("Could not load sound font: %s\n", path);
@@ -20,6 +20,111 @@ void Canvas::serialize(
     write_stream(out, m_layer);
 }
 
+static uint64_t hash_bytes(uint64_t hash, void const * data, size_t size) {
+    /* FNV-1a */
+    unsigned char const * bytes = static_cast<unsigned char const *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+template<typename T>
+static uint64_t hash_value(uint64_t hash, T const & value) {
+    return hash_bytes(hash, &value, sizeof(value));
+}
+
+static uint64_t hash_text(CanvasText const & text) {
+    uint64_t hash = hash_bytes(14695981039346656037ull, text.text, text.length);
+
+    /* word wrapping looks past the end of the text */
+    size_t end = text.length;
+    if (text.length > 0) {
+        while (text.text[end] &&
+               text.text[end] != ' ' &&
+               text.text[end] != '\n') {
+            ++end;
+        }
+    }
+    return hash_bytes(hash, text.text + text.length, end - text.length);
+}
+
+static uint64_t hash_node(
+    uint64_t hash,
+    CanvasNode const & n,
+    int32_t relative_parent,
+    uint64_t text_hash
+) {
+    /* fields are hashed one by one since the node may contain
+     * uninitialized padding
+     */
+    hash = hash_value(hash, relative_parent);
+    hash = hash_value(hash, n.dimension);
+    hash = hash_value(hash, n.dimension_mode);
+    hash = hash_value(hash, n.position);
+    hash = hash_value(hash, n.origin);
+    hash = hash_value(hash, n.position_mode);
+    hash = hash_value(hash, n.origin_mode);
+    hash = hash_value(hash, n.parent_anchor);
+    hash = hash_value(hash, n.center_point);
+    hash = hash_value(hash, n.color);
+    hash = hash_value(hash, n.inherit_color);
+    hash = hash_value(hash, n.texture);
+    hash = hash_value(hash, n.mode);
+    hash = hash_value(hash, n.layer);
+
+    switch (n.mode) {
+        case CanvasNode::Mode::rect: {
+            hash = hash_value(hash, n.u.rect);
+            break;
+        }
+        case CanvasNode::Mode::text: {
+            /* font metrics are assumed to stay the same for as long as the
+             * char info is alive
+             */
+            hash = hash_value(hash, n.u.text.char_info);
+            hash = hash_value(hash, n.u.text.font_size);
+            hash = hash_value(hash, n.u.text.length);
+            hash = hash_value(hash, text_hash);
+            break;
+        }
+        case CanvasNode::Mode::invisible: {
+            break;
+        }
+    }
+
+    return hash;
+}
+
+void Canvas::begin_node(CanvasNode const & node, CanvasSubtreeID id) {
+    if (m_current_parent == -1) {
+        Subtree subtree;
+        /* explicit ids and root indices use separate key ranges */
+        subtree.key = id == NO_CANVAS_SUBTREE ?
+            static_cast<uint64_t>(m_subtrees.size()) :
+            (uint64_t{1} << 32) | id;
+        subtree.hash = 14695981039346656037ull;
+        subtree.begin = static_cast<uint32_t>(m_node_stack.size());
+        m_subtrees.push_back(subtree);
+    }
+
+    Subtree & subtree = m_subtrees.back();
+
+    CanvasStackNode n;
+    n.n = node;
+    n.parent = m_current_parent;
+    n.text_hash = node.mode == CanvasNode::Mode::text ?
+        hash_text(node.u.text) : 0;
+
+    int32_t relative_parent = n.parent == -1 ?
+        -1 : n.parent - static_cast<int32_t>(subtree.begin);
+    subtree.hash = hash_node(subtree.hash, node, relative_parent, n.text_hash);
+
+    m_current_parent = m_node_stack.size();
+    m_node_stack.push_back(n);
+    subtree.end = static_cast<uint32_t>(m_node_stack.size());
+}
+
 
 glm::vec2 get_anchor_factor(CanvasNode::AnchorPoint anchor_point) {
     switch (anchor_point) {
@@ -82,11 +187,13 @@ static float get_curr_word_width(
     return width;
 }
 
+/* The alignment offsets below were originally applied in view space, where a
+ * pixel spans 2 / screen size units, so they are halved to give pixels.
+ */
 static void align_text_x(
-    RenderRect2D * rects,
+    CanvasGlyph * glyphs,
     uint32_t row_start,
     uint32_t row_end,
-    float screen_width,
     float parent_width,
     float row_width,
     prt3::CanvasNode::AnchorPoint alignment
@@ -96,35 +203,33 @@ static void align_text_x(
         case prt3::CanvasNode::AnchorPoint::top_left:
         case prt3::CanvasNode::AnchorPoint::mid_left:
         case prt3::CanvasNode::AnchorPoint::bottom_left: {
-            adjustment = -parent_width / screen_width;
+            adjustment = -parent_width;
             break;
         }
         case prt3::CanvasNode::AnchorPoint::top:
         case prt3::CanvasNode::AnchorPoint::mid:
         case prt3::CanvasNode::AnchorPoint::bottom: {
-            adjustment = (parent_width - row_width) / screen_width;
+            adjustment = parent_width - row_width;
             break;
         }
         case prt3::CanvasNode::AnchorPoint::top_right:
         case prt3::CanvasNode::AnchorPoint::mid_right:
         case prt3::CanvasNode::AnchorPoint::bottom_right: {
-            adjustment = (parent_width + 2.0f * (parent_width - row_width)) /
-                         screen_width;
+            adjustment = parent_width + 2.0f * (parent_width - row_width);
             break;
         }
     }
+    adjustment *= 0.5f;
 
     for (uint32_t i = row_start; i < row_end; ++i) {
-        RenderRect2D & rect = rects[i];
-        rect.position.x += adjustment;
+        glyphs[i].position.x += adjustment;
     }
 }
 
 static void align_text_y(
-    RenderRect2D * rects,
+    CanvasGlyph * glyphs,
     uint32_t text_start,
     uint32_t text_end,
-    float screen_height,
     float parent_height,
     float text_height,
     float font_size,
@@ -135,36 +240,246 @@ static void align_text_y(
         case prt3::CanvasNode::AnchorPoint::top_left:
         case prt3::CanvasNode::AnchorPoint::top:
         case prt3::CanvasNode::AnchorPoint::top_right: {
-            adjustment = -parent_height / screen_height;
+            adjustment = -parent_height;
             break;
         }
         case prt3::CanvasNode::AnchorPoint::mid_left:
         case prt3::CanvasNode::AnchorPoint::mid:
         case prt3::CanvasNode::AnchorPoint::mid_right: {
-            adjustment = -(parent_height - text_height - 1.5f * font_size) /
-                           screen_height;
+            adjustment = -(parent_height - text_height - 1.5f * font_size);
             break;
         }
         case prt3::CanvasNode::AnchorPoint::bottom_left:
         case prt3::CanvasNode::AnchorPoint::bottom:
         case prt3::CanvasNode::AnchorPoint::bottom_right: {
-            adjustment = (parent_height -
-                         2.0f * (parent_height - text_height - font_size)) /
-                         screen_height;
+            adjustment = parent_height -
+                         2.0f * (parent_height - text_height - font_size);
             break;
         }
     }
+    adjustment *= 0.5f;
 
     for (uint32_t i = text_start; i < text_end; ++i) {
-        RenderRect2D & rect = rects[i];
-        rect.position.y += adjustment;
+        glyphs[i].position.y += adjustment;
     }
 }
 
+static void layout_text(
+    CanvasText const & text,
+    glm::vec2 dimension,
+    CanvasNode::AnchorPoint alignment,
+    std::vector<CanvasGlyph> & glyphs
+) {
+    float font_size = static_cast<float>(text.font_size);
+
+    glm::vec2 curr_pos = glm::vec2{0.0f, dimension.y - font_size};
+    float start_y = curr_pos.y;
+
+    float row_width = 0.0f;
+    uint32_t row_start = 0;
+
+    glyphs.resize(text.length);
+
+    for (uint32_t i = 0; i < text.length; ++i) {
+        unsigned char c =
+            *reinterpret_cast<unsigned const char *>(&text.text[i]);
+
+        FontChar const & fc = text.char_info[c];
+        glm::vec2 o = fc.uv_origin;
+        glm::vec2 dim = fc.uv_dimension;
+
+        float lb = font_size * fc.left_bearing;
+        float advance = font_size * fc.advance;
+
+        glm::vec2 glyph_dim =
+            fc.norm_scale *
+            glm::vec2{font_size * fc.ratio, font_size};
+
+        bool first_char_in_word =
+            !is_whitespace(c) &&
+            (i == 0 || is_whitespace(text.text[i-1]));
+
+        if (first_char_in_word) {
+            float curr_word_width = get_curr_word_width(text, i);
+            if (row_width + curr_word_width > dimension.x) {
+                /* reposition previous row */
+                align_text_x(
+                    glyphs.data(),
+                    row_start,
+                    i,
+                    dimension.x,
+                    row_width,
+                    alignment
+                );
+
+                curr_pos.x = 0.0f;
+                curr_pos.y -= font_size;
+                row_start = i;
+                row_width = 0.0f;
+            }
+        }
+
+        glm::vec2 offset = font_size * fc.offset;
+        glm::vec2 glyph_pos = curr_pos + offset;
+        glyph_pos.x += lb;
+        glyph_pos.y -= glyph_dim.y;
+
+        CanvasGlyph & glyph = glyphs[i];
+        glyph.position = glyph_pos;
+        glyph.dimension = glyph_dim;
+        glyph.uv0 = o + glm::vec2{ 0.0f, dim.y };
+        glyph.uv1 = o + glm::vec2{ dim.x, dim.y };
+        glyph.uv2 = o + glm::vec2{ dim.x, 0.0f };
+        glyph.uv3 = o;
+
+        curr_pos.x += advance;
+        row_width += advance;
+    }
+
+    /* align last row */
+    align_text_x(
+        glyphs.data(),
+        row_start,
+        text.length,
+        dimension.x,
+        row_width,
+        alignment
+    );
+
+    float text_height = start_y - curr_pos.y;
+    align_text_y(
+        glyphs.data(),
+        0,
+        text.length,
+        dimension.y,
+        text_height,
+        font_size,
+        alignment
+    );
+}
+
+Canvas::TextLayout const & Canvas::get_text_layout(
+    CanvasStackNode const & sn,
+    glm::vec2 dimension
+) {
+    CanvasText const & text = sn.n.u.text;
+    CanvasNode::AnchorPoint alignment = sn.n.center_point;
+
+    uint64_t key = sn.text_hash;
+    key = hash_value(key, text.char_info);
+    key = hash_value(key, text.font_size);
+    key = hash_value(key, text.length);
+    key = hash_value(key, dimension);
+    key = hash_value(key, alignment);
+
+    TextLayout & layout = m_text_layouts[key];
+    layout.last_used = m_frame;
+
+    if (layout.char_info == text.char_info &&
+        layout.font_size == text.font_size &&
+        layout.length == text.length &&
+        layout.dimension == dimension &&
+        layout.alignment == alignment &&
+        layout.glyphs.size() == text.length) {
+        return layout;
+    }
+
+    layout.char_info = text.char_info;
+    layout.font_size = text.font_size;
+    layout.length = text.length;
+    layout.dimension = dimension;
+    layout.alignment = alignment;
+    layout_text(text, dimension, alignment, layout.glyphs);
+
+    return layout;
+}
+
 void Canvas::collect_render_data(
     Scene const & scene,
+    std::vector<RenderRect2D> & data,
+    std::vector<RenderRect2DRange> & ranges
+) {
+    unsigned int w, h;
+    scene.get_window_size(w, h);
+
+    /* state that affects the layout of every subtree */
+    uint64_t canvas_hash = 14695981039346656037ull;
+    canvas_hash = hash_value(canvas_hash, w);
+    canvas_hash = hash_value(canvas_hash, h);
+    canvas_hash = hash_value(canvas_hash, m_layer);
+
+    TextureManager const & textures = scene.texture_manager();
+    for (Subtree const & subtree : m_subtrees) {
+        uint64_t hash = hash_value(subtree.hash, canvas_hash);
+        /* packed textures are drawn from their page once it has been
+         * uploaded, which only changes the subtrees that use them
+         */
+        for (uint32_t i = subtree.begin; i < subtree.end; ++i) {
+            glm::vec4 uv_transform;
+            ResourceID texture = textures.resolve_texture(
+                m_node_stack[i].n.texture,
+                uv_transform
+            );
+            hash = hash_value(hash, texture);
+            hash = hash_value(hash, uv_transform);
+        }
+
+        auto it = m_cache.find(subtree.key);
+        if (it == m_cache.end()) {
+            it = m_cache.emplace(subtree.key, CachedSubtree{}).first;
+            it->second.hash = ~hash;
+        }
+
+        CachedSubtree & cached = it->second;
+        if (cached.hash != hash) {
+            cached.rects.clear();
+            layout_subtree(
+                subtree,
+                w,
+                h,
+                textures,
+                cached.rects
+            );
+            cached.hash = hash;
+        }
+        cached.used = true;
+
+        RenderRect2DRange range;
+        range.hash = hash;
+        range.start = static_cast<uint32_t>(data.size());
+        range.count = static_cast<uint32_t>(cached.rects.size());
+        ranges.push_back(range);
+
+        data.insert(data.end(), cached.rects.begin(), cached.rects.end());
+    }
+
+    ++m_frame;
+    for (auto it = m_text_layouts.begin(); it != m_text_layouts.end();) {
+        if (m_frame - it->second.last_used > TEXT_LAYOUT_LIFETIME) {
+            it = m_text_layouts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    /* evict subtrees that were not pushed this frame */
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        if (!it->second.used) {
+            it = m_cache.erase(it);
+        } else {
+            it->second.used = false;
+            ++it;
+        }
+    }
+}
+
+void Canvas::layout_subtree(
+    Subtree const & subtree,
+    unsigned int w,
+    unsigned int h,
+    TextureManager const & textures,
     std::vector<RenderRect2D> & data
-) const {
+) {
     struct StackInfo {
         glm::vec4 color;
         int32_t layer;
@@ -172,27 +487,22 @@ void Canvas::collect_render_data(
         glm::vec2 position;
     };
 
-    thread_local std::vector<StackInfo> stack_info;
-    stack_info.resize(1);
-    stack_info[0].color = glm::vec4{1.0f, 1.0f, 1.0f, 1.0f};
-    stack_info[0].layer = 0;
+    StackInfo root_info;
+    root_info.color = glm::vec4{1.0f, 1.0f, 1.0f, 1.0f};
+    root_info.layer = 0;
+    root_info.dimension = glm::vec2{w, h};
+    root_info.position = glm::vec2{0.0f};
 
-    unsigned int w, h;
-    scene.get_window_size(w, h);
-    stack_info[0].dimension = glm::vec2{w, h};
+    /* info of each node of the subtree, looked up by its children */
+    thread_local std::vector<StackInfo> stack_info;
+    stack_info.resize(subtree.end - subtree.begin);
 
-    int32_t curr_parent = -2;
-    for (CanvasStackNode const & sn : m_node_stack) {
+    for (uint32_t index = subtree.begin; index < subtree.end; ++index) {
+        CanvasStackNode const & sn = m_node_stack[index];
         CanvasNode const & n = sn.n;
-        bool moved_up_stack = curr_parent < sn.parent;
-        curr_parent = sn.parent;
-
-        if (!moved_up_stack) {
-            stack_info.pop_back();
-        }
-
-        StackInfo const & curr_info = stack_info.back();
-        StackInfo info;
+        StackInfo const & curr_info = sn.parent == -1 ?
+            root_info : stack_info[sn.parent - subtree.begin];
+        StackInfo & info = stack_info[index - subtree.begin];
 
         /* color */
         glm::vec4 color;
@@ -254,18 +564,21 @@ void Canvas::collect_render_data(
         info.layer = layer;
         int32_t rect_layer = layer + m_layer * (UINT16_MAX + 1);
 
+        glm::vec4 uv_transform;
+        ResourceID texture = textures.resolve_texture(n.texture, uv_transform);
+
         switch (n.mode) {
             case CanvasNode::Mode::rect: {
                 RenderRect2D rect;
                 rect.color = color;
-                rect.uv0 = n.u.rect.uv0;
-                rect.uv1 = n.u.rect.uv1;
-                rect.uv2 = n.u.rect.uv2;
-                rect.uv3 = n.u.rect.uv3;
+                rect.uv0 = transform_uv(uv_transform, n.u.rect.uv0);
+                rect.uv1 = transform_uv(uv_transform, n.u.rect.uv1);
+                rect.uv2 = transform_uv(uv_transform, n.u.rect.uv2);
+                rect.uv3 = transform_uv(uv_transform, n.u.rect.uv3);
                 /* convert to view space coordinates */
                 rect.position = 2.0f * (position / glm::vec2{w, h}) - 1.0f;
                 rect.dimension = 2.0f * (dimension / glm::vec2{w, h});
-                rect.texture = n.texture;
+                rect.texture = texture;
                 rect.layer = rect_layer;
 
                 data.push_back(rect);
@@ -273,110 +586,34 @@ void Canvas::collect_render_data(
                 break;
             }
             case CanvasNode::Mode::text: {
-                CanvasText const & text = n.u.text;
-                float font_size = static_cast<float>(text.font_size);
-
-                glm::vec2 curr_pos = position;
-                curr_pos.y += dimension.y - font_size;
-                float start_y = curr_pos.y;
-
-                float row_width = 0.0f;
-                uint32_t text_rect_start = data.size();
-                uint32_t row_start = text_rect_start;
-
-                for (uint32_t i = 0; i < text.length; ++i) {
-                    unsigned char c =
-                        *reinterpret_cast<unsigned const char *>(&text.text[i]);
-
-                    FontChar const & fc = text.char_info[c];
-                    glm::vec2 o = fc.uv_origin;
-                    glm::vec2 dim = fc.uv_dimension;
-
-                    float lb = font_size * fc.left_bearing;
-                    float advance = font_size * fc.advance;
-
-                    glm::vec2 rect_dim =
-                        fc.norm_scale *
-                        glm::vec2{font_size * fc.ratio, font_size};
-
-                    bool first_char_in_word =
-                        !is_whitespace(c) &&
-                        (i == 0 || is_whitespace(text.text[i-1]));
-
-                    if (first_char_in_word) {
-                        float curr_word_width = get_curr_word_width(text, i);
-                        if (row_width + curr_word_width > dimension.x) {
-                            /* reposition previous row */
-                            align_text_x(
-                                data.data(),
-                                row_start,
-                                i,
-                                w,
-                                dimension.x,
-                                row_width,
-                                n.center_point
-                            );
-
-                            curr_pos.x = position.x;
-                            curr_pos.y -= font_size;
-                            row_start = i;
-                            row_width = 0.0f;
-                        }
-                    }
-
-                    glm::vec2 offset = font_size * fc.offset;
-                    glm::vec2 rect_pos = curr_pos + offset;
-                    rect_pos.x += lb;
-                    rect_pos.y -= rect_dim.y;
-
-                    RenderRect2D rect;
+                TextLayout const & layout = get_text_layout(sn, dimension);
+
+                /* the glyphs of a text are emitted as one contiguous run */
+                glm::vec2 inv_size = 1.0f / glm::vec2{w, h};
+                size_t run_start = data.size();
+                data.resize(run_start + layout.glyphs.size());
+
+                for (size_t i = 0; i < layout.glyphs.size(); ++i) {
+                    CanvasGlyph const & glyph = layout.glyphs[i];
+                    RenderRect2D & rect = data[run_start + i];
                     rect.color = color;
-                    rect.uv0 = o + glm::vec2{ 0.0f, dim.y };
-                    rect.uv1 = o + glm::vec2{ dim.x, dim.y };
-                    rect.uv2 = o + glm::vec2{ dim.x, 0.0f };
-                    rect.uv3 = o;
+                    rect.uv0 = transform_uv(uv_transform, glyph.uv0);
+                    rect.uv1 = transform_uv(uv_transform, glyph.uv1);
+                    rect.uv2 = transform_uv(uv_transform, glyph.uv2);
+                    rect.uv3 = transform_uv(uv_transform, glyph.uv3);
                     /* convert to view space coordinates */
-                    rect.position = 2.0f * (rect_pos / glm::vec2{w, h}) - 1.0f;
-                    rect.dimension = 2.0f * (rect_dim / glm::vec2{w, h});
-                    rect.texture = n.texture;
+                    rect.position =
+                        2.0f * ((position + glyph.position) * inv_size) - 1.0f;
+                    rect.dimension = 2.0f * (glyph.dimension * inv_size);
+                    rect.texture = texture;
                     rect.layer = rect_layer;
-
-                    data.emplace_back(rect);
-
-                    curr_pos.x += advance;
-                    row_width += advance;
                 }
 
-                /* align last row */
-                align_text_x(
-                    data.data(),
-                    row_start,
-                    data.size(),
-                    w,
-                    dimension.x,
-                    row_width,
-                    n.center_point
-                );
-
-                float text_height = start_y - curr_pos.y;
-                align_text_y(
-                    data.data(),
-                    text_rect_start,
-                    data.size(),
-                    h,
-                    dimension.y,
-                    text_height,
-                    text.font_size,
-                    n.center_point
-                );
-
                 break;
             }
             case CanvasNode::Mode::invisible: {
                 break;
             }
         }
-
-        stack_info.push_back(info);
     }
 }
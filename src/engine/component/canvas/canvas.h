@@ -6,11 +6,13 @@
 #include "src/engine/rendering/resources.h"
 #include "src/util/uuid.h"
 
+#include <unordered_map>
 #include <vector>
 
 namespace prt3 {
 
 class Scene;
+class TextureManager;
 
 template<typename T>
 class ComponentStorage;
@@ -27,6 +29,16 @@ struct FontChar {
     float norm_scale;
 };
 
+/* glyph quad in pixels, relative to the position of the text box */
+struct CanvasGlyph {
+    glm::vec2 position;
+    glm::vec2 dimension;
+    glm::vec2 uv0;
+    glm::vec2 uv1;
+    glm::vec2 uv2;
+    glm::vec2 uv3;
+};
+
 struct CanvasText {
     /* Should map to array with 256 entries if length is not 0 */
     FontChar const * char_info;
@@ -96,8 +108,12 @@ struct CanvasNode {
 struct CanvasStackNode {
     CanvasNode n;
     int32_t parent;
+    uint64_t text_hash; // hash of the characters if n is a text node
 };
 
+typedef uint32_t CanvasSubtreeID;
+constexpr CanvasSubtreeID NO_CANVAS_SUBTREE = -1;
+
 class Canvas {
 public:
     Canvas(Scene & scene, NodeID node_id);
@@ -115,21 +131,25 @@ public:
 
     inline static void collect_render_data(
         Scene const & scene,
-        std::vector<Canvas> const & components,
-        std::vector<RenderRect2D> & data
+        std::vector<Canvas> & components,
+        std::vector<RenderRect2D> & data,
+        std::vector<RenderRect2DRange> & ranges
     ) {
-        for (Canvas const & canvas : components) {
-            canvas.collect_render_data(scene, data);
+        for (Canvas & canvas : components) {
+            canvas.collect_render_data(scene, data, ranges);
         }
     }
 
-    void begin_node(CanvasNode const & node) {
-        CanvasStackNode n;
-        n.n = node;
-        n.parent = m_current_parent;
-        m_current_parent = m_node_stack.size();
-        m_node_stack.push_back(n);
-    }
+    /* Nodes pushed at the root of the canvas start a new subtree. The layout
+     * of a subtree is retained across frames and is only recomputed when
+     * the hash of its nodes changes. Subtrees are identified by id, or by
+     * their order among the root nodes if no id is given. Ids are ignored
+     * for nodes that are not at the root.
+     */
+    void begin_node(
+        CanvasNode const & node,
+        CanvasSubtreeID id = NO_CANVAS_SUBTREE
+    );
 
     void end_node() {
         m_current_parent = m_node_stack[m_current_parent].parent;
@@ -142,17 +162,68 @@ private:
     std::vector<CanvasStackNode> m_node_stack;
     int32_t m_current_parent = -1;
 
+    struct Subtree {
+        uint64_t key;
+        uint64_t hash;
+        uint32_t begin; // index of the root in m_node_stack
+        uint32_t end;
+    };
+    std::vector<Subtree> m_subtrees;
+
+    struct CachedSubtree {
+        uint64_t hash;
+        std::vector<RenderRect2D> rects;
+        bool used;
+    };
+    std::unordered_map<uint64_t, CachedSubtree> m_cache;
+
+    /* Positioned glyphs of laid out text, which do not depend on color,
+     * layer or the position of the text box. Layouts are kept for a while
+     * after their last use, since text in subtrees that are unchanged is
+     * not looked up.
+     */
+    struct TextLayout {
+        FontChar const * char_info;
+        uint32_t font_size;
+        uint32_t length;
+        glm::vec2 dimension;
+        CanvasNode::AnchorPoint alignment;
+        uint32_t last_used;
+        std::vector<CanvasGlyph> glyphs;
+    };
+    std::unordered_map<uint64_t, TextLayout> m_text_layouts;
+    static constexpr uint32_t TEXT_LAYOUT_LIFETIME = 300; // in frames
+    uint32_t m_frame = 0;
+
     int16_t m_layer;
 
     void reset_stack() {
         m_node_stack.clear();
+        m_subtrees.clear();
         m_current_parent = -1;
     }
 
     void collect_render_data(
         Scene const & scene,
+        std::vector<RenderRect2D> & data,
+        std::vector<RenderRect2DRange> & ranges
+    );
+
+    /* textures of rects are resolved with textures, so that rects whose
+     * textures are packed into the same atlas page can be drawn together
+     */
+    void layout_subtree(
+        Subtree const & subtree,
+        unsigned int w,
+        unsigned int h,
+        TextureManager const & textures,
         std::vector<RenderRect2D> & data
-    ) const;
+    );
+
+    TextLayout const & get_text_layout(
+        CanvasStackNode const & sn,
+        glm::vec2 dimension
+    );
 
     void remove(Scene & /*scene*/) {}
 
@@ -25,7 +25,8 @@ ColliderComponent::ColliderComponent(
     Scene & scene,
     NodeID node_id,
     ColliderType type,
-    ModelHandle model_handle
+    ModelHandle model_handle,
+    uint32_t lod
 )
  : m_node_id{node_id} {
     Model const & model = scene.get_model(model_handle);
@@ -34,6 +35,7 @@ ColliderComponent::ColliderComponent(
         m_node_id,
         type,
         model,
+        lod,
         scene.get_node(node_id).get_global_transform(scene)
     );
 }
@@ -42,7 +44,8 @@ ColliderComponent::ColliderComponent(
     Scene & scene,
     NodeID node_id,
     ColliderType type,
-    Model const & model
+    Model const & model,
+    uint32_t lod
 )
  : m_node_id{node_id} {
     PhysicsSystem & sys = scene.physics_system();
@@ -50,6 +53,7 @@ ColliderComponent::ColliderComponent(
         m_node_id,
         type,
         model,
+        lod,
         scene.get_node(node_id).get_global_transform(scene)
     );
 }
@@ -155,7 +159,8 @@ void ColliderComponent::set_mask(Scene & scene, CollisionLayer mask) {
 void ColliderComponent::set_collider(
     Scene & scene,
     ColliderType type,
-    ModelHandle model_handle
+    ModelHandle model_handle,
+    uint32_t lod
 ) {
     Model const & model = scene.get_model(model_handle);
     PhysicsSystem & sys = scene.physics_system();
@@ -164,6 +169,7 @@ void ColliderComponent::set_collider(
         m_node_id,
         type,
         model,
+        lod,
         scene.get_node(m_node_id).get_global_transform(scene)
     );
 }
@@ -171,7 +177,8 @@ void ColliderComponent::set_collider(
 void ColliderComponent::set_collider(
     Scene & scene,
     ColliderType type,
-    Model const & model
+    Model const & model,
+    uint32_t lod
 ) {
     PhysicsSystem & sys = scene.physics_system();
     sys.remove_collider(m_tag);
@@ -179,6 +186,7 @@ void ColliderComponent::set_collider(
         m_node_id,
         type,
         model,
+        lod,
         scene.get_node(m_node_id).get_global_transform(scene)
     );
 }
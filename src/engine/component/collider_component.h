@@ -23,13 +23,15 @@ public:
         Scene & scene,
         NodeID node_id,
         ColliderType type,
-        ModelHandle model_handle
+        ModelHandle model_handle,
+        uint32_t lod = 0
     );
     ColliderComponent(
         Scene & scene,
         NodeID node_id,
         ColliderType type,
-        Model const & model
+        Model const & model,
+        uint32_t lod = 0
     );
     ColliderComponent(
         Scene & scene,
@@ -69,8 +71,19 @@ public:
     void set_layer(Scene & scene, CollisionLayer layer);
     void set_mask(Scene & scene, CollisionLayer mask);
 
-    void set_collider(Scene & scene, ColliderType type, ModelHandle model_handle);
-    void set_collider(Scene & scene, ColliderType type, Model const & model);
+    /* lod selects a simplified level of detail of the model's meshes */
+    void set_collider(
+        Scene & scene,
+        ColliderType type,
+        ModelHandle model_handle,
+        uint32_t lod = 0
+    );
+    void set_collider(
+        Scene & scene,
+        ColliderType type,
+        Model const & model,
+        uint32_t lod = 0
+    );
     void set_collider(
         Scene & scene,
         ColliderType type,
@@ -17,6 +17,7 @@
 #include "src/engine/component/point_light.h"
 #include "src/engine/component/script_set.h"
 #include "src/engine/component/sound_source.h"
+#include "src/engine/component/static_geometry.h"
 #include "src/engine/component/weapon.h"
 #include "src/util/template_util.h"
 #include "src/util/log.h"
@@ -150,7 +151,8 @@ using ComponentTypes = type_pack<
     Weapon,
     Decal,
     Canvas,
-    ParticleSystem
+    ParticleSystem,
+    StaticGeometry
 >;
 
 using ComponentStoragesType = wrap_arg_pack_in_storage<std::tuple, ComponentTypes>::type;
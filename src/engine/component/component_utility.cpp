@@ -20,7 +20,11 @@ void prt3::serialize_texture(
     }
 }
 
-ResourceID prt3::deserialize_texture(std::istream & in, Scene & scene) {
+ResourceID prt3::deserialize_texture(
+    std::istream & in,
+    Scene & scene,
+    TexturePacking packing
+) {
     size_t n_path;
     read_stream(in, n_path);
 
@@ -30,7 +34,7 @@ ResourceID prt3::deserialize_texture(std::istream & in, Scene & scene) {
 
         in.read(path.data(), path.size());
 
-        return scene.upload_texture(path);
+        return scene.request_texture(path, packing);
     }
 
     return NO_RESOURCE;
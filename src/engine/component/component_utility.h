@@ -11,7 +11,11 @@ void serialize_texture(
     ResourceID tex_id
 );
 
-ResourceID deserialize_texture(std::istream & in, Scene & scene);
+ResourceID deserialize_texture(
+    std::istream & in,
+    Scene & scene,
+    TexturePacking packing = TexturePacking::none
+);
 
 } // namespace prt3
 
@@ -3,6 +3,8 @@
 #include "src/engine/component/component_utility.h"
 #include "src/engine/scene/scene.h"
 
+#include <algorithm>
+
 using namespace prt3;
 
 Decal::Decal(Scene & /*scene*/, NodeID node_id)
@@ -15,7 +17,7 @@ Decal::Decal(Scene & /*scene*/, NodeID node_id, ResourceID texture_id)
 
 Decal::Decal(Scene & scene, NodeID node_id, std::istream & in)
  : m_node_id{node_id} {
-    m_texture_id = deserialize_texture(in, scene);
+    m_texture_id = deserialize_texture(in, scene, TexturePacking::atlas);
     read_stream(in, m_dimensions);
     read_stream(in, m_color);
 }
@@ -30,19 +32,99 @@ void Decal::serialize(
 }
 
 
+static bool outside_frustum(glm::mat4 const & mvp) {
+    /* the decal volume is a unit cube, which is outside of the frustum if
+     * all of its corners are on the outside of one of the clip planes
+     */
+    glm::vec4 corners[8];
+    for (unsigned int i = 0; i < 8; ++i) {
+        glm::vec4 corner{
+            (i & 1) ? 0.5f : -0.5f,
+            (i & 2) ? 0.5f : -0.5f,
+            (i & 4) ? 0.5f : -0.5f,
+            1.0f
+        };
+        corners[i] = mvp * corner;
+    }
+
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+        bool all_below = true;
+        bool all_above = true;
+        for (glm::vec4 const & c : corners) {
+            all_below = all_below && c[axis] < -c.w;
+            all_above = all_above && c[axis] > c.w;
+        }
+        if (all_below || all_above) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::array<glm::vec4, 3> affine_rows(glm::mat4 const & m) {
+    glm::mat4 t = glm::transpose(m);
+    return { t[0], t[1], t[2] };
+}
+
 void Decal::collect_render_data(
     std::vector<Decal> const & components,
     std::vector<Transform> const & global_transforms,
-    std::vector<DecalRenderData> & data
+    glm::mat4 const & view_projection,
+    TextureManager const & textures,
+    DecalData & data
 ) {
+    struct VisibleDecal {
+        ResourceID texture;
+        glm::vec4 uv_transform;
+        glm::mat4 transform;
+        glm::vec4 color;
+    };
+    thread_local std::vector<VisibleDecal> visible;
+    visible.clear();
+
     for (Decal const & decal : components) {
         if (decal.texture_id() == NO_RESOURCE) continue;
         Transform tform = global_transforms[decal.node_id()];
         tform.scale *= decal.dimensions();
+        glm::mat4 transform = tform.to_matrix();
+
+        if (outside_frustum(view_projection * transform)) continue;
+
+        VisibleDecal v;
+        v.texture = textures.resolve_texture(
+            decal.texture_id(),
+            v.uv_transform
+        );
+        v.transform = transform;
+        v.color = decal.m_color;
+        visible.push_back(v);
+    }
+
+    /* Stable, so that decals sharing a texture keep their blending order.
+     * Decals whose textures are packed into the same atlas page share it.
+     */
+    std::stable_sort(visible.begin(), visible.end(),
+        [](VisibleDecal const & a, VisibleDecal const & b) {
+            return a.texture < b.texture;
+        }
+    );
+
+    for (VisibleDecal const & decal : visible) {
+        if (data.textures.empty() ||
+            data.textures.back().texture != decal.texture) {
+            DecalData::TextureRange range;
+            range.start_index = data.attributes.size();
+            range.count = 0;
+            range.texture = decal.texture;
+            data.textures.push_back(range);
+        }
+        ++data.textures.back().count;
 
-        data.push_back({});
-        data.back().transform = tform.to_matrix();
-        data.back().color = decal.m_color;
-        data.back().texture = decal.texture_id();
+        data.attributes.push_back({});
+        DecalAttributes & attributes = data.attributes.back();
+        attributes.transform = affine_rows(decal.transform);
+        attributes.inv_transform = affine_rows(glm::inverse(decal.transform));
+        attributes.color = decal.color;
+        attributes.uv_transform = decal.uv_transform;
     }
 }
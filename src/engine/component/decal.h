@@ -37,10 +37,16 @@ public:
     glm::vec4 const & color() const { return m_color; }
     glm::vec4 & color() { return m_color; }
 
+    /* Decals outside of the view frustum are culled. The remaining decals
+     * are grouped by the texture that textures resolves theirs to, so that
+     * each group can be drawn instanced.
+     */
     static void collect_render_data(
         std::vector<Decal> const & components,
         std::vector<Transform> const & global_transforms,
-        std::vector<DecalRenderData> & data
+        glm::mat4 const & view_projection,
+        TextureManager const & textures,
+        DecalData & data
     );
 
     void serialize(
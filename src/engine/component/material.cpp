@@ -22,7 +22,8 @@ MaterialComponent::MaterialComponent(
     NodeID node_id,
     std::istream & in
 )
- : m_node_id{node_id} {
+ : m_node_id{node_id},
+   m_resource_id{NO_RESOURCE} {
     ModelManager & man = scene.model_manager();
 
     size_t n_path;
@@ -38,11 +39,24 @@ MaterialComponent::MaterialComponent(
     int32_t mesh_index;
     read_stream(in, mesh_index);
 
-    auto handle = scene.upload_model(path);
-    m_resource_id = man.get_material_id_from_mesh_index(
-        handle,
-        mesh_index
-    );
+    m_streaming_model = scene.request_model(path);
+    m_streaming_mesh_index = mesh_index;
+    resolve_streamed_model(man);
+}
+
+void MaterialComponent::resolve_streamed_model(ModelManager const & man) {
+    if (m_streaming_model == NO_MODEL ||
+        man.model_is_streaming(m_streaming_model)) {
+        return;
+    }
+
+    /* a model that failed to load keeps its placeholder, without meshes */
+    ModelResource const & resource = man.get_model_resource(m_streaming_model);
+    if (static_cast<size_t>(m_streaming_mesh_index) <
+        resource.mesh_material_ids.size()) {
+        m_resource_id = resource.mesh_material_ids[m_streaming_mesh_index];
+    }
+    m_streaming_model = NO_MODEL;
 }
 
 void MaterialComponent::serialize(
@@ -52,6 +66,16 @@ void MaterialComponent::serialize(
     ModelManager const & man = scene.model_manager();
     ResourceID id = m_resource_id;
 
+    if (id == NO_RESOURCE && m_streaming_model != NO_MODEL) {
+        std::string const & path = man.get_model(m_streaming_model).path();
+
+        write_stream(out, path.size());
+        out.write(path.data(), path.size());
+
+        write_stream(out, m_streaming_mesh_index);
+        return;
+    }
+
     Model const & model = man.get_model_from_material_id(id);
 
     std::string const & path = model.path();
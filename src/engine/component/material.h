@@ -2,6 +2,7 @@
 #define PRT3_MATERIAL_COMPONENT_H
 
 #include "src/engine/scene/node.h"
+#include "src/engine/rendering/model_manager.h"
 #include "src/engine/rendering/resources.h"
 #include "src/engine/rendering/render_data.h"
 #include "src/util/uuid.h"
@@ -24,7 +25,15 @@ public:
 
     NodeID node_id() const { return m_node_id; }
     ResourceID resource_id() const { return m_resource_id; }
-    void set_resource_id(ResourceID id) { m_resource_id = id; }
+    void set_resource_id(ResourceID id)
+    { m_resource_id = id; m_streaming_model = NO_MODEL; }
+
+    /* the model that the material is taken from while it is being
+     * streamed, until then the material has no resource
+     */
+    ModelHandle streaming_model() const { return m_streaming_model; }
+    /* takes the resource of the material once its model has been uploaded */
+    void resolve_streamed_model(ModelManager const & man);
 
     MaterialOverride & material_override() { return m_material_override; }
     MaterialOverride const & material_override() const
@@ -41,6 +50,8 @@ public:
 private:
     NodeID m_node_id;
     ResourceID m_resource_id;
+    ModelHandle m_streaming_model = NO_MODEL;
+    int32_t m_streaming_mesh_index = -1;
     // material override is not serialized
     MaterialOverride m_material_override = {};
 
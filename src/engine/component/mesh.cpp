@@ -33,11 +33,24 @@ Mesh::Mesh(Scene & scene, NodeID node_id, std::istream & in)
     int32_t mesh_index;
     read_stream(in, mesh_index);
 
-    auto handle = scene.upload_model(path);
-    m_resource_id = man.get_mesh_id_from_mesh_index(
-        handle,
-        mesh_index
-    );
+    m_streaming_model = scene.request_model(path);
+    m_streaming_mesh_index = mesh_index;
+    resolve_streamed_model(man);
+}
+
+void Mesh::resolve_streamed_model(ModelManager const & man) {
+    if (m_streaming_model == NO_MODEL ||
+        man.model_is_streaming(m_streaming_model)) {
+        return;
+    }
+
+    /* a model that failed to load keeps its placeholder, without meshes */
+    ModelResource const & resource = man.get_model_resource(m_streaming_model);
+    if (static_cast<size_t>(m_streaming_mesh_index) <
+        resource.mesh_resource_ids.size()) {
+        m_resource_id = resource.mesh_resource_ids[m_streaming_mesh_index];
+    }
+    m_streaming_model = NO_MODEL;
 }
 
 void Mesh::serialize(
@@ -56,6 +69,13 @@ void Mesh::serialize(
         out.write(path.data(), path.size());
 
         write_stream(out, man.get_mesh_index_from_mesh_id(id));
+    } else if (m_streaming_model != NO_MODEL) {
+        std::string const & path = man.get_model(m_streaming_model).path();
+
+        write_stream(out, path.size());
+        out.write(path.data(), path.size());
+
+        write_stream(out, m_streaming_mesh_index);
     } else {
         write_stream(out, size_t{0});
     }
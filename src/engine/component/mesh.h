@@ -2,6 +2,7 @@
 #define PRT3_MESH_COMPONENT_H
 
 #include "src/engine/scene/node.h"
+#include "src/engine/rendering/model_manager.h"
 #include "src/engine/rendering/resources.h"
 #include "src/util/uuid.h"
 
@@ -22,7 +23,15 @@ public:
 
     NodeID node_id() const { return m_node_id; }
     ResourceID resource_id() const { return m_resource_id; }
-    void set_resource_id(ResourceID id) { m_resource_id = id; }
+    void set_resource_id(ResourceID id)
+    { m_resource_id = id; m_streaming_model = NO_MODEL; }
+
+    /* the model that the mesh is taken from while it is being streamed,
+     * until then the mesh has no resource
+     */
+    ModelHandle streaming_model() const { return m_streaming_model; }
+    /* takes the resource of the mesh once its model has been uploaded */
+    void resolve_streamed_model(ModelManager const & man);
 
     void serialize(
         std::ostream & out,
@@ -35,6 +44,8 @@ public:
 private:
     NodeID m_node_id;
     ResourceID m_resource_id;
+    ModelHandle m_streaming_model = NO_MODEL;
+    int32_t m_streaming_mesh_index = -1;
 
     void remove(Scene & /*scene*/) {}
 
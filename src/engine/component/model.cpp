@@ -35,7 +35,8 @@ ModelComponent::ModelComponent(
 
         in.read(path.data(), path.size());
 
-        m_model_handle = scene.upload_model(path);
+        /* renders nothing until the model has been streamed in */
+        m_model_handle = scene.request_model(path);
     }
 }
 
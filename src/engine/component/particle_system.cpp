@@ -4,6 +4,8 @@
 #include "src/engine/scene/scene.h"
 #include "src/util/random.h"
 
+#include <algorithm>
+
 using namespace prt3;
 
 ParticleSystem::ParticleSystem(Scene & /*scene*/, NodeID node_id)
@@ -28,7 +30,8 @@ ParticleSystem::ParticleSystem(
     read_stream(in, m_parameters.velocity);
     read_stream(in, m_parameters.dampening);
     read_stream(in, m_parameters.gravity);
-    m_parameters.texture_id = deserialize_texture(in, scene);
+    m_parameters.texture_id =
+        deserialize_texture(in, scene, TexturePacking::atlas);
     read_stream(in, m_parameters.animated);
     read_stream(in, m_parameters.tex_div_w);
     read_stream(in, m_parameters.tex_div_h);
@@ -277,13 +280,21 @@ void ParticleSystem::update(
 
 void ParticleSystem::collect_render_data(
         std::vector<ParticleSystem> const & components,
+        TextureManager const & textures,
         ParticleData & data
 ) {
+    struct VisibleSystem {
+        ParticleSystem const * ps;
+        uint32_t n_particles;
+        ResourceID texture;
+        glm::vec4 uv_transform;
+    };
+    thread_local std::vector<VisibleSystem> visible;
+    visible.clear();
+
     for (ParticleSystem const & ps : components) {
         if (!ps.m_parameters.active) continue;
 
-        ParticleSystem::Parameters const & params = ps.m_parameters;
-
         uint32_t n_particles = 0;
         for (Particle const & particle : ps.m_particles) {
             if (particle.alive) ++n_particles;
@@ -291,18 +302,46 @@ void ParticleSystem::collect_render_data(
 
         if (n_particles == 0) continue;
 
-        ParticleData::TextureRange range;
-        range.start_index = data.attributes.size();
-        range.count = n_particles;
-        range.texture = params.texture_id;
+        VisibleSystem v;
+        v.ps = &ps;
+        v.n_particles = n_particles;
+        v.texture = textures.resolve_texture(
+            ps.m_parameters.texture_id,
+            v.uv_transform
+        );
+        visible.push_back(v);
+    }
+
+    /* Particles are blended independently of their order, so systems whose
+     * textures are packed into the same atlas page can share a range.
+     */
+    std::stable_sort(visible.begin(), visible.end(),
+        [](VisibleSystem const & a, VisibleSystem const & b) {
+            return a.texture < b.texture;
+        }
+    );
+
+    for (VisibleSystem const & v : visible) {
+        ParticleSystem const & ps = *v.ps;
+        ParticleSystem::Parameters const & params = ps.m_parameters;
+
+        if (data.textures.empty() ||
+            data.textures.back().texture != v.texture) {
+            ParticleData::TextureRange range;
+            range.start_index = data.attributes.size();
+            range.count = 0;
+            range.texture = v.texture;
+            data.textures.push_back(range);
+        }
+        data.textures.back().count += v.n_particles;
+
         float inv_div_w = params.animated ? 1.0f / params.tex_div_w : 1.0f;
         float inv_div_h = params.animated ? 1.0f / params.tex_div_h : 1.0f;
-        range.inv_div.x = inv_div_w;
-        range.inv_div.y = inv_div_h;
+        glm::vec2 uv_scale = glm::vec2{v.uv_transform.z, v.uv_transform.w};
+        glm::vec2 uv_size = uv_scale * glm::vec2{inv_div_w, inv_div_h};
 
-        data.textures.push_back(range);
         uint32_t i = data.attributes.size();
-        data.attributes.resize(i + n_particles);
+        data.attributes.resize(i + v.n_particles);
 
         for (Particle const & particle : ps.m_particles) {
             if (!particle.alive) continue;
@@ -313,6 +352,7 @@ void ParticleSystem::collect_render_data(
             attr.color[2] = static_cast<uint8_t>(255.0f * particle.color[2]);
             attr.color[3] = static_cast<uint8_t>(255.0f * particle.color[3]);
 
+            glm::vec2 base_uv;
             if (ps.m_parameters.animated) {
                 uint32_t frame = get_frame(
                     particle.t,
@@ -325,10 +365,12 @@ void ParticleSystem::collect_render_data(
                 float x = static_cast<float>(ind_x) + 0.5f;
                 float y = static_cast<float>(ind_y) + 0.5f;
 
-                attr.base_uv = glm::vec2{x * inv_div_w, y * inv_div_h};
+                base_uv = glm::vec2{x * inv_div_w, y * inv_div_h};
             } else {
-                attr.base_uv = glm::vec2{0.5f, 0.5f};
+                base_uv = glm::vec2{0.5f, 0.5f};
             }
+            attr.base_uv = transform_uv(v.uv_transform, base_uv);
+            attr.uv_size = uv_size;
 
             ++i;
         }
@@ -2,6 +2,7 @@
 #define PRT3_PARTICLE_SYSTEM_H
 
 #include "src/engine/rendering/renderer.h"
+#include "src/engine/rendering/texture_manager.h"
 #include "src/engine/scene/node.h"
 #include "src/util/serialization_util.h"
 #include "src/util/uuid.h"
@@ -33,8 +34,12 @@ public:
     ResourceID const & texture_id() const { return m_parameters.texture_id; }
     ResourceID & texture_id() { return m_parameters.texture_id; }
 
+    /* systems are grouped by the texture that textures resolves theirs
+     * to, so that each group can be drawn instanced
+     */
     static void collect_render_data(
         std::vector<ParticleSystem> const & components,
+        TextureManager const & textures,
         ParticleData & data
     );
 
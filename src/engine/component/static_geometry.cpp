@@ -0,0 +1,14 @@
+#include "static_geometry.h"
+
+using namespace prt3;
+
+StaticGeometry::StaticGeometry(Scene &, NodeID node_id)
+ : m_node_id{node_id} {}
+
+StaticGeometry::StaticGeometry(Scene &, NodeID node_id, std::istream &)
+ : m_node_id{node_id} {}
+
+void StaticGeometry::serialize(
+    std::ostream &,
+    Scene const &
+) const {}
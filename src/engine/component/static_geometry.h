@@ -0,0 +1,44 @@
+#ifndef PRT3_STATIC_GEOMETRY_H
+#define PRT3_STATIC_GEOMETRY_H
+
+#include "src/engine/scene/node.h"
+#include "src/util/uuid.h"
+
+namespace prt3 {
+
+class Scene;
+
+template<typename T>
+class ComponentStorage;
+
+/* Marks the Mesh or ModelComponent of a node as static. When a scene is
+ * loaded into the game, the geometry of static nodes is merged into
+ * per-material batches and the nodes themselves are no longer drawn, so
+ * static nodes should never be moved or tinted individually.
+ */
+class StaticGeometry {
+public:
+    StaticGeometry(Scene & scene, NodeID node_id);
+    StaticGeometry(Scene & scene, NodeID node_id, std::istream & in);
+
+    NodeID node_id() const { return m_node_id; }
+
+    void serialize(
+        std::ostream & out,
+        Scene const & scene
+    ) const;
+
+    static char const * name() { return "Static Geometry"; }
+    static constexpr UUID uuid = 186713513885556424ull;
+
+private:
+    NodeID m_node_id;
+
+    void remove(Scene & /*scene*/) {}
+
+    friend class ComponentStorage<StaticGeometry>;
+};
+
+} // namespace prt3
+
+#endif
@@ -2,11 +2,13 @@
 
 #include "src/engine/component/script/script.h"
 #include "src/engine/component/script_set.h"
+#include "src/util/asset_manifest.h"
 #include "src/util/mem.h"
 #include "src/util/log.h"
+#include "src/util/virtual_file_system.h"
 
-#include <fstream>
 #include <unordered_set>
+#include <vector>
 
 using namespace prt3;
 
@@ -17,6 +19,7 @@ Context::Context(BackendType backend_type)
    m_material_manager{*this},
    m_model_manager{*this},
    m_texture_manager{*this},
+   m_asset_loader{*this},
    m_edit_scene{*this},
    m_game_scene{*this},
    m_scene_manager{*this},
@@ -30,14 +33,24 @@ Context::~Context() {
 }
 
 void Context::set_project_from_path(std::string const & path) {
-    std::ifstream in(path, std::ios::binary);
+    std::vector<char> data;
+    VirtualFileSystem::instance().read_file(path.c_str(), data);
+    imemstream in(data.data(), data.size());
     m_project.deserialize(in);
-    in.close();
+
+    /* revalidates the checksums of the assets that were recorded in an
+     * earlier session, all at once, before the models that need them are
+     * loaded
+     */
+    AssetManifest::instance().refresh(m_thread_pool);
 
     if (!m_project.main_scene_path().empty()) {
-        std::ifstream scene_in(m_project.main_scene_path(), std::ios::binary);
+        VirtualFileSystem::instance().read_file(
+            m_project.main_scene_path().c_str(),
+            data
+        );
+        imemstream scene_in(data.data(), data.size());
         m_edit_scene.deserialize(scene_in);
-        scene_in.close();
     }
 }
 
@@ -49,8 +62,27 @@ TransitionState Context::load_scene_if_queued(TransitionState state) {
     );
 }
 
+void Context::update_streaming() {
+    m_asset_loader.update();
+    /* after the loader, so that textures it finished are sampled from
+     * their atlas page this frame
+     */
+    m_texture_manager.update_atlas();
+    m_edit_scene.resolve_streamed_models();
+    m_game_scene.resolve_streamed_models();
+
+    /* once per burst of loading rather than once per asset */
+    if (m_asset_loader.idle()) {
+        AssetManifest::instance().save();
+    }
+}
+
 void Context::start_game(Scene const & scene) {
     m_game_scene = scene;
+    /* the edit scene may differ from any file on disk, so the batches
+     * are not cached
+     */
+    m_game_scene.build_static_batches("");
     m_game_is_active = true;
     m_project.on_game_start(m_game_scene);
 }
@@ -4,6 +4,7 @@
 #include "src/engine/audio/audio_manager.h"
 #include "src/engine/scene/scene.h"
 #include "src/engine/scene/scene_manager.h"
+#include "src/engine/rendering/asset_loader.h"
 #include "src/engine/rendering/renderer.h"
 #include "src/engine/rendering/material_manager.h"
 #include "src/engine/rendering/model_manager.h"
@@ -11,6 +12,7 @@
 #include "src/engine/core/backend_type.h"
 #include "src/engine/core/input.h"
 #include "src/engine/project/project.h"
+#include "src/util/thread_pool.h"
 
 namespace prt3 {
 
@@ -27,6 +29,8 @@ public:
     MaterialManager & material_manager() { return m_material_manager; }
     ModelManager & model_manager() { return m_model_manager; }
     TextureManager & texture_manager() { return m_texture_manager; }
+    AssetLoader & asset_loader() { return m_asset_loader; }
+    AssetLoader const & asset_loader() const { return m_asset_loader; }
     Scene & edit_scene() { return m_edit_scene; }
     Scene const & edit_scene() const { return m_edit_scene; }
     Scene & game_scene() { return m_game_scene; }
@@ -34,6 +38,7 @@ public:
     SceneManager & scene_manager() { return m_scene_manager; }
     AudioManager & audio_manager() { return m_audio_manager; }
     Project & project() { return m_project; }
+    ThreadPool & thread_pool() { return m_thread_pool; }
 
     void set_project_from_path(std::string const & path);
 
@@ -42,15 +47,23 @@ public:
 
     TransitionState load_scene_if_queued(TransitionState state);
 
+    /* uploads streamed assets within the budget of the frame, and hands
+     * them to the components that wait for them
+     */
+    void update_streaming();
+
     void update_window_size(int w, int h);
 
     bool game_is_active() { return m_game_is_active; }
 
 private:
+    /* first, so that it outlives everything that hands it work */
+    ThreadPool m_thread_pool;
     Renderer m_renderer;
     MaterialManager m_material_manager;
     ModelManager m_model_manager;
     TextureManager m_texture_manager;
+    AssetLoader m_asset_loader;
     Scene m_edit_scene;
     Scene m_game_scene;
     SceneManager m_scene_manager;
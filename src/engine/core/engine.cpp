@@ -24,16 +24,18 @@ bool Engine::execute_frame() {
     static RenderData render_data;
     render_data.clear();
 
+    m_context.update_streaming();
+
     m_transition_state = m_context.load_scene_if_queued(m_transition_state);
     if (m_transition_state != NO_TRANSITION) {
         Scene & scene = m_context.game_scene();
 
-        scene.collect_render_data(render_data.scene);
-
         scene.get_camera().collect_camera_render_data(
             render_data.camera_data
         );
 
+        scene.collect_render_data(render_data.camera_data, render_data.scene);
+
         m_context.renderer().render(render_data, false);
 
         m_context.audio_manager().update(
@@ -67,12 +69,15 @@ bool Engine::execute_frame() {
 
                 scene.update(fixed_delta_time);
 
-                scene.collect_render_data(render_data.scene);
-
                 scene.get_camera().collect_camera_render_data(
                     render_data.camera_data
                 );
 
+                scene.collect_render_data(
+                    render_data.camera_data,
+                    render_data.scene
+                );
+
                 m_context.renderer().render(render_data, false);
 
                 m_context.audio_manager().update(
@@ -88,12 +93,15 @@ bool Engine::execute_frame() {
 
                 m_editor.update(fixed_delta_time);
 
-                scene.collect_render_data(render_data.scene);
-
                 m_editor.get_camera().collect_camera_render_data(
                     render_data.camera_data
                 );
 
+                scene.collect_render_data(
+                    render_data.camera_data,
+                    render_data.scene
+                );
+
                 m_editor.collect_render_data(render_data.editor_data);
 
                 m_context.renderer().render(render_data, true);
@@ -138,7 +146,14 @@ void Engine::measure_duration() {
     }
 
     if (m_print_framerate && m_frame_number % 10 == 0) {
-        PRT3LOG("framerate: %f (%f ms)\n", fps, avg_ms);
+        RenderStats stats = m_context.renderer().render_stats();
+        PRT3LOG(
+            "framerate: %f (%f ms), state changes: %u issued, %u elided\n",
+            fps,
+            avg_ms,
+            stats.state_changes_issued,
+            stats.state_changes_elided
+        );
     }
 
     m_last_frame_time_point = now;
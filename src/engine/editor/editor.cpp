@@ -48,11 +48,17 @@ void Editor::update(float delta_time) {
             int x, y;
             input.get_cursor_position(x, y);
 
-            NodeID id = m_context.renderer().get_selected(x, y);
-            m_editor_context.set_selected_node(id);
+            if (!m_context.renderer().request_selection(x, y)) {
+                m_editor_context.set_selected_node(pick_on_cpu(x, y));
+            }
         }
     }
 
+    NodeID selected;
+    if (m_context.renderer().poll_selection(selected)) {
+        m_editor_context.set_selected_node(selected);
+    }
+
     if (input.get_key(KEY_CODE_LEFT_CONTROL)){
         if (input.get_key_down(KEY_CODE_Z)) {
             if (input.get_key(KEY_CODE_LEFT_SHIFT)) {
@@ -66,6 +72,26 @@ void Editor::update(float delta_time) {
     ImGui::Render();
 }
 
+NodeID Editor::pick_on_cpu(int x, int y) {
+    Renderer const & renderer = m_context.renderer();
+    glm::vec2 ndc{
+        2.0f * x / renderer.window_width() - 1.0f,
+        1.0f - 2.0f * y / renderer.window_height()
+    };
+
+    Camera const & camera = m_camera.get_camera();
+    glm::mat4 view_projection =
+        camera.get_projection_matrix() * camera.get_view_matrix();
+
+    Scene const & scene = m_context.edit_scene();
+    return m_mesh_picker.pick(
+        scene,
+        scene.m_transform_cache.global_transforms().data(),
+        view_projection,
+        ndc
+    );
+}
+
 void Editor::collect_render_data(
     EditorRenderData & data
 ) {
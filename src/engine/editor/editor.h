@@ -7,6 +7,7 @@
 #include "src/engine/scene/node.h"
 #include "src/engine/editor/gizmo/gizmo_manager.h"
 #include "src/engine/editor/action/action_manager.h"
+#include "src/engine/rendering/mesh_picker.h"
 
 
 namespace prt3 {
@@ -39,6 +40,11 @@ private:
     ActionManager m_action_manager;
 
     ResourceID m_line_box_res_id;
+
+    /* used when the render backend does not support picking */
+    MeshPicker m_mesh_picker;
+
+    NodeID pick_on_cpu(int x, int y);
 };
 
 } // namespace prt3
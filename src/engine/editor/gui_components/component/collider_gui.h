@@ -276,6 +276,10 @@ void inner_show_component<ColliderComponent>(
                 ImGui::OpenPopup("select_model_popup");
             }
 
+            /* coarser levels of detail make cheaper colliders */
+            static int lod = 0;
+            ImGui::SliderInt("level of detail", &lod, 0, Model::MAX_LODS - 1);
+
             ModelManager & man = context.get_model_manager();
             std::vector<Model> const & models = man.models();
 
@@ -283,12 +287,14 @@ void inner_show_component<ColliderComponent>(
                 ImGui::SameLine();
                 for (Model const & model : models) {
                     if (ImGui::Selectable(model.path().c_str())) {
+                        std::vector<glm::vec3> triangles;
+                        model.collect_triangles(lod, triangles);
                         context.editor().perform_action<ActionSetCollider<
-                            Model
+                            std::vector<glm::vec3>
                         > >(
                             id,
                             tag.type,
-                            model
+                            triangles
                         );
                         tag = component.tag();
                     }
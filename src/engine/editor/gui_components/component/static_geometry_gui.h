@@ -0,0 +1,25 @@
+#ifndef PRT3_STATIC_GEOMETRY_GUI_H
+#define PRT3_STATIC_GEOMETRY_GUI_H
+
+#include "src/engine/editor/gui_components/component/component_gui.h"
+#include "src/engine/editor/editor_context.h"
+#include "src/engine/component/static_geometry.h"
+
+#include "imgui.h"
+
+namespace prt3 {
+
+template<>
+void inner_show_component<StaticGeometry>(
+    EditorContext & /*context*/,
+    NodeID /*id*/
+) {
+    ImGui::TextWrapped(
+        "Geometry of this node is merged into static batches "
+        "when the scene is loaded into the game."
+    );
+}
+
+} // namespace prt3
+
+#endif
@@ -46,10 +46,12 @@ ColliderTag PhysicsSystem::add_mesh_collider(
     NodeID node_id,
     ColliderType type,
     Model const & model,
+    uint32_t lod,
     Transform const & transform
 ) {
     ColliderTag tag = create_collider_from_model(
         model,
+        lod,
         transform,
         type
     );
@@ -348,31 +350,14 @@ ColliderTag PhysicsSystem::create_collider_from_triangles(
 
 ColliderTag PhysicsSystem::create_collider_from_model(
     Model const & model,
+    uint32_t lod,
     Transform const & transform,
     ColliderType type
 ) {
     ColliderContainer & container = get_container(type);
 
-    std::vector<Model::Vertex> v_buf = model.vertex_buffer();
-    std::vector<uint32_t> i_buf = model.index_buffer();
-
     std::vector<glm::vec3> tris;
-    tris.resize(i_buf.size());
-
-    for (auto const & node : model.nodes()) {
-        if (node.mesh_index == -1) {
-            continue;
-        }
-
-        glm::mat4 tform = node.inherited_transform.to_matrix();
-
-        auto const & mesh = model.meshes()[node.mesh_index];
-
-        auto end_index = mesh.start_index + mesh.num_indices;
-        for (auto i = mesh.start_index; i < end_index; ++i) {
-            tris[i] = glm::vec3(tform * glm::vec4(v_buf[i_buf[i]].position, 1.0f));
-        }
-    }
+    model.collect_triangles(lod, tris);
 
     ColliderTag tag;
     tag.shape = ColliderShape::mesh;
@@ -294,10 +294,12 @@ private:
         Transform const & transform
     );
 
+    /* lod selects a simplified level of detail of the model's meshes */
     ColliderTag add_mesh_collider(
         NodeID node_id,
         ColliderType type,
         Model const & model,
+        uint32_t lod,
         Transform const & transform
     );
 
@@ -344,6 +346,7 @@ private:
 
     ColliderTag create_collider_from_model(
         Model const & model,
+        uint32_t lod,
         Transform const & transform,
         ColliderType type
     );
@@ -0,0 +1,194 @@
+#include "asset_loader.h"
+
+#include "src/engine/core/context.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+using namespace prt3;
+
+struct AssetLoader::Finished {
+    std::mutex mutex;
+    /* notified whenever an asset is added */
+    std::condition_variable added;
+    std::vector<LoadedAsset> assets;
+};
+
+static size_t upload_size(Model const & model) {
+    size_t vertex_size = model.packed_vertices_size() > 0 ?
+        model.packed_vertices_size() :
+        model.vertex_buffer().size() * sizeof(Model::Vertex);
+    return vertex_size +
+        model.vertex_bone_buffer().size() * sizeof(Model::BoneData) +
+        model.index_buffer().size() * sizeof(uint32_t);
+}
+
+AssetLoader::AssetLoader(Context & context)
+ : m_context{context},
+   m_finished{std::make_shared<Finished>()} {}
+
+AssetLoader::~AssetLoader() {}
+
+void AssetLoader::on_request() {
+    if (m_progress.done()) {
+        m_progress = {};
+    }
+    ++m_progress.n_requested;
+}
+
+void AssetLoader::load_model(ModelHandle handle, std::string const & path) {
+    on_request();
+
+    std::shared_ptr<Finished> finished = m_finished;
+    m_context.thread_pool().submit([finished, handle, path]() {
+        LoadedAsset asset;
+        asset.model_handle = handle;
+        asset.path = path;
+        asset.model = Model{path.c_str()};
+
+        {
+            std::lock_guard<std::mutex> lock{finished->mutex};
+            finished->assets.push_back(std::move(asset));
+        }
+        finished->added.notify_all();
+    });
+}
+
+void AssetLoader::load_texture(
+    ResourceID id,
+    std::string const & path,
+    TextureUsage usage,
+    TextureCompression const & compression
+) {
+    on_request();
+
+    std::shared_ptr<Finished> finished = m_finished;
+    m_context.thread_pool().submit([finished, id, path, usage, compression]() {
+        LoadedAsset asset;
+        asset.texture_id = id;
+        asset.path = path;
+        load_texture_data(path.c_str(), usage, compression, asset.texture);
+
+        {
+            std::lock_guard<std::mutex> lock{finished->mutex};
+            finished->assets.push_back(std::move(asset));
+        }
+        finished->added.notify_all();
+    });
+}
+
+void AssetLoader::update() {
+    typedef std::chrono::high_resolution_clock Clock;
+    Clock::time_point start = Clock::now();
+    auto elapsed_ms = [start]() {
+        return std::chrono::duration<double, std::milli>(
+            Clock::now() - start
+        ).count();
+    };
+
+    ThreadPool & pool = m_context.thread_pool();
+    size_t bytes = 0;
+    bool uploaded = false;
+    while (true) {
+        if (m_uploads.empty()) {
+            std::lock_guard<std::mutex> lock{m_finished->mutex};
+            for (LoadedAsset & asset : m_finished->assets) {
+                m_uploads.push_back(std::move(asset));
+            }
+            m_finished->assets.clear();
+        }
+
+        bool over_budget = elapsed_ms() >= m_budget_ms ||
+                           bytes >= m_budget_bytes;
+
+        if (m_uploads.empty()) {
+            /* without workers, decoding is part of the frame */
+            if (pool.has_workers() || over_budget || !pool.run_task()) {
+                break;
+            }
+            continue;
+        }
+
+        if (uploaded && over_budget) {
+            break;
+        }
+
+        bytes += upload(m_uploads.front());
+        m_uploads.pop_front();
+        uploaded = true;
+    }
+}
+
+void AssetLoader::wait_for_model(ModelHandle handle) {
+    ModelManager const & man = m_context.model_manager();
+    upload_while([&]() { return man.model_is_streaming(handle); });
+}
+
+void AssetLoader::wait_for_texture(ResourceID id) {
+    TextureManager const & man = m_context.texture_manager();
+    upload_while([&]() { return man.texture_is_streaming(id); });
+}
+
+void AssetLoader::upload_while(std::function<bool()> const & waiting) {
+    ThreadPool & pool = m_context.thread_pool();
+    while (waiting()) {
+        if (m_uploads.empty()) {
+            std::unique_lock<std::mutex> lock{m_finished->mutex};
+            if (m_finished->assets.empty()) {
+                /* helps with the queued tasks, or waits for the workers to
+                 * finish the ones that they are running
+                 */
+                lock.unlock();
+                if (pool.run_task()) {
+                    continue;
+                }
+                lock.lock();
+                m_finished->added.wait(
+                    lock,
+                    [this]() { return !m_finished->assets.empty(); }
+                );
+            }
+
+            for (LoadedAsset & asset : m_finished->assets) {
+                m_uploads.push_back(std::move(asset));
+            }
+            m_finished->assets.clear();
+        }
+
+        upload(m_uploads.front());
+        m_uploads.pop_front();
+    }
+}
+
+size_t AssetLoader::upload(LoadedAsset & asset) {
+    size_t bytes = 0;
+    bool success;
+    if (asset.model_handle != NO_MODEL) {
+        bytes = upload_size(asset.model);
+        success = asset.model.valid();
+        m_context.model_manager().finish_streaming(
+            asset.model_handle,
+            std::move(asset.model)
+        );
+    } else {
+        TextureData & data = asset.texture;
+        bytes = texture_data_size(data);
+        success = data.data != nullptr;
+        m_context.texture_manager().finish_streaming(
+            asset.texture_id,
+            asset.path,
+            data
+        );
+        free_texture_data(data);
+    }
+
+    ++m_progress.n_finished;
+    if (success) {
+        m_progress.bytes_uploaded += bytes;
+    } else {
+        ++m_progress.n_failed;
+    }
+    return bytes;
+}
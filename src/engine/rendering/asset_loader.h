@@ -0,0 +1,115 @@
+#ifndef PRT3_ASSET_LOADER_H
+#define PRT3_ASSET_LOADER_H
+
+#include "src/engine/rendering/model.h"
+#include "src/engine/rendering/model_manager.h"
+#include "src/engine/rendering/resources.h"
+#include "src/engine/rendering/texture.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace prt3 {
+
+class Context;
+
+/* progress of the assets that have been requested since the loader was
+ * last idle
+ */
+struct LoadProgress {
+    uint32_t n_requested = 0;
+    /* including those that failed to load */
+    uint32_t n_finished = 0;
+    uint32_t n_failed = 0;
+    size_t bytes_uploaded = 0;
+
+    bool done() const { return n_finished == n_requested; }
+    float fraction() const {
+        return n_requested == 0 ?
+            1.0f : static_cast<float>(n_finished) / n_requested;
+    }
+};
+
+/* Streams models and textures in the background. Files are read and
+ * decoded on the workers of the thread pool of the context, or, if there
+ * are none, on the main thread as part of update(). Uploads to the backend
+ * happen in update(), which stops once the upload budget of the frame is
+ * spent.
+ *
+ * Requests are made through ModelManager::request_model and
+ * TextureManager::request_texture, which hand out placeholders that are
+ * replaced in place once the asset has been uploaded.
+ */
+class AssetLoader {
+public:
+    static constexpr double DEFAULT_BUDGET_MS = 4.0;
+    static constexpr size_t DEFAULT_BUDGET_BYTES = 16 * 1024 * 1024;
+
+    AssetLoader(Context & context);
+    ~AssetLoader();
+
+    AssetLoader(AssetLoader const &) = delete;
+    AssetLoader & operator=(AssetLoader const &) = delete;
+
+    /* uploads assets that have finished loading until either budget is
+     * spent, but always at least one, so that loading progresses
+     */
+    void update();
+
+    void set_budget(double milliseconds, size_t bytes)
+    { m_budget_ms = milliseconds; m_budget_bytes = bytes; }
+
+    LoadProgress const & progress() const { return m_progress; }
+    bool idle() const { return m_progress.done(); }
+
+private:
+    struct LoadedAsset {
+        ModelHandle model_handle = NO_MODEL;
+        ResourceID texture_id = NO_RESOURCE;
+        std::string path;
+        Model model;
+        TextureData texture = {};
+    };
+    /* assets that workers have finished, shared with the tasks so that
+     * they can finish after the loader is gone
+     */
+    struct Finished;
+
+    Context & m_context;
+    std::shared_ptr<Finished> m_finished;
+    std::deque<LoadedAsset> m_uploads;
+
+    LoadProgress m_progress;
+    double m_budget_ms = DEFAULT_BUDGET_MS;
+    size_t m_budget_bytes = DEFAULT_BUDGET_BYTES;
+
+    void load_model(ModelHandle handle, std::string const & path);
+    void load_texture(
+        ResourceID id,
+        std::string const & path,
+        TextureUsage usage,
+        TextureCompression const & compression
+    );
+
+    /* uploads finished assets, in order, until the streaming model or
+     * texture has been replaced, so that it is never loaded twice
+     */
+    void wait_for_model(ModelHandle handle);
+    void wait_for_texture(ResourceID id);
+    void upload_while(std::function<bool()> const & waiting);
+
+    void on_request();
+    /* returns the number of bytes uploaded */
+    size_t upload(LoadedAsset & asset);
+
+    friend class ModelManager;
+    friend class TextureManager;
+};
+
+} // namespace prt3
+
+#endif
@@ -0,0 +1,250 @@
+#include "light_clusters.h"
+
+#include "src/util/simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace prt3;
+
+void LightClusters::LightsSoA::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    r.clear();
+    index.clear();
+}
+
+void LightClusters::LightsSoA::push_back(
+    glm::vec3 const & pos,
+    float radius,
+    uint16_t i
+) {
+    x.push_back(pos.x);
+    y.push_back(pos.y);
+    z.push_back(pos.z);
+    r.push_back(radius);
+    index.push_back(i);
+}
+
+void LightClusters::LightsSoA::pad() {
+    while (x.size() % 4 != 0) {
+        x.push_back(0.0f);
+        y.push_back(0.0f);
+        z.push_back(0.0f);
+        r.push_back(0.0f);
+    }
+}
+
+/* bit mask of the lanes in group g that hold actual lights */
+static uint32_t valid_lanes(size_t n, size_t g) {
+    size_t remaining = n - g;
+    return remaining >= 4 ? 0xfu : (1u << remaining) - 1u;
+}
+
+float LightClusters::light_range(PointLight const & light, float max_range) {
+    float intensity = std::max(
+        light.color.r,
+        std::max(light.color.g, light.color.b)
+    );
+
+    /* solve a * d^2 + b * d + c = intensity / cutoff for d */
+    float k = intensity / LIGHT_CUTOFF;
+    float a = light.quadratic_term;
+    float b = light.linear_term;
+    float c = light.constant_term;
+
+    if (k <= c) {
+        return 0.0f;
+    }
+
+    float range;
+    if (a > 0.0f) {
+        float disc = b * b - 4.0f * a * (c - k);
+        range = (-b + std::sqrt(disc)) / (2.0f * a);
+    } else if (b > 0.0f) {
+        range = (k - c) / b;
+    } else {
+        range = max_range;
+    }
+
+    return std::min(range, max_range);
+}
+
+void LightClusters::update_cluster_bounds(
+    CameraRenderData const & camera_data
+) {
+    m_projection_matrix = camera_data.projection_matrix;
+    m_near_plane = camera_data.near_plane;
+    m_far_plane = camera_data.far_plane;
+
+    float near = m_near_plane;
+    float far = m_far_plane;
+    float log_ratio = std::log(far / near);
+
+    m_depth_slice_scale = DIM_Z / log_ratio;
+    m_depth_slice_bias = -(DIM_Z * std::log(near)) / log_ratio;
+
+    for (uint32_t z = 0; z <= DIM_Z; ++z) {
+        m_slice_depths[z] =
+            near * std::pow(far / near, static_cast<float>(z) / DIM_Z);
+    }
+
+    /* Unproject two points along the view ray through each tile corner.
+     * Points are stored as (x, y, depth) where depth = -z in view space.
+     * This works for both perspective and orthographic projections.
+     */
+    constexpr uint32_t N_CORNERS = (DIM_X + 1) * (DIM_Y + 1);
+    std::array<glm::vec3, N_CORNERS> corner_origin;
+    std::array<glm::vec3, N_CORNERS> corner_dir; // change per unit of depth
+
+    glm::mat4 inv_proj = glm::inverse(camera_data.projection_matrix);
+    for (uint32_t y = 0; y <= DIM_Y; ++y) {
+        for (uint32_t x = 0; x <= DIM_X; ++x) {
+            float ndc_x = -1.0f + (2.0f * x) / DIM_X;
+            float ndc_y = -1.0f + (2.0f * y) / DIM_Y;
+
+            glm::vec4 p0 = inv_proj * glm::vec4{ndc_x, ndc_y, 0.0f, 1.0f};
+            glm::vec4 p1 = inv_proj * glm::vec4{ndc_x, ndc_y, 0.5f, 1.0f};
+            glm::vec3 a = glm::vec3{p0} / p0.w;
+            glm::vec3 b = glm::vec3{p1} / p1.w;
+            a.z = -a.z;
+            b.z = -b.z;
+
+            uint32_t i = x + (DIM_X + 1) * y;
+            corner_dir[i] = (b - a) / (b.z - a.z);
+            corner_origin[i] = a - a.z * corner_dir[i];
+        }
+    }
+
+    m_cluster_min.resize(N_CLUSTERS);
+    m_cluster_max.resize(N_CLUSTERS);
+
+    for (uint32_t z = 0; z < DIM_Z; ++z) {
+        float depths[2] = { m_slice_depths[z], m_slice_depths[z + 1] };
+        for (uint32_t y = 0; y < DIM_Y; ++y) {
+            for (uint32_t x = 0; x < DIM_X; ++x) {
+                glm::vec3 mn{std::numeric_limits<float>::max()};
+                glm::vec3 mx{std::numeric_limits<float>::lowest()};
+                for (uint32_t corner = 0; corner < 4; ++corner) {
+                    uint32_t cx = x + (corner & 1u);
+                    uint32_t cy = y + (corner >> 1u);
+                    uint32_t i = cx + (DIM_X + 1) * cy;
+                    for (float depth : depths) {
+                        glm::vec3 p = corner_origin[i] + depth * corner_dir[i];
+                        mn = glm::min(mn, p);
+                        mx = glm::max(mx, p);
+                    }
+                }
+
+                uint32_t c = cluster_index(x, y, z);
+                m_cluster_min[c] = mn;
+                m_cluster_max[c] = mx;
+            }
+        }
+    }
+}
+
+void LightClusters::assign_lights(
+    CameraRenderData const & camera_data,
+    PointLightRenderData const * lights,
+    size_t n_lights
+) {
+    if (camera_data.projection_matrix != m_projection_matrix ||
+        camera_data.near_plane != m_near_plane ||
+        camera_data.far_plane != m_far_plane) {
+        update_cluster_bounds(camera_data);
+    }
+
+    m_clusters.resize(N_CLUSTERS);
+    m_light_indices.clear();
+
+    /* transform lights into (x, y, depth) view space */
+    m_view_lights.clear();
+    size_t max_lights = std::numeric_limits<uint16_t>::max();
+    n_lights = std::min(n_lights, max_lights);
+    float max_range = m_far_plane - m_near_plane;
+    for (size_t i = 0; i < n_lights; ++i) {
+        float range = light_range(lights[i].light, max_range);
+        if (range <= 0.0f) continue;
+
+        glm::vec3 pos =
+            camera_data.view_matrix * glm::vec4{lights[i].position, 1.0f};
+        pos.z = -pos.z;
+        m_view_lights.push_back(pos, range, static_cast<uint16_t>(i));
+    }
+    m_view_lights.pad();
+
+    LightsSoA const & vl = m_view_lights;
+    LightsSoA & sl = m_slice_lights;
+    F32x4 zero = splat4(0.0f);
+
+    for (uint32_t z = 0; z < DIM_Z; ++z) {
+        /* reject lights outside the depth range of the slice */
+        F32x4 d0 = splat4(m_slice_depths[z]);
+        F32x4 d1 = splat4(m_slice_depths[z + 1]);
+
+        sl.clear();
+        for (size_t g = 0; g < vl.size(); g += 4) {
+            F32x4 depth = load4(&vl.z[g]);
+            F32x4 r = load4(&vl.r[g]);
+            uint32_t mask = mask_le4(sub4(depth, r), d1) &
+                            mask_le4(d0, add4(depth, r)) &
+                            valid_lanes(vl.size(), g);
+            for (uint32_t lane = 0; lane < 4; ++lane) {
+                if (mask & (1u << lane)) {
+                    sl.push_back(
+                        glm::vec3{vl.x[g+lane], vl.y[g+lane], vl.z[g+lane]},
+                        vl.r[g+lane],
+                        vl.index[g+lane]
+                    );
+                }
+            }
+        }
+        sl.pad();
+
+        /* sphere against cluster bounds, four lights at a time */
+        for (uint32_t y = 0; y < DIM_Y; ++y) {
+            for (uint32_t x = 0; x < DIM_X; ++x) {
+                uint32_t c = cluster_index(x, y, z);
+                Cluster & cluster = m_clusters[c];
+                cluster.offset = static_cast<uint32_t>(m_light_indices.size());
+
+                glm::vec3 const & mn = m_cluster_min[c];
+                glm::vec3 const & mx = m_cluster_max[c];
+                F32x4 min_x = splat4(mn.x);
+                F32x4 min_y = splat4(mn.y);
+                F32x4 min_z = splat4(mn.z);
+                F32x4 max_x = splat4(mx.x);
+                F32x4 max_y = splat4(mx.y);
+                F32x4 max_z = splat4(mx.z);
+
+                for (size_t g = 0; g < sl.size(); g += 4) {
+                    F32x4 lx = load4(&sl.x[g]);
+                    F32x4 ly = load4(&sl.y[g]);
+                    F32x4 lz = load4(&sl.z[g]);
+                    F32x4 r = load4(&sl.r[g]);
+
+                    F32x4 dx = max4(max4(sub4(min_x, lx), sub4(lx, max_x)), zero);
+                    F32x4 dy = max4(max4(sub4(min_y, ly), sub4(ly, max_y)), zero);
+                    F32x4 dz = max4(max4(sub4(min_z, lz), sub4(lz, max_z)), zero);
+                    F32x4 dist2 =
+                        add4(add4(mul4(dx, dx), mul4(dy, dy)), mul4(dz, dz));
+
+                    uint32_t mask = mask_le4(dist2, mul4(r, r)) &
+                                    valid_lanes(sl.size(), g);
+                    for (uint32_t lane = 0; lane < 4; ++lane) {
+                        if ((mask & (1u << lane)) &&
+                            m_light_indices.size() < MAX_LIGHT_INDICES) {
+                            m_light_indices.push_back(sl.index[g + lane]);
+                        }
+                    }
+                }
+
+                cluster.count = static_cast<uint32_t>(m_light_indices.size())
+                                - cluster.offset;
+            }
+        }
+    }
+}
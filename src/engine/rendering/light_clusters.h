@@ -0,0 +1,97 @@
+#ifndef PRT3_LIGHT_CLUSTERS_H
+#define PRT3_LIGHT_CLUSTERS_H
+
+#include "src/engine/rendering/render_data.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+/* Splits the view frustum into a grid of clusters, tiled in screen space
+ * and sliced exponentially in view depth, and assigns point lights to the
+ * clusters their range of influence overlaps. Independent of any graphics
+ * API so that it can run headless.
+ */
+class LightClusters {
+public:
+    static constexpr uint32_t DIM_X = 16;
+    static constexpr uint32_t DIM_Y = 8;
+    static constexpr uint32_t DIM_Z = 24;
+    static constexpr uint32_t N_CLUSTERS = DIM_X * DIM_Y * DIM_Z;
+
+    /* upper bound on the total length of the light index list */
+    static constexpr uint32_t MAX_LIGHT_INDICES = 1u << 20;
+
+    /* light intensity below which a light no longer affects a cluster */
+    static constexpr float LIGHT_CUTOFF = 1.0f / 256.0f;
+
+    struct Cluster {
+        uint32_t offset; // into light_indices()
+        uint32_t count;
+    };
+
+    void assign_lights(
+        CameraRenderData const & camera_data,
+        PointLightRenderData const * lights,
+        size_t n_lights
+    );
+
+    /* indexed by cluster_index() */
+    std::vector<Cluster> const & clusters() const { return m_clusters; }
+    std::vector<uint16_t> const & light_indices() const
+    { return m_light_indices; }
+
+    /* slice = log(view_depth) * depth_slice_scale() + depth_slice_bias() */
+    float depth_slice_scale() const { return m_depth_slice_scale; }
+    float depth_slice_bias() const { return m_depth_slice_bias; }
+
+    static uint32_t cluster_index(uint32_t x, uint32_t y, uint32_t z)
+    { return x + DIM_X * (y + DIM_Y * z); }
+
+    /* distance at which the light's contribution falls below LIGHT_CUTOFF */
+    static float light_range(PointLight const & light, float max_range);
+
+private:
+    std::vector<Cluster> m_clusters;
+    std::vector<uint16_t> m_light_indices;
+
+    /* view space cluster bounds, only recomputed when the projection changes */
+    glm::mat4 m_projection_matrix = glm::mat4{0.0f};
+    float m_near_plane = 0.0f;
+    float m_far_plane = 0.0f;
+    std::vector<glm::vec3> m_cluster_min;
+    std::vector<glm::vec3> m_cluster_max;
+    std::array<float, DIM_Z + 1> m_slice_depths;
+
+    float m_depth_slice_scale = 0.0f;
+    float m_depth_slice_bias = 0.0f;
+
+    /* view space lights in structure-of-arrays layout, padded to a
+     * multiple of four
+     */
+    struct LightsSoA {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> r;
+        std::vector<uint16_t> index;
+
+        void clear();
+        void push_back(glm::vec3 const & pos, float radius, uint16_t i);
+        void pad();
+        size_t size() const { return index.size(); }
+    };
+
+    LightsSoA m_view_lights;
+    LightsSoA m_slice_lights;
+
+    void update_cluster_bounds(CameraRenderData const & camera_data);
+};
+
+} // namespace prt3
+
+#endif
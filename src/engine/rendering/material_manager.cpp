@@ -21,17 +21,24 @@ ResourceID MaterialManager::upload_material(
     material.twosided = mesh_material.twosided;
     material.transparent = mesh_material.transparent;
 
+    /* textures are streamed in, with placeholders that match the
+     * defaults that backends use for materials without the texture
+     */
     TextureManager & tex_man = m_context.texture_manager();
     material.albedo_map = mesh_material.albedo_map.empty() ?
-        NO_RESOURCE : tex_man.upload_texture(mesh_material.albedo_map);
+        NO_RESOURCE : tex_man.request_texture(mesh_material.albedo_map);
     material.normal_map = mesh_material.normal_map.empty() ?
-        NO_RESOURCE : tex_man.upload_texture(mesh_material.normal_map);
+        NO_RESOURCE : tex_man.request_texture(
+            mesh_material.normal_map,
+            glm::u8vec4{0x00, 0x00, 0xff, 0xff},
+            TextureUsage::normal_map
+        );
     material.metallic_map = mesh_material.metallic_map.empty() ?
-        NO_RESOURCE : tex_man.upload_texture(mesh_material.metallic_map);
+        NO_RESOURCE : tex_man.request_texture(mesh_material.metallic_map);
     material.roughness_map = mesh_material.roughness_map.empty() ?
-        NO_RESOURCE : tex_man.upload_texture(mesh_material.roughness_map);
+        NO_RESOURCE : tex_man.request_texture(mesh_material.roughness_map);
     material.ambient_occlusion_map = mesh_material.ambient_occlusion_map.empty() ?
-        NO_RESOURCE : tex_man.upload_texture(mesh_material.ambient_occlusion_map);
+        NO_RESOURCE : tex_man.request_texture(mesh_material.ambient_occlusion_map);
 
     ResourceID id = m_context.renderer().upload_material(material);
     m_material_ids.insert(id);
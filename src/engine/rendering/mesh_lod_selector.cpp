@@ -0,0 +1,77 @@
+#include "mesh_lod_selector.h"
+
+#include <glm/gtx/component_wise.hpp>
+
+using namespace prt3;
+
+uint32_t MeshLODSelector::lod_from_size(
+    float size,
+    float threshold_scale,
+    uint32_t n_lods
+) {
+    uint32_t lod = 0;
+    while (lod + 1 < n_lods && size < SCREEN_SIZES[lod] * threshold_scale) {
+        ++lod;
+    }
+    return lod;
+}
+
+void MeshLODSelector::begin_frame(CameraRenderData const & camera_data) {
+    m_view_position = camera_data.view_position;
+    m_projection_scale = camera_data.projection_matrix[1][1];
+    m_orthographic = camera_data.projection_matrix[3][3] == 1.0f;
+    m_next_lods.clear();
+}
+
+uint32_t MeshLODSelector::select(
+    uint64_t key,
+    Model::Mesh const & mesh,
+    glm::mat4 const & transform
+) {
+    uint32_t n_lods = mesh.n_lods();
+    if (n_lods == 1) {
+        return 0;
+    }
+
+    glm::vec3 center = transform * glm::vec4{mesh.bounds_center, 1.0f};
+    float scale = glm::compMax(glm::vec3{
+        glm::length(glm::vec3{transform[0]}),
+        glm::length(glm::vec3{transform[1]}),
+        glm::length(glm::vec3{transform[2]})
+    });
+    float radius = scale * mesh.bounds_radius;
+
+    float size;
+    if (m_orthographic) {
+        size = radius * m_projection_scale;
+    } else {
+        float distance = glm::distance(center, m_view_position);
+        if (distance <= radius) {
+            m_next_lods[key] = 0;
+            return 0;
+        }
+        size = radius * m_projection_scale / distance;
+    }
+
+    /* the level may only become coarser once the size is below the lower
+     * threshold and finer once it is above the upper threshold
+     */
+    uint32_t coarsest = lod_from_size(size, 1.0f + HYSTERESIS, n_lods);
+    uint32_t finest = lod_from_size(size, 1.0f - HYSTERESIS, n_lods);
+
+    uint32_t lod;
+    auto it = m_lods.find(key);
+    if (it != m_lods.end()) {
+        lod = glm::clamp(it->second, finest, coarsest);
+    } else {
+        lod = lod_from_size(size, 1.0f, n_lods);
+    }
+
+    m_next_lods[key] = lod;
+    return lod;
+}
+
+void MeshLODSelector::end_frame() {
+    /* instances that were not drawn are forgotten */
+    m_lods.swap(m_next_lods);
+}
@@ -0,0 +1,56 @@
+#ifndef PRT3_MESH_LOD_SELECTOR_H
+#define PRT3_MESH_LOD_SELECTOR_H
+
+#include "src/engine/rendering/model.h"
+#include "src/engine/rendering/render_data.h"
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+namespace prt3 {
+
+/* Picks a level of detail for each drawn mesh from the size of its
+ * bounding sphere on screen. The level chosen in the previous frame is
+ * kept until the size moves past the threshold by a margin, so meshes
+ * near a threshold do not switch back and forth.
+ */
+class MeshLODSelector {
+public:
+    void begin_frame(CameraRenderData const & camera_data);
+
+    /* key identifies the mesh instance between frames */
+    uint32_t select(
+        uint64_t key,
+        Model::Mesh const & mesh,
+        glm::mat4 const & transform
+    );
+
+    void end_frame();
+
+private:
+    /* Bounding sphere radius relative to half the viewport height at
+     * which each level after the first starts being used
+     */
+    static constexpr std::array<float, Model::MAX_LODS - 1> SCREEN_SIZES =
+        { 0.3f, 0.12f, 0.05f };
+    /* relative margin around the thresholds */
+    static constexpr float HYSTERESIS = 0.15f;
+
+    glm::vec3 m_view_position;
+    float m_projection_scale;
+    bool m_orthographic;
+
+    std::unordered_map<uint64_t, uint32_t> m_lods;
+    std::unordered_map<uint64_t, uint32_t> m_next_lods;
+
+    static uint32_t lod_from_size(
+        float size,
+        float threshold_scale,
+        uint32_t n_lods
+    );
+};
+
+} // namespace prt3
+
+#endif
@@ -0,0 +1,389 @@
+#include "mesh_optimization.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace prt3;
+
+static constexpr uint32_t NO_TRIANGLE = ~uint32_t{0};
+
+/* scoring constants from Forsyth's article */
+static constexpr float CACHE_DECAY_POWER = 1.5f;
+static constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float VALENCE_BOOST_SCALE = 2.0f;
+static constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+static float vertex_score(int32_t cache_position, uint32_t live_triangles) {
+    if (live_triangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            /* vertices of the last triangle get a fixed score, so that
+             * the same edge is not used twice in a row
+             */
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            score = std::pow(
+                1.0f - (cache_position - 3) * scale,
+                CACHE_DECAY_POWER
+            );
+        }
+    }
+
+    /* vertices with few triangles left are prioritized, so that they
+     * are not left behind
+     */
+    score += VALENCE_BOOST_SCALE *
+             std::pow(float(live_triangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+/* FIFO post-transform cache, vertices are in the cache if they were
+ * inserted less than cache_size misses ago
+ */
+class FIFOCache {
+public:
+    FIFOCache(size_t n_vertices, uint32_t cache_size)
+     : m_timestamps(n_vertices, 0),
+       m_time{cache_size + 1},
+       m_cache_size{cache_size} {}
+
+    /* returns true on a miss */
+    bool access(uint32_t vertex) {
+        if (m_time - m_timestamps[vertex] > m_cache_size) {
+            m_timestamps[vertex] = m_time;
+            ++m_time;
+            return true;
+        }
+        return false;
+    }
+
+    void flush() { m_time += m_cache_size + 1; }
+
+private:
+    std::vector<uint32_t> m_timestamps;
+    uint32_t m_time;
+    uint32_t m_cache_size;
+};
+
+void prt3::optimize_vertex_cache(
+    uint32_t const * indices,
+    size_t n_indices,
+    size_t n_vertices,
+    uint32_t * result
+) {
+    size_t n_triangles = n_indices / 3;
+    if (n_triangles == 0) {
+        return;
+    }
+
+    /* triangles adjacent to each vertex, the first live_triangles[v] of
+     * them have not been emitted yet
+     */
+    std::vector<uint32_t> live_triangles(n_vertices, 0);
+    for (size_t i = 0; i < 3 * n_triangles; ++i) {
+        ++live_triangles[indices[i]];
+    }
+
+    std::vector<uint32_t> adjacency_offsets(n_vertices + 1, 0);
+    for (size_t v = 0; v < n_vertices; ++v) {
+        adjacency_offsets[v + 1] = adjacency_offsets[v] + live_triangles[v];
+    }
+
+    std::vector<uint32_t> adjacency(3 * n_triangles);
+    {
+        std::vector<uint32_t> fill(
+            adjacency_offsets.begin(),
+            adjacency_offsets.end() - 1
+        );
+        for (size_t i = 0; i < 3 * n_triangles; ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int32_t> cache_position(n_vertices, -1);
+    std::vector<float> scores(n_vertices);
+    for (size_t v = 0; v < n_vertices; ++v) {
+        scores[v] = vertex_score(-1, live_triangles[v]);
+    }
+
+    std::vector<float> triangle_scores(n_triangles);
+    std::vector<bool> emitted(n_triangles, false);
+    uint32_t best_triangle = 0;
+    for (size_t t = 0; t < n_triangles; ++t) {
+        triangle_scores[t] = scores[indices[3 * t]] +
+                             scores[indices[3 * t + 1]] +
+                             scores[indices[3 * t + 2]];
+        if (triangle_scores[t] > triangle_scores[best_triangle]) {
+            best_triangle = static_cast<uint32_t>(t);
+        }
+    }
+
+    uint32_t cache[VERTEX_CACHE_SIZE + 3];
+    uint32_t new_cache[VERTEX_CACHE_SIZE + 3];
+    size_t cache_count = 0;
+    size_t input_cursor = 0;
+
+    for (size_t out = 0; out < n_triangles; ++out) {
+        if (best_triangle == NO_TRIANGLE) {
+            /* nothing in the cache is adjacent to a live triangle, so
+             * continue with the next one in input order
+             */
+            while (emitted[input_cursor]) {
+                ++input_cursor;
+            }
+            best_triangle = static_cast<uint32_t>(input_cursor);
+        }
+
+        uint32_t const * triangle = indices + 3 * best_triangle;
+        std::copy(triangle, triangle + 3, result + 3 * out);
+        emitted[best_triangle] = true;
+
+        size_t new_count = 0;
+        for (unsigned int i = 0; i < 3; ++i) {
+            uint32_t v = triangle[i];
+
+            uint32_t * begin = adjacency.data() + adjacency_offsets[v];
+            uint32_t * end = begin + live_triangles[v];
+            uint32_t * it = std::find(begin, end, best_triangle);
+            if (it != end) {
+                std::swap(*it, *(end - 1));
+                --live_triangles[v];
+            }
+
+            if (std::find(new_cache, new_cache + new_count, v) ==
+                new_cache + new_count) {
+                new_cache[new_count++] = v;
+            }
+        }
+
+        for (size_t i = 0; i < cache_count; ++i) {
+            uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                new_cache[new_count++] = v;
+            }
+        }
+
+        /* vertices that were pushed out of the cache are rescored too */
+        for (size_t i = 0; i < new_count; ++i) {
+            uint32_t v = new_cache[i];
+            cache_position[v] = i < VERTEX_CACHE_SIZE ? int32_t(i) : -1;
+
+            float score = vertex_score(cache_position[v], live_triangles[v]);
+            float diff = score - scores[v];
+            scores[v] = score;
+
+            uint32_t const * adj = adjacency.data() + adjacency_offsets[v];
+            for (uint32_t j = 0; j < live_triangles[v]; ++j) {
+                triangle_scores[adj[j]] += diff;
+            }
+        }
+
+        cache_count = std::min(new_count, size_t{VERTEX_CACHE_SIZE});
+        std::copy(new_cache, new_cache + cache_count, cache);
+
+        best_triangle = NO_TRIANGLE;
+        float best_score = -1.0f;
+        for (size_t i = 0; i < cache_count; ++i) {
+            uint32_t v = cache[i];
+            uint32_t const * adj = adjacency.data() + adjacency_offsets[v];
+            for (uint32_t j = 0; j < live_triangles[v]; ++j) {
+                if (triangle_scores[adj[j]] > best_score) {
+                    best_score = triangle_scores[adj[j]];
+                    best_triangle = adj[j];
+                }
+            }
+        }
+    }
+}
+
+void prt3::optimize_overdraw(
+    Model::Vertex const * vertices,
+    uint32_t * indices,
+    size_t n_indices,
+    float threshold
+) {
+    size_t n_triangles = n_indices / 3;
+    if (n_triangles < 2) {
+        return;
+    }
+
+    size_t n_vertices = *std::max_element(indices, indices + 3 * n_triangles) + 1;
+
+    /* hard boundaries are where all vertices of a triangle miss, which
+     * means the cache is cold regardless of what was drawn before
+     */
+    std::vector<uint32_t> misses(n_triangles);
+    std::vector<uint32_t> hard_boundaries;
+    {
+        FIFOCache cache{n_vertices, VERTEX_CACHE_SIZE};
+        for (size_t t = 0; t < n_triangles; ++t) {
+            misses[t] = uint32_t{cache.access(indices[3 * t])} +
+                        uint32_t{cache.access(indices[3 * t + 1])} +
+                        uint32_t{cache.access(indices[3 * t + 2])};
+            if (misses[t] == 3) {
+                hard_boundaries.push_back(static_cast<uint32_t>(t));
+            }
+        }
+    }
+    hard_boundaries.push_back(static_cast<uint32_t>(n_triangles));
+
+    /* soft boundaries split hard clusters where the cache miss ratio so
+     * far is close enough to the ratio of the whole cluster
+     */
+    std::vector<uint32_t> clusters;
+    FIFOCache cache{n_vertices, VERTEX_CACHE_SIZE};
+    for (size_t c = 0; c + 1 < hard_boundaries.size(); ++c) {
+        uint32_t begin = hard_boundaries[c];
+        uint32_t end = hard_boundaries[c + 1];
+
+        uint32_t cluster_misses = 0;
+        for (uint32_t t = begin; t < end; ++t) {
+            cluster_misses += misses[t];
+        }
+        float target = threshold * float(cluster_misses) / (end - begin);
+
+        cache.flush();
+        clusters.push_back(begin);
+        uint32_t running_misses = 0;
+        uint32_t running_triangles = 0;
+        for (uint32_t t = begin; t < end; ++t) {
+            running_misses += uint32_t{cache.access(indices[3 * t])} +
+                              uint32_t{cache.access(indices[3 * t + 1])} +
+                              uint32_t{cache.access(indices[3 * t + 2])};
+            ++running_triangles;
+
+            if (t + 1 < end &&
+                float(running_misses) / running_triangles <= target) {
+                cache.flush();
+                clusters.push_back(t + 1);
+                running_misses = 0;
+                running_triangles = 0;
+            }
+        }
+    }
+
+    size_t n_clusters = clusters.size();
+    clusters.push_back(static_cast<uint32_t>(n_triangles));
+    if (n_clusters < 2) {
+        return;
+    }
+
+    struct Cluster {
+        uint32_t begin;
+        uint32_t end;
+        glm::vec3 centroid;
+        glm::vec3 normal;
+        float sort_key;
+    };
+
+    std::vector<Cluster> cluster_data(n_clusters);
+    glm::vec3 mesh_centroid{0.0f};
+    float mesh_area = 0.0f;
+    for (size_t c = 0; c < n_clusters; ++c) {
+        Cluster & cluster = cluster_data[c];
+        cluster.begin = clusters[c];
+        cluster.end = clusters[c + 1];
+        cluster.centroid = glm::vec3{0.0f};
+        cluster.normal = glm::vec3{0.0f};
+
+        float area = 0.0f;
+        for (uint32_t t = cluster.begin; t < cluster.end; ++t) {
+            glm::vec3 const & p0 = vertices[indices[3 * t]].position;
+            glm::vec3 const & p1 = vertices[indices[3 * t + 1]].position;
+            glm::vec3 const & p2 = vertices[indices[3 * t + 2]].position;
+
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float a = glm::length(n);
+            cluster.centroid += a * (p0 + p1 + p2) / 3.0f;
+            cluster.normal += n;
+            area += a;
+        }
+
+        mesh_centroid += cluster.centroid;
+        mesh_area += area;
+        if (area > 0.0f) {
+            cluster.centroid /= area;
+        }
+    }
+    if (mesh_area > 0.0f) {
+        mesh_centroid /= mesh_area;
+    }
+
+    /* clusters that face away from the center are more likely to occlude
+     * the rest of the mesh, so they are drawn first
+     */
+    for (Cluster & cluster : cluster_data) {
+        float length = glm::length(cluster.normal);
+        cluster.sort_key = length > 0.0f ?
+            glm::dot(cluster.centroid - mesh_centroid, cluster.normal / length) :
+            0.0f;
+    }
+
+    std::stable_sort(
+        cluster_data.begin(),
+        cluster_data.end(),
+        [](Cluster const & a, Cluster const & b) {
+            return a.sort_key > b.sort_key;
+        }
+    );
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(3 * n_triangles);
+    for (Cluster const & cluster : cluster_data) {
+        sorted.insert(
+            sorted.end(),
+            indices + 3 * cluster.begin,
+            indices + 3 * cluster.end
+        );
+    }
+    std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+uint32_t prt3::optimize_vertex_fetch_remap(
+    uint32_t * indices,
+    size_t n_indices,
+    size_t n_vertices,
+    std::vector<uint32_t> & remap
+) {
+    remap.assign(n_vertices, NO_VERTEX_REMAP);
+
+    uint32_t n_referenced = 0;
+    for (size_t i = 0; i < n_indices; ++i) {
+        uint32_t & remapped = remap[indices[i]];
+        if (remapped == NO_VERTEX_REMAP) {
+            remapped = n_referenced;
+            ++n_referenced;
+        }
+        indices[i] = remapped;
+    }
+    return n_referenced;
+}
+
+VertexCacheStatistics prt3::analyze_vertex_cache(
+    uint32_t const * indices,
+    size_t n_indices,
+    size_t n_vertices,
+    uint32_t cache_size
+) {
+    VertexCacheStatistics stats{};
+    stats.triangles = static_cast<uint32_t>(n_indices / 3);
+
+    std::vector<bool> seen(n_vertices, false);
+    FIFOCache cache{n_vertices, cache_size};
+    for (size_t i = 0; i < 3 * size_t{stats.triangles}; ++i) {
+        uint32_t v = indices[i];
+        if (!seen[v]) {
+            seen[v] = true;
+            ++stats.unique_vertices;
+        }
+        if (cache.access(v)) {
+            ++stats.vertices_transformed;
+        }
+    }
+    return stats;
+}
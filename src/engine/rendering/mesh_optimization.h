@@ -0,0 +1,83 @@
+#ifndef PRT3_MESH_OPTIMIZATION_H
+#define PRT3_MESH_OPTIMIZATION_H
+
+#include "src/engine/rendering/model.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+/* size of the post-transform vertex cache that meshes are optimized for
+ * and measured against
+ */
+static constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+/* Reorders the triangles of a triangle list so that consecutive triangles
+ * reuse vertices that are still in the post-transform vertex cache, after
+ * Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". Indices must be
+ * smaller than n_vertices. result may not alias indices.
+ */
+void optimize_vertex_cache(
+    uint32_t const * indices,
+    size_t n_indices,
+    size_t n_vertices,
+    uint32_t * result
+);
+
+/* Reorders a cache optimized triangle list to reduce overdraw, after
+ * Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced
+ * Overdraw". The list is split into clusters where the cache would be
+ * cold anyway, or where splitting raises the miss ratio by at most
+ * threshold, and clusters that face outwards are drawn first. indices are
+ * reordered in place.
+ */
+void optimize_overdraw(
+    Model::Vertex const * vertices,
+    uint32_t * indices,
+    size_t n_indices,
+    float threshold = 1.05f
+);
+
+static constexpr uint32_t NO_VERTEX_REMAP = ~uint32_t{0};
+
+/* Renumbers vertices in the order that they are first referenced by
+ * indices, so that vertex fetches are sequential, and rewrites indices
+ * accordingly. remap maps old vertex indices to new ones, vertices that
+ * are never referenced map to NO_VERTEX_REMAP. Returns the number of
+ * referenced vertices.
+ */
+uint32_t optimize_vertex_fetch_remap(
+    uint32_t * indices,
+    size_t n_indices,
+    size_t n_vertices,
+    std::vector<uint32_t> & remap
+);
+
+struct VertexCacheStatistics {
+    uint32_t vertices_transformed;
+    uint32_t unique_vertices;
+    uint32_t triangles;
+
+    /* average cache miss ratio, transformed vertices per triangle */
+    float acmr() const
+    { return triangles > 0 ? float(vertices_transformed) / triangles : 0.0f; }
+
+    /* average transform to vertex ratio, 1.0 is optimal */
+    float atvr() const {
+        return unique_vertices > 0 ?
+            float(vertices_transformed) / unique_vertices : 0.0f;
+    }
+};
+
+/* simulates a FIFO post-transform cache of cache_size entries */
+VertexCacheStatistics analyze_vertex_cache(
+    uint32_t const * indices,
+    size_t n_indices,
+    size_t n_vertices,
+    uint32_t cache_size = VERTEX_CACHE_SIZE
+);
+
+} // namespace prt3
+
+#endif
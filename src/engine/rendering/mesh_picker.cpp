@@ -0,0 +1,217 @@
+#include "mesh_picker.h"
+
+#include "src/engine/scene/scene.h"
+#include "src/util/geometry_util.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace prt3;
+
+MeshPicker::MeshTree const & MeshPicker::get_mesh_tree(
+    ResourceID mesh_id,
+    Model const & model,
+    uint32_t mesh_index
+) {
+    Model::Mesh const & mesh = model.meshes()[mesh_index];
+
+    auto it = m_mesh_trees.find(mesh_id);
+    if (it != m_mesh_trees.end() &&
+        it->second.model == &model &&
+        it->second.start_index == mesh.start_index &&
+        it->second.num_indices == mesh.num_indices) {
+        return it->second;
+    }
+
+    MeshTree & mt = m_mesh_trees[mesh_id];
+    mt = {};
+    mt.model = &model;
+    mt.start_index = mesh.start_index;
+    mt.num_indices = mesh.num_indices;
+
+    auto const & vertices = model.vertex_buffer();
+    auto const & indices = model.index_buffer();
+
+    uint32_t n_triangles = mesh.num_indices / 3;
+    mt.vertices.resize(3 * n_triangles);
+    for (uint32_t i = 0; i < 3 * n_triangles; ++i) {
+        mt.vertices[i] = vertices[indices[mesh.start_index + i]].position;
+    }
+
+    /* leaves are identified by 16 bit collider ids, so large meshes store
+     * several triangles per leaf
+     */
+    constexpr uint32_t max_leaves = std::numeric_limits<ColliderID>::max();
+    mt.triangles_per_leaf = (n_triangles + max_leaves - 1) / max_leaves;
+    mt.triangles_per_leaf = std::max(mt.triangles_per_leaf, 1u);
+
+    if (n_triangles == 0) {
+        mt.bounds = {};
+        return mt;
+    }
+
+    mt.bounds.lower_bound = mt.vertices[0];
+    mt.bounds.upper_bound = mt.vertices[0];
+
+    uint32_t n_leaves =
+        (n_triangles + mt.triangles_per_leaf - 1) / mt.triangles_per_leaf;
+    for (uint32_t leaf = 0; leaf < n_leaves; ++leaf) {
+        uint32_t first = 3 * leaf * mt.triangles_per_leaf;
+        uint32_t last = std::min(
+            first + 3 * mt.triangles_per_leaf,
+            3 * n_triangles
+        );
+
+        AABB aabb;
+        aabb.lower_bound = mt.vertices[first];
+        aabb.upper_bound = mt.vertices[first];
+        for (uint32_t i = first + 1; i < last; ++i) {
+            aabb.lower_bound = glm::min(aabb.lower_bound, mt.vertices[i]);
+            aabb.upper_bound = glm::max(aabb.upper_bound, mt.vertices[i]);
+        }
+        mt.bounds += aabb;
+
+        mt.tree.insert(
+            ColliderTag{static_cast<ColliderID>(leaf),
+                        ColliderShape::mesh,
+                        ColliderType::collider},
+            1,
+            aabb
+        );
+    }
+
+    return mt;
+}
+
+void MeshPicker::test_mesh(
+    Ray const & ray,
+    ResourceID mesh_id,
+    Model const & model,
+    uint32_t mesh_index,
+    glm::mat4 const & transform,
+    NodeID node_id,
+    float & closest_t,
+    NodeID & closest_node
+) {
+    MeshTree const & mt = get_mesh_tree(mesh_id, model, mesh_index);
+    if (mt.vertices.empty()) {
+        return;
+    }
+
+    /* the ray is tested in mesh space, as a segment parameterized by t in
+     * [0, closest_t], which is the same in every space
+     */
+    glm::mat4 inv = glm::inverse(transform);
+    glm::vec3 origin = inv * glm::vec4{ray.origin, 1.0f};
+    glm::vec3 segment = glm::vec3{inv * glm::vec4{ray.end, 1.0f}} - origin;
+
+    if (!AABB::intersect_ray(mt.bounds, origin, segment, closest_t)) {
+        return;
+    }
+
+    m_leaves.clear();
+    mt.tree.query_raycast(origin, segment, closest_t, 1, m_leaves);
+
+    float seg_len2 = glm::dot(segment, segment);
+    uint32_t n_vertices = static_cast<uint32_t>(mt.vertices.size());
+    for (ColliderTag const & tag : m_leaves) {
+        uint32_t first = 3 * tag.id * mt.triangles_per_leaf;
+        uint32_t last = std::min(
+            first + 3 * mt.triangles_per_leaf,
+            n_vertices
+        );
+
+        for (uint32_t i = first; i < last; i += 3) {
+            glm::vec3 intersection;
+            if (triangle_ray_intersect(
+                origin,
+                segment,
+                mt.vertices[i],
+                mt.vertices[i + 1],
+                mt.vertices[i + 2],
+                intersection
+            )) {
+                float t = glm::dot(intersection - origin, segment) / seg_len2;
+                if (t < closest_t) {
+                    closest_t = t;
+                    closest_node = node_id;
+                }
+            }
+        }
+    }
+}
+
+NodeID MeshPicker::pick(
+    Scene const & scene,
+    Transform const * global_transforms,
+    glm::mat4 const & view_projection,
+    glm::vec2 ndc
+) {
+    glm::mat4 inv_vp = glm::inverse(view_projection);
+    glm::vec4 near = inv_vp * glm::vec4{ndc, 0.0f, 1.0f};
+    glm::vec4 far = inv_vp * glm::vec4{ndc, 1.0f, 1.0f};
+
+    Ray ray;
+    ray.origin = glm::vec3{near} / near.w;
+    ray.end = glm::vec3{far} / far.w;
+
+    float closest_t = 1.0f;
+    NodeID closest_node = NO_NODE;
+
+    ModelManager const & man = scene.model_manager();
+
+    auto test_mesh_component = [&](ResourceID mesh_id, NodeID id) {
+        if (mesh_id == NO_RESOURCE) return;
+
+        test_mesh(
+            ray,
+            mesh_id,
+            man.get_model_from_mesh_id(mesh_id),
+            man.get_mesh_index_from_mesh_id(mesh_id),
+            global_transforms[id].to_matrix(),
+            id,
+            closest_t,
+            closest_node
+        );
+    };
+
+    auto test_model_component = [&](ModelHandle handle, NodeID id) {
+        if (handle == NO_MODEL) return;
+
+        auto const & resources = man.get_model_resource(handle);
+        Model const & model = man.get_model(handle);
+        glm::mat4 global = global_transforms[id].to_matrix();
+
+        for (size_t i = 0; i < resources.mesh_resource_ids.size(); ++i) {
+            auto const & model_node =
+                model.nodes()[model.meshes()[i].node_index];
+            test_mesh(
+                ray,
+                resources.mesh_resource_ids[i],
+                model,
+                static_cast<uint32_t>(i),
+                global * model_node.inherited_transform.to_matrix(),
+                id,
+                closest_t,
+                closest_node
+            );
+        }
+    };
+
+    for (Mesh const & comp : scene.get_all_components<Mesh>()) {
+        test_mesh_component(comp.resource_id(), comp.node_id());
+    }
+    for (AnimatedMesh const & comp : scene.get_all_components<AnimatedMesh>()) {
+        test_mesh_component(comp.resource_id(), comp.node_id());
+    }
+    for (ModelComponent const & comp :
+         scene.get_all_components<ModelComponent>()) {
+        test_model_component(comp.model_handle(), comp.node_id());
+    }
+    for (AnimatedModel const & comp :
+         scene.get_all_components<AnimatedModel>()) {
+        test_model_component(comp.model_handle(), comp.node_id());
+    }
+
+    return closest_node;
+}
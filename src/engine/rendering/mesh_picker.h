@@ -0,0 +1,88 @@
+#ifndef PRT3_MESH_PICKER_H
+#define PRT3_MESH_PICKER_H
+
+#include "src/engine/component/transform.h"
+#include "src/engine/physics/aabb.h"
+#include "src/engine/physics/aabb_tree.h"
+#include "src/engine/rendering/model.h"
+#include "src/engine/rendering/resources.h"
+#include "src/engine/scene/node.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace prt3 {
+
+class Scene;
+
+/* Picks nodes on the CPU by casting a ray against the meshes of a scene.
+ * Instances are first tested against their bounds and then against the
+ * triangles of the mesh, which are kept in a DynamicAABBTree per mesh.
+ * The trees are built on first use and cached. Animated meshes are tested
+ * in their bind pose.
+ */
+class MeshPicker {
+public:
+    /**
+     * @param scene scene to pick from
+     * @param global_transforms global transforms of the scene nodes
+     * @param view_projection view projection matrix of the camera
+     * @param ndc picked position in normalized device coordinates
+     * @return node of the closest mesh hit, or NO_NODE
+     */
+    NodeID pick(
+        Scene const & scene,
+        Transform const * global_transforms,
+        glm::mat4 const & view_projection,
+        glm::vec2 ndc
+    );
+
+    void clear() { m_mesh_trees.clear(); }
+
+private:
+    struct MeshTree {
+        DynamicAABBTree tree;
+        AABB bounds;
+        std::vector<glm::vec3> vertices; // three per triangle
+        uint32_t triangles_per_leaf;
+
+        /* used to detect meshes whose resource id has been reused */
+        Model const * model;
+        uint32_t start_index;
+        uint32_t num_indices;
+    };
+
+    struct Ray {
+        glm::vec3 origin;
+        glm::vec3 end;
+    };
+
+    std::unordered_map<ResourceID, MeshTree> m_mesh_trees;
+    std::vector<ColliderTag> m_leaves;
+
+    MeshTree const & get_mesh_tree(
+        ResourceID mesh_id,
+        Model const & model,
+        uint32_t mesh_index
+    );
+
+    void test_mesh(
+        Ray const & ray,
+        ResourceID mesh_id,
+        Model const & model,
+        uint32_t mesh_index,
+        glm::mat4 const & transform,
+        NodeID node_id,
+        float & closest_t,
+        NodeID & closest_node
+    );
+};
+
+} // namespace prt3
+
+#endif
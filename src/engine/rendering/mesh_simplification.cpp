@@ -0,0 +1,361 @@
+#include "mesh_simplification.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+using namespace prt3;
+
+static constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+/* symmetric 4x4 matrix, the upper triangle is stored row by row */
+struct Quadric {
+    double m[10] = {};
+
+    void add_plane(glm::dvec3 n, double d) {
+        m[0] += n.x * n.x; m[1] += n.x * n.y; m[2] += n.x * n.z;
+        m[3] += n.x * d;   m[4] += n.y * n.y; m[5] += n.y * n.z;
+        m[6] += n.y * d;   m[7] += n.z * n.z; m[8] += n.z * d;
+        m[9] += d * d;
+    }
+
+    void add(Quadric const & other) {
+        for (unsigned int i = 0; i < 10; ++i) {
+            m[i] += other.m[i];
+        }
+    }
+
+    double error(glm::dvec3 v) const {
+        return m[0] * v.x * v.x + 2.0 * m[1] * v.x * v.y +
+               2.0 * m[2] * v.x * v.z + 2.0 * m[3] * v.x +
+               m[4] * v.y * v.y + 2.0 * m[5] * v.y * v.z +
+               2.0 * m[6] * v.y +
+               m[7] * v.z * v.z + 2.0 * m[8] * v.z +
+               m[9];
+    }
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double error;
+};
+
+static float attribute_distance(
+    Model::Vertex const & a,
+    Model::Vertex const & b
+) {
+    glm::vec2 duv = a.texture_coordinate - b.texture_coordinate;
+    return glm::dot(duv, duv) + 0.5f * (1.0f - glm::dot(a.normal, b.normal));
+}
+
+static uint32_t resolve(std::vector<uint32_t> & remap, uint32_t v) {
+    uint32_t root = v;
+    while (remap[root] != root) {
+        root = remap[root];
+    }
+    while (remap[v] != root) {
+        uint32_t next = remap[v];
+        remap[v] = root;
+        v = next;
+    }
+    return root;
+}
+
+void prt3::simplify_mesh(
+    Model::Vertex const * vertices,
+    uint32_t const * indices,
+    size_t n_indices,
+    size_t target_index_count,
+    std::vector<uint32_t> & result
+) {
+    result.assign(indices, indices + n_indices);
+    if (n_indices <= target_index_count) {
+        return;
+    }
+
+    /* only the vertices referenced by the mesh take part, they are given
+     * local indices
+     */
+    std::unordered_map<uint32_t, uint32_t> local_index;
+    std::vector<uint32_t> local_to_global;
+    std::vector<uint32_t> tris(n_indices);
+    for (size_t i = 0; i < n_indices; ++i) {
+        auto res = local_index.emplace(
+            indices[i],
+            static_cast<uint32_t>(local_to_global.size())
+        );
+        if (res.second) {
+            local_to_global.push_back(indices[i]);
+        }
+        tris[i] = res.first->second;
+    }
+    size_t n_local = local_to_global.size();
+
+    auto vertex = [&](uint32_t local) -> Model::Vertex const & {
+        return vertices[local_to_global[local]];
+    };
+
+    /* vertices that share a position are collapsed together */
+    std::unordered_map<glm::vec3, uint32_t> position_index;
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> position_of(n_local);
+    for (uint32_t i = 0; i < n_local; ++i) {
+        auto res = position_index.emplace(
+            vertex(i).position,
+            static_cast<uint32_t>(positions.size())
+        );
+        if (res.second) {
+            positions.push_back(vertex(i).position);
+        }
+        position_of[i] = res.first->second;
+    }
+    size_t n_positions = positions.size();
+
+    std::vector<uint32_t> first_vertex(n_positions, NO_VERTEX);
+    std::vector<uint32_t> next_vertex(n_local, NO_VERTEX);
+    for (uint32_t i = static_cast<uint32_t>(n_local); i-- > 0;) {
+        next_vertex[i] = first_vertex[position_of[i]];
+        first_vertex[position_of[i]] = i;
+    }
+
+    /* positions where the uv coordinates are discontinuous */
+    std::vector<bool> seam(n_positions, false);
+    for (uint32_t p = 0; p < n_positions; ++p) {
+        uint32_t first = first_vertex[p];
+        for (uint32_t v = next_vertex[first]; v != NO_VERTEX;
+             v = next_vertex[v]) {
+            glm::vec2 duv = vertex(v).texture_coordinate -
+                            vertex(first).texture_coordinate;
+            if (glm::dot(duv, duv) > 1e-8f) {
+                seam[p] = true;
+                break;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(n_positions);
+    for (size_t i = 0; i < n_indices; i += 3) {
+        uint32_t p0 = position_of[tris[i]];
+        uint32_t p1 = position_of[tris[i + 1]];
+        uint32_t p2 = position_of[tris[i + 2]];
+        glm::dvec3 a = positions[p0];
+        glm::dvec3 n = glm::cross(
+            glm::dvec3{positions[p1]} - a,
+            glm::dvec3{positions[p2]} - a
+        );
+        double length = glm::length(n);
+        if (length == 0.0) {
+            continue;
+        }
+        n /= length;
+        double d = -glm::dot(n, a);
+        quadrics[p0].add_plane(n, d);
+        quadrics[p1].add_plane(n, d);
+        quadrics[p2].add_plane(n, d);
+    }
+
+    std::vector<uint32_t> remap(n_local);
+    for (uint32_t i = 0; i < n_local; ++i) {
+        remap[i] = i;
+    }
+
+    size_t target_triangles = target_index_count / 3;
+
+    std::vector<uint64_t> edges;
+    std::vector<bool> locked(n_positions);
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> adjacency_offsets(n_positions + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<bool> touched(n_positions);
+
+    while (true) {
+        /* apply the collapses of the previous pass */
+        size_t n_tri_indices = 0;
+        for (size_t i = 0; i < tris.size(); i += 3) {
+            uint32_t v0 = resolve(remap, tris[i]);
+            uint32_t v1 = resolve(remap, tris[i + 1]);
+            uint32_t v2 = resolve(remap, tris[i + 2]);
+            uint32_t p0 = position_of[v0];
+            uint32_t p1 = position_of[v1];
+            uint32_t p2 = position_of[v2];
+            if (p0 == p1 || p1 == p2 || p2 == p0) {
+                continue;
+            }
+            tris[n_tri_indices++] = v0;
+            tris[n_tri_indices++] = v1;
+            tris[n_tri_indices++] = v2;
+        }
+        tris.resize(n_tri_indices);
+
+        size_t n_triangles = tris.size() / 3;
+        if (n_triangles <= target_triangles) {
+            break;
+        }
+
+        /* edges used by a single triangle lie on a border */
+        edges.clear();
+        for (size_t i = 0; i < tris.size(); i += 3) {
+            for (size_t j = 0; j < 3; ++j) {
+                uint64_t a = position_of[tris[i + j]];
+                uint64_t b = position_of[tris[i + (j + 1) % 3]];
+                edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        std::fill(locked.begin(), locked.end(), false);
+        for (size_t i = 0; i < edges.size();) {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j] == edges[i]) {
+                ++j;
+            }
+            if (j - i == 1) {
+                locked[edges[i] >> 32] = true;
+                locked[edges[i] & 0xFFFFFFFF] = true;
+            }
+            i = j;
+        }
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (uint64_t edge : edges) {
+            uint32_t p = static_cast<uint32_t>(edge >> 32);
+            uint32_t q = static_cast<uint32_t>(edge & 0xFFFFFFFF);
+
+            Quadric quadric = quadrics[p];
+            quadric.add(quadrics[q]);
+
+            /* collapsing a seam onto a vertex that is not on a seam would
+             * stretch the uv coordinates of one side
+             */
+            bool p_to_q = !locked[p] && (!seam[p] || seam[q]);
+            bool q_to_p = !locked[q] && (!seam[q] || seam[p]);
+            double p_to_q_error = quadric.error(positions[q]);
+            double q_to_p_error = quadric.error(positions[p]);
+
+            if (p_to_q && (!q_to_p || p_to_q_error <= q_to_p_error)) {
+                collapses.push_back({p, q, p_to_q_error});
+            } else if (q_to_p) {
+                collapses.push_back({q, p, q_to_p_error});
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(),
+            [](Collapse const & a, Collapse const & b) {
+                return a.error < b.error;
+            }
+        );
+
+        std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+        for (uint32_t v : tris) {
+            ++adjacency_offsets[position_of[v] + 1];
+        }
+        for (size_t p = 0; p < n_positions; ++p) {
+            adjacency_offsets[p + 1] += adjacency_offsets[p];
+        }
+        adjacency.resize(tris.size());
+        {
+            std::vector<uint32_t> heads(
+                adjacency_offsets.begin(),
+                adjacency_offsets.end() - 1
+            );
+            for (size_t i = 0; i < tris.size(); ++i) {
+                adjacency[heads[position_of[tris[i]]]++] =
+                    static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        /* Collapses within a pass may not affect the same triangles, which
+         * keeps the flip test below exact. Positions of all triangles
+         * around a collapsed vertex are therefore left alone until the
+         * next pass.
+         */
+        std::fill(touched.begin(), touched.end(), false);
+        size_t to_remove = n_triangles - target_triangles;
+        size_t removed = 0;
+        size_t n_collapsed = 0;
+        for (Collapse const & collapse : collapses) {
+            if (removed >= to_remove) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+
+            uint32_t begin = adjacency_offsets[collapse.from];
+            uint32_t end = adjacency_offsets[collapse.from + 1];
+
+            bool flipped = false;
+            size_t n_degenerate = 0;
+            for (uint32_t i = begin; i < end && !flipped; ++i) {
+                uint32_t const * tri = &tris[3 * adjacency[i]];
+                glm::vec3 before[3];
+                glm::vec3 after[3];
+                bool degenerate = false;
+                for (size_t j = 0; j < 3; ++j) {
+                    uint32_t p = position_of[tri[j]];
+                    degenerate |= p == collapse.to;
+                    before[j] = positions[p];
+                    after[j] = positions[p == collapse.from ? collapse.to : p];
+                }
+                if (degenerate) {
+                    ++n_degenerate;
+                    continue;
+                }
+
+                glm::vec3 n_before = glm::cross(
+                    before[1] - before[0],
+                    before[2] - before[0]
+                );
+                glm::vec3 n_after = glm::cross(
+                    after[1] - after[0],
+                    after[2] - after[0]
+                );
+                flipped = glm::dot(n_before, n_after) <= 0.0f;
+            }
+            if (flipped) {
+                continue;
+            }
+
+            /* each vertex is replaced by the vertex at the new position
+             * whose attributes are the closest match
+             */
+            for (uint32_t v = first_vertex[collapse.from]; v != NO_VERTEX;
+                 v = next_vertex[v]) {
+                uint32_t best = first_vertex[collapse.to];
+                float best_distance = attribute_distance(vertex(v), vertex(best));
+                for (uint32_t w = next_vertex[best]; w != NO_VERTEX;
+                     w = next_vertex[w]) {
+                    float distance = attribute_distance(vertex(v), vertex(w));
+                    if (distance < best_distance) {
+                        best = w;
+                        best_distance = distance;
+                    }
+                }
+                remap[v] = best;
+            }
+
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+
+            for (uint32_t i = begin; i < end; ++i) {
+                uint32_t const * tri = &tris[3 * adjacency[i]];
+                touched[position_of[tri[0]]] = true;
+                touched[position_of[tri[1]]] = true;
+                touched[position_of[tri[2]]] = true;
+            }
+
+            removed += n_degenerate;
+            ++n_collapsed;
+        }
+
+        if (n_collapsed == 0) {
+            break;
+        }
+    }
+
+    result.resize(tris.size());
+    for (size_t i = 0; i < tris.size(); ++i) {
+        result[i] = local_to_global[tris[i]];
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef PRT3_MESH_SIMPLIFICATION_H
+#define PRT3_MESH_SIMPLIFICATION_H
+
+#include "src/engine/rendering/model.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+/* Reduces a triangle list towards target_index_count indices by
+ * collapsing edges in order of their quadric error. Vertices are
+ * collapsed onto existing vertices, so the result indexes into the same
+ * vertex buffer and stays valid for skinning. Vertices that share a
+ * position are treated as one, so meshes with hard normals or uv seams are
+ * simplified as a whole. Vertices on open borders are never moved.
+ *
+ * The result may contain more indices than requested if the mesh can not
+ * be reduced further.
+ */
+void simplify_mesh(
+    Model::Vertex const * vertices,
+    uint32_t const * indices,
+    size_t n_indices,
+    size_t target_index_count,
+    std::vector<uint32_t> & result
+);
+
+} // namespace prt3
+
+#endif
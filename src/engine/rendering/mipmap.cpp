@@ -0,0 +1,266 @@
+#include "mipmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace prt3;
+
+namespace {
+
+/* in texels of the smaller level */
+constexpr float KAISER_RADIUS = 3.0f;
+constexpr float KAISER_ALPHA = 4.0f;
+
+struct Tap {
+    int index;
+    float weight;
+};
+
+/* the taps of every texel along one axis, the taps of texel i are
+ * taps[offsets[i]] to taps[offsets[i + 1]]
+ */
+struct AxisTaps {
+    std::vector<Tap> taps;
+    std::vector<size_t> offsets;
+};
+
+} // namespace
+
+static float bessel_i0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    float half_x = 0.5f * x;
+    for (int k = 1; k < 32; ++k) {
+        term *= half_x / k;
+        float term_sq = term * term;
+        sum += term_sq;
+        if (term_sq < sum * 1e-8f) {
+            break;
+        }
+    }
+    return sum;
+}
+
+static float sinc(float x) {
+    if (std::fabs(x) < 1e-6f) {
+        return 1.0f;
+    }
+    float px = 3.14159265358979f * x;
+    return std::sin(px) / px;
+}
+
+static float filter_radius(MipFilter filter) {
+    switch (filter) {
+        case MipFilter::box: return 0.5f;
+        case MipFilter::kaiser: return KAISER_RADIUS;
+    }
+    return 0.5f;
+}
+
+/* t is the distance between texel centers, in texels of the smaller level */
+static float filter_weight(MipFilter filter, float t) {
+    switch (filter) {
+        case MipFilter::box: {
+            return std::fabs(t) <= 0.5f ? 1.0f : 0.0f;
+        }
+        case MipFilter::kaiser: {
+            float r = t / KAISER_RADIUS;
+            if (std::fabs(r) >= 1.0f) {
+                return 0.0f;
+            }
+            return sinc(t) *
+                   bessel_i0(KAISER_ALPHA * std::sqrt(1.0f - r * r)) /
+                   bessel_i0(KAISER_ALPHA);
+        }
+    }
+    return 0.0f;
+}
+
+static void compute_taps(
+    int src_size,
+    int dst_size,
+    MipFilter filter,
+    AxisTaps & axis
+) {
+    axis.taps.clear();
+    axis.offsets.clear();
+
+    float scale = static_cast<float>(src_size) / dst_size;
+    float support = filter_radius(filter) * scale;
+
+    for (int i = 0; i < dst_size; ++i) {
+        axis.offsets.push_back(axis.taps.size());
+
+        float center = (i + 0.5f) * scale;
+        int first = static_cast<int>(std::floor(center - support));
+        int last = static_cast<int>(std::ceil(center + support));
+
+        float sum = 0.0f;
+        size_t begin = axis.taps.size();
+        for (int j = first; j <= last; ++j) {
+            float weight = filter_weight(filter, (j + 0.5f - center) / scale);
+            if (weight == 0.0f) {
+                continue;
+            }
+            /* texels past the edge repeat the edge */
+            int index = std::min(std::max(j, 0), src_size - 1);
+            axis.taps.push_back({index, weight});
+            sum += weight;
+        }
+        for (size_t t = begin; t < axis.taps.size(); ++t) {
+            axis.taps[t].weight /= sum;
+        }
+    }
+    axis.offsets.push_back(axis.taps.size());
+}
+
+static void resample(
+    std::vector<float> const & src,
+    int src_width,
+    int src_height,
+    std::vector<float> & dst,
+    int dst_width,
+    int dst_height,
+    int channels,
+    MipFilter filter
+) {
+    thread_local AxisTaps x_taps;
+    thread_local AxisTaps y_taps;
+    thread_local std::vector<float> tmp;
+    compute_taps(src_width, dst_width, filter, x_taps);
+    compute_taps(src_height, dst_height, filter, y_taps);
+
+    /* horizontally into tmp, then vertically into dst */
+    tmp.resize(static_cast<size_t>(dst_width) * src_height * channels);
+    for (int y = 0; y < src_height; ++y) {
+        float const * src_row =
+            src.data() + static_cast<size_t>(y) * src_width * channels;
+        float * tmp_row =
+            tmp.data() + static_cast<size_t>(y) * dst_width * channels;
+        for (int x = 0; x < dst_width; ++x) {
+            float acc[4] = {};
+            for (size_t t = x_taps.offsets[x]; t < x_taps.offsets[x + 1]; ++t) {
+                Tap tap = x_taps.taps[t];
+                float const * texel = src_row + tap.index * channels;
+                for (int c = 0; c < channels; ++c) {
+                    acc[c] += tap.weight * texel[c];
+                }
+            }
+            for (int c = 0; c < channels; ++c) {
+                tmp_row[x * channels + c] = acc[c];
+            }
+        }
+    }
+
+    dst.resize(static_cast<size_t>(dst_width) * dst_height * channels);
+    size_t row_size = static_cast<size_t>(dst_width) * channels;
+    for (int y = 0; y < dst_height; ++y) {
+        float * dst_row = dst.data() + y * row_size;
+        std::fill(dst_row, dst_row + row_size, 0.0f);
+        for (size_t t = y_taps.offsets[y]; t < y_taps.offsets[y + 1]; ++t) {
+            Tap tap = y_taps.taps[t];
+            float const * tmp_row = tmp.data() + tap.index * row_size;
+            for (size_t i = 0; i < row_size; ++i) {
+                dst_row[i] += tap.weight * tmp_row[i];
+            }
+        }
+    }
+}
+
+int prt3::mip_level_count(int width, int height) {
+    int size = std::max(width, height);
+    int n_levels = 1;
+    while (size > 1) {
+        size /= 2;
+        ++n_levels;
+    }
+    return n_levels;
+}
+
+void prt3::mip_level_dimensions(
+    int width,
+    int height,
+    int level,
+    int & level_width,
+    int & level_height
+) {
+    level_width = std::max(width >> level, 1);
+    level_height = std::max(height >> level, 1);
+}
+
+size_t prt3::mip_chain_size(int width, int height, int channels, int n_levels) {
+    size_t size = 0;
+    for (int level = 0; level < n_levels; ++level) {
+        int w, h;
+        mip_level_dimensions(width, height, level, w, h);
+        size += static_cast<size_t>(w) * h * channels;
+    }
+    return size;
+}
+
+void prt3::generate_mip_chain(
+    unsigned char * data,
+    int width,
+    int height,
+    int channels,
+    int n_levels,
+    MipFilter filter
+) {
+    bool alpha_weighted = channels == 2 || channels == 4;
+    int alpha = channels - 1;
+    int n_colors = alpha_weighted ? channels - 1 : channels;
+
+    /* premultiplied while filtering */
+    thread_local std::vector<float> src;
+    thread_local std::vector<float> dst;
+    size_t n_texels = static_cast<size_t>(width) * height;
+    src.resize(n_texels * channels);
+    for (size_t i = 0; i < n_texels; ++i) {
+        unsigned char const * texel = data + i * channels;
+        float a = alpha_weighted ? texel[alpha] / 255.0f : 1.0f;
+        for (int c = 0; c < n_colors; ++c) {
+            src[i * channels + c] = a * (texel[c] / 255.0f);
+        }
+        if (alpha_weighted) {
+            src[i * channels + alpha] = a;
+        }
+    }
+
+    unsigned char * out = data + n_texels * channels;
+    int src_width = width;
+    int src_height = height;
+    for (int level = 1; level < n_levels; ++level) {
+        int dst_width, dst_height;
+        mip_level_dimensions(width, height, level, dst_width, dst_height);
+
+        resample(
+            src, src_width, src_height,
+            dst, dst_width, dst_height,
+            channels,
+            filter
+        );
+
+        size_t n_dst_texels = static_cast<size_t>(dst_width) * dst_height;
+        for (size_t i = 0; i < n_dst_texels; ++i) {
+            float * texel = dst.data() + i * channels;
+            /* negative lobes can overshoot */
+            float a = 1.0f;
+            if (alpha_weighted) {
+                a = std::min(std::max(texel[alpha], 0.0f), 1.0f);
+                texel[alpha] = a;
+                out[alpha] = static_cast<unsigned char>(a * 255.0f + 0.5f);
+            }
+            for (int c = 0; c < n_colors; ++c) {
+                texel[c] = std::min(std::max(texel[c], 0.0f), a);
+                float straight = a > 0.0f ? texel[c] / a : 0.0f;
+                out[c] = static_cast<unsigned char>(straight * 255.0f + 0.5f);
+            }
+            out += channels;
+        }
+
+        src.swap(dst);
+        src_width = dst_width;
+        src_height = dst_height;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef PRT3_MIPMAP_H
+#define PRT3_MIPMAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace prt3 {
+
+enum class MipFilter : uint32_t {
+    /* averages the texels that a texel of the next level covers */
+    box,
+    /* Kaiser windowed sinc, which keeps smaller levels sharper than a box
+     * filter without visible ringing
+     */
+    kaiser
+};
+
+/* the number of levels in a full mip chain, down to 1x1 */
+int mip_level_count(int width, int height);
+
+void mip_level_dimensions(
+    int width,
+    int height,
+    int level,
+    int & level_width,
+    int & level_height
+);
+
+/* the size in bytes of the first n_levels levels, tightly packed */
+size_t mip_chain_size(int width, int height, int channels, int n_levels);
+
+/* Computes levels 1 to n_levels - 1 from level 0, which is at the start of
+ * data, and writes them tightly packed after it. Every level is filtered
+ * from the previous one in floating point. Colors are weighted by alpha
+ * when there is an alpha channel, so that transparent texels do not bleed
+ * into opaque ones, but the levels are stored with straight alpha like the
+ * source.
+ */
+void generate_mip_chain(
+    unsigned char * data,
+    int width,
+    int height,
+    int channels,
+    int n_levels,
+    MipFilter filter
+);
+
+} // namespace prt3
+
+#endif
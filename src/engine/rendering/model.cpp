@@ -1,9 +1,14 @@
 #include "model.h"
 
+#include "src/engine/rendering/mesh_optimization.h"
+#include "src/engine/rendering/mesh_simplification.h"
+#include "src/engine/rendering/p3m_format.h"
 #include "src/main/args.h"
+#include "src/util/asset_manifest.h"
 #include "src/util/file_util.h"
 #include "src/util/checksum.h"
 #include "src/util/log.h"
+#include "src/util/virtual_file_system.h"
 
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/euler_angles.hpp>
@@ -15,8 +20,10 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <cstddef>
 #include <cstring>
 #include <cstdio>
+#include <sstream>
 
 using namespace prt3;
 
@@ -55,26 +62,47 @@ inline uint16_t extract_key_index(
     return index;
 }
 
-Model::Model(char const * path)
+Model::Model(char const * path, bool optimize)
  : m_path{path} {
     char const * slash = std::strrchr(path, '/');
     m_name = slash ? slash + 1 : 0;
 
     char const * extension = get_file_extension(path);
     if (strcmp(extension, PRT3_MODEL_EXT) == 0) {
-        load_prt3model(path);
+        uint32_t version;
+        if (!load_prt3model(path, 0, version)) {
+            generate_lods();
+        }
+    } else if (!optimize) {
+        load_with_assimp(path);
+        generate_lods();
     } else {
         if (!attempt_load_cached(path)) {
             load_with_assimp(path);
-            static std::string prt3_cache;
+            generate_lods();
+            optimize_meshes();
+            thread_local std::string prt3_cache;
             prt3_cache = path + cached_postfix;
 
-            CRC32String checksum = compute_crc32(path);
-            std::ofstream out(prt3_cache, std::ios::binary);
-            out.write(checksum.data(), checksum.writeable_size());
-            save_prt3model(out, prt3_cache.c_str());
+            XXH64String checksum = AssetManifest::instance().checksum(path);
+            write_file_atomic(prt3_cache, [&](std::ostream & out) {
+                out.write(checksum.data(), checksum.writeable_size());
+                save_prt3model(out);
+            });
         }
     }
+
+    compute_mesh_bounds();
+}
+
+Model Model::placeholder(std::string const & path) {
+    Model model;
+    model.m_path = path;
+    size_t slash = path.rfind('/');
+    model.m_name = slash != std::string::npos ? path.substr(slash + 1) : path;
+    model.m_nodes.emplace_back();
+    model.m_nodes.back().name = model.m_name;
+    return model;
 }
 
 int32_t Model::get_animation_index(char const * name) const {
@@ -363,13 +391,13 @@ void Model::blend_animation(
 
 std::string Model::get_texture(aiMaterial & ai_mat, aiTextureType type, char const * model_path) {
     // TODO: optimize, too many temporary strings
-    static aiString ai_path;
-    static std::string tex_path;
+    thread_local aiString ai_path;
+    thread_local std::string tex_path;
     tex_path.clear();
     if (ai_mat.GetTexture(type, 0, &ai_path) == AI_SUCCESS) {
-        static std::string rel_path;
+        thread_local std::string rel_path;
         rel_path = std::string(ai_path.C_Str());
-        static std::string model_path_str;
+        thread_local std::string model_path_str;
         model_path_str = std::string(model_path);
 
         tex_path = model_path_str.substr(0, model_path_str.rfind('/') + 1) + rel_path;
@@ -425,14 +453,183 @@ void Model::calculate_tangent_space() {
     }
 }
 
+void Model::generate_lods() {
+    if (!m_valid) {
+        return;
+    }
+
+    /* meshes below this size are cheap enough at full detail */
+    constexpr uint32_t min_triangles = 64;
+    /* levels that remove less than this fraction of the previous level
+     * are not worth the memory
+     */
+    constexpr float min_reduction = 0.2f;
+
+    std::vector<uint32_t> source;
+    std::vector<uint32_t> simplified;
+    for (Mesh & mesh : m_meshes) {
+        mesh.lods.clear();
+        if (mesh.num_indices / 3 < min_triangles) {
+            continue;
+        }
+
+        source.assign(
+            m_index_buffer.begin() + mesh.start_index,
+            m_index_buffer.begin() + mesh.start_index + mesh.num_indices
+        );
+
+        for (uint32_t level = 1; level < MAX_LODS; ++level) {
+            size_t target = 3 * ((mesh.num_indices / 3) >> level);
+            simplify_mesh(
+                m_vertex_buffer.data(),
+                source.data(),
+                source.size(),
+                target,
+                simplified
+            );
+
+            if (simplified.empty() ||
+                simplified.size() > (1.0f - min_reduction) * source.size()) {
+                break;
+            }
+
+            LOD lod;
+            lod.start_index = static_cast<uint32_t>(m_index_buffer.size());
+            lod.num_indices = static_cast<uint32_t>(simplified.size());
+            m_index_buffer.insert(
+                m_index_buffer.end(),
+                simplified.begin(),
+                simplified.end()
+            );
+            mesh.lods.push_back(lod);
+
+            if (simplified.size() / 3 < min_triangles) {
+                break;
+            }
+            source.swap(simplified);
+        }
+    }
+}
+
+void Model::optimize_meshes() {
+    if (!m_valid || m_index_buffer.empty()) {
+        return;
+    }
+
+    release_packed_vertices();
+
+    size_t n_vertices = m_vertex_buffer.size();
+    std::vector<uint32_t> optimized;
+    auto optimize_range = [&](uint32_t start_index, uint32_t num_indices) {
+        uint32_t * range = m_index_buffer.data() + start_index;
+        optimized.resize(num_indices);
+        optimize_vertex_cache(range, num_indices, n_vertices, optimized.data());
+        optimize_overdraw(m_vertex_buffer.data(), optimized.data(), num_indices);
+        std::copy(optimized.begin(), optimized.end(), range);
+    };
+
+    for (Mesh const & mesh : m_meshes) {
+        optimize_range(mesh.start_index, mesh.num_indices);
+        for (LOD const & lod : mesh.lods) {
+            optimize_range(lod.start_index, lod.num_indices);
+        }
+    }
+
+    /* levels of detail are stored after all meshes and only use vertices
+     * of their mesh, so numbering the vertices in index buffer order keeps
+     * the vertices of each mesh together
+     */
+    std::vector<uint32_t> remap;
+    uint32_t n_referenced = optimize_vertex_fetch_remap(
+        m_index_buffer.data(),
+        m_index_buffer.size(),
+        n_vertices,
+        remap
+    );
+
+    std::vector<Vertex> vertices(n_referenced);
+    for (size_t i = 0; i < n_vertices; ++i) {
+        if (remap[i] != NO_VERTEX_REMAP) {
+            vertices[remap[i]] = m_vertex_buffer[i];
+        }
+    }
+    m_vertex_buffer.swap(vertices);
+
+    if (m_vertex_bone_buffer.size() == n_vertices) {
+        std::vector<BoneData> bone_data(n_referenced);
+        for (size_t i = 0; i < n_vertices; ++i) {
+            if (remap[i] != NO_VERTEX_REMAP) {
+                bone_data[remap[i]] = m_vertex_bone_buffer[i];
+            }
+        }
+        m_vertex_bone_buffer.swap(bone_data);
+    }
+}
+
+void Model::compute_mesh_bounds() {
+    for (Mesh & mesh : m_meshes) {
+        if (mesh.num_indices == 0) {
+            continue;
+        }
+
+        uint32_t end = mesh.start_index + mesh.num_indices;
+        glm::vec3 min = m_vertex_buffer[m_index_buffer[mesh.start_index]].position;
+        glm::vec3 max = min;
+        for (uint32_t i = mesh.start_index; i < end; ++i) {
+            glm::vec3 const & pos = m_vertex_buffer[m_index_buffer[i]].position;
+            min = glm::min(min, pos);
+            max = glm::max(max, pos);
+        }
+
+        mesh.bounds_center = 0.5f * (min + max);
+        float radius2 = 0.0f;
+        for (uint32_t i = mesh.start_index; i < end; ++i) {
+            glm::vec3 d =
+                m_vertex_buffer[m_index_buffer[i]].position - mesh.bounds_center;
+            radius2 = glm::max(radius2, glm::dot(d, d));
+        }
+        mesh.bounds_radius = glm::sqrt(radius2);
+    }
+}
+
+void Model::collect_triangles(
+    uint32_t lod,
+    std::vector<glm::vec3> & triangles
+) const {
+    for (Node const & node : m_nodes) {
+        if (node.mesh_index == -1) {
+            continue;
+        }
+
+        glm::mat4 tform = node.inherited_transform.to_matrix();
+        Mesh const & mesh = m_meshes[node.mesh_index];
+        LOD range = mesh.lod(glm::min(lod, mesh.n_lods() - 1));
+
+        uint32_t end = range.start_index + range.num_indices;
+        for (uint32_t i = range.start_index; i < end; ++i) {
+            glm::vec3 const & pos = m_vertex_buffer[m_index_buffer[i]].position;
+            triangles.push_back(glm::vec3(tform * glm::vec4(pos, 1.0f)));
+        }
+    }
+}
+
 void Model::load_with_assimp(char const * path) {
     Assimp::Importer importer;
     importer.SetPropertyInteger(
         AI_CONFIG_PP_SBP_REMOVE,
         aiPrimitiveType_LINE | aiPrimitiveType_POINT);
 
-    aiScene const * scene = importer.ReadFile(
-        path,
+    thread_local std::vector<char> file;
+    if (!VirtualFileSystem::instance().read_file(path, file)) {
+        PRT3ERROR("Failed to read model file %s.\n", path);
+        m_valid = false;
+        return;
+    }
+
+    /* the extension tells assimp which importer to use */
+    aiScene const * scene = importer.ReadFileFromMemory(
+        file.data(),
+        file.size(),
         aiProcess_ValidateDataStructure    |
         aiProcess_CalcTangentSpace         |
         aiProcess_Triangulate              |
@@ -440,9 +637,9 @@ void Model::load_with_assimp(char const * path) {
         aiProcess_FindDegenerates          |
         aiProcess_JoinIdenticalVertices    |
         aiProcess_RemoveRedundantMaterials |
-        aiProcess_ImproveCacheLocality     |
         aiProcess_SortByPType              |
-        aiProcess_PopulateArmatureData
+        aiProcess_PopulateArmatureData,
+        get_file_extension(path)
     );
 
     // check if import failed
@@ -456,7 +653,7 @@ void Model::load_with_assimp(char const * path) {
     // parse materials
     m_materials.resize(scene->mNumMaterials);
     for (size_t i = 0; i < m_materials.size(); ++i) {
-        static aiString matName;
+        thread_local aiString matName;
         aiGetMaterialString(scene->mMaterials[i], AI_MATKEY_NAME, &matName);
         m_materials[i].name = matName.C_Str();
 
@@ -486,10 +683,10 @@ void Model::load_with_assimp(char const * path) {
         aiMatrix4x4 tform;
         int32_t parent_index;
     };
-    static std::vector<std::string> bone_to_name;
+    thread_local std::vector<std::string> bone_to_name;
     bone_to_name.clear();
 
-    static std::vector<TFormNode> tform_nodes;
+    thread_local std::vector<TFormNode> tform_nodes;
 
     tform_nodes.push_back({scene->mRootNode, scene->mRootNode->mTransformation, -1});
     while (!tform_nodes.empty()) {
@@ -599,7 +796,7 @@ void Model::load_with_assimp(char const * path) {
             for (size_t j = 0; j < aiMesh->mNumBones; ++j) {
                 aiBone const * bone = aiMesh->mBones[j];
 
-                static std::string bone_name;
+                thread_local std::string bone_name;
                 bone_name = bone->mName.C_Str();
 
                 bone_to_name[bi] = bone_name;
@@ -793,63 +990,69 @@ void Model::load_with_assimp(char const * path) {
     // calculate_tangent_space();
 }
 
-void Model::save_prt3model(std::ofstream & out, char const * path) const {
-    write_stream(out, m_valid);
+struct P3MOutputSection {
+    P3MSectionID id;
+    uint32_t element_size;
+    void const * data;
+    size_t size;
+};
+
+template<typename T>
+static void add_section(
+    std::vector<P3MOutputSection> & sections,
+    P3MSectionID id,
+    T const * data,
+    size_t n
+) {
+    sections.push_back({id, sizeof(T), data, n * sizeof(T)});
+}
 
-    write_stream(out, m_nodes.size());
-    for (Node const & node : m_nodes) {
-        write_stream(out, node.parent_index);
-        write_stream(out, node.mesh_index);
-        write_stream(out, node.channel_index);
-        write_stream(out, node.bone_index);
-        out << node.transform;
-        out << node.inherited_transform;
-
-        write_string(out, node.name);
-
-        write_stream(out, node.child_indices.size());
-        for (uint32_t child_index : node.child_indices) {
-            write_stream(out, child_index);
-        }
-    }
+void Model::save_prt3model(char const * path) const {
+    write_file_atomic(path, [this](std::ostream & out) {
+        save_prt3model(out);
+    });
+}
 
-    write_stream(out, m_meshes.size());
-    for (Mesh const & mesh : m_meshes) {
-        write_stream(out, mesh.start_index);
-        write_stream(out, mesh.num_indices);
-        write_stream(out, mesh.start_bone);
-        write_stream(out, mesh.num_bones);
-        write_stream(out, mesh.material_index);
-        write_stream(out, mesh.node_index);
+void Model::save_prt3model(std::ostream & out) const {
+    std::ostringstream metadata;
+    write_stream(metadata, m_valid);
 
-        write_string(out, mesh.name);
+    write_stream(metadata, m_nodes.size());
+    for (Node const & node : m_nodes) {
+        write_stream(metadata, node.parent_index);
+        write_stream(metadata, node.mesh_index);
+        write_stream(metadata, node.channel_index);
+        write_stream(metadata, node.bone_index);
+        metadata << node.transform;
+        metadata << node.inherited_transform;
+
+        write_string(metadata, node.name);
+
+        write_stream(metadata, node.child_indices.size());
+        write_stream_n(
+            metadata,
+            node.child_indices.data(),
+            node.child_indices.size()
+        );
     }
 
-    write_stream(out, m_animations.size());
-    write_stream_n(out, m_animations.data(), m_animations.size());
-
-    write_stream(out, m_channels.size());
-    out.write(
-        reinterpret_cast<char const *>(m_channels.data()),
-        m_channels.size() * sizeof(m_channels[0])
-    );
-
-    write_stream(out, m_position_keys.size());
-    write_stream_n(out, m_position_keys.data(), m_position_keys.size());
-    write_stream(out, m_position_locations.size());
-    write_stream_n(out, m_position_locations.data(), m_position_locations.size());
+    std::vector<LOD> lods;
+    write_stream(metadata, m_meshes.size());
+    for (Mesh const & mesh : m_meshes) {
+        write_stream(metadata, mesh.start_index);
+        write_stream(metadata, mesh.num_indices);
+        write_stream(metadata, mesh.start_bone);
+        write_stream(metadata, mesh.num_bones);
+        write_stream(metadata, mesh.material_index);
+        write_stream(metadata, mesh.node_index);
+        write_stream(metadata, mesh.lods.size());
 
-    write_stream(out, m_rotation_keys.size());
-    write_stream_n(out, m_rotation_keys.data(), m_rotation_keys.size());
-    write_stream(out, m_rotation_locations.size());
-    write_stream_n(out, m_rotation_locations.data(), m_rotation_locations.size());
+        write_string(metadata, mesh.name);
 
-    write_stream(out, m_scale_keys.size());
-    write_stream_n(out, m_scale_keys.data(), m_scale_keys.size());
-    write_stream(out, m_scale_locations.size());
-    write_stream_n(out, m_scale_locations.data(), m_scale_locations.size());
+        lods.insert(lods.end(), mesh.lods.begin(), mesh.lods.end());
+    }
 
-    static std::vector<std::string const *> animation_names;
+    thread_local std::vector<std::string const *> animation_names;
     assert(m_animations.size() == m_name_to_animation.size() && "sizes differ");
     animation_names.resize(m_animations.size());
 
@@ -858,60 +1061,120 @@ void Model::save_prt3model(std::ofstream & out, char const * path) const {
     }
 
     for (std::string const * name : animation_names) {
-        write_string(out, *name);
+        write_string(metadata, *name);
     }
 
-    write_stream(out, m_materials.size());
+    write_stream(metadata, m_materials.size());
     for (MeshMaterial const & material : m_materials) {
-        write_stream(out, material.name.length());
-        out.write(material.name.c_str(), material.name.length());
-
-        write_stream(out, material.albedo);
-        write_stream(out, material.metallic);
-        write_stream(out, material.roughness);
-        write_stream(out, material.ao);
-        write_stream(out, material.emissive);
-        write_stream(out, material.twosided);
-
-        write_string(out, material.albedo_map);
-        write_string(out, material.normal_map);
-        write_string(out, material.metallic_map);
-        write_string(out, material.roughness_map);
-        write_string(out, material.ambient_occlusion_map);
-    }
-
-    write_stream(out, m_vertex_buffer.size());
-    out.write(
-        reinterpret_cast<char const *>(m_vertex_buffer.data()),
-        m_vertex_buffer.size() * sizeof(m_vertex_buffer[0])
-    );
+        write_string(metadata, material.name);
+
+        write_stream(metadata, material.albedo);
+        write_stream(metadata, material.metallic);
+        write_stream(metadata, material.roughness);
+        write_stream(metadata, material.ao);
+        write_stream(metadata, material.emissive);
+        write_stream(metadata, material.twosided);
+
+        write_string(metadata, material.albedo_map);
+        write_string(metadata, material.normal_map);
+        write_string(metadata, material.metallic_map);
+        write_string(metadata, material.roughness_map);
+        write_string(metadata, material.ambient_occlusion_map);
+    }
 
-    write_stream(out, m_vertex_bone_buffer.size());
-    out.write(
-        reinterpret_cast<char const *>(m_vertex_bone_buffer.data()),
-        m_vertex_bone_buffer.size() * sizeof(m_vertex_bone_buffer[0])
-    );
+    std::string metadata_data = metadata.str();
 
-    write_stream(out, m_index_buffer.size());
-    out.write(
-        reinterpret_cast<char const *>(m_index_buffer.data()),
-        m_index_buffer.size() * sizeof(m_index_buffer[0])
-    );
+    /* indices are stored as 16 bit if every vertex can be addressed */
+    std::vector<uint16_t> short_indices;
+    bool use_short_indices = m_vertex_buffer.size() <= (1u << 16);
+    if (use_short_indices) {
+        short_indices.resize(m_index_buffer.size());
+        for (size_t i = 0; i < m_index_buffer.size(); ++i) {
+            short_indices[i] = static_cast<uint16_t>(m_index_buffer[i]);
+        }
+    }
 
-    write_stream(out, m_bones.size());
-    out.write(
-        reinterpret_cast<char const *>(m_bones.data()),
-        m_bones.size() * sizeof(m_bones[0])
-    );
+    PackedVertexFormat packed_format = choose_packed_vertex_format(*this);
+    std::vector<uint8_t> packed_vertices;
+    pack_vertices(*this, packed_format, packed_vertices);
+
+    std::vector<P3MOutputSection> sections;
+    add_section(sections, P3MSectionID::metadata,
+                metadata_data.data(), metadata_data.size());
+    add_section(sections, P3MSectionID::vertices,
+                m_vertex_buffer.data(), m_vertex_buffer.size());
+    add_section(sections, P3MSectionID::vertex_bone_data,
+                m_vertex_bone_buffer.data(), m_vertex_bone_buffer.size());
+    if (use_short_indices) {
+        add_section(sections, P3MSectionID::indices,
+                    short_indices.data(), short_indices.size());
+    } else {
+        add_section(sections, P3MSectionID::indices,
+                    m_index_buffer.data(), m_index_buffer.size());
+    }
+    add_section(sections, P3MSectionID::bones,
+                m_bones.data(), m_bones.size());
+    add_section(sections, P3MSectionID::bone_to_node,
+                m_bone_to_node.data(), m_bone_to_node.size());
+    add_section(sections, P3MSectionID::animations,
+                m_animations.data(), m_animations.size());
+    add_section(sections, P3MSectionID::channels,
+                m_channels.data(), m_channels.size());
+    add_section(sections, P3MSectionID::position_keys,
+                m_position_keys.data(), m_position_keys.size());
+    add_section(sections, P3MSectionID::position_locations,
+                m_position_locations.data(), m_position_locations.size());
+    add_section(sections, P3MSectionID::rotation_keys,
+                m_rotation_keys.data(), m_rotation_keys.size());
+    add_section(sections, P3MSectionID::rotation_locations,
+                m_rotation_locations.data(), m_rotation_locations.size());
+    add_section(sections, P3MSectionID::scale_keys,
+                m_scale_keys.data(), m_scale_keys.size());
+    add_section(sections, P3MSectionID::scale_locations,
+                m_scale_locations.data(), m_scale_locations.size());
+    add_section(sections, P3MSectionID::lods, lods.data(), lods.size());
+    add_section(sections, P3MSectionID::packed_vertex_format, &packed_format, 1);
+    add_section(sections, P3MSectionID::packed_vertices,
+                packed_vertices.data(), packed_vertices.size());
+
+    /* offsets are relative to the header, but aligned in the file, since
+     * caches are prefixed with a checksum
+     */
+    std::streamoff base = std::max(std::streamoff{0}, std::streamoff{out.tellp()});
+
+    P3MHeader header{};
+    std::memcpy(header.magic, P3M_MAGIC, sizeof(header.magic));
+    header.version = P3M_VERSION;
+    header.n_sections = static_cast<uint32_t>(sections.size());
+
+    std::vector<P3MSectionEntry> entries(sections.size());
+    uint64_t cursor = sizeof(header) + entries.size() * sizeof(entries[0]);
+    for (size_t i = 0; i < sections.size(); ++i) {
+        uint64_t misalignment = (base + cursor) % P3M_SECTION_ALIGNMENT;
+        if (misalignment != 0) {
+            cursor += P3M_SECTION_ALIGNMENT - misalignment;
+        }
 
-    for (uint32_t const & node_index : m_bone_to_node) {
-        write_stream(out, node_index);
+        entries[i].id = sections[i].id;
+        entries[i].element_size = sections[i].element_size;
+        entries[i].offset = cursor;
+        entries[i].size = sections[i].size;
+        cursor += sections[i].size;
     }
 
-    out.close();
-#ifdef __EMSCRIPTEN__
-    emscripten_save_file_via_put(path);
-#endif // __EMSCRIPTEN__
+    write_stream(out, header);
+    write_stream_n(out, entries.data(), entries.size());
+
+    uint64_t written = sizeof(header) + entries.size() * sizeof(entries[0]);
+    char const padding[P3M_SECTION_ALIGNMENT] = {};
+    for (size_t i = 0; i < sections.size(); ++i) {
+        out.write(padding, entries[i].offset - written);
+        out.write(
+            static_cast<char const *>(sections[i].data),
+            sections[i].size
+        );
+        written = entries[i].offset + entries[i].size;
+    }
 }
 
 bool Model::attempt_load_cached(char const * path) {
@@ -924,22 +1187,476 @@ bool Model::attempt_load_cached(char const * path) {
         return false;
     }
 
-    CRC32String checksum;
+    XXH64String checksum;
     std::fread(checksum.data(), 1, checksum.writeable_size(), in);
+    std::fclose(in);
 
     if (!Args::force_cached()) {
-        CRC32String current_checksum = compute_crc32(path);
+        XXH64String current_checksum =
+            AssetManifest::instance().checksum(path);
 
         if (checksum != current_checksum) {
             return false;
         }
     }
 
-    load_prt3model(in);
+    uint32_t version;
+    bool has_lods = load_prt3model(
+        cache_path.c_str(),
+        checksum.writeable_size(),
+        version
+    );
+
+    if (version == 0) {
+        /* unreadable caches are rebuilt */
+        m_valid = true;
+        return false;
+    }
+
+    if (!has_lods) {
+        generate_lods();
+    }
+
+    if (version < P3M_VERSION) {
+        /* caches in older formats are upgraded */
+        optimize_meshes();
+        write_file_atomic(cache_path, [&](std::ostream & out) {
+            out.write(checksum.data(), checksum.writeable_size());
+            save_prt3model(out);
+        });
+    }
+    return true;
+}
+
+bool Model::load_prt3model(
+    char const * path,
+    size_t offset,
+    uint32_t & version
+) {
+    auto file = std::make_shared<MappedFile>();
+    if (!VirtualFileSystem::instance().map_file(path, *file) ||
+        file->size() < offset) {
+        PRT3ERROR("Failed to read model file %s.\n", path);
+        m_valid = false;
+        version = 0;
+        return true;
+    }
+
+    P3MHeader header;
+    if (file->size() - offset >= sizeof(header)) {
+        std::memcpy(&header, file->data() + offset, sizeof(header));
+        if (std::memcmp(header.magic, P3M_MAGIC, sizeof(header.magic)) == 0) {
+            if (!load_prt3model_v2(file, offset)) {
+                PRT3ERROR("Invalid model file %s.\n", path);
+                m_valid = false;
+                version = 0;
+                return true;
+            }
+            version = header.version;
+            return true;
+        }
+    }
+
+    /* version 1 has no header and is read field by field */
+    version = 1;
+
+    std::FILE * in = fmemopen(
+        const_cast<uint8_t *>(file->data()),
+        file->size(),
+        "rb"
+    );
+    std::fseek(in, static_cast<long>(offset), SEEK_SET);
+    return load_prt3model_v1(in);
+}
+
+template<typename T>
+static void read_section(
+    uint8_t const * data,
+    P3MSectionEntry const * section,
+    std::vector<T> & v
+) {
+    if (section == nullptr) {
+        v.clear();
+        return;
+    }
+    v.resize(section->size / sizeof(T));
+    std::memcpy(v.data(), data + section->offset, v.size() * sizeof(T));
+}
+
+/* copies the packed vertex format of section, returns false if the
+ * section has the wrong size or holds flags that are not bools
+ */
+static bool read_packed_vertex_format(
+    uint8_t const * data,
+    P3MSectionEntry const & section,
+    PackedVertexFormat & format
+) {
+    if (section.size != sizeof(PackedVertexFormat)) {
+        return false;
+    }
+
+    uint8_t const * src = data + section.offset;
+    for (size_t flag : {
+            offsetof(PackedVertexFormat, quantized_positions),
+            offsetof(PackedVertexFormat, boned),
+            offsetof(PackedVertexFormat, wide_bone_ids)
+        }) {
+        if (src[flag] > 1) {
+            return false;
+        }
+    }
+
+    std::memcpy(&format, src, sizeof(format));
     return true;
 }
 
-void Model::load_prt3model(std::FILE * in) {
+static bool packed_vertex_formats_match(
+    PackedVertexFormat const & a,
+    PackedVertexFormat const & b
+) {
+    return a.quantized_positions == b.quantized_positions &&
+           a.boned == b.boned &&
+           a.wide_bone_ids == b.wide_bone_ids &&
+           a.stride == b.stride &&
+           a.position_offset == b.position_offset &&
+           a.normal_offset == b.normal_offset &&
+           a.tangent_offset == b.tangent_offset &&
+           a.texture_coordinate_offset == b.texture_coordinate_offset &&
+           a.bone_ids_offset == b.bone_ids_offset &&
+           a.bone_weights_offset == b.bone_weights_offset &&
+           a.position_transform == b.position_transform;
+}
+
+bool Model::load_prt3model_v2(
+    std::shared_ptr<MappedFile const> const & file,
+    size_t offset
+) {
+    uint8_t const * data = file->data() + offset;
+    size_t size = file->size() - offset;
+
+    P3MHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    size_t table_end =
+        sizeof(header) + size_t{header.n_sections} * sizeof(P3MSectionEntry);
+    if (header.version != P3M_VERSION || table_end > size) {
+        return false;
+    }
+
+    constexpr size_t n_known =
+        static_cast<size_t>(P3MSectionID::total_num_sections);
+    P3MSectionEntry entries[n_known];
+    P3MSectionEntry const * sections[n_known] = {};
+    for (uint32_t i = 0; i < header.n_sections; ++i) {
+        P3MSectionEntry entry;
+        std::memcpy(
+            &entry,
+            data + sizeof(header) + i * sizeof(entry),
+            sizeof(entry)
+        );
+        if (entry.offset > size || entry.size > size - entry.offset) {
+            return false;
+        }
+
+        /* sections from newer versions are skipped */
+        size_t id = static_cast<size_t>(entry.id);
+        if (id < n_known) {
+            entries[id] = entry;
+            sections[id] = &entries[id];
+        }
+    }
+
+    auto has_element_size = [&](P3MSectionID id, size_t element_size) {
+        P3MSectionEntry const * section = sections[static_cast<size_t>(id)];
+        return section == nullptr || section->element_size == element_size;
+    };
+
+    P3MSectionEntry const * index_section =
+        sections[static_cast<size_t>(P3MSectionID::indices)];
+    bool valid =
+        sections[static_cast<size_t>(P3MSectionID::metadata)] != nullptr &&
+        has_element_size(P3MSectionID::vertices, sizeof(Vertex)) &&
+        has_element_size(P3MSectionID::vertex_bone_data, sizeof(BoneData)) &&
+        (has_element_size(P3MSectionID::indices, sizeof(uint16_t)) ||
+         has_element_size(P3MSectionID::indices, sizeof(uint32_t))) &&
+        has_element_size(P3MSectionID::bones, sizeof(Bone)) &&
+        has_element_size(P3MSectionID::bone_to_node, sizeof(uint32_t)) &&
+        has_element_size(P3MSectionID::animations, sizeof(Animation)) &&
+        has_element_size(P3MSectionID::channels, sizeof(Channel)) &&
+        has_element_size(P3MSectionID::position_keys, sizeof(glm::vec3)) &&
+        has_element_size(P3MSectionID::rotation_keys, sizeof(glm::quat)) &&
+        has_element_size(P3MSectionID::scale_keys, sizeof(glm::vec3)) &&
+        has_element_size(P3MSectionID::lods, sizeof(LOD)) &&
+        has_element_size(
+            P3MSectionID::packed_vertex_format,
+            sizeof(PackedVertexFormat)
+        );
+    if (!valid) {
+        return false;
+    }
+
+    read_section(data, sections[size_t(P3MSectionID::vertices)], m_vertex_buffer);
+    read_section(data, sections[size_t(P3MSectionID::vertex_bone_data)], m_vertex_bone_buffer);
+    read_section(data, sections[size_t(P3MSectionID::bones)], m_bones);
+    read_section(data, sections[size_t(P3MSectionID::bone_to_node)], m_bone_to_node);
+    read_section(data, sections[size_t(P3MSectionID::animations)], m_animations);
+    read_section(data, sections[size_t(P3MSectionID::channels)], m_channels);
+    read_section(data, sections[size_t(P3MSectionID::position_keys)], m_position_keys);
+    read_section(data, sections[size_t(P3MSectionID::position_locations)], m_position_locations);
+    read_section(data, sections[size_t(P3MSectionID::rotation_keys)], m_rotation_keys);
+    read_section(data, sections[size_t(P3MSectionID::rotation_locations)], m_rotation_locations);
+    read_section(data, sections[size_t(P3MSectionID::scale_keys)], m_scale_keys);
+    read_section(data, sections[size_t(P3MSectionID::scale_locations)], m_scale_locations);
+
+    if (index_section != nullptr && index_section->element_size == sizeof(uint16_t)) {
+        std::vector<uint16_t> short_indices;
+        read_section(data, index_section, short_indices);
+        m_index_buffer.assign(short_indices.begin(), short_indices.end());
+    } else {
+        read_section(data, index_section, m_index_buffer);
+    }
+
+    std::vector<LOD> lods;
+    read_section(data, sections[size_t(P3MSectionID::lods)], lods);
+
+    /* a corrupt file is discarded as a whole, leaving the model as it was
+     * before, so that it can be imported again
+     */
+    auto discard = [this]() {
+        Model empty;
+        empty.m_name = std::move(m_name);
+        empty.m_path = std::move(m_path);
+        *this = std::move(empty);
+        return false;
+    };
+
+    P3MSectionEntry const * metadata_section =
+        sections[size_t(P3MSectionID::metadata)];
+    MemoryStreamBuffer buffer{
+        data + metadata_section->offset,
+        metadata_section->size
+    };
+    std::istream in{&buffer};
+
+    /* every element takes at least a byte, so counts larger than the
+     * metadata can only come from corrupt data
+     */
+    size_t max_count = metadata_section->size;
+    auto read_count = [&](size_t & count) {
+        read_stream(in, count);
+        return in && count <= max_count;
+    };
+    auto read_name = [&](std::string & name) {
+        size_t len;
+        if (!read_count(len)) return false;
+        name.resize(len);
+        in.read(name.data(), len);
+        return static_cast<bool>(in);
+    };
+
+    read_stream(in, m_valid);
+
+    size_t n_nodes;
+    if (!read_count(n_nodes)) return discard();
+    m_nodes.resize(n_nodes);
+    for (Node & node : m_nodes) {
+        read_stream(in, node.parent_index);
+        read_stream(in, node.mesh_index);
+        read_stream(in, node.channel_index);
+        read_stream(in, node.bone_index);
+
+        read_stream(in, node.transform.rotation);
+        read_stream(in, node.transform.position);
+        read_stream(in, node.transform.scale);
+
+        read_stream(in, node.inherited_transform.rotation);
+        read_stream(in, node.inherited_transform.position);
+        read_stream(in, node.inherited_transform.scale);
+
+        if (!read_name(node.name)) return discard();
+
+        size_t n_indices;
+        if (!read_count(n_indices)) return discard();
+        node.child_indices.resize(n_indices);
+        read_stream_n(in, node.child_indices.data(), n_indices);
+    }
+
+    int node_ind = 0;
+    m_name_to_node.reserve(m_nodes.size());
+    for (Node const & node : m_nodes) {
+        m_name_to_node[node.name] = node_ind;
+        ++node_ind;
+    }
+
+    size_t n_meshes;
+    if (!read_count(n_meshes)) return discard();
+    m_meshes.resize(n_meshes);
+    size_t lod_index = 0;
+    for (Mesh & mesh : m_meshes) {
+        read_stream(in, mesh.start_index);
+        read_stream(in, mesh.num_indices);
+        read_stream(in, mesh.start_bone);
+        read_stream(in, mesh.num_bones);
+        read_stream(in, mesh.material_index);
+        read_stream(in, mesh.node_index);
+
+        size_t n_lods;
+        read_stream(in, n_lods);
+        if (!in || n_lods >= MAX_LODS || n_lods > lods.size() - lod_index) {
+            return discard();
+        }
+        mesh.lods.assign(
+            lods.begin() + lod_index,
+            lods.begin() + lod_index + n_lods
+        );
+        lod_index += n_lods;
+
+        if (!read_name(mesh.name)) return discard();
+    }
+
+    m_name_to_animation.reserve(m_animations.size());
+    for (int i = 0; i < static_cast<int>(m_animations.size()); ++i) {
+        thread_local std::string name;
+        if (!read_name(name)) return discard();
+        m_name_to_animation[name] = i;
+    }
+
+    size_t n_materials;
+    if (!read_count(n_materials)) return discard();
+    m_materials.resize(n_materials);
+    for (MeshMaterial & material : m_materials) {
+        if (!read_name(material.name)) return discard();
+
+        read_stream(in, material.albedo);
+        read_stream(in, material.metallic);
+        read_stream(in, material.roughness);
+        read_stream(in, material.ao);
+        read_stream(in, material.emissive);
+        read_stream(in, material.twosided);
+
+        if (!read_name(material.albedo_map) ||
+            !read_name(material.normal_map) ||
+            !read_name(material.metallic_map) ||
+            !read_name(material.roughness_map) ||
+            !read_name(material.ambient_occlusion_map)) {
+            return discard();
+        }
+    }
+
+    if (!in || lod_index != lods.size() || !references_valid()) {
+        return discard();
+    }
+
+    /* packed vertices are handed to the renderer straight from the
+     * mapping, which is kept alive for as long as they are needed. They
+     * are only used if they are in the format that they would be packed
+     * in at upload, otherwise they are packed again.
+     */
+    P3MSectionEntry const * format_section =
+        sections[size_t(P3MSectionID::packed_vertex_format)];
+    P3MSectionEntry const * packed_section =
+        sections[size_t(P3MSectionID::packed_vertices)];
+    PackedVertexFormat format;
+    if (format_section != nullptr && packed_section != nullptr &&
+        read_packed_vertex_format(data, *format_section, format) &&
+        packed_vertex_formats_match(
+            format,
+            choose_packed_vertex_format(*this)
+        ) &&
+        packed_section->size == m_vertex_buffer.size() * format.stride) {
+        m_packed_vertex_format = format;
+        m_mapping = file;
+        m_packed_vertices = data + packed_section->offset;
+        m_packed_vertices_size = packed_section->size;
+    }
+
+    return true;
+}
+
+/* whether start + count elements fit in size, without overflowing */
+static bool range_fits(uint64_t start, uint64_t count, uint64_t size) {
+    return start <= size && count <= size - start;
+}
+
+bool Model::references_valid() const {
+    size_t n_vertices = m_vertex_buffer.size();
+    size_t n_indices = m_index_buffer.size();
+
+    for (uint32_t index : m_index_buffer) {
+        if (index >= n_vertices) return false;
+    }
+
+    if (!m_vertex_bone_buffer.empty() &&
+        m_vertex_bone_buffer.size() != n_vertices) {
+        return false;
+    }
+
+    for (Node const & node : m_nodes) {
+        if (node.parent_index < -1 ||
+            node.parent_index >= static_cast<int64_t>(m_nodes.size()) ||
+            node.mesh_index < -1 ||
+            node.mesh_index >= static_cast<int64_t>(m_meshes.size()) ||
+            node.bone_index < -1 ||
+            node.bone_index >= static_cast<int64_t>(m_bones.size()) ||
+            node.channel_index < -1) {
+            return false;
+        }
+        for (uint32_t child : node.child_indices) {
+            if (child >= m_nodes.size()) return false;
+        }
+    }
+
+    for (Mesh const & mesh : m_meshes) {
+        for (uint32_t level = 0; level < mesh.n_lods(); ++level) {
+            LOD lod = mesh.lod(level);
+            if (!range_fits(lod.start_index, lod.num_indices, n_indices)) {
+                return false;
+            }
+        }
+        if (mesh.node_index >= m_nodes.size() ||
+            mesh.material_index < 0 ||
+            mesh.material_index >= static_cast<int64_t>(m_materials.size()) ||
+            mesh.start_bone < 0 || mesh.num_bones < 0 ||
+            !range_fits(mesh.start_bone, mesh.num_bones, m_bones.size())) {
+            return false;
+        }
+    }
+
+    if (m_bone_to_node.size() != m_bones.size()) return false;
+    for (uint32_t node_index : m_bone_to_node) {
+        if (node_index >= m_nodes.size()) return false;
+    }
+
+    for (Animation const & animation : m_animations) {
+        if (!range_fits(
+                animation.start_index,
+                animation.num_indices,
+                m_channels.size()
+            )) {
+            return false;
+        }
+    }
+
+    for (Channel const & channel : m_channels) {
+        if (channel.loc_start_index > m_position_locations.size() ||
+            channel.loc_start_index > m_rotation_locations.size() ||
+            channel.loc_start_index > m_scale_locations.size() ||
+            channel.pos_start_index > m_position_keys.size() ||
+            channel.rot_start_index > m_rotation_keys.size() ||
+            channel.scale_start_index > m_scale_keys.size()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Model::release_packed_vertices() {
+    m_mapping.reset();
+    m_packed_vertices = nullptr;
+    m_packed_vertices_size = 0;
+}
+
+bool Model::load_prt3model_v1(std::FILE * in) {
     read_stream(in, m_valid);
 
     size_t n_nodes;
@@ -1029,7 +1746,7 @@ void Model::load_prt3model(std::FILE * in) {
 
     m_name_to_animation.reserve(m_animations.size());
     for (int i = 0; i < static_cast<int>(m_animations.size()); ++i) {
-        static std::string name;
+        thread_local std::string name;
         read_string(in, name);
         m_name_to_animation[name] = i;
     }
@@ -1075,4 +1792,20 @@ void Model::load_prt3model(std::FILE * in) {
     m_bone_to_node.resize(n_bones);
     read_stream_n(in, m_bones.data(), n_bones);
     read_stream_n(in, m_bone_to_node.data(), n_bones);
+
+    size_t n_lod_meshes;
+    bool has_lods =
+        std::fread(&n_lod_meshes, sizeof(n_lod_meshes), 1, in) == 1 &&
+        n_lod_meshes == m_meshes.size();
+    if (has_lods) {
+        for (Mesh & mesh : m_meshes) {
+            size_t n_lods;
+            read_stream(in, n_lods);
+            mesh.lods.resize(n_lods);
+            read_stream_n(in, mesh.lods.data(), n_lods);
+        }
+    }
+
+    std::fclose(in);
+    return has_lods;
 }
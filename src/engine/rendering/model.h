@@ -2,6 +2,8 @@
 #define PRT3_MODEL_H
 
 #include "src/engine/component/transform.h"
+#include "src/engine/rendering/packed_vertex.h"
+#include "src/util/mapped_file.h"
 #include "src/util/math_util.h"
 
 #define GLM_FORCE_RADIANS
@@ -16,6 +18,7 @@
 #include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -49,7 +52,6 @@ public:
     struct Mesh;
     struct MeshMaterial;
     struct Vertex;
-    struct BonedVertex;
     struct BoneData;
     struct Bone;
     struct Animation;
@@ -57,9 +59,21 @@ public:
     struct AnimationKey;
     struct Channel;
     struct Node;
+    struct LOD;
+
+    /* levels of detail per mesh, including the mesh itself */
+    static constexpr uint32_t MAX_LODS = 4;
 
     Model() {}
-    Model(char const * path);
+    /* if optimize is false, the model is loaded as it is stored in the
+     * source file, bypassing the cache, without mesh optimization
+     */
+    Model(char const * path, bool optimize = true);
+
+    /* an empty model, with only a root node, that stands in for the model
+     * at path while it is being loaded
+     */
+    static Model placeholder(std::string const & path);
 
     std::vector<Node>         const & nodes()              const { return m_nodes; };
     std::vector<Mesh>         const & meshes()             const { return m_meshes; };
@@ -111,8 +125,35 @@ public:
     std::string const & path() const { return m_path; }
     void set_path(std::string path) { m_path = path; }
 
-    void save_prt3model(char const * path) const
-    { std::ofstream out{path, std::ios::binary}; save_prt3model(out, path); }
+    void save_prt3model(char const * path) const;
+
+    /* appends the triangles of a level of detail of all meshes, in model
+     * space, falling back to the coarsest level a mesh has
+     */
+    void collect_triangles(
+        uint32_t lod,
+        std::vector<glm::vec3> & triangles
+    ) const;
+
+    /* Vertices in the format that they are uploaded in, if the model was
+     * loaded from a file that stores them. They point into the mapped
+     * file, so that they can be uploaded without being copied, and are
+     * only valid as long as the model is not modified.
+     */
+    uint8_t const * packed_vertices() const { return m_packed_vertices; }
+    size_t packed_vertices_size() const { return m_packed_vertices_size; }
+    PackedVertexFormat const & packed_vertex_format() const
+    { return m_packed_vertex_format; }
+    /* unmaps the file once the packed vertices are no longer needed */
+    void release_packed_vertices();
+
+    /* reorders the triangles of every mesh and level of detail for the
+     * vertex cache and overdraw, and the vertex buffer in the order that
+     * the vertices are used. Vertices of each mesh end up contiguous, so
+     * that meshes with few enough vertices can be drawn with 16-bit
+     * indices.
+     */
+    void optimize_meshes();
 
 private:
     std::string m_name;
@@ -143,18 +184,41 @@ private:
     std::unordered_map<std::string, int32_t> m_name_to_animation;
     std::unordered_map<std::string, int32_t> m_name_to_node;
 
+    std::shared_ptr<MappedFile const> m_mapping;
+    PackedVertexFormat m_packed_vertex_format = {};
+    uint8_t const * m_packed_vertices = nullptr;
+    size_t m_packed_vertices_size = 0;
+
     void calculate_tangent_space();
+    void generate_lods();
+    void compute_mesh_bounds();
     std::string get_texture(aiMaterial & aiMat, aiTextureType type, char const * model_path);
 
     void load_with_assimp(char const * path);
 
     bool attempt_load_cached(char const * path);
 
-    void save_prt3model(std::ofstream & out, char const * path) const;
-
-    void load_prt3model(std::FILE * in);
-    inline void load_prt3model(char const * path)
-    { load_prt3model(std::fopen(path, "rb")); }
+    void save_prt3model(std::ostream & out) const;
+
+    /* loads the model that starts at offset in the file, in any version
+     * of the format. version is set to the version of the file, or 0 if
+     * it could not be read. Returns false if the file predates levels of
+     * detail.
+     */
+    bool load_prt3model(char const * path, size_t offset, uint32_t & version);
+    bool load_prt3model_v1(std::FILE * in);
+    /* returns false if the file is not a valid version 2 file, or refers
+     * to data that it does not contain, in which case the model is left
+     * empty
+     */
+    bool load_prt3model_v2(
+        std::shared_ptr<MappedFile const> const & file,
+        size_t offset
+    );
+    /* whether every index and range of the model refers to data that it
+     * holds
+     */
+    bool references_valid() const;
 
 };
 
@@ -174,6 +238,11 @@ struct Model::Bone {
     glm::mat4 inverse_mesh_transform;
 };
 
+struct Model::LOD {
+    uint32_t start_index;
+    uint32_t num_indices;
+};
+
 struct Model::Mesh {
     uint32_t start_index;
     uint32_t num_indices;
@@ -183,6 +252,20 @@ struct Model::Mesh {
     uint32_t node_index;
 
     std::string name;
+
+    /* simplified versions of the mesh, from finest to coarsest */
+    std::vector<LOD> lods;
+
+    /* bounding sphere of the vertices, in model space */
+    glm::vec3 bounds_center{0.0f};
+    float bounds_radius = 0.0f;
+
+    uint32_t n_lods() const { return 1 + static_cast<uint32_t>(lods.size()); }
+
+    /* level 0 is the mesh itself */
+    LOD lod(uint32_t level) const {
+        return level == 0 ? LOD{start_index, num_indices} : lods[level - 1];
+    }
 };
 
 struct Model::MeshMaterial {
@@ -229,11 +312,6 @@ struct Model::Vertex {
     glm::vec3 bitangent;
 };
 
-struct Model::BonedVertex {
-    Vertex vertex_data;
-    BoneData bone_data;
-};
-
 } // namespace prt3
 
 #endif
\ No newline at end of file
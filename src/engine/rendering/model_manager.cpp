@@ -3,12 +3,14 @@
 #include "src/engine/scene/scene.h"
 #include "src/engine/core/context.h"
 #include "src/engine/rendering/model.h"
+#include "src/util/log.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 #include <iostream>
+#include <unordered_set>
 
 using namespace prt3;
 
@@ -39,9 +41,20 @@ void ModelManager::clear() {
     m_material_id_to_mesh_index.clear();
     m_path_to_model_handle.clear();
     m_free_handles.clear();
+    m_streaming_models.clear();
 }
 
 void ModelManager::free_model(ModelHandle handle) {
+    free_model_resources(handle);
+
+    m_path_to_model_handle.erase(m_models[handle].path());
+    m_models[handle] = Model{};
+    m_streaming_models.erase(handle);
+
+    m_free_handles.push_back(handle);
+}
+
+void ModelManager::free_model_resources(ModelHandle handle) {
     ModelResource const & res = m_model_resources.at(handle);
 
     m_context.renderer().free_model(
@@ -65,12 +78,6 @@ void ModelManager::free_model(ModelHandle handle) {
         }
         m_model_resources.erase(handle);
     }
-
-    m_path_to_model_handle.erase(m_models[handle].path());
-    m_model_resources.erase(handle);
-    m_models[handle] = Model{};
-
-    m_free_handles.push_back(handle);
 }
 
 ModelHandle ModelManager::upload_model(
@@ -98,6 +105,71 @@ ModelHandle ModelManager::upload_model(
     }
 
     ModelHandle handle = m_path_to_model_handle.at(path);
+    if (model_is_streaming(handle)) {
+        load_streaming_model(handle);
+    }
+
+    return handle;
+}
+
+ModelHandle ModelManager::request_model(std::string const & path) {
+    auto it = m_path_to_model_handle.find(path);
+    if (it != m_path_to_model_handle.end()) {
+        return it->second;
+    }
+
+    ModelHandle handle = upload_model(Model::placeholder(path));
+    m_streaming_models.insert(handle);
+    m_context.asset_loader().load_model(handle, path);
+    return handle;
+}
+
+bool ModelManager::finish_streaming(ModelHandle handle, Model && model) {
+    auto it = m_streaming_models.find(handle);
+    if (it == m_streaming_models.end() ||
+        m_models[handle].path() != model.path()) {
+        return false;
+    }
+    m_streaming_models.erase(it);
+
+    if (!model.valid()) {
+        /* the placeholder stays, so that the handle remains usable */
+        PRT3ERROR(
+            "failed to load model at path \"%s\".\n",
+            model.path().c_str()
+        );
+        return false;
+    }
+
+    upload_model(std::move(model));
+    ++m_n_models_streamed;
+    return true;
+}
+
+void ModelManager::load_streaming_model(ModelHandle handle) {
+    m_context.asset_loader().wait_for_model(handle);
+}
+
+ModelHandle ModelManager::upload_model(Model && model) {
+    ModelHandle handle;
+    auto it = m_path_to_model_handle.find(model.path());
+    if (it != m_path_to_model_handle.end()) {
+        handle = it->second;
+        if (model_is_uploaded(handle)) {
+            free_model_resources(handle);
+        }
+        m_models[handle] = std::move(model);
+    } else if (m_free_handles.empty()) {
+        handle = m_models.size();
+        m_models.push_back(std::move(model));
+    } else {
+        handle = m_free_handles.back();
+        m_free_handles.pop_back();
+        m_models[handle] = std::move(model);
+    }
+
+    m_path_to_model_handle[m_models[handle].path()] = handle;
+    upload_model(handle);
 
     return handle;
 }
@@ -145,6 +217,10 @@ NodeID ModelManager::add_model_to_scene(
 ) {
     new_nodes.clear();
 
+    if (model_is_streaming(handle)) {
+        load_streaming_model(handle);
+    }
+
     if (!model_is_uploaded(handle)) {
         upload_model(handle);
     }
@@ -221,6 +297,54 @@ NodeID ModelManager::add_model_to_scene(
     return model_node_id;
 }
 
+std::vector<ModelHandle> ModelManager::upload_models(
+    std::vector<std::string> const & paths
+) {
+    std::vector<std::string const *> new_paths;
+    std::unordered_set<std::string> seen;
+    for (std::string const & path : paths) {
+        bool known =
+            m_path_to_model_handle.find(path) != m_path_to_model_handle.end();
+        if (!known && seen.insert(path).second) {
+            new_paths.push_back(&path);
+        }
+    }
+
+    std::vector<Model> models(new_paths.size());
+    m_context.thread_pool().parallel_for(
+        new_paths.size(),
+        [&](size_t i) { models[i] = Model{new_paths[i]->c_str()}; }
+    );
+
+    /* backends are not thread safe */
+    for (Model & model : models) {
+        if (model.valid()) {
+            upload_model(std::move(model));
+        }
+    }
+
+    /* models that are already streaming are finished by the asset loader,
+     * rather than imported a second time
+     */
+    for (std::string const & path : paths) {
+        auto it = m_path_to_model_handle.find(path);
+        if (it != m_path_to_model_handle.end() &&
+            model_is_streaming(it->second)) {
+            load_streaming_model(it->second);
+        }
+    }
+
+    std::vector<ModelHandle> handles;
+    handles.reserve(paths.size());
+    for (std::string const & path : paths) {
+        auto it = m_path_to_model_handle.find(path);
+        handles.push_back(
+            it != m_path_to_model_handle.end() ? it->second : NO_MODEL
+        );
+    }
+    return handles;
+}
+
 bool ModelManager::model_is_uploaded(ModelHandle handle) {
     return m_model_resources.find(handle) != m_model_resources.end();
 }
@@ -243,6 +367,9 @@ void ModelManager::upload_model(ModelHandle handle) {
         resource.mesh_resource_ids
     );
 
+    /* the backend has its own copy of the vertices now */
+    m_models[handle].release_packed_vertices();
+
     resource.mesh_material_ids.resize(resource.mesh_resource_ids.size());
 
     thread_local std::vector<uint32_t> queue;
@@ -15,7 +15,7 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
-
+#include <unordered_set>
 
 namespace prt3 {
 
@@ -79,6 +79,25 @@ public:
     std::unordered_map<ModelHandle, ModelResource> const & model_resources() const
     { return m_model_resources; }
 
+    /* true while the handle refers to the placeholder of a model that is
+     * being loaded in the background
+     */
+    bool model_is_streaming(ModelHandle handle) const
+    { return m_streaming_models.find(handle) != m_streaming_models.end(); }
+
+    /* incremented whenever a streaming model is replaced by the real one */
+    uint32_t n_models_streamed() const { return m_n_models_streamed; }
+
+    /* Imports the models that are not loaded yet concurrently, on the
+     * thread pool of the context, and then uploads them to the backend on
+     * this thread, in order. Returns the handle of each path, or NO_MODEL
+     * if it could not be loaded. The models are not referenced by any
+     * scene until they are uploaded through it, which is then a lookup.
+     */
+    std::vector<ModelHandle> upload_models(
+        std::vector<std::string> const & paths
+    );
+
     NodeID add_model_to_scene(
         Scene & scene,
         ModelHandle handle,
@@ -123,7 +142,30 @@ private:
 
     std::vector<ModelHandle> m_free_handles;
 
+    std::unordered_set<ModelHandle> m_streaming_models;
+    uint32_t m_n_models_streamed = 0;
+
     ModelHandle upload_model(std::string const & path);
+    /* uploads a model that was built in memory. A model that is already
+     * loaded from the same path is replaced in place, so that its handle
+     * stays valid
+     */
+    ModelHandle upload_model(Model && model);
+
+    /* Returns at once with the handle of a placeholder, which the asset
+     * loader replaces in place once the model has been imported and
+     * uploaded. The handle stays valid, but the resource ids of the meshes
+     * and materials of the model are only known after that.
+     */
+    ModelHandle request_model(std::string const & path);
+    /* replaces the placeholder of a streaming model, returns false if the
+     * model failed to load or is no longer waited for
+     */
+    bool finish_streaming(ModelHandle handle, Model && model);
+    /* waits for the asset loader to finish a streaming model, for callers
+     * that need its data at once
+     */
+    void load_streaming_model(ModelHandle handle);
 
     NodeID add_model_to_scene_from_path(
         std::string const & path,
@@ -139,10 +181,13 @@ private:
 
     void clear();
     void free_model(ModelHandle handle);
+    void free_model_resources(ModelHandle handle);
 
     friend class Scene;
     friend class SceneManager;
     friend class Context;
+    friend class StaticBatches;
+    friend class AssetLoader;
 };
 
 } // namespace prt3
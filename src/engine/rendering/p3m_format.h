@@ -0,0 +1,67 @@
+#ifndef PRT3_P3M_FORMAT_H
+#define PRT3_P3M_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace prt3 {
+
+/* Layout of .p3m files from version 2 onwards.
+ *
+ * A file starts with a P3MHeader, followed by a table of n_sections
+ * P3MSectionEntry. Each section is a contiguous array whose offset, from
+ * the start of the header, is aligned so that the array is aligned to
+ * P3M_SECTION_ALIGNMENT in the file, which lets a memory mapped file be
+ * read in place. Readers skip sections that they do not know.
+ *
+ * Version 1 files have no header and start with a bool, so they never
+ * start with the magic.
+ */
+static constexpr char P3M_MAGIC[4] = {'P', '3', 'M', '\0'};
+static constexpr uint32_t P3M_VERSION = 2;
+static constexpr size_t P3M_SECTION_ALIGNMENT = 16;
+
+enum class P3MSectionID : uint32_t {
+    /* nodes, meshes, materials and animation names, serialized with
+     * write_stream
+     */
+    metadata,
+    vertices,
+    vertex_bone_data,
+    /* element_size is 2 if the model has few enough vertices */
+    indices,
+    bones,
+    bone_to_node,
+    animations,
+    channels,
+    position_keys,
+    position_locations,
+    rotation_keys,
+    rotation_locations,
+    scale_keys,
+    scale_locations,
+    /* levels of detail of all meshes, in mesh order */
+    lods,
+    /* vertices in the format that they are uploaded in */
+    packed_vertex_format,
+    packed_vertices,
+    total_num_sections
+};
+
+struct P3MHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t n_sections;
+    uint32_t reserved;
+};
+
+struct P3MSectionEntry {
+    P3MSectionID id;
+    uint32_t element_size;
+    uint64_t offset;
+    uint64_t size; // in bytes
+};
+
+} // namespace prt3
+
+#endif
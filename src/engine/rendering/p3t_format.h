@@ -0,0 +1,53 @@
+#ifndef PRT3_P3T_FORMAT_H
+#define PRT3_P3T_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace prt3 {
+
+/* Layout of cooked texture caches, which follows KTX2 in spirit.
+ *
+ * A file starts with a P3THeader, followed by a P3TLevel for each of the
+ * n_levels mip levels, from width x height down to 1x1. The levels
+ * themselves start at data_offset, which is aligned to
+ * P3T_DATA_ALIGNMENT, and are stored tightly packed, in the TextureFormat
+ * given by format. Uncompressed levels have channels bytes per texel,
+ * compressed levels consist of 4x4 texel blocks. Since the levels are
+ * stored in the layout that the backend expects, a memory mapped cache is
+ * uploaded in place.
+ */
+static constexpr char P3T_MAGIC[4] = {'P', '3', 'T', '\0'};
+static constexpr uint32_t P3T_VERSION = 2;
+static constexpr uint64_t P3T_DATA_ALIGNMENT = 16;
+
+struct P3THeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    /* of the source image */
+    uint32_t channels;
+    uint32_t n_levels;
+    /* the MipFilter that the levels were computed with */
+    uint32_t filter;
+    /* the TextureFormat of the levels */
+    uint32_t format;
+    /* the CompressionPreset that compressed levels were encoded with */
+    uint32_t preset;
+    uint32_t reserved;
+    uint64_t data_offset;
+    uint64_t data_size;
+    /* XXH64 of the source image, as a null terminated hex string */
+    char source_checksum[24];
+};
+
+struct P3TLevel {
+    /* from the start of the file */
+    uint64_t offset;
+    uint64_t size;
+};
+
+} // namespace prt3
+
+#endif
@@ -0,0 +1,203 @@
+#include "packed_vertex.h"
+
+#include "src/engine/rendering/model.h"
+
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include <cstring>
+#include <limits>
+
+using namespace prt3;
+
+static int16_t to_snorm16(float v) {
+    float clamped = glm::clamp(v, -1.0f, 1.0f);
+    return static_cast<int16_t>(glm::round(clamped * 32767.0f));
+}
+
+template<typename T>
+static void write_at(uint8_t * dst, T const & value) {
+    std::memcpy(dst, &value, sizeof(value));
+}
+
+glm::vec2 prt3::octahedral_encode(glm::vec3 n) {
+    float l1 = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+    if (l1 == 0.0f) {
+        return glm::vec2{0.0f};
+    }
+    n /= l1;
+
+    glm::vec2 e{n.x, n.y};
+    if (n.z < 0.0f) {
+        e = glm::vec2{
+            (1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+        };
+    }
+    return e;
+}
+
+glm::vec3 prt3::octahedral_decode(glm::vec2 e) {
+    glm::vec3 n{e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y)};
+    if (n.z < 0.0f) {
+        n = glm::vec3{
+            (1.0f - glm::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - glm::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f),
+            n.z
+        };
+    }
+    return glm::normalize(n);
+}
+
+PackedVertexFormat prt3::choose_packed_vertex_format(Model const & model) {
+    PackedVertexFormat format{};
+    format.boned = model.is_animated();
+    format.wide_bone_ids = model.bones().size() > 256;
+    format.position_transform = glm::mat4{1.0f};
+
+    /* skinning happens before the model transform, so positions of
+     * animated models can not be dequantized by it
+     */
+    if (!format.boned && !model.vertex_buffer().empty()) {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{std::numeric_limits<float>::lowest()};
+        for (Model::Vertex const & vertex : model.vertex_buffer()) {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+
+        glm::vec3 extent = max - min;
+        float max_extent = glm::max(extent.x, glm::max(extent.y, extent.z));
+        if (max_extent <= PackedVertexFormat::MAX_QUANTIZED_EXTENT) {
+            format.quantized_positions = true;
+            glm::vec3 half_extent = glm::max(
+                0.5f * extent,
+                glm::vec3{std::numeric_limits<float>::epsilon()}
+            );
+            format.position_transform =
+                glm::translate(0.5f * (min + max)) * glm::scale(half_extent);
+        }
+    }
+
+    uint32_t offset = 0;
+    format.position_offset = offset;
+    offset += format.quantized_positions ? 4 * sizeof(int16_t) :
+                                           4 * sizeof(float);
+    format.normal_offset = offset;
+    offset += 2 * sizeof(int16_t);
+    format.tangent_offset = offset;
+    offset += 2 * sizeof(int16_t);
+    format.texture_coordinate_offset = offset;
+    offset += 2 * sizeof(uint16_t);
+    if (format.boned) {
+        format.bone_ids_offset = offset;
+        offset += format.wide_bone_ids ? 4 * sizeof(uint16_t) :
+                                         4 * sizeof(uint8_t);
+        format.bone_weights_offset = offset;
+        offset += 4 * sizeof(uint8_t);
+    }
+    format.stride = offset;
+
+    return format;
+}
+
+void prt3::pack_vertices(
+    Model const & model,
+    PackedVertexFormat const & format,
+    std::vector<uint8_t> & data
+) {
+    std::vector<Model::Vertex> const & vertices = model.vertex_buffer();
+    std::vector<Model::BoneData> const & bone_data =
+        model.vertex_bone_buffer();
+
+    data.resize(vertices.size() * format.stride);
+
+    glm::mat4 inv_position_transform = glm::inverse(format.position_transform);
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        Model::Vertex const & vertex = vertices[i];
+        uint8_t * dst = data.data() + i * format.stride;
+
+        float bitangent_sign = glm::dot(
+            glm::cross(vertex.normal, vertex.tangent),
+            vertex.bitangent
+        ) < 0.0f ? -1.0f : 1.0f;
+
+        if (format.quantized_positions) {
+            glm::vec3 p = glm::vec3{
+                inv_position_transform * glm::vec4{vertex.position, 1.0f}
+            };
+            write_at(dst + format.position_offset, glm::i16vec4{
+                to_snorm16(p.x),
+                to_snorm16(p.y),
+                to_snorm16(p.z),
+                to_snorm16(bitangent_sign)
+            });
+        } else {
+            write_at(
+                dst + format.position_offset,
+                glm::vec4{vertex.position, bitangent_sign}
+            );
+        }
+
+        glm::vec2 normal = octahedral_encode(vertex.normal);
+        write_at(dst + format.normal_offset, glm::i16vec2{
+            to_snorm16(normal.x),
+            to_snorm16(normal.y)
+        });
+
+        glm::vec2 tangent = octahedral_encode(vertex.tangent);
+        write_at(dst + format.tangent_offset, glm::i16vec2{
+            to_snorm16(tangent.x),
+            to_snorm16(tangent.y)
+        });
+
+        write_at(dst + format.texture_coordinate_offset, glm::u16vec2{
+            glm::packHalf1x16(vertex.texture_coordinate.x),
+            glm::packHalf1x16(vertex.texture_coordinate.y)
+        });
+
+        if (!format.boned) {
+            continue;
+        }
+
+        Model::BoneData const & bones = bone_data[i];
+        if (format.wide_bone_ids) {
+            write_at(
+                dst + format.bone_ids_offset,
+                glm::u16vec4{bones.bone_ids}
+            );
+        } else {
+            write_at(
+                dst + format.bone_ids_offset,
+                glm::u8vec4{bones.bone_ids}
+            );
+        }
+
+        /* rounding is corrected on the largest weight, so that the
+         * weights still sum to one
+         */
+        glm::vec4 weights = bones.bone_weights;
+        float sum = weights.x + weights.y + weights.z + weights.w;
+        glm::u8vec4 unorm_weights{0};
+        if (sum > 0.0f) {
+            weights /= sum;
+            int total = 0;
+            int largest = 0;
+            for (int j = 0; j < 4; ++j) {
+                unorm_weights[j] = static_cast<uint8_t>(
+                    glm::round(glm::clamp(weights[j], 0.0f, 1.0f) * 255.0f)
+                );
+                total += unorm_weights[j];
+                if (weights[j] > weights[largest]) {
+                    largest = j;
+                }
+            }
+            unorm_weights[largest] = static_cast<uint8_t>(
+                unorm_weights[largest] + (255 - total)
+            );
+        }
+        write_at(dst + format.bone_weights_offset, unorm_weights);
+    }
+}
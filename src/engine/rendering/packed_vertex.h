@@ -0,0 +1,63 @@
+#ifndef PRT3_PACKED_VERTEX_H
+#define PRT3_PACKED_VERTEX_H
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+class Model;
+
+/* Compact vertex format that models are uploaded in.
+ *
+ * Normals and tangents are octahedral encoded as two snorm16 values and
+ * texture coordinates are half floats. The position has four components,
+ * the w component holds the sign of the bitangent, which is reconstructed
+ * from the normal and the tangent. Bone ids are 8 bit, or 16 bit for
+ * models with more bones than that, and bone weights are unorm8.
+ *
+ * Positions of models that are not animated are stored as snorm16
+ * relative to the bounds of the model, unless the model is too large for
+ * that to be precise. position_transform maps them back into model space.
+ * Quantization uses the bounds of the whole model rather than each mesh,
+ * since the meshes of a model share a vertex buffer.
+ */
+struct PackedVertexFormat {
+    /* largest extent of a model whose positions are quantized */
+    static constexpr float MAX_QUANTIZED_EXTENT = 256.0f;
+
+    bool quantized_positions;
+    bool boned;
+    bool wide_bone_ids;
+
+    uint32_t stride;
+    uint32_t position_offset;
+    uint32_t normal_offset;
+    uint32_t tangent_offset;
+    uint32_t texture_coordinate_offset;
+    uint32_t bone_ids_offset;
+    uint32_t bone_weights_offset;
+
+    glm::mat4 position_transform;
+};
+
+PackedVertexFormat choose_packed_vertex_format(Model const & model);
+
+void pack_vertices(
+    Model const & model,
+    PackedVertexFormat const & format,
+    std::vector<uint8_t> & data
+);
+
+/* maps a unit vector onto [-1, 1]^2 */
+glm::vec2 octahedral_encode(glm::vec3 n);
+glm::vec3 octahedral_decode(glm::vec2 e);
+
+} // namespace prt3
+
+#endif
@@ -38,6 +38,7 @@ struct MaterialOverride {
 
 struct MeshRenderData {
     ResourceID mesh_id;
+    uint32_t lod; // level of detail
     ResourceID material_id;
     MaterialOverride material_override;
     NodeData node_data;
@@ -49,15 +50,47 @@ struct AnimatedMeshRenderData {
     uint32_t bone_data_index;
 };
 
-struct DecalRenderData {
-    glm::mat4 transform;
+/* affine transforms are stored as the first three rows of their matrices */
+struct DecalAttributes {
+    std::array<glm::vec4, 3> transform;
+    std::array<glm::vec4, 3> inv_transform;
     glm::vec4 color;
-    ResourceID texture;
+    /* into the texture of the range, see TextureManager::resolve_texture */
+    glm::vec4 uv_transform;
+};
+
+struct DecalData {
+    std::vector<DecalAttributes> attributes;
+
+    struct TextureRange {
+        uint32_t start_index;
+        uint32_t count;
+        ResourceID texture;
+    };
+
+    std::vector<TextureRange> textures;
 };
 
+/* affine bone transform stored as the first three rows of its matrix */
+typedef std::array<glm::vec4, 3> BoneMatrix;
 
-struct BoneData {
-    std::array<glm::mat4, 100> bones;
+struct BonePalette {
+    uint32_t offset;
+    uint32_t count; // zero means the bind pose is used
+};
+
+/* Bone matrices of all animations, packed back to back. The data persists
+ * between frames and only palettes listed in dirty_palettes were rewritten
+ * during the current frame, unless layout_changed is set.
+ */
+struct BoneRenderData {
+    std::vector<BoneMatrix> bones;
+    /* indexed by AnimatedMeshRenderData::bone_data_index */
+    std::vector<BonePalette> palettes;
+    std::vector<uint32_t> dirty_palettes;
+    bool layout_changed = true;
+    /* identifies the scene that wrote the layout */
+    void const * source = nullptr;
 };
 
 struct WireframeRenderData {
@@ -72,9 +105,9 @@ struct PointLightRenderData {
 };
 
 struct LightRenderData {
-    static constexpr size_t MAX_NUMBER_OF_POINT_LIGHTS = 4;
-    size_t number_of_point_lights;
-    std::array<PointLightRenderData, MAX_NUMBER_OF_POINT_LIGHTS> point_lights;
+    /* lights beyond this count are culled by distance to the camera */
+    static constexpr size_t MAX_NUMBER_OF_POINT_LIGHTS = 256;
+    std::vector<PointLightRenderData> point_lights;
     DirectionalLight directional_light;
     bool directional_light_on;
     AmbientLight ambient_light;
@@ -92,9 +125,22 @@ struct RenderRect2D {
     int32_t layer;
 };
 
+/* consecutive rects of a canvas subtree, the hash changes whenever any of
+ * the rects do
+ */
+struct RenderRect2DRange {
+    uint64_t hash;
+    uint32_t start;
+    uint32_t count;
+};
+
 struct ParticleAttributes {
     glm::vec4 pos_size; // (x, y, z, size)
+    /* the center of the current frame and its size, in the texture of the
+     * range
+     */
     glm::vec2 base_uv;
+    glm::vec2 uv_size;
     std::array<uint8_t, 4> color;
 };
 
@@ -104,7 +150,6 @@ struct ParticleData {
     struct TextureRange {
         uint32_t start_index;
         uint32_t count;
-        glm::vec2 inv_div;
         ResourceID texture;
     };
 
@@ -114,11 +159,12 @@ struct ParticleData {
 struct SceneRenderData {
     std::vector<MeshRenderData> mesh_data;
     std::vector<AnimatedMeshRenderData> animated_mesh_data;
-    std::vector<BoneData> bone_data;
+    BoneRenderData bone_data;
     std::vector<MeshRenderData> selected_mesh_data;
     std::vector<AnimatedMeshRenderData> selected_animated_mesh_data;
-    std::vector<DecalRenderData> decal_data;
+    DecalData decal_data;
     std::vector<RenderRect2D> canvas_data;
+    std::vector<RenderRect2DRange> canvas_ranges;
     ParticleData particle_data;
     LightRenderData light_data;
 };
@@ -134,14 +180,20 @@ struct RenderData {
 
     void clear() {
         camera_data = {};
-        scene.light_data = {};
+        scene.light_data.point_lights.clear();
+        scene.light_data.directional_light = {};
+        scene.light_data.directional_light_on = false;
+        scene.light_data.ambient_light = {};
         scene.mesh_data.clear();
         scene.animated_mesh_data.clear();
-        scene.bone_data.clear();
+        scene.bone_data.dirty_palettes.clear();
+        scene.bone_data.layout_changed = false;
         scene.selected_mesh_data.clear();
         scene.selected_animated_mesh_data.clear();
-        scene.decal_data.clear();
+        scene.decal_data.attributes.clear();
+        scene.decal_data.textures.clear();
         scene.canvas_data.clear();
+        scene.canvas_ranges.clear();
         scene.particle_data.attributes.clear();
         scene.particle_data.textures.clear();
         editor_data.line_data.clear();
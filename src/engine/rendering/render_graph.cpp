@@ -0,0 +1,166 @@
+#include "render_graph.h"
+
+#include <algorithm>
+
+using namespace prt3;
+
+void RenderGraph::clear() {
+    m_resources.clear();
+    m_passes.clear();
+    m_active_passes.clear();
+    m_physical_textures.clear();
+}
+
+RenderGraphResourceID RenderGraph::create_texture(
+    RenderGraphTextureDesc const & desc
+) {
+    Resource resource{};
+    resource.desc = desc;
+    resource.imported = false;
+    m_resources.push_back(resource);
+    return static_cast<RenderGraphResourceID>(m_resources.size() - 1);
+}
+
+RenderGraphResourceID RenderGraph::import_resource() {
+    Resource resource{};
+    resource.imported = true;
+    m_resources.push_back(resource);
+    return static_cast<RenderGraphResourceID>(m_resources.size() - 1);
+}
+
+RenderGraphPassID RenderGraph::add_pass() {
+    m_passes.push_back({});
+    return static_cast<RenderGraphPassID>(m_passes.size() - 1);
+}
+
+void RenderGraph::read(
+    RenderGraphPassID pass,
+    RenderGraphResourceID resource
+) {
+    m_passes[pass].reads.push_back(resource);
+}
+
+void RenderGraph::write(
+    RenderGraphPassID pass,
+    RenderGraphResourceID resource
+) {
+    m_passes[pass].writes.push_back(resource);
+}
+
+void RenderGraph::mark_output(RenderGraphResourceID resource) {
+    m_resources[resource].output = true;
+}
+
+void RenderGraph::compile() {
+    cull_passes();
+    compute_lifetimes();
+    alias_textures();
+}
+
+void RenderGraph::cull_passes() {
+    /* passes are declared in execution order, so a single backwards sweep
+     * finds every pass that an output depends on
+     */
+    std::vector<bool> needed(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); ++i) {
+        needed[i] = m_resources[i].output;
+    }
+
+    for (size_t i = m_passes.size(); i-- > 0;) {
+        Pass & pass = m_passes[i];
+        pass.active = false;
+        for (RenderGraphResourceID id : pass.writes) {
+            if (needed[id]) {
+                pass.active = true;
+                break;
+            }
+        }
+
+        if (pass.active) {
+            for (RenderGraphResourceID id : pass.reads) {
+                needed[id] = true;
+            }
+        }
+    }
+
+    m_active_passes.clear();
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        if (m_passes[i].active) {
+            m_active_passes.push_back(static_cast<RenderGraphPassID>(i));
+        }
+    }
+}
+
+void RenderGraph::compute_lifetimes() {
+    for (Resource & resource : m_resources) {
+        resource.first_use = -1;
+        resource.last_use = 0;
+        resource.physical = NO_PHYSICAL_TEXTURE;
+    }
+
+    auto use = [this](RenderGraphResourceID id, uint32_t index) {
+        Resource & resource = m_resources[id];
+        resource.first_use = std::min(resource.first_use, index);
+        resource.last_use = std::max(resource.last_use, index);
+    };
+
+    for (uint32_t i = 0; i < m_active_passes.size(); ++i) {
+        Pass const & pass = m_passes[m_active_passes[i]];
+        for (RenderGraphResourceID id : pass.reads) {
+            use(id, i);
+        }
+        for (RenderGraphResourceID id : pass.writes) {
+            use(id, i);
+        }
+    }
+
+    /* outputs must outlive the graph */
+    uint32_t end = static_cast<uint32_t>(m_active_passes.size());
+    for (Resource & resource : m_resources) {
+        if (resource.output && resource.first_use != uint32_t(-1)) {
+            resource.last_use = end;
+        }
+    }
+}
+
+void RenderGraph::alias_textures() {
+    m_physical_textures.clear();
+
+    std::vector<RenderGraphResourceID> transients;
+    for (size_t i = 0; i < m_resources.size(); ++i) {
+        Resource const & resource = m_resources[i];
+        if (!resource.imported && resource.first_use != uint32_t(-1)) {
+            transients.push_back(static_cast<RenderGraphResourceID>(i));
+        }
+    }
+
+    std::stable_sort(transients.begin(), transients.end(),
+        [this](RenderGraphResourceID a, RenderGraphResourceID b) {
+            return m_resources[a].first_use < m_resources[b].first_use;
+        }
+    );
+
+    /* last active pass that uses each physical texture */
+    std::vector<uint32_t> physical_last_use;
+
+    for (RenderGraphResourceID id : transients) {
+        Resource & resource = m_resources[id];
+
+        for (size_t i = 0; i < m_physical_textures.size(); ++i) {
+            if (physical_last_use[i] < resource.first_use &&
+                m_physical_textures[i] == resource.desc) {
+                resource.physical = static_cast<uint32_t>(i);
+                break;
+            }
+        }
+
+        if (resource.physical == NO_PHYSICAL_TEXTURE) {
+            resource.physical =
+                static_cast<uint32_t>(m_physical_textures.size());
+            m_physical_textures.push_back(resource.desc);
+            physical_last_use.push_back(0);
+        }
+
+        physical_last_use[resource.physical] = resource.last_use;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef PRT3_RENDER_GRAPH_H
+#define PRT3_RENDER_GRAPH_H
+
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+typedef uint32_t RenderGraphResourceID;
+typedef uint32_t RenderGraphPassID;
+
+/* format is left to the backend, the graph only compares it */
+struct RenderGraphTextureDesc {
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+
+    bool operator==(RenderGraphTextureDesc const & other) const {
+        return width == other.width &&
+               height == other.height &&
+               format == other.format;
+    }
+};
+
+/* Passes declare the resources they read and write, in execution order.
+ * Compiling the graph culls passes that do not contribute to any output
+ * and assigns transient textures to physical textures. Transient textures
+ * whose lifetimes do not overlap share a physical texture if their
+ * descriptions match. Imported resources are owned outside of the graph
+ * and are never aliased.
+ *
+ * The graph does not touch any graphics API, backends allocate the
+ * physical textures and execute the active passes.
+ */
+class RenderGraph {
+public:
+    static constexpr uint32_t NO_PHYSICAL_TEXTURE = -1;
+
+    void clear();
+
+    RenderGraphResourceID create_texture(RenderGraphTextureDesc const & desc);
+    RenderGraphResourceID import_resource();
+
+    RenderGraphPassID add_pass();
+    void read(RenderGraphPassID pass, RenderGraphResourceID resource);
+    void write(RenderGraphPassID pass, RenderGraphResourceID resource);
+
+    /* marks a resource as needed after the graph has executed */
+    void mark_output(RenderGraphResourceID resource);
+
+    void compile();
+
+    /* valid after compile() */
+    bool pass_active(RenderGraphPassID pass) const
+    { return m_passes[pass].active; }
+
+    std::vector<RenderGraphPassID> const & active_passes() const
+    { return m_active_passes; }
+
+    /* NO_PHYSICAL_TEXTURE for imported and unused resources */
+    uint32_t physical_texture(RenderGraphResourceID resource) const
+    { return m_resources[resource].physical; }
+
+    std::vector<RenderGraphTextureDesc> const & physical_textures() const
+    { return m_physical_textures; }
+
+private:
+    struct Resource {
+        RenderGraphTextureDesc desc;
+        bool imported;
+        bool output;
+
+        /* lifetime in active passes, set on compile */
+        uint32_t first_use;
+        uint32_t last_use;
+        uint32_t physical;
+    };
+
+    struct Pass {
+        std::vector<RenderGraphResourceID> reads;
+        std::vector<RenderGraphResourceID> writes;
+        bool active;
+    };
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+
+    std::vector<RenderGraphPassID> m_active_passes;
+    std::vector<RenderGraphTextureDesc> m_physical_textures;
+
+    void cull_passes();
+    void compute_lifetimes();
+    void alias_textures();
+};
+
+} // namespace prt3
+
+#endif
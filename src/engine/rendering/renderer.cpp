@@ -1,9 +1,11 @@
 #include "renderer.h"
 
+#include "src/backend/capture/capture_renderer.h"
 #include "src/backend/dummy/dummy_renderer.h"
 #include "src/backend/opengl/gl_renderer.h"
 #include "src/engine/core/backend_type.h"
 #include "src/engine/core/context.h"
+#include "src/main/args.h"
 
 using namespace prt3;
 
@@ -67,6 +69,13 @@ Renderer::Renderer(
             break;
         }
     }
+
+    if (!m_is_dummy && !Args::capture_path().empty()) {
+        m_render_backend = new CaptureRenderer(
+            m_render_backend,
+            Args::capture_path().c_str()
+        );
+    }
 }
 
 Renderer::~Renderer() {
@@ -79,6 +79,8 @@ public:
 
     ResourceID upload_texture(TextureData const & data)
     { return m_render_backend->upload_texture(data); }
+    void update_texture(ResourceID id, TextureData const & data)
+    { m_render_backend->update_texture(id, data); }
     void free_texture(ResourceID id)
     { return m_render_backend->free_texture(id); }
 
@@ -95,12 +97,25 @@ public:
         return m_render_backend->get_internal_texture_id(id);
     }
 
-    NodeID get_selected(int x, int y) {
-        return m_render_backend->get_selected(x, y);
+    TextureFormatSupport texture_format_support() const
+    { return m_render_backend->texture_format_support(); }
+
+    RenderStats render_stats() const {
+        return m_render_backend->render_stats();
+    }
+
+    bool request_selection(int x, int y) {
+        return m_render_backend->request_selection(x, y);
+    }
+
+    bool poll_selection(NodeID & id) {
+        return m_render_backend->poll_selection(id);
     }
 
     Input & input() { return m_input; }
 
+    RenderBackend & backend() { return *m_render_backend; }
+
     int window_width() const { return m_window_width; }
     int window_height() const { return m_window_height; }
     float downscale_factor() const { return m_downscale_factor; }
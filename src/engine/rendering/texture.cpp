@@ -1,19 +1,302 @@
 #include "texture.h"
 
+#include "src/engine/rendering/mipmap.h"
+#include "src/engine/rendering/p3t_format.h"
+#include "src/main/args.h"
+#include "src/util/asset_manifest.h"
+#include "src/util/file_util.h"
+#include "src/util/log.h"
+#include "src/util/virtual_file_system.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 using namespace prt3;
 
-bool prt3::load_texture_data(char const * path, TextureData & data) {
-    data.data = stbi_load(
-        path,
-        &data.width,
-        &data.height,
-        &data.channels,
+static std::string const cached_postfix = "_prt3cache";
+
+static constexpr MipFilter cooking_filter = MipFilter::kaiser;
+
+static void set_texture_data(
+    P3THeader const & header,
+    std::shared_ptr<MappedFile const> const & file,
+    TextureData & data
+) {
+    data.width = static_cast<int>(header.width);
+    data.height = static_cast<int>(header.height);
+    data.channels = static_cast<int>(header.channels);
+    data.n_levels = static_cast<int>(header.n_levels);
+    data.format = static_cast<TextureFormat>(header.format);
+    data.data = const_cast<unsigned char *>(file->data() + header.data_offset);
+    data.storage = file;
+}
+
+static uint64_t level_table_end(uint32_t n_levels) {
+    return sizeof(P3THeader) + uint64_t{n_levels} * sizeof(P3TLevel);
+}
+
+static uint64_t data_offset(uint32_t n_levels) {
+    return (level_table_end(n_levels) + P3T_DATA_ALIGNMENT - 1) &
+           ~(P3T_DATA_ALIGNMENT - 1);
+}
+
+/* whether a cache was cooked with the current settings. Whether the
+ * texture has alpha is only known once it is decoded, so both formats are
+ * accepted.
+ */
+static bool cached_format_matches(
+    P3THeader const & header,
+    TextureUsage usage,
+    TextureCompression const & compression
+) {
+    if (header.format > static_cast<uint32_t>(TextureFormat::eac_rg11)) {
+        return false;
+    }
+    TextureFormat format = static_cast<TextureFormat>(header.format);
+
+    int width = static_cast<int>(header.width);
+    int height = static_cast<int>(header.height);
+    if (format != choose_texture_format(
+            compression, usage, width, height, false) &&
+        format != choose_texture_format(
+            compression, usage, width, height, true)) {
+        return false;
+    }
+    return !texture_format_is_compressed(format) ||
+           header.preset == static_cast<uint32_t>(compression.preset);
+}
+
+static bool load_cached_texture(
+    char const * cache_path,
+    XXH64String const & checksum,
+    TextureUsage usage,
+    TextureCompression const & compression,
+    TextureData & data
+) {
+    auto file = std::make_shared<MappedFile>();
+    if (!VirtualFileSystem::instance().map_file(cache_path, *file) ||
+        file->size() < sizeof(P3THeader)) {
+        return false;
+    }
+
+    P3THeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, P3T_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != P3T_VERSION ||
+        header.filter != static_cast<uint32_t>(cooking_filter) ||
+        !cached_format_matches(header, usage, compression)) {
+        return false;
+    }
+
+    header.source_checksum[sizeof(header.source_checksum) - 1] = '\0';
+    if (!Args::force_cached() &&
+        checksum != XXH64String{header.source_checksum}) {
+        return false;
+    }
+
+    TextureFormat format = static_cast<TextureFormat>(header.format);
+    if (header.width == 0 || header.height == 0 ||
+        header.channels == 0 || header.channels > 4 ||
+        header.n_levels == 0 || header.n_levels > 32 ||
+        header.data_offset != data_offset(header.n_levels) ||
+        header.data_size != texture_chain_size(
+            format,
+            header.width,
+            header.height,
+            header.channels,
+            header.n_levels
+        ) ||
+        file->size() < header.data_offset ||
+        file->size() - header.data_offset < header.data_size) {
+        return false;
+    }
+
+    /* levels have to be tightly packed, since they are uploaded that way */
+    uint64_t offset = header.data_offset;
+    for (uint32_t level = 0; level < header.n_levels; ++level) {
+        P3TLevel entry;
+        std::memcpy(
+            &entry,
+            file->data() + sizeof(P3THeader) + level * sizeof(P3TLevel),
+            sizeof(entry)
+        );
+        int w, h;
+        mip_level_dimensions(header.width, header.height, level, w, h);
+        if (entry.offset != offset ||
+            entry.size != texture_level_size(format, w, h, header.channels)) {
+            return false;
+        }
+        offset += entry.size;
+    }
+
+    set_texture_data(header, file, data);
+    return true;
+}
+
+static bool has_alpha(unsigned char const * texels, size_t n, int channels) {
+    if (channels != 2 && channels != 4) {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (texels[i * channels + channels - 1] != 0xff) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* decodes the image at path and computes its mip chain, compressed if
+ * compression asks for it, into a cache
+ */
+static bool cook_texture(
+    char const * path,
+    XXH64String const & checksum,
+    TextureUsage usage,
+    TextureCompression const & compression,
+    std::vector<char> & cache
+) {
+    thread_local std::vector<char> file;
+    if (!VirtualFileSystem::instance().read_file(path, file)) {
+        return false;
+    }
+
+    int width, height, channels;
+    stbi_uc * pixels = stbi_load_from_memory(
+        reinterpret_cast<stbi_uc const *>(file.data()),
+        static_cast<int>(file.size()),
+        &width,
+        &height,
+        &channels,
         0
     );
-    return data.data != 0;
+    if (pixels == nullptr) {
+        return false;
+    }
+
+    int n_levels = mip_level_count(width, height);
+    size_t n_texels = static_cast<size_t>(width) * height;
+
+    thread_local std::vector<unsigned char> levels;
+    levels.resize(mip_chain_size(width, height, channels, n_levels));
+    std::memcpy(levels.data(), pixels, n_texels * channels);
+    stbi_image_free(pixels);
+
+    generate_mip_chain(
+        levels.data(),
+        width,
+        height,
+        channels,
+        n_levels,
+        cooking_filter
+    );
+
+    TextureFormat format = choose_texture_format(
+        compression,
+        usage,
+        width,
+        height,
+        has_alpha(levels.data(), n_texels, channels)
+    );
+
+    P3THeader header = {};
+    std::memcpy(header.magic, P3T_MAGIC, sizeof(header.magic));
+    header.version = P3T_VERSION;
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.channels = static_cast<uint32_t>(channels);
+    header.n_levels = static_cast<uint32_t>(n_levels);
+    header.filter = static_cast<uint32_t>(cooking_filter);
+    header.format = static_cast<uint32_t>(format);
+    header.preset = static_cast<uint32_t>(compression.preset);
+    header.data_offset = data_offset(header.n_levels);
+    header.data_size =
+        texture_chain_size(format, width, height, channels, n_levels);
+    std::memcpy(
+        header.source_checksum,
+        checksum.data(),
+        checksum.writeable_size()
+    );
+
+    cache.assign(header.data_offset + header.data_size, 0);
+    std::memcpy(cache.data(), &header, sizeof(header));
+
+    unsigned char const * src = levels.data();
+    uint64_t offset = header.data_offset;
+    for (int level = 0; level < n_levels; ++level) {
+        int w, h;
+        mip_level_dimensions(width, height, level, w, h);
+
+        P3TLevel entry;
+        entry.offset = offset;
+        entry.size = texture_level_size(format, w, h, channels);
+        std::memcpy(
+            cache.data() + sizeof(header) + level * sizeof(entry),
+            &entry,
+            sizeof(entry)
+        );
+
+        unsigned char * dst =
+            reinterpret_cast<unsigned char *>(cache.data() + offset);
+        if (texture_format_is_compressed(format)) {
+            compress_texture(
+                src,
+                w,
+                h,
+                channels,
+                format,
+                compression.preset,
+                dst
+            );
+        } else {
+            std::memcpy(dst, src, entry.size);
+        }
+
+        src += static_cast<size_t>(w) * h * channels;
+        offset += entry.size;
+    }
+    return true;
+}
+
+bool prt3::load_texture_data(
+    char const * path,
+    TextureUsage usage,
+    TextureCompression const & compression,
+    TextureData & data
+) {
+    free_texture_data(data);
+
+    thread_local std::string cache_path;
+    cache_path = path + cached_postfix;
+
+    XXH64String checksum = AssetManifest::instance().checksum(path);
+    if (load_cached_texture(
+            cache_path.c_str(), checksum, usage, compression, data)) {
+        return true;
+    }
+
+    std::vector<char> cache;
+    if (!cook_texture(path, checksum, usage, compression, cache)) {
+        return false;
+    }
+
+    /* textures that can not be hashed can not be validated later */
+    if (checksum.len() > 0) {
+        write_file_atomic(cache_path, [&](std::ostream & out) {
+            out.write(cache.data(), cache.size());
+        });
+    }
+
+    P3THeader header;
+    std::memcpy(&header, cache.data(), sizeof(header));
+
+    auto file = std::make_shared<MappedFile>();
+    file->assign(std::move(cache));
+    set_texture_data(header, file, data);
+    return true;
 }
 
 void prt3::free_texture_data(TextureData & data) {
@@ -21,8 +304,17 @@ void prt3::free_texture_data(TextureData & data) {
     data.height = 0;
     data.channels = 0;
     data.data = nullptr;
+    data.n_levels = 1;
+    data.format = TextureFormat::uncompressed;
+    data.storage.reset();
 }
 
-void prt3::free_texture_data(unsigned char * data) {
-    stbi_image_free(data);
+size_t prt3::texture_data_size(TextureData const & data) {
+    return texture_chain_size(
+        data.format,
+        data.width,
+        data.height,
+        data.channels,
+        data.n_levels
+    );
 }
@@ -1,17 +1,46 @@
 #ifndef PRT3_TEXTURE_H
 
+#include "src/engine/rendering/texture_compression.h"
+#include "src/util/mapped_file.h"
+
+#include <cstddef>
+#include <memory>
+
 namespace prt3 {
 
 struct TextureData {
-    int width;
-    int height;
-    int channels;
-    unsigned char * data;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    /* n_levels mip levels, from width x height down, each tightly packed
+     * after the previous one. If n_levels is 1, the other levels are
+     * generated on upload.
+     */
+    unsigned char * data = nullptr;
+    int n_levels = 1;
+    /* compressed textures always come with all their levels */
+    TextureFormat format = TextureFormat::uncompressed;
+    /* owns data, if it was loaded with load_texture_data */
+    std::shared_ptr<MappedFile const> storage;
 };
 
-bool load_texture_data(char const * path, TextureData & data);
+/* Loads the texture at path with its full mip chain, in the format that
+ * choose_texture_format picks for usage and compression. The first load
+ * of a texture decodes it and writes the result to a cache next to it,
+ * later loads map the cache as long as neither the texture nor the
+ * compression settings have changed. data is left empty if the texture can
+ * not be loaded.
+ */
+bool load_texture_data(
+    char const * path,
+    TextureUsage usage,
+    TextureCompression const & compression,
+    TextureData & data
+);
 void free_texture_data(TextureData & data);
-void free_texture_data(unsigned char * data);
+
+/* the size of all mip levels of data, in bytes */
+size_t texture_data_size(TextureData const & data);
 
 } // namespace prt3
 
@@ -0,0 +1,152 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+
+using namespace prt3;
+
+static void expand_texel(
+    unsigned char const * texel,
+    int channels,
+    unsigned char * rgba
+) {
+    switch (channels) {
+        case 1: {
+            rgba[0] = rgba[1] = rgba[2] = texel[0];
+            rgba[3] = 0xff;
+            break;
+        }
+        case 2: {
+            rgba[0] = rgba[1] = rgba[2] = texel[0];
+            rgba[3] = texel[1];
+            break;
+        }
+        case 3: {
+            rgba[0] = texel[0];
+            rgba[1] = texel[1];
+            rgba[2] = texel[2];
+            rgba[3] = 0xff;
+            break;
+        }
+        default: {
+            rgba[0] = texel[0];
+            rgba[1] = texel[1];
+            rgba[2] = texel[2];
+            rgba[3] = texel[3];
+            break;
+        }
+    }
+}
+
+bool TextureAtlas::fits(TextureData const & data) {
+    return data.data != nullptr &&
+           data.format == TextureFormat::uncompressed &&
+           data.channels >= 1 && data.channels <= 4 &&
+           data.width > 0 && data.width <= MAX_ENTRY_SIZE &&
+           data.height > 0 && data.height <= MAX_ENTRY_SIZE;
+}
+
+bool TextureAtlas::insert(TextureData const & data, Entry & entry) {
+    if (!fits(data)) return false;
+
+    int w = data.width + 2 * GUTTER;
+    int h = data.height + 2 * GUTTER;
+
+    /* the shelf that wastes the least height */
+    uint32_t page_index = 0;
+    int shelf_index = -1;
+    int best_height = 0;
+    for (uint32_t i = 0; i < m_pages.size(); ++i) {
+        std::vector<Shelf> const & shelves = m_pages[i].shelves;
+        for (size_t j = 0; j < shelves.size(); ++j) {
+            Shelf const & shelf = shelves[j];
+            if (shelf.height < h || PAGE_SIZE - shelf.width < w) continue;
+
+            if (shelf_index == -1 || shelf.height < best_height) {
+                page_index = i;
+                shelf_index = static_cast<int>(j);
+                best_height = shelf.height;
+            }
+        }
+    }
+
+    if (shelf_index == -1) {
+        page_index = 0;
+        while (page_index < m_pages.size() &&
+               PAGE_SIZE - m_pages[page_index].height < h) {
+            ++page_index;
+        }
+
+        if (page_index == m_pages.size()) {
+            m_pages.emplace_back();
+            m_pages.back().texels.resize(4 * PAGE_SIZE * PAGE_SIZE);
+        }
+
+        Page & page = m_pages[page_index];
+        shelf_index = static_cast<int>(page.shelves.size());
+        page.shelves.push_back(Shelf{ page.height, h, 0 });
+        page.height += h;
+    }
+
+    Page & page = m_pages[page_index];
+    Shelf & shelf = page.shelves[shelf_index];
+
+    entry.page = page_index;
+    entry.x = shelf.width + GUTTER;
+    entry.y = shelf.y + GUTTER;
+    entry.width = data.width;
+    entry.height = data.height;
+
+    shelf.width += w;
+    ++page.n_entries;
+    page.dirty = true;
+
+    /* the gutter repeats the closest texel of the entry */
+    for (int y = -GUTTER; y < data.height + GUTTER; ++y) {
+        int src_y = std::clamp(y, 0, data.height - 1);
+        unsigned char const * src_row =
+            data.data + static_cast<size_t>(src_y) * data.width * data.channels;
+        unsigned char * dst_row = page.texels.data() +
+            4 * (static_cast<size_t>(entry.y + y) * PAGE_SIZE + entry.x);
+
+        for (int x = -GUTTER; x < data.width + GUTTER; ++x) {
+            int src_x = std::clamp(x, 0, data.width - 1);
+            expand_texel(
+                src_row + src_x * data.channels,
+                data.channels,
+                dst_row + 4 * x
+            );
+        }
+    }
+
+    return true;
+}
+
+void TextureAtlas::remove(Entry const & entry) {
+    Page & page = m_pages[entry.page];
+    --page.n_entries;
+    if (page.n_entries == 0) {
+        /* the texels are left as they are, since nothing samples them */
+        page.shelves.clear();
+        page.height = 0;
+    }
+}
+
+TextureData TextureAtlas::page_data(uint32_t page) const {
+    TextureData data;
+    data.width = PAGE_SIZE;
+    data.height = PAGE_SIZE;
+    data.channels = 4;
+    data.data = const_cast<unsigned char *>(m_pages[page].texels.data());
+    data.n_levels = 1;
+    return data;
+}
+
+glm::vec4 TextureAtlas::uv_transform(Entry const & entry) {
+    float inv_size = 1.0f / PAGE_SIZE;
+    return glm::vec4{
+        entry.x * inv_size,
+        entry.y * inv_size,
+        entry.width * inv_size,
+        entry.height * inv_size
+    };
+}
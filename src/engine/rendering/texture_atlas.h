@@ -0,0 +1,94 @@
+#ifndef PRT3_TEXTURE_ATLAS_H
+#define PRT3_TEXTURE_ATLAS_H
+
+#include "src/engine/rendering/texture.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+/* Packs small textures into shared RGBA pages, so that geometry that
+ * samples formerly distinct textures can be drawn together.
+ *
+ * Pages are filled shelf by shelf. An entry goes on the shelf that wastes
+ * the least height among those it fits on, and a new shelf is opened below
+ * the last one of the first page with room otherwise. Shelves are never
+ * reclaimed individually, a page is emptied once all of its entries have
+ * been removed. Each entry is surrounded by a gutter of its repeated edge
+ * texels, so that sampling at the edges of an entry clamps rather than
+ * reading its neighbours.
+ */
+class TextureAtlas {
+public:
+    static constexpr int PAGE_SIZE = 1024;
+    /* textures with a larger side are not packed */
+    static constexpr int MAX_ENTRY_SIZE = 128;
+    static constexpr int GUTTER = 1;
+
+    struct Entry {
+        uint32_t page;
+        /* of the first texel of the entry, inside of its gutter */
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    /* whether data is uncompressed and small enough to be packed */
+    static bool fits(TextureData const & data);
+
+    /* copies the first level of data into a page, with one or two channels
+     * expanded as luminance and luminance alpha. Returns false if data does
+     * not fit.
+     */
+    bool insert(TextureData const & data, Entry & entry);
+    void remove(Entry const & entry);
+    void clear() { m_pages.clear(); }
+
+    uint32_t n_pages() const { return static_cast<uint32_t>(m_pages.size()); }
+
+    /* the texels of page as a single level RGBA texture, valid until the
+     * next insert
+     */
+    TextureData page_data(uint32_t page) const;
+
+    /* whether page has changed since it was last marked clean */
+    bool page_dirty(uint32_t page) const { return m_pages[page].dirty; }
+    void mark_clean(uint32_t page) { m_pages[page].dirty = false; }
+
+    /* maps texture coordinates in [0, 1] of entry to coordinates of its
+     * page, as (offset, scale)
+     */
+    static glm::vec4 uv_transform(Entry const & entry);
+
+private:
+    struct Shelf {
+        int y;
+        int height;
+        /* taken from the left edge of the page */
+        int width;
+    };
+
+    struct Page {
+        std::vector<unsigned char> texels;
+        std::vector<Shelf> shelves;
+        /* taken from the top of the page */
+        int height = 0;
+        uint32_t n_entries = 0;
+        bool dirty = true;
+    };
+
+    std::vector<Page> m_pages;
+};
+
+/* applies a transform from TextureAtlas::uv_transform to uv */
+inline glm::vec2 transform_uv(glm::vec4 const & transform, glm::vec2 uv)
+{ return glm::vec2{transform.x, transform.y} +
+         glm::vec2{transform.z, transform.w} * uv; }
+
+} // namespace prt3
+
+#endif // PRT3_TEXTURE_ATLAS_H
@@ -0,0 +1,1198 @@
+#include "texture_compression.h"
+
+#include "src/engine/rendering/mipmap.h"
+#include "src/util/simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace prt3;
+
+namespace {
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+
+/* 4x4 texels in RGBA, row by row */
+struct Block {
+    uint8_t texels[16][4];
+};
+
+/* ETC1 intensity modifiers of each table, in the order of the selectors */
+alignas(16) constexpr float ETC_MODIFIERS[8][4] = {
+    {  2.0f,   8.0f,  -2.0f,   -8.0f },
+    {  5.0f,  17.0f,  -5.0f,  -17.0f },
+    {  9.0f,  29.0f,  -9.0f,  -29.0f },
+    { 13.0f,  42.0f, -13.0f,  -42.0f },
+    { 18.0f,  60.0f, -18.0f,  -60.0f },
+    { 24.0f,  80.0f, -24.0f,  -80.0f },
+    { 33.0f, 106.0f, -33.0f, -106.0f },
+    { 47.0f, 183.0f, -47.0f, -183.0f },
+};
+
+/* the texels of the two subblocks of an ETC block, without and with the
+ * flip bit, i.e. side by side and on top of each other
+ */
+constexpr int ETC_SUBBLOCKS[2][2][8] = {
+    { { 0, 1, 4, 5,  8,  9, 12, 13 }, { 2, 3, 6, 7, 10, 11, 14, 15 } },
+    { { 0, 1, 2, 3,  4,  5,  6,  7 }, { 8, 9, 10, 11, 12, 13, 14, 15 } },
+};
+
+/* EAC modifiers of each table, the smallest is at 3 and the largest at 7 */
+constexpr int EAC_MODIFIERS[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+};
+
+struct BC1Endpoints {
+    uint16_t c0;
+    uint16_t c1;
+    uint32_t indices;
+    float error;
+};
+
+struct ETCSubblock {
+    /* quantized to 4 or 5 bits */
+    int base[3];
+    int table;
+    uint8_t selectors[8];
+    float error;
+};
+
+} // namespace
+
+static inline int clamp_int(int x, int lo, int hi) {
+    return std::min(std::max(x, lo), hi);
+}
+
+static inline uint32_t read_be32(uint8_t const * in) {
+    return (uint32_t{in[0]} << 24) | (uint32_t{in[1]} << 16) |
+           (uint32_t{in[2]} << 8) | uint32_t{in[3]};
+}
+
+static inline void write_be32(uint32_t v, uint8_t * out) {
+    out[0] = static_cast<uint8_t>(v >> 24);
+    out[1] = static_cast<uint8_t>(v >> 16);
+    out[2] = static_cast<uint8_t>(v >> 8);
+    out[3] = static_cast<uint8_t>(v);
+}
+
+/* ETC and EAC index texels column by column */
+static inline int column_major(int texel) {
+    return (texel & 3) * 4 + (texel >> 2);
+}
+
+static void load_block(
+    unsigned char const * texels,
+    int width,
+    int height,
+    int channels,
+    int block_x,
+    int block_y,
+    Block & block
+) {
+    for (int y = 0; y < 4; ++y) {
+        int src_y = std::min(block_y * 4 + y, height - 1);
+        for (int x = 0; x < 4; ++x) {
+            int src_x = std::min(block_x * 4 + x, width - 1);
+            size_t index = static_cast<size_t>(src_y) * width + src_x;
+            unsigned char const * src = texels + index * channels;
+            uint8_t * dst = block.texels[y * 4 + x];
+            switch (channels) {
+                case 1: {
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3] = 0xff;
+                    break;
+                }
+                case 2: {
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3] = src[1];
+                    break;
+                }
+                case 3: {
+                    std::memcpy(dst, src, 3);
+                    dst[3] = 0xff;
+                    break;
+                }
+                default: {
+                    std::memcpy(dst, src, 4);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void store_block(
+    Block const & block,
+    int width,
+    int height,
+    int block_x,
+    int block_y,
+    unsigned char * out
+) {
+    for (int y = 0; y < 4; ++y) {
+        int dst_y = block_y * 4 + y;
+        for (int x = 0; x < 4; ++x) {
+            int dst_x = block_x * 4 + x;
+            if (dst_x >= width || dst_y >= height) {
+                continue;
+            }
+            std::memcpy(
+                out + (static_cast<size_t>(dst_y) * width + dst_x) * 4,
+                block.texels[y * 4 + x],
+                4
+            );
+        }
+    }
+}
+
+static void block_channel(Block const & block, int channel, float values[16]) {
+    for (int i = 0; i < 16; ++i) {
+        values[i] = block.texels[i][channel];
+    }
+}
+
+/* picks the nearest of eight values, returns the squared distance */
+static inline float nearest8(F32x4 lo, F32x4 hi, float value, uint8_t & index) {
+    F32x4 v = splat4(value);
+    F32x4 d0 = sub4(lo, v);
+    F32x4 d1 = sub4(hi, v);
+    alignas(16) float d[8];
+    store4(d, mul4(d0, d0));
+    store4(d + 4, mul4(d1, d1));
+
+    int best = 0;
+    for (int i = 1; i < 8; ++i) {
+        if (d[i] < d[best]) {
+            best = i;
+        }
+    }
+    index = static_cast<uint8_t>(best);
+    return d[best];
+}
+
+/* picks the nearest palette entry for every value and returns the squared
+ * error, or some error of at least limit once it is clear that the palette
+ * is not better than that
+ */
+static float select8(
+    float const palette[8],
+    float const values[16],
+    uint8_t selectors[16],
+    float limit
+) {
+    F32x4 lo = load4(palette);
+    F32x4 hi = load4(palette + 4);
+    float error = 0.0f;
+    for (int i = 0; i < 16 && error < limit; ++i) {
+        error += nearest8(lo, hi, values[i], selectors[i]);
+    }
+    return error;
+}
+
+/* BC1 */
+
+static uint16_t pack_565(float const color[3]) {
+    int r = static_cast<int>(std::lround(color[0] * (31.0f / 255.0f)));
+    int g = static_cast<int>(std::lround(color[1] * (63.0f / 255.0f)));
+    int b = static_cast<int>(std::lround(color[2] * (31.0f / 255.0f)));
+    r = clamp_int(r, 0, 31);
+    g = clamp_int(g, 0, 63);
+    b = clamp_int(b, 0, 31);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(uint16_t c, int color[3]) {
+    int r = (c >> 11) & 31;
+    int g = (c >> 5) & 63;
+    int b = c & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+/* the three color mode is used by BC1 blocks where c0 <= c1 */
+static void bc1_palette(
+    uint16_t c0,
+    uint16_t c1,
+    bool four_color,
+    int palette[4][3]
+) {
+    unpack_565(c0, palette[0]);
+    unpack_565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        int a = palette[0][c];
+        int b = palette[1][c];
+        if (four_color) {
+            palette[2][c] = (2 * a + b) / 3;
+            palette[3][c] = (a + 2 * b) / 3;
+        } else {
+            palette[2][c] = (a + b) / 2;
+            palette[3][c] = 0;
+        }
+    }
+}
+
+/* picks the nearest palette entry for every texel, returns the squared
+ * error
+ */
+static float bc1_select(
+    Block const & block,
+    int const palette[4][3],
+    uint32_t & indices
+) {
+    alignas(16) float channels[3][4];
+    for (int i = 0; i < 4; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            channels[c][i] = static_cast<float>(palette[i][c]);
+        }
+    }
+    F32x4 r = load4(channels[0]);
+    F32x4 g = load4(channels[1]);
+    F32x4 b = load4(channels[2]);
+
+    float error = 0.0f;
+    indices = 0;
+    for (int i = 0; i < 16; ++i) {
+        uint8_t const * texel = block.texels[i];
+        F32x4 dr = sub4(r, splat4(texel[0]));
+        F32x4 dg = sub4(g, splat4(texel[1]));
+        F32x4 db = sub4(b, splat4(texel[2]));
+        alignas(16) float d[4];
+        store4(d, add4(add4(mul4(dr, dr), mul4(dg, dg)), mul4(db, db)));
+
+        int best = 0;
+        for (int j = 1; j < 4; ++j) {
+            if (d[j] < d[best]) {
+                best = j;
+            }
+        }
+        indices |= static_cast<uint32_t>(best) << (2 * i);
+        error += d[best];
+    }
+    return error;
+}
+
+static BC1Endpoints bc1_try(
+    Block const & block,
+    float const e0[3],
+    float const e1[3]
+) {
+    BC1Endpoints endpoints;
+    endpoints.c0 = pack_565(e0);
+    endpoints.c1 = pack_565(e1);
+    /* c0 > c1 selects the four color mode, which BC3 always uses. Equal
+     * endpoints end up with every index at 0, which means c0 in both modes.
+     */
+    if (endpoints.c0 < endpoints.c1) {
+        std::swap(endpoints.c0, endpoints.c1);
+    }
+
+    int palette[4][3];
+    bc1_palette(endpoints.c0, endpoints.c1, true, palette);
+    endpoints.error = bc1_select(block, palette, endpoints.indices);
+    return endpoints;
+}
+
+/* the ends of the principal axis of the colors of a block, through their
+ * mean
+ */
+static void principal_endpoints(Block const & block, float e0[3], float e1[3]) {
+    float mean[3] = {};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            mean[c] += block.texels[i][c];
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        mean[c] /= 16.0f;
+    }
+
+    float cov[3][3] = {};
+    for (int i = 0; i < 16; ++i) {
+        float d[3];
+        for (int c = 0; c < 3; ++c) {
+            d[c] = block.texels[i][c] - mean[c];
+        }
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) {
+                cov[r][c] += d[r] * d[c];
+            }
+        }
+    }
+
+    /* power iteration from the column with the largest variance */
+    int start = 0;
+    for (int c = 1; c < 3; ++c) {
+        if (cov[c][c] > cov[start][start]) {
+            start = c;
+        }
+    }
+    float axis[3] = { cov[0][start], cov[1][start], cov[2][start] };
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[3];
+        for (int r = 0; r < 3; ++r) {
+            next[r] = cov[r][0] * axis[0] + cov[r][1] * axis[1] +
+                      cov[r][2] * axis[2];
+        }
+        float len = std::sqrt(
+            next[0] * next[0] + next[1] * next[1] + next[2] * next[2]
+        );
+        if (len < 1e-6f) {
+            break;
+        }
+        for (int c = 0; c < 3; ++c) {
+            axis[c] = next[c] / len;
+        }
+    }
+    float len = std::sqrt(
+        axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]
+    );
+    if (len < 1e-6f) {
+        /* a single color */
+        for (int c = 0; c < 3; ++c) {
+            e0[c] = e1[c] = mean[c];
+        }
+        return;
+    }
+    for (int c = 0; c < 3; ++c) {
+        axis[c] /= len;
+    }
+
+    float t_min = INF;
+    float t_max = -INF;
+    for (int i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+            t += (block.texels[i][c] - mean[c]) * axis[c];
+        }
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+    for (int c = 0; c < 3; ++c) {
+        e0[c] = std::min(std::max(mean[c] + t_max * axis[c], 0.0f), 255.0f);
+        e1[c] = std::min(std::max(mean[c] + t_min * axis[c], 0.0f), 255.0f);
+    }
+}
+
+/* the endpoints that minimize the squared error for fixed four color
+ * indices, false if the indices do not determine both
+ */
+static bool bc1_refine(
+    Block const & block,
+    uint32_t indices,
+    float e0[3],
+    float e1[3]
+) {
+    static constexpr float weights[4] = {
+        1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f
+    };
+
+    float aa = 0.0f;
+    float bb = 0.0f;
+    float ab = 0.0f;
+    float ax[3] = {};
+    float bx[3] = {};
+    for (int i = 0; i < 16; ++i) {
+        float a = weights[(indices >> (2 * i)) & 3];
+        float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; ++c) {
+            ax[c] += a * block.texels[i][c];
+            bx[c] += b * block.texels[i][c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) {
+        return false;
+    }
+    for (int c = 0; c < 3; ++c) {
+        e0[c] = (ax[c] * bb - bx[c] * ab) / det;
+        e1[c] = (bx[c] * aa - ax[c] * ab) / det;
+        e0[c] = std::min(std::max(e0[c], 0.0f), 255.0f);
+        e1[c] = std::min(std::max(e1[c], 0.0f), 255.0f);
+    }
+    return true;
+}
+
+static void encode_bc1(Block const & block, bool quality, uint8_t out[8]) {
+    float e0[3];
+    float e1[3];
+    principal_endpoints(block, e0, e1);
+    BC1Endpoints best = bc1_try(block, e0, e1);
+
+    /* alternate between fitting endpoints to the indices and indices to
+     * the endpoints while it helps
+     */
+    for (int i = 0; quality && i < 2 && best.error > 0.0f; ++i) {
+        if (!bc1_refine(block, best.indices, e0, e1)) {
+            break;
+        }
+        BC1Endpoints endpoints = bc1_try(block, e0, e1);
+        if (endpoints.error >= best.error) {
+            break;
+        }
+        best = endpoints;
+    }
+
+    out[0] = static_cast<uint8_t>(best.c0);
+    out[1] = static_cast<uint8_t>(best.c0 >> 8);
+    out[2] = static_cast<uint8_t>(best.c1);
+    out[3] = static_cast<uint8_t>(best.c1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<uint8_t>(best.indices >> (8 * i));
+    }
+}
+
+static void decode_bc1(uint8_t const in[8], bool four_color, Block & block) {
+    uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+    uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+    int palette[4][3];
+    bc1_palette(c0, c1, four_color || c0 > c1, palette);
+
+    for (int i = 0; i < 16; ++i) {
+        int index = (in[4 + i / 4] >> (2 * (i % 4))) & 3;
+        for (int c = 0; c < 3; ++c) {
+            block.texels[i][c] = static_cast<uint8_t>(palette[index][c]);
+        }
+    }
+}
+
+/* BC4 */
+
+/* a0 <= a1 selects six interpolated values, plus 0 and 255 */
+static void bc4_palette(int a0, int a1, float palette[8]) {
+    palette[0] = static_cast<float>(a0);
+    palette[1] = static_cast<float>(a1);
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i) {
+            int value = ((7 - i) * a0 + i * a1 + 3) / 7;
+            palette[i + 1] = static_cast<float>(value);
+        }
+    } else {
+        for (int i = 1; i < 5; ++i) {
+            int value = ((5 - i) * a0 + i * a1 + 2) / 5;
+            palette[i + 1] = static_cast<float>(value);
+        }
+        palette[6] = 0.0f;
+        palette[7] = 255.0f;
+    }
+}
+
+static void encode_bc4(float const values[16], bool quality, uint8_t out[8]) {
+    int lo = 255;
+    int hi = 0;
+    for (int i = 0; i < 16; ++i) {
+        lo = std::min(lo, static_cast<int>(values[i]));
+        hi = std::max(hi, static_cast<int>(values[i]));
+    }
+
+    float palette[8];
+    int best_a0 = hi;
+    int best_a1 = lo;
+    uint8_t best_selectors[16];
+    bc4_palette(best_a0, best_a1, palette);
+    float best = select8(palette, values, best_selectors, INF);
+
+    auto attempt = [&](int a0, int a1) {
+        uint8_t selectors[16];
+        bc4_palette(a0, a1, palette);
+        float error = select8(palette, values, selectors, best);
+        if (error < best) {
+            best = error;
+            best_a0 = a0;
+            best_a1 = a1;
+            std::memcpy(best_selectors, selectors, sizeof(selectors));
+        }
+    };
+
+    if (quality && best > 0.0f) {
+        /* slightly inset endpoints spread the interpolated values better
+         * over the bulk of the values
+         */
+        for (int d0 = 0; d0 <= 2; ++d0) {
+            for (int d1 = 0; d1 <= 2; ++d1) {
+                if ((d0 != 0 || d1 != 0) && hi - d0 > lo + d1) {
+                    attempt(hi - d0, lo + d1);
+                }
+            }
+        }
+
+        /* the six value mode represents 0 and 255 exactly */
+        int inner_lo = 255;
+        int inner_hi = 0;
+        for (int i = 0; i < 16; ++i) {
+            int v = static_cast<int>(values[i]);
+            if (v != 0 && v != 255) {
+                inner_lo = std::min(inner_lo, v);
+                inner_hi = std::max(inner_hi, v);
+            }
+        }
+        if (inner_lo <= inner_hi) {
+            attempt(inner_lo, inner_hi);
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(best_a0);
+    out[1] = static_cast<uint8_t>(best_a1);
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; ++i) {
+        bits |= static_cast<uint64_t>(best_selectors[i]) << (3 * i);
+    }
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+}
+
+static void decode_bc4(uint8_t const in[8], Block & block, int channel) {
+    float palette[8];
+    bc4_palette(in[0], in[1], palette);
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) {
+        bits |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+    }
+    for (int i = 0; i < 16; ++i) {
+        block.texels[i][channel] =
+            static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7]);
+    }
+}
+
+/* ETC2, in the individual and differential modes that it shares with
+ * ETC1
+ */
+
+static inline int etc_expand(int q, int bits) {
+    return bits == 4 ? (q << 4) | q : (q << 3) | (q >> 2);
+}
+
+/* finds the table and selectors with the smallest error for a subblock with
+ * a base color. Returns the error, or limit if no table is better.
+ */
+static float etc_subblock(
+    Block const & block,
+    int const texels[8],
+    int const base[3],
+    float limit,
+    int & table,
+    uint8_t selectors[8]
+) {
+    F32x4 zero = splat4(0.0f);
+    F32x4 full = splat4(255.0f);
+    F32x4 base_r = splat4(static_cast<float>(base[0]));
+    F32x4 base_g = splat4(static_cast<float>(base[1]));
+    F32x4 base_b = splat4(static_cast<float>(base[2]));
+
+    float best = limit;
+    for (int t = 0; t < 8; ++t) {
+        F32x4 modifiers = load4(ETC_MODIFIERS[t]);
+        F32x4 r = min4(max4(add4(base_r, modifiers), zero), full);
+        F32x4 g = min4(max4(add4(base_g, modifiers), zero), full);
+        F32x4 b = min4(max4(add4(base_b, modifiers), zero), full);
+
+        float error = 0.0f;
+        uint8_t table_selectors[8];
+        for (int i = 0; i < 8 && error < best; ++i) {
+            uint8_t const * texel = block.texels[texels[i]];
+            F32x4 dr = sub4(r, splat4(texel[0]));
+            F32x4 dg = sub4(g, splat4(texel[1]));
+            F32x4 db = sub4(b, splat4(texel[2]));
+            alignas(16) float d[4];
+            store4(d, add4(add4(mul4(dr, dr), mul4(dg, dg)), mul4(db, db)));
+
+            int nearest = 0;
+            for (int j = 1; j < 4; ++j) {
+                if (d[j] < d[nearest]) {
+                    nearest = j;
+                }
+            }
+            table_selectors[i] = static_cast<uint8_t>(nearest);
+            error += d[nearest];
+        }
+
+        if (error < best) {
+            best = error;
+            table = t;
+            std::memcpy(selectors, table_selectors, sizeof(table_selectors));
+        }
+    }
+    return best;
+}
+
+/* searches base colors, with bits per component, around the mean of a
+ * subblock, where component c is kept within [lo[c], hi[c]]
+ */
+static void etc_search(
+    Block const & block,
+    int const texels[8],
+    int bits,
+    bool quality,
+    int const lo[3],
+    int const hi[3],
+    ETCSubblock & best
+) {
+    int max_q = (1 << bits) - 1;
+    int center[3];
+    for (int c = 0; c < 3; ++c) {
+        float sum = 0.0f;
+        for (int i = 0; i < 8; ++i) {
+            sum += block.texels[texels[i]][c];
+        }
+        int q = static_cast<int>(std::lround(sum / 8.0f * max_q / 255.0f));
+        center[c] = clamp_int(q, lo[c], hi[c]);
+    }
+
+    best.error = INF;
+    int radius = quality ? 1 : 0;
+    for (int dr = -radius; dr <= radius; ++dr) {
+        for (int dg = -radius; dg <= radius; ++dg) {
+            for (int db = -radius; db <= radius; ++db) {
+                int q[3] = { center[0] + dr, center[1] + dg, center[2] + db };
+                bool valid = true;
+                for (int c = 0; c < 3; ++c) {
+                    valid = valid && q[c] >= lo[c] && q[c] <= hi[c];
+                }
+                if (!valid) {
+                    continue;
+                }
+
+                int base[3];
+                for (int c = 0; c < 3; ++c) {
+                    base[c] = etc_expand(q[c], bits);
+                }
+                int table = 0;
+                uint8_t selectors[8] = {};
+                float error = etc_subblock(
+                    block, texels, base, best.error, table, selectors
+                );
+                if (error < best.error) {
+                    best.error = error;
+                    best.table = table;
+                    std::memcpy(best.base, q, sizeof(q));
+                    std::memcpy(best.selectors, selectors, sizeof(selectors));
+                }
+            }
+        }
+    }
+}
+
+static void etc_pack(
+    bool differential,
+    int flip,
+    ETCSubblock const & s0,
+    ETCSubblock const & s1,
+    uint8_t out[8]
+) {
+    uint32_t high = 0;
+    for (int c = 0; c < 3; ++c) {
+        if (differential) {
+            int delta = s1.base[c] - s0.base[c];
+            high |= static_cast<uint32_t>(s0.base[c]) << (27 - 8 * c);
+            high |= static_cast<uint32_t>(delta & 7) << (24 - 8 * c);
+        } else {
+            high |= static_cast<uint32_t>(s0.base[c]) << (28 - 8 * c);
+            high |= static_cast<uint32_t>(s1.base[c]) << (24 - 8 * c);
+        }
+    }
+    high |= static_cast<uint32_t>(s0.table) << 5;
+    high |= static_cast<uint32_t>(s1.table) << 2;
+    high |= differential ? 2u : 0u;
+    high |= static_cast<uint32_t>(flip);
+
+    /* the high bits of the selectors in the upper half */
+    uint32_t low = 0;
+    ETCSubblock const * subblocks[2] = { &s0, &s1 };
+    for (int s = 0; s < 2; ++s) {
+        for (int i = 0; i < 8; ++i) {
+            int j = column_major(ETC_SUBBLOCKS[flip][s][i]);
+            uint32_t selector = subblocks[s]->selectors[i];
+            low |= (selector >> 1) << (j + 16);
+            low |= (selector & 1) << j;
+        }
+    }
+
+    write_be32(high, out);
+    write_be32(low, out + 4);
+}
+
+/* encodes a block with one flip and mode, returns the error */
+static float etc_encode_mode(
+    Block const & block,
+    int flip,
+    bool differential,
+    bool quality,
+    float limit,
+    uint8_t out[8]
+) {
+    static constexpr int zero[3] = { 0, 0, 0 };
+    static constexpr int max_4[3] = { 15, 15, 15 };
+    static constexpr int max_5[3] = { 31, 31, 31 };
+
+    int const * texels_0 = ETC_SUBBLOCKS[flip][0];
+    int const * texels_1 = ETC_SUBBLOCKS[flip][1];
+
+    ETCSubblock s0;
+    ETCSubblock s1;
+    if (differential) {
+        /* the second base color is stored as an offset in [-4, 3] */
+        etc_search(block, texels_0, 5, quality, zero, max_5, s0);
+        int lo[3];
+        int hi[3];
+        for (int c = 0; c < 3; ++c) {
+            lo[c] = std::max(s0.base[c] - 4, 0);
+            hi[c] = std::min(s0.base[c] + 3, 31);
+        }
+        etc_search(block, texels_1, 5, quality, lo, hi, s1);
+    } else {
+        etc_search(block, texels_0, 4, quality, zero, max_4, s0);
+        etc_search(block, texels_1, 4, quality, zero, max_4, s1);
+    }
+
+    float error = s0.error + s1.error;
+    if (error < limit) {
+        etc_pack(differential, flip, s0, s1, out);
+    }
+    return error;
+}
+
+static void encode_etc(Block const & block, bool quality, uint8_t out[8]) {
+    float best = INF;
+    int best_flip = 0;
+    bool best_differential = false;
+    for (int flip = 0; flip < 2; ++flip) {
+        for (int differential = 0; differential < 2; ++differential) {
+            float error = etc_encode_mode(
+                block, flip, differential != 0, false, best, out
+            );
+            if (error < best) {
+                best = error;
+                best_flip = flip;
+                best_differential = differential != 0;
+            }
+        }
+    }
+
+    /* the neighbouring base colors are only searched for the best mode */
+    if (quality && best > 0.0f) {
+        etc_encode_mode(block, best_flip, best_differential, true, best, out);
+    }
+}
+
+static void decode_etc(uint8_t const in[8], Block & block) {
+    uint32_t high = read_be32(in);
+    uint32_t low = read_be32(in + 4);
+    bool differential = (high & 2) != 0;
+    int flip = high & 1;
+
+    int base[2][3];
+    for (int c = 0; c < 3; ++c) {
+        if (differential) {
+            int q0 = (high >> (27 - 8 * c)) & 31;
+            int delta = (high >> (24 - 8 * c)) & 7;
+            delta = delta >= 4 ? delta - 8 : delta;
+            base[0][c] = etc_expand(q0, 5);
+            base[1][c] = etc_expand(q0 + delta, 5);
+        } else {
+            base[0][c] = etc_expand((high >> (28 - 8 * c)) & 15, 4);
+            base[1][c] = etc_expand((high >> (24 - 8 * c)) & 15, 4);
+        }
+    }
+    int tables[2] = {
+        static_cast<int>((high >> 5) & 7),
+        static_cast<int>((high >> 2) & 7)
+    };
+
+    for (int s = 0; s < 2; ++s) {
+        for (int i = 0; i < 8; ++i) {
+            int texel = ETC_SUBBLOCKS[flip][s][i];
+            int j = column_major(texel);
+            int selector = (((low >> (j + 16)) & 1) << 1) | ((low >> j) & 1);
+            int modifier = static_cast<int>(ETC_MODIFIERS[tables[s]][selector]);
+            for (int c = 0; c < 3; ++c) {
+                block.texels[texel][c] = static_cast<uint8_t>(
+                    clamp_int(base[s][c] + modifier, 0, 255)
+                );
+            }
+        }
+    }
+}
+
+/* EAC, either 8 bit alpha or an 11 bit channel */
+
+static void eac_palette(
+    int base,
+    int multiplier,
+    int table,
+    bool eleven,
+    float palette[8]
+) {
+    for (int i = 0; i < 8; ++i) {
+        int modifier = EAC_MODIFIERS[table][i];
+        int value;
+        if (eleven) {
+            value = base * 8 + 4 + (multiplier == 0 ?
+                modifier : modifier * multiplier * 8);
+            value = clamp_int(value, 0, 2047);
+        } else {
+            value = clamp_int(base + modifier * multiplier, 0, 255);
+        }
+        palette[i] = static_cast<float>(value);
+    }
+}
+
+static void encode_eac(
+    float const channel[16],
+    bool eleven,
+    bool quality,
+    uint8_t out[8]
+) {
+    /* the error is measured in the units of the decoded values */
+    float scale = eleven ? 2047.0f / 255.0f : 1.0f;
+    float step = eleven ? 8.0f : 1.0f;
+    float values[16];
+    float lo = INF;
+    float hi = -INF;
+    for (int i = 0; i < 16; ++i) {
+        values[i] = channel[i] * scale;
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+
+    float best = INF;
+    int best_base = 0;
+    int best_multiplier = 1;
+    int best_table = 0;
+    uint8_t best_selectors[16] = {};
+
+    int radius = quality ? 1 : 0;
+    for (int table = 0; table < 16 && best > 0.0f; ++table) {
+        /* spread the table over the range of the values. A multiplier of 0
+         * is avoided, since it is not valid for alpha.
+         */
+        int mod_lo = EAC_MODIFIERS[table][3];
+        int mod_hi = EAC_MODIFIERS[table][7];
+        int multiplier = static_cast<int>(
+            std::lround((hi - lo) / ((mod_hi - mod_lo) * step))
+        );
+        multiplier = clamp_int(multiplier, 1, 15);
+        float center = 0.5f * (lo + hi) -
+                       0.5f * (mod_lo + mod_hi) * multiplier * step;
+        int base = static_cast<int>(
+            std::lround(eleven ? (center - 4.0f) / 8.0f : center)
+        );
+        base = clamp_int(base, 0, 255);
+
+        for (int dm = -radius; dm <= radius; ++dm) {
+            int m = multiplier + dm;
+            if (m < 1 || m > 15) {
+                continue;
+            }
+            for (int db = -radius; db <= radius; ++db) {
+                int b = base + db;
+                if (b < 0 || b > 255) {
+                    continue;
+                }
+
+                alignas(16) float palette[8];
+                uint8_t selectors[16];
+                eac_palette(b, m, table, eleven, palette);
+                float error = select8(palette, values, selectors, best);
+                if (error < best) {
+                    best = error;
+                    best_base = b;
+                    best_multiplier = m;
+                    best_table = table;
+                    std::memcpy(best_selectors, selectors, sizeof(selectors));
+                }
+            }
+        }
+    }
+
+    uint32_t high = (static_cast<uint32_t>(best_base) << 24) |
+                    (static_cast<uint32_t>(best_multiplier) << 20) |
+                    (static_cast<uint32_t>(best_table) << 16);
+    uint32_t low = 0;
+    for (int i = 0; i < 16; ++i) {
+        /* 48 bits of selectors, the first in the highest bits */
+        int shift = 45 - 3 * column_major(i);
+        uint64_t selector = static_cast<uint64_t>(best_selectors[i]) << shift;
+        high |= static_cast<uint32_t>(selector >> 32);
+        low |= static_cast<uint32_t>(selector);
+    }
+    write_be32(high, out);
+    write_be32(low, out + 4);
+}
+
+static void decode_eac(
+    uint8_t const in[8],
+    bool eleven,
+    Block & block,
+    int channel
+) {
+    uint64_t bits = (static_cast<uint64_t>(read_be32(in)) << 32) |
+                    read_be32(in + 4);
+    int base = static_cast<int>(bits >> 56);
+    int multiplier = static_cast<int>((bits >> 52) & 15);
+    int table = static_cast<int>((bits >> 48) & 15);
+
+    float palette[8];
+    eac_palette(base, multiplier, table, eleven, palette);
+    for (int i = 0; i < 16; ++i) {
+        int selector = (bits >> (45 - 3 * column_major(i))) & 7;
+        int value = static_cast<int>(palette[selector]);
+        if (eleven) {
+            value = (value * 255 + 1023) / 2047;
+        }
+        block.texels[i][channel] = static_cast<uint8_t>(value);
+    }
+}
+
+static size_t block_size(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::bc1:
+        case TextureFormat::etc2_rgb: return 8;
+        case TextureFormat::bc3:
+        case TextureFormat::bc5:
+        case TextureFormat::etc2_rgba:
+        case TextureFormat::eac_rg11: return 16;
+        case TextureFormat::uncompressed: return 0;
+    }
+    return 0;
+}
+
+static bool is_power_of_two(int x) {
+    return x > 0 && (x & (x - 1)) == 0;
+}
+
+TextureFormat prt3::choose_texture_format(
+    TextureCompression const & compression,
+    TextureUsage usage,
+    int width,
+    int height,
+    bool has_alpha
+) {
+    int max_side = std::max(width, height);
+    if (!compression.enabled ||
+        max_side <= compression.uncompressed_max_size ||
+        width < 4 || height < 4 ||
+        !is_power_of_two(width) || !is_power_of_two(height)) {
+        return TextureFormat::uncompressed;
+    }
+
+    TextureFormatSupport const & support = compression.support;
+    if (usage == TextureUsage::normal_map) {
+        if (support.rgtc) {
+            return TextureFormat::bc5;
+        }
+        if (support.etc2) {
+            return TextureFormat::eac_rg11;
+        }
+        return TextureFormat::uncompressed;
+    }
+
+    if (support.s3tc) {
+        return has_alpha ? TextureFormat::bc3 : TextureFormat::bc1;
+    }
+    if (support.etc2) {
+        return has_alpha ? TextureFormat::etc2_rgba : TextureFormat::etc2_rgb;
+    }
+    return TextureFormat::uncompressed;
+}
+
+size_t prt3::texture_level_size(
+    TextureFormat format,
+    int width,
+    int height,
+    int channels
+) {
+    if (!texture_format_is_compressed(format)) {
+        return static_cast<size_t>(width) * height * channels;
+    }
+    size_t n_blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+    return n_blocks * block_size(format);
+}
+
+size_t prt3::texture_chain_size(
+    TextureFormat format,
+    int width,
+    int height,
+    int channels,
+    int n_levels
+) {
+    size_t size = 0;
+    for (int level = 0; level < n_levels; ++level) {
+        int w, h;
+        mip_level_dimensions(width, height, level, w, h);
+        size += texture_level_size(format, w, h, channels);
+    }
+    return size;
+}
+
+void prt3::compress_texture(
+    unsigned char const * texels,
+    int width,
+    int height,
+    int channels,
+    TextureFormat format,
+    CompressionPreset preset,
+    unsigned char * out
+) {
+    bool quality = preset == CompressionPreset::quality;
+    int n_blocks_x = (width + 3) / 4;
+    int n_blocks_y = (height + 3) / 4;
+
+    Block block;
+    float values[16];
+    for (int by = 0; by < n_blocks_y; ++by) {
+        for (int bx = 0; bx < n_blocks_x; ++bx) {
+            load_block(texels, width, height, channels, bx, by, block);
+            switch (format) {
+                case TextureFormat::bc1: {
+                    encode_bc1(block, quality, out);
+                    break;
+                }
+                case TextureFormat::bc3: {
+                    block_channel(block, 3, values);
+                    encode_bc4(values, quality, out);
+                    encode_bc1(block, quality, out + 8);
+                    break;
+                }
+                case TextureFormat::bc5: {
+                    block_channel(block, 0, values);
+                    encode_bc4(values, quality, out);
+                    block_channel(block, 1, values);
+                    encode_bc4(values, quality, out + 8);
+                    break;
+                }
+                case TextureFormat::etc2_rgb: {
+                    encode_etc(block, quality, out);
+                    break;
+                }
+                case TextureFormat::etc2_rgba: {
+                    block_channel(block, 3, values);
+                    encode_eac(values, false, quality, out);
+                    encode_etc(block, quality, out + 8);
+                    break;
+                }
+                case TextureFormat::eac_rg11: {
+                    block_channel(block, 0, values);
+                    encode_eac(values, true, quality, out);
+                    block_channel(block, 1, values);
+                    encode_eac(values, true, quality, out + 8);
+                    break;
+                }
+                case TextureFormat::uncompressed: {
+                    return;
+                }
+            }
+            out += block_size(format);
+        }
+    }
+}
+
+void prt3::decompress_texture(
+    unsigned char const * blocks,
+    int width,
+    int height,
+    TextureFormat format,
+    unsigned char * out
+) {
+    int n_blocks_x = (width + 3) / 4;
+    int n_blocks_y = (height + 3) / 4;
+
+    Block block;
+    for (int by = 0; by < n_blocks_y; ++by) {
+        for (int bx = 0; bx < n_blocks_x; ++bx) {
+            for (int i = 0; i < 16; ++i) {
+                block.texels[i][0] = 0;
+                block.texels[i][1] = 0;
+                block.texels[i][2] = 0;
+                block.texels[i][3] = 0xff;
+            }
+            switch (format) {
+                case TextureFormat::bc1: {
+                    decode_bc1(blocks, false, block);
+                    break;
+                }
+                case TextureFormat::bc3: {
+                    decode_bc4(blocks, block, 3);
+                    decode_bc1(blocks + 8, true, block);
+                    break;
+                }
+                case TextureFormat::bc5: {
+                    decode_bc4(blocks, block, 0);
+                    decode_bc4(blocks + 8, block, 1);
+                    break;
+                }
+                case TextureFormat::etc2_rgb: {
+                    decode_etc(blocks, block);
+                    break;
+                }
+                case TextureFormat::etc2_rgba: {
+                    decode_eac(blocks, false, block, 3);
+                    decode_etc(blocks + 8, block);
+                    break;
+                }
+                case TextureFormat::eac_rg11: {
+                    decode_eac(blocks, true, block, 0);
+                    decode_eac(blocks + 8, true, block, 1);
+                    break;
+                }
+                case TextureFormat::uncompressed: {
+                    return;
+                }
+            }
+            store_block(block, width, height, bx, by, out);
+            blocks += block_size(format);
+        }
+    }
+}
+
+double prt3::texture_psnr(
+    unsigned char const * a,
+    unsigned char const * b,
+    int width,
+    int height,
+    TextureFormat format
+) {
+    int n_channels = 4;
+    switch (format) {
+        case TextureFormat::bc1:
+        case TextureFormat::etc2_rgb: n_channels = 3; break;
+        case TextureFormat::bc5:
+        case TextureFormat::eac_rg11: n_channels = 2; break;
+        default: break;
+    }
+
+    size_t n_texels = static_cast<size_t>(width) * height;
+    double sum = 0.0;
+    for (size_t i = 0; i < n_texels; ++i) {
+        for (int c = 0; c < n_channels; ++c) {
+            double d = static_cast<double>(a[i * 4 + c]) - b[i * 4 + c];
+            sum += d * d;
+        }
+    }
+    if (sum == 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double mse = sum / (static_cast<double>(n_texels) * n_channels);
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
@@ -0,0 +1,143 @@
+#ifndef PRT3_TEXTURE_COMPRESSION_H
+#define PRT3_TEXTURE_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace prt3 {
+
+/* Formats that textures are cooked into. Compressed formats store 4x4
+ * texel blocks, row by row, in the layout that GL expects for the
+ * corresponding internal format.
+ */
+enum class TextureFormat : uint32_t {
+    uncompressed,
+    /* RGB in 8 bytes per block, S3TC DXT1 */
+    bc1,
+    /* RGB as bc1 and alpha as bc4, 16 bytes per block, S3TC DXT5 */
+    bc3,
+    /* two bc4 channels, red and green, in 16 bytes per block, RGTC2 */
+    bc5,
+    /* RGB in 8 bytes per block, ETC2 */
+    etc2_rgb,
+    /* RGB as etc2_rgb and alpha as EAC, 16 bytes per block */
+    etc2_rgba,
+    /* two 11 bit EAC channels, red and green, in 16 bytes per block */
+    eac_rg11
+};
+
+enum class CompressionPreset : uint32_t {
+    /* endpoints and base colors straight from the texel statistics */
+    fast,
+    /* refines endpoints and searches neighbouring base colors, several
+     * times slower than fast
+     */
+    quality
+};
+
+enum class TextureUsage : uint32_t {
+    color,
+    /* Only x and y are kept when a normal map is compressed, z is zero
+     * and has to be reconstructed when the map is sampled
+     */
+    normal_map
+};
+
+/* the compressed formats that a backend can sample */
+struct TextureFormatSupport {
+    /* bc1 and bc3 */
+    bool s3tc = false;
+    /* bc5 */
+    bool rgtc = false;
+    /* etc2_rgb, etc2_rgba and eac_rg11 */
+    bool etc2 = false;
+};
+
+/* how textures are cooked */
+struct TextureCompression {
+    bool enabled = false;
+    CompressionPreset preset = CompressionPreset::fast;
+    TextureFormatSupport support;
+    /* textures with no side larger than this stay uncompressed */
+    int uncompressed_max_size = 0;
+};
+
+/* Picks the format to cook a texture into. BC formats are preferred over
+ * ETC2 where both are supported. Only textures whose sides are powers of
+ * two, and at least 4, are compressed, since WebGL requires every mip level
+ * of a compressed texture to be either a multiple of the block size or
+ * smaller than a block, and only those with a side larger than
+ * compression.uncompressed_max_size.
+ */
+TextureFormat choose_texture_format(
+    TextureCompression const & compression,
+    TextureUsage usage,
+    int width,
+    int height,
+    bool has_alpha
+);
+
+inline bool texture_format_is_compressed(TextureFormat format)
+{ return format != TextureFormat::uncompressed; }
+
+/* the size of a width x height image in format, in bytes. channels is only
+ * used for uncompressed images.
+ */
+size_t texture_level_size(
+    TextureFormat format,
+    int width,
+    int height,
+    int channels
+);
+
+/* the size of the first n_levels mip levels, tightly packed */
+size_t texture_chain_size(
+    TextureFormat format,
+    int width,
+    int height,
+    int channels,
+    int n_levels
+);
+
+/* Compresses a width x height image with channels bytes per texel into
+ * texture_level_size(format, width, height, channels) bytes at out. One or
+ * two channels are treated as luminance and luminance alpha. Partial
+ * blocks at the edges repeat the edge texels.
+ */
+void compress_texture(
+    unsigned char const * texels,
+    int width,
+    int height,
+    int channels,
+    TextureFormat format,
+    CompressionPreset preset,
+    unsigned char * out
+);
+
+/* Decodes a compressed image to width * height * 4 bytes of RGBA at out.
+ * Channels that format does not store are 0, and alpha 255. Only meant for
+ * measuring the encoders, it decodes the block modes that compress_texture
+ * emits.
+ */
+void decompress_texture(
+    unsigned char const * blocks,
+    int width,
+    int height,
+    TextureFormat format,
+    unsigned char * out
+);
+
+/* the peak signal to noise ratio, in dB, between two RGBA images, over the
+ * channels that format stores. Infinite if the images are identical.
+ */
+double texture_psnr(
+    unsigned char const * a,
+    unsigned char const * b,
+    int width,
+    int height,
+    TextureFormat format
+);
+
+} // namespace prt3
+
+#endif
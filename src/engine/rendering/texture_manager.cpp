@@ -3,44 +3,155 @@
 #include "texture.h"
 
 #include "src/engine/core/context.h"
+#include "src/main/args.h"
 
 using namespace prt3;
 
 TextureManager::TextureManager(Context & context)
-: m_context{context} {}
+: m_context{context} {
+    m_compression.support = context.renderer().texture_format_support();
 
-ResourceID TextureManager::upload_texture(std::string const & path) {
+    std::string const & preset = Args::texture_compression();
+    if (preset == "fast") {
+        m_compression.enabled = true;
+        m_compression.preset = CompressionPreset::fast;
+    } else if (preset == "quality") {
+        m_compression.enabled = true;
+        m_compression.preset = CompressionPreset::quality;
+    } else if (!preset.empty()) {
+        PRT3WARNING(
+            "Unknown texture compression preset \"%s\".\n",
+            preset.c_str()
+        );
+    }
+
+    m_packed_compression = m_compression;
+    m_packed_compression.uncompressed_max_size = TextureAtlas::MAX_ENTRY_SIZE;
+}
+
+ResourceID TextureManager::upload_texture(
+    std::string const & path,
+    TextureUsage usage,
+    TexturePacking packing
+) {
     ResourceID res_id;
 
     if (m_path_to_resource_id.find(path) == m_path_to_resource_id.end()) {
 
         TextureData data;
-        if (load_texture_data(path.c_str(), data)) {
-            res_id = m_context.renderer().upload_texture(data);
-            free_texture_data(data);
-        } else {
+        if (!load_texture_data(
+                path.c_str(),
+                usage,
+                cook_settings(packing),
+                data
+            )) {
             PRT3ERROR("failed to load tecture at path \"%s\".\n", path.c_str());
             return NO_RESOURCE;
         }
+        res_id = m_context.renderer().upload_texture(data);
 
         TextureRef & texture_ref = m_texture_refs[res_id];
         texture_ref.path = path;
+        texture_ref.usage = usage;
+        texture_ref.packing = packing;
         m_path_to_resource_id[path] = res_id;
+
+        pack_texture(res_id, texture_ref, data);
+        free_texture_data(data);
     } else {
         res_id = m_path_to_resource_id.at(path);
+        if (texture_is_streaming(res_id)) {
+            load_streaming_texture(res_id);
+        }
+    }
+
+    ++m_texture_refs.at(res_id).ref_count;
+    return res_id;
+}
+
+ResourceID TextureManager::request_texture(
+    std::string const & path,
+    glm::u8vec4 placeholder_color,
+    TextureUsage usage,
+    TexturePacking packing
+) {
+    ResourceID res_id;
+
+    auto it = m_path_to_resource_id.find(path);
+    if (it == m_path_to_resource_id.end()) {
+        TextureData placeholder;
+        placeholder.width = 1;
+        placeholder.height = 1;
+        placeholder.channels = 4;
+        placeholder.data = &placeholder_color[0];
+        res_id = m_context.renderer().upload_texture(placeholder);
+
+        TextureRef & texture_ref = m_texture_refs[res_id];
+        texture_ref.path = path;
+        texture_ref.usage = usage;
+        texture_ref.packing = packing;
+        m_path_to_resource_id[path] = res_id;
+
+        m_streaming_textures.insert(res_id);
+        m_context.asset_loader().load_texture(
+            res_id,
+            path,
+            usage,
+            cook_settings(packing)
+        );
+    } else {
+        res_id = it->second;
     }
 
     ++m_texture_refs.at(res_id).ref_count;
     return res_id;
 }
 
+bool TextureManager::finish_streaming(
+    ResourceID resource_id,
+    std::string const & path,
+    TextureData const & data
+) {
+    auto it = m_streaming_textures.find(resource_id);
+    if (it == m_streaming_textures.end() ||
+        m_texture_refs.at(resource_id).path != path) {
+        return false;
+    }
+    m_streaming_textures.erase(it);
+
+    if (data.data == nullptr) {
+        /* the placeholder stays */
+        PRT3ERROR("failed to load tecture at path \"%s\".\n", path.c_str());
+        return false;
+    }
+
+    m_context.renderer().update_texture(resource_id, data);
+    pack_texture(resource_id, m_texture_refs.at(resource_id), data);
+    return true;
+}
+
+void TextureManager::load_streaming_texture(ResourceID resource_id) {
+    m_context.asset_loader().wait_for_texture(resource_id);
+}
+
 void TextureManager::clear() {
     for (auto const & pair : m_texture_refs) {
         m_context.renderer().free_texture(pair.first);
     }
 
+    for (ResourceID page : m_atlas_pages) {
+        if (page != NO_RESOURCE) {
+            m_context.renderer().free_texture(page);
+        }
+    }
+
     m_texture_refs.clear();
     m_path_to_resource_id.clear();
+    m_streaming_textures.clear();
+
+    m_atlas.clear();
+    m_atlas_pages.clear();
+    m_atlas_entries.clear();
 }
 
 void TextureManager::free_texture_ref(ResourceID resource_id) {
@@ -51,5 +162,64 @@ void TextureManager::free_texture_ref(ResourceID resource_id) {
         m_context.renderer().free_texture(resource_id);
         m_path_to_resource_id.erase(ref.path);
         m_texture_refs.erase(resource_id);
+        m_streaming_textures.erase(resource_id);
+
+        auto it = m_atlas_entries.find(resource_id);
+        if (it != m_atlas_entries.end()) {
+            m_atlas.remove(it->second);
+            m_atlas_entries.erase(it);
+        }
+    }
+}
+
+void TextureManager::pack_texture(
+    ResourceID resource_id,
+    TextureRef const & ref,
+    TextureData const & data
+) {
+    if (ref.packing != TexturePacking::atlas ||
+        m_atlas_entries.find(resource_id) != m_atlas_entries.end()) {
+        return;
+    }
+
+    TextureAtlas::Entry entry;
+    if (m_atlas.insert(data, entry)) {
+        m_atlas_entries[resource_id] = entry;
+    }
+}
+
+ResourceID TextureManager::resolve_texture(
+    ResourceID resource_id,
+    glm::vec4 & uv_transform
+) const {
+    auto it = m_atlas_entries.find(resource_id);
+    /* a page is only sampled once it holds the texels of the entry */
+    if (it != m_atlas_entries.end()) {
+        TextureAtlas::Entry const & entry = it->second;
+        if (entry.page < m_atlas_pages.size() &&
+            m_atlas_pages[entry.page] != NO_RESOURCE &&
+            !m_atlas.page_dirty(entry.page)) {
+            uv_transform = TextureAtlas::uv_transform(entry);
+            return m_atlas_pages[entry.page];
+        }
+    }
+
+    uv_transform = glm::vec4{0.0f, 0.0f, 1.0f, 1.0f};
+    return resource_id;
+}
+
+void TextureManager::update_atlas() {
+    m_atlas_pages.resize(m_atlas.n_pages(), NO_RESOURCE);
+
+    for (uint32_t i = 0; i < m_atlas.n_pages(); ++i) {
+        if (!m_atlas.page_dirty(i)) continue;
+
+        TextureData data = m_atlas.page_data(i);
+        if (m_atlas_pages[i] == NO_RESOURCE) {
+            m_atlas_pages[i] = m_context.renderer().upload_texture(data);
+        } else {
+            m_context.renderer().update_texture(m_atlas_pages[i], data);
+        }
+        m_atlas.mark_clean(i);
     }
 }
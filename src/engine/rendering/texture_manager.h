@@ -2,25 +2,57 @@
 #define PRT3_TEXTURE_MANAGER_H
 
 #include "src/engine/rendering/resources.h"
+#include "src/engine/rendering/texture.h"
+#include "src/engine/rendering/texture_atlas.h"
+
+#include <glm/glm.hpp>
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 
 namespace prt3 {
 
 class Context;
 
+/* a hint of how a texture is sampled */
+enum class TexturePacking {
+    none,
+    /* Within [0, 1] and clamped at the edges, by particles, decals or
+     * canvas rects. Small textures are packed into a shared atlas page, see
+     * TextureManager::resolve_texture.
+     */
+    atlas
+};
+
 class TextureManager {
 private:
     struct TextureRef {
         std::string path;
         uint32_t ref_count;
+        TextureUsage usage;
+        TexturePacking packing;
     };
 public:
     TextureManager(Context & context);
 
-    ResourceID upload_texture(std::string const & path);
+    /* the packing of a texture is decided by the call that first loads it */
+    ResourceID upload_texture(
+        std::string const & path,
+        TextureUsage usage = TextureUsage::color,
+        TexturePacking packing = TexturePacking::none
+    );
+    /* Returns at once with the id of a 1x1 texture in placeholder_color,
+     * whose image the asset loader replaces once the texture has been
+     * decoded, so that the id stays valid.
+     */
+    ResourceID request_texture(
+        std::string const & path,
+        glm::u8vec4 placeholder_color = glm::u8vec4{0xff},
+        TextureUsage usage = TextureUsage::color,
+        TexturePacking packing = TexturePacking::none
+    );
     void free_texture_ref(ResourceID resource_id);
     void clear();
 
@@ -33,13 +65,72 @@ public:
     std::unordered_map<std::string, ResourceID> const & path_to_resource_id() const
     { return m_path_to_resource_id; }
 
+    bool texture_is_streaming(ResourceID resource_id) const
+    { return m_streaming_textures.find(resource_id) != m_streaming_textures.end(); }
+
+    /* how textures are cooked, from --texture-compression and the formats
+     * that the backend supports
+     */
+    TextureCompression const & compression() const { return m_compression; }
+
+    /* The texture to bind in place of resource_id, which is either an atlas
+     * page or resource_id itself, and the transform from texture
+     * coordinates of resource_id to coordinates of that texture, as
+     * (offset, scale). Packed textures stay valid on their own as well.
+     */
+    ResourceID resolve_texture(
+        ResourceID resource_id,
+        glm::vec4 & uv_transform
+    ) const;
+
+    /* uploads the atlas pages that have changed, once per frame */
+    void update_atlas();
+
 private:
     Context & m_context;
 
+    TextureCompression m_compression;
+
     std::unordered_map<ResourceID, TextureRef> m_texture_refs;
     std::unordered_map<std::string, ResourceID> m_path_to_resource_id;
 
+    std::unordered_set<ResourceID> m_streaming_textures;
+
+    TextureAtlas m_atlas;
+    /* by page index, NO_RESOURCE until the page is first uploaded */
+    std::vector<ResourceID> m_atlas_pages;
+    std::unordered_map<ResourceID, TextureAtlas::Entry> m_atlas_entries;
+
+    /* textures that are small enough to be packed are kept uncompressed,
+     * so that they can be copied into a page
+     */
+    TextureCompression m_packed_compression;
+
+    TextureCompression const & cook_settings(TexturePacking packing) const {
+        return packing == TexturePacking::atlas ?
+            m_packed_compression : m_compression;
+    }
+    /* packs data into the atlas if ref asks for it and it fits */
+    void pack_texture(
+        ResourceID resource_id,
+        TextureRef const & ref,
+        TextureData const & data
+    );
+
+    /* replaces the placeholder of a streaming texture, returns false if
+     * the texture failed to load or is no longer waited for. Does not free
+     * data.
+     */
+    bool finish_streaming(
+        ResourceID resource_id,
+        std::string const & path,
+        TextureData const & data
+    );
+    /* waits for the asset loader to finish a streaming texture */
+    void load_streaming_texture(ResourceID resource_id);
+
     friend class Scene;
+    friend class AssetLoader;
 };
 
 } // namespace prt3
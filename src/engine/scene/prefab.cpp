@@ -2,32 +2,20 @@
 
 #include "src/util/serialization_util.h"
 #include "src/util/mem.h"
+#include "src/util/log.h"
+#include "src/util/virtual_file_system.h"
 
 #include <sstream>
 #include <iostream>
 #include <vector>
 #include <unordered_map>
-#include <fstream>
 
 using namespace prt3;
 
 Prefab::Prefab(char const * path) {
-    std::ifstream file(path, std::ios::binary);
-
-    file.unsetf(std::ios::skipws);
-    std::streampos file_size;
-
-    file.seekg(0, std::ios::end);
-    file_size = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    m_data.reserve(file_size);
-
-    m_data.insert(
-        m_data.begin(),
-        std::istream_iterator<char>(file),
-        std::istream_iterator<char>()
-    );
+    if (!VirtualFileSystem::instance().read_file(path, m_data)) {
+        PRT3ERROR("Failed to read prefab %s.\n", path);
+    }
 }
 
 static constexpr NodeID mapped_parent_id = -2;
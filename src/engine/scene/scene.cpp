@@ -278,7 +278,63 @@ Input & Scene::get_input() {
     return m_context->input();
 }
 
+void Scene::collect_bone_data(BoneRenderData & bone_data) {
+    std::vector<Animation> & animations = m_animation_system.m_animations;
+
+    /* the palette layout only changes when animations are added or
+     * removed, in which case every palette is rewritten
+     */
+    bool rebuild = bone_data.source != this ||
+                   bone_data.palettes.size() != animations.size() + 1;
+    for (size_t i = 0; !rebuild && i < animations.size(); ++i) {
+        rebuild = bone_data.palettes[i].count !=
+                  animations[i].transforms.size();
+    }
+
+    if (rebuild) {
+        bone_data.source = this;
+        bone_data.layout_changed = true;
+        bone_data.palettes.resize(animations.size() + 1);
+
+        uint32_t offset = 0;
+        for (size_t i = 0; i < animations.size(); ++i) {
+            uint32_t count =
+                static_cast<uint32_t>(animations[i].transforms.size());
+            bone_data.palettes[i] = BonePalette{offset, count};
+            offset += count;
+        }
+        /* fallback palette for animated meshes without an animation */
+        bone_data.palettes.back() = BonePalette{offset, 0};
+        bone_data.bones.resize(offset);
+    }
+
+    for (size_t i = 0; i < animations.size(); ++i) {
+        Animation & animation = animations[i];
+        if (!rebuild && !animation.pose_changed) continue;
+
+        BoneMatrix * dst =
+            bone_data.bones.data() + bone_data.palettes[i].offset;
+        for (glm::mat4 const & m : animation.transforms) {
+            glm::mat4 t = glm::transpose(m);
+            *dst = BoneMatrix{ t[0], t[1], t[2] };
+            ++dst;
+        }
+
+        animation.pose_changed = false;
+        if (!rebuild && !animation.transforms.empty()) {
+            bone_data.dirty_palettes.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+/* identifies a mesh instance for level of detail selection */
+static uint64_t lod_key(NodeID node_id, ResourceID mesh_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(node_id)) << 32) |
+           static_cast<uint32_t>(mesh_id);
+}
+
 void Scene::collect_render_data(
+    CameraRenderData const & camera_data,
     SceneRenderData & scene_data
 ) {
     m_transform_cache.collect_global_transforms(
@@ -317,33 +373,18 @@ void Scene::collect_render_data(
                 m_transform_cache.global_transforms()[pair.node_id].to_matrix() *
                 bones[pair.bone_index].offset_matrix;
         }
+        animation.pose_changed = true;
     }
 
-    std::vector<Animation> const & animations =
-        m_animation_system.animations();
-
-    scene_data.bone_data.resize(animations.size() + 1);
+    std::vector<Animation> & animations = m_animation_system.m_animations;
     size_t bone_data_back_index = animations.size();
-    for (glm::mat4 & bone : scene_data.bone_data[bone_data_back_index].bones) {
-        bone = glm::mat4{1.0f};
-    }
-
-    size_t bone_data_i = 0;
-    for (Animation const & animation : animations) {
-        BoneData & bone_data = scene_data.bone_data[bone_data_i];
-
-        assert(animation.transforms.size() < bone_data.bones.size());
-
-        for (size_t i = 0; i < animation.transforms.size(); ++i) {
-            bone_data.bones[i] = animation.transforms[i];
-        }
-
-        ++bone_data_i;
-    }
+    collect_bone_data(scene_data.bone_data);
 
     std::vector<Transform> const & global_transforms =
         m_transform_cache.global_transforms();
 
+    m_lod_selector.begin_frame(camera_data);
+
     static std::unordered_set<NodeID> selected_incl_children;
     selected_incl_children.clear();
     static std::vector<NodeID> queue;
@@ -364,7 +405,8 @@ void Scene::collect_render_data(
 
     auto const & mesh_comps = m_component_manager.get_all_components<Mesh>();
     for (auto const & mesh_comp : mesh_comps) {
-        if (mesh_comp.resource_id() == NO_RESOURCE) {
+        if (mesh_comp.resource_id() == NO_RESOURCE ||
+            m_static_batches.is_batched(mesh_comp.node_id())) {
             continue;
         }
 
@@ -388,6 +430,14 @@ void Scene::collect_render_data(
 
         Model const & model =
             model_manager().get_model_from_mesh_id(mesh_comp.resource_id());
+        Model::Mesh const & mesh = model.meshes()[
+            model_manager().get_mesh_index_from_mesh_id(mesh_comp.resource_id())
+        ];
+        mesh_data.lod = m_lod_selector.select(
+            lod_key(id, mesh_data.mesh_id),
+            mesh,
+            mesh_data.transform
+        );
 
         if (!model.is_animated()) {
             scene_data.mesh_data.push_back(mesh_data);
@@ -409,7 +459,8 @@ void Scene::collect_render_data(
     auto const & model_comps = m_component_manager.get_all_components<ModelComponent>();
     for (auto const & model_comp : model_comps) {
         ModelHandle handle = model_comp.model_handle();
-        if (handle == NO_MODEL) {
+        if (handle == NO_MODEL ||
+            m_static_batches.is_batched(model_comp.node_id())) {
             continue;
         }
         NodeID id = model_comp.node_id();
@@ -429,6 +480,11 @@ void Scene::collect_render_data(
             mesh_data.transform =
                 global_transforms[id].to_matrix()
                 * model_node.inherited_transform.to_matrix();
+            mesh_data.lod = m_lod_selector.select(
+                lod_key(id, mesh_data.mesh_id),
+                model.meshes()[i],
+                mesh_data.transform
+            );
 
             if (!model.is_animated()) {
                 scene_data.mesh_data.push_back(mesh_data);
@@ -446,6 +502,12 @@ void Scene::collect_render_data(
         }
     }
 
+    m_static_batches.collect_render_data(
+        man,
+        camera_data.projection_matrix * camera_data.view_matrix,
+        scene_data.mesh_data
+    );
+
     auto const & anim_model_comps =
         m_component_manager.get_all_components<AnimatedModel>();
 
@@ -476,6 +538,11 @@ void Scene::collect_render_data(
             mesh_data.transform =
                 global_transforms[id].to_matrix()
                 * model_node.inherited_transform.to_matrix();
+            mesh_data.lod = m_lod_selector.select(
+                lod_key(id, mesh_data.mesh_id),
+                model.meshes()[i],
+                mesh_data.transform
+            );
 
             data.mesh_data = mesh_data;
             data.bone_data_index = anim_id;
@@ -517,6 +584,17 @@ void Scene::collect_render_data(
             model_manager().get_model_handle_from_mesh_id(
                 mesh_comp.resource_id()
             );
+        Model::Mesh const & mesh = model_manager().get_model(model_handle)
+            .meshes()[
+                model_manager().get_mesh_index_from_mesh_id(
+                    mesh_comp.resource_id()
+                )
+            ];
+        mesh_data.lod = m_lod_selector.select(
+            lod_key(id, mesh_data.mesh_id),
+            mesh,
+            mesh_data.transform
+        );
 
         NodeID armature_id = mesh_comp.armature_id();
 
@@ -542,7 +620,8 @@ void Scene::collect_render_data(
         }
     }
 
-    std::vector<PointLightRenderData> point_lights;
+    std::vector<PointLightRenderData> & point_lights =
+        scene_data.light_data.point_lights;
     auto const & lights
         = m_component_manager.get_all_components<PointLightComponent>();
     for (auto const & light : lights) {
@@ -554,20 +633,29 @@ void Scene::collect_render_data(
         point_lights.push_back(point_light_data);
     }
 
-    glm::vec3 camera_position = m_camera.get_position();
-    std::sort(point_lights.begin(), point_lights.end(),
-        [&camera_position](PointLightRenderData const & a, PointLightRenderData const & b) {
-            return glm::distance2(a.position, camera_position) <
-                   glm::distance2(b.position, camera_position);
-        });
-
-    scene_data.light_data.number_of_point_lights =
-        point_lights.size() < LightRenderData::MAX_NUMBER_OF_POINT_LIGHTS ?
-            point_lights.size() : LightRenderData::MAX_NUMBER_OF_POINT_LIGHTS;
-    for (size_t i = 0; i < scene_data.light_data.number_of_point_lights; ++i) {
-        scene_data.light_data.point_lights[i] = point_lights[i];
+    /* lights are assigned to view clusters by the renderer, so they only
+     * need to be culled here if there are more than it can hold
+     */
+    constexpr size_t max_lights = LightRenderData::MAX_NUMBER_OF_POINT_LIGHTS;
+    if (point_lights.size() > max_lights) {
+        glm::vec3 camera_position = m_camera.get_position();
+        std::nth_element(
+            point_lights.begin(),
+            point_lights.begin() + max_lights,
+            point_lights.end(),
+            [&camera_position](
+                PointLightRenderData const & a,
+                PointLightRenderData const & b
+            ) {
+                return glm::distance2(a.position, camera_position) <
+                       glm::distance2(b.position, camera_position);
+            }
+        );
+        point_lights.resize(max_lights);
     }
 
+    m_lod_selector.end_frame();
+
     scene_data.light_data.directional_light = m_directional_light;
     scene_data.light_data.directional_light_on = m_directional_light_on;
 
@@ -577,6 +665,8 @@ void Scene::collect_render_data(
     Decal::collect_render_data(
         m_component_manager.get_all_components<Decal>(),
         global_transforms,
+        camera_data.projection_matrix * camera_data.view_matrix,
+        texture_manager(),
         scene_data.decal_data
     );
 
@@ -584,12 +674,14 @@ void Scene::collect_render_data(
     Canvas::collect_render_data(
         *this,
         m_component_manager.get_all_components<Canvas>(),
-        scene_data.canvas_data
+        scene_data.canvas_data,
+        scene_data.canvas_ranges
     );
 
     /* particle systems */
     ParticleSystem::collect_render_data(
         m_component_manager.get_all_components<ParticleSystem>(),
+        texture_manager(),
         scene_data.particle_data
     );
 }
@@ -624,6 +716,51 @@ TextureManager & Scene::texture_manager() {
     return m_context->texture_manager();
 }
 
+LoadProgress const & Scene::loading_progress() const {
+    return m_context->asset_loader().progress();
+}
+
+void Scene::resolve_streamed_models() {
+    ModelManager const & man = model_manager();
+    if (m_n_models_streamed == man.n_models_streamed()) {
+        return;
+    }
+    m_n_models_streamed = man.n_models_streamed();
+
+    for (Mesh & comp : m_component_manager.get_all_components<Mesh>()) {
+        comp.resolve_streamed_model(man);
+    }
+    for (MaterialComponent & comp :
+         m_component_manager.get_all_components<MaterialComponent>()) {
+        comp.resolve_streamed_model(man);
+    }
+}
+
+void Scene::load_streamed_models(NodeID id) {
+    ModelManager & man = model_manager();
+
+    if (has_component<Mesh>(id)) {
+        Mesh & comp = get_component<Mesh>(id);
+        if (man.model_is_streaming(comp.streaming_model())) {
+            man.load_streaming_model(comp.streaming_model());
+        }
+        comp.resolve_streamed_model(man);
+    }
+    if (has_component<MaterialComponent>(id)) {
+        MaterialComponent & comp = get_component<MaterialComponent>(id);
+        if (man.model_is_streaming(comp.streaming_model())) {
+            man.load_streaming_model(comp.streaming_model());
+        }
+        comp.resolve_streamed_model(man);
+    }
+    if (has_component<ModelComponent>(id)) {
+        ModelHandle handle = get_component<ModelComponent>(id).model_handle();
+        if (man.model_is_streaming(handle)) {
+            man.load_streaming_model(handle);
+        }
+    }
+}
+
 SceneManager & Scene::scene_manager() {
     return m_context->scene_manager();
 }
@@ -789,6 +926,7 @@ void Scene::internal_clear(bool should_place_root) {
     m_ambient_light = {{1.0f, 1.0f, 1.0f}};
 
     m_transform_cache.clear();
+    m_static_batches.clear();
 
     m_script_container.clear();
 
@@ -4,6 +4,7 @@
 #include "src/engine/scene/node.h"
 #include "src/engine/scene/script_container.h"
 #include "src/engine/scene/signal.h"
+#include "src/engine/scene/static_batches.h"
 #include "src/engine/scene/transform_cache.h"
 #include "src/engine/component/component_manager.h"
 #include "src/engine/component/script_set.h"
@@ -14,7 +15,9 @@
 #include "src/engine/animation/animation_system.h"
 #include "src/engine/navigation/navigation_system.h"
 #include "src/engine/rendering/renderer.h"
+#include "src/engine/rendering/asset_loader.h"
 #include "src/engine/rendering/camera.h"
+#include "src/engine/rendering/mesh_lod_selector.h"
 #include "src/engine/rendering/texture_manager.h"
 #include "src/engine/core/input.h"
 #include "src/util/uuid.h"
@@ -95,11 +98,55 @@ public:
         return node_id;
     }
 
-    ResourceID upload_texture(std::string const & path)
-    { return register_texture(texture_manager().upload_texture(path)); }
+    ResourceID upload_texture(
+        std::string const & path,
+        TexturePacking packing = TexturePacking::none
+    ) {
+        return register_texture(texture_manager().upload_texture(
+            path,
+            TextureUsage::color,
+            packing
+        ));
+    }
+
+    /* Like upload_model and upload_texture, but return at once with a
+     * placeholder while the asset is loaded in the background. Meshes and
+     * materials that are deserialized from a streaming model get their
+     * resources once it has been uploaded.
+     */
+    ModelHandle request_model(std::string const & path)
+    { return register_model(model_manager().request_model(path)); }
+
+    ResourceID request_texture(
+        std::string const & path,
+        TexturePacking packing = TexturePacking::none
+    ) {
+        return register_texture(texture_manager().request_texture(
+            path,
+            glm::u8vec4{0xff},
+            TextureUsage::color,
+            packing
+        ));
+    }
+
+    /* for loading screens */
+    LoadProgress const & loading_progress() const;
 
-    ResourceID upload_persistent_texture(std::string const & path)
-    { return texture_manager().upload_texture(path); }
+    /* loads the models that the components of a node are waiting for, on
+     * this thread
+     */
+    void load_streamed_models(NodeID id);
+
+    ResourceID upload_persistent_texture(
+        std::string const & path,
+        TexturePacking packing = TexturePacking::none
+    ) {
+        return texture_manager().upload_texture(
+            path,
+            TextureUsage::color,
+            packing
+        );
+    }
     void free_persistent_texture(ResourceID id)
     { return texture_manager().free_texture_ref(id); }
 
@@ -291,6 +338,9 @@ public:
     NavigationSystem const & navigation_system() const { return m_navigation_system; }
     NavigationSystem & navigation_system() { return m_navigation_system; }
 
+    StaticBatches const & static_batches() const { return m_static_batches; }
+    StaticBatches & static_batches() { return m_static_batches; }
+
     ModelManager const & model_manager() const;
     Model const & get_model(ModelHandle handle) const;
 
@@ -355,10 +405,17 @@ private:
     AmbientLight m_ambient_light;
 
     TransformCache m_transform_cache;
+    MeshLODSelector m_lod_selector;
+    StaticBatches m_static_batches;
 
     std::unordered_set<ModelHandle> m_referenced_models;
     std::unordered_set<ResourceID> m_referenced_textures;
 
+    /* ModelManager::n_models_streamed() when the components last took
+     * the resources of streamed models
+     */
+    uint32_t m_n_models_streamed = 0;
+
     NodeID m_selected_node = NO_NODE;
 
     void place_root();
@@ -374,11 +431,20 @@ private:
     void start();
     void update(float delta_time);
 
+    void resolve_streamed_models();
+
+    /* scene_path is the file that the scene was loaded from, if any */
+    void build_static_batches(std::string const & scene_path)
+    { m_static_batches.build(*this, scene_path); }
+
     void clear_node_mod_flags();
 
+    /* camera data is used to cull render data that is off screen */
     void collect_render_data(
+        CameraRenderData const & camera_data,
         SceneRenderData & scene_data
     );
+    void collect_bone_data(BoneRenderData & bone_data);
 
     void update_window_size(int w, int h);
 
@@ -417,6 +483,7 @@ private:
     friend class SceneManager;
     friend class Prefab;
     friend class Project;
+    friend class StaticBatches;
     friend AnimatedModel::AnimatedModel(Scene &, NodeID, std::istream &);
     friend ModelComponent::ModelComponent(Scene &, NodeID, std::istream &);
     friend MaterialComponent::MaterialComponent(Scene &, NodeID, std::istream &);
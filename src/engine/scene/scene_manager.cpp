@@ -2,8 +2,10 @@
 
 #include "src/engine/core/context.h"
 #include "src/util/mem.h"
+#include "src/util/virtual_file_system.h"
 
 #include <sstream>
+#include <vector>
 
 using namespace prt3;
 
@@ -42,9 +44,18 @@ TransitionState SceneManager::load_scene_if_queued(
         existing_textures = scene.referenced_textures();
 
         /* load scene */
-        std::ifstream in(queued_scene_path(), std::ios::binary);
+        std::vector<char> data;
+        VirtualFileSystem::instance().read_file(
+            queued_scene_path().c_str(),
+            data
+        );
+        imemstream in(data.data(), data.size());
         scene.deserialize(in);
-        in.close();
+
+        /* batches are built before unused models are freed, so that a
+         * cached batch model that is still loaded can be reused
+         */
+        scene.build_static_batches(queued_scene_path());
 
         /* free unused models */
         for (ModelHandle handle : existing_models) {
@@ -151,4 +162,8 @@ void SceneManager::set_tint(
         comp.material_override().tint_active = active;
         comp.material_override().tint = glm::vec4{tint, 1.0f};
     }
+    MaterialOverride & batch_override =
+        scene.static_batches().material_override();
+    batch_override.tint_active = active;
+    batch_override.tint = glm::vec4{tint, 1.0f};
 }
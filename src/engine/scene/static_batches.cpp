@@ -0,0 +1,476 @@
+#include "static_batches.h"
+
+#include "src/engine/scene/scene.h"
+#include "src/util/asset_manifest.h"
+#include "src/util/checksum.h"
+#include "src/util/file_util.h"
+#include "src/util/log.h"
+#include "src/util/serialization_util.h"
+#include "src/util/virtual_file_system.h"
+
+#include <glm/gtc/matrix_access.hpp>
+
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+using namespace prt3;
+
+static constexpr uint32_t STATIC_BATCH_CACHE_VERSION = 2;
+static std::string const cache_postfix = "_static";
+static std::string const uncached_model_path = "static_batches";
+
+namespace {
+
+struct SourceMesh {
+    ModelHandle handle;
+    uint32_t mesh_index;
+    Model::MeshMaterial const * material;
+    glm::mat4 transform;
+};
+
+struct Dependency {
+    std::string path;
+    XXH64String checksum;
+};
+
+struct Batch {
+    uint32_t material_index;
+    std::vector<Model::Vertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+} // namespace
+
+static bool same_material(
+    Model::MeshMaterial const & a,
+    Model::MeshMaterial const & b
+) {
+    return a.albedo == b.albedo &&
+           a.metallic == b.metallic &&
+           a.roughness == b.roughness &&
+           a.ao == b.ao &&
+           a.emissive == b.emissive &&
+           a.twosided == b.twosided &&
+           a.transparent == b.transparent &&
+           a.albedo_map == b.albedo_map &&
+           a.normal_map == b.normal_map &&
+           a.metallic_map == b.metallic_map &&
+           a.roughness_map == b.roughness_map &&
+           a.ambient_occlusion_map == b.ambient_occlusion_map;
+}
+
+static glm::vec3 safe_normalize(glm::vec3 v) {
+    float length = glm::length(v);
+    return length > 0.0f ? v / length : v;
+}
+
+/* collects the meshes of a static node, returns false if any of them can
+ * not be batched, in which case the node is drawn as usual
+ */
+static bool collect_source_meshes(
+    Scene const & scene,
+    NodeID id,
+    std::vector<SourceMesh> & meshes
+) {
+    ModelManager const & man = scene.model_manager();
+    glm::mat4 transform =
+        scene.get_node(id).get_global_transform(scene).to_matrix();
+
+    size_t n_meshes = meshes.size();
+    bool batchable = false;
+
+    if (scene.has_component<Mesh>(id)) {
+        ResourceID mesh_id = scene.get_component<Mesh>(id).resource_id();
+        ResourceID material_id = scene.has_component<MaterialComponent>(id) ?
+            scene.get_component<MaterialComponent>(id).resource_id() :
+            NO_RESOURCE;
+
+        if (mesh_id != NO_RESOURCE && material_id != NO_RESOURCE) {
+            Model const & material_model =
+                man.get_model_from_material_id(material_id);
+            int32_t material_mesh_index =
+                man.get_mesh_index_from_material_id(material_id);
+            Model::MeshMaterial const & material =
+                material_model.materials()[
+                    material_model.meshes()[material_mesh_index].material_index
+                ];
+
+            meshes.push_back({
+                man.get_model_handle_from_mesh_id(mesh_id),
+                static_cast<uint32_t>(man.get_mesh_index_from_mesh_id(mesh_id)),
+                &material,
+                transform
+            });
+            batchable = true;
+        }
+    }
+
+    if (scene.has_component<ModelComponent>(id)) {
+        ModelHandle handle =
+            scene.get_component<ModelComponent>(id).model_handle();
+        if (handle != NO_MODEL) {
+            Model const & model = man.get_model(handle);
+            for (uint32_t i = 0; i < model.meshes().size(); ++i) {
+                Model::Mesh const & mesh = model.meshes()[i];
+                Model::Node const & model_node = model.nodes()[mesh.node_index];
+                meshes.push_back({
+                    handle,
+                    i,
+                    &model.materials()[mesh.material_index],
+                    transform * model_node.inherited_transform.to_matrix()
+                });
+            }
+            batchable = true;
+        }
+    }
+
+    for (size_t i = n_meshes; i < meshes.size() && batchable; ++i) {
+        SourceMesh const & source = meshes[i];
+        batchable = !man.get_model(source.handle).is_animated() &&
+                    !source.material->transparent;
+    }
+
+    if (!batchable) {
+        meshes.resize(n_meshes);
+    }
+    return batchable;
+}
+
+static bool cache_is_valid(
+    std::string const & cache_path,
+    std::string const & model_path,
+    std::vector<Dependency> const & dependencies
+) {
+    std::ifstream in(cache_path, std::ios::binary);
+    if (!in || !VirtualFileSystem::instance().exists(model_path.c_str())) {
+        return false;
+    }
+
+    uint32_t version;
+    read_stream(in, version);
+    size_t n_dependencies;
+    read_stream(in, n_dependencies);
+    if (!in ||
+        version != STATIC_BATCH_CACHE_VERSION ||
+        n_dependencies != dependencies.size()) {
+        return false;
+    }
+
+    for (Dependency const & dependency : dependencies) {
+        std::string path;
+        XXH64String checksum;
+        read_string(in, path);
+        in.read(checksum.data(), checksum.writeable_size());
+        if (!in ||
+            path != dependency.path ||
+            checksum != dependency.checksum) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void write_cache(
+    std::string const & cache_path,
+    std::vector<Dependency> const & dependencies
+) {
+    std::ofstream out(cache_path, std::ios::binary);
+    write_stream(out, STATIC_BATCH_CACHE_VERSION);
+    write_stream(out, dependencies.size());
+    for (Dependency const & dependency : dependencies) {
+        write_string(out, dependency.path);
+        out.write(
+            dependency.checksum.data(),
+            dependency.checksum.writeable_size()
+        );
+    }
+    out.close();
+
+#ifdef __EMSCRIPTEN__
+    emscripten_save_file_via_put(cache_path);
+#endif // __EMSCRIPTEN__
+}
+
+static void merge_meshes(
+    ModelManager const & man,
+    std::vector<SourceMesh> const & sources,
+    Model & model
+) {
+    std::vector<Batch> batches;
+    std::unordered_map<uint64_t, uint32_t> batch_indices;
+    std::unordered_map<uint64_t, uint32_t> vertex_indices;
+
+    for (SourceMesh const & source : sources) {
+        Model const & src_model = man.get_model(source.handle);
+        Model::Mesh const & mesh = src_model.meshes()[source.mesh_index];
+        auto const & src_vertices = src_model.vertex_buffer();
+        auto const & src_indices = src_model.index_buffer();
+
+        uint32_t material_index = 0;
+        while (material_index < model.materials().size() &&
+               !same_material(model.materials()[material_index],
+                              *source.material)) {
+            ++material_index;
+        }
+        if (material_index == model.materials().size()) {
+            model.materials().push_back(*source.material);
+        }
+
+        glm::mat3 basis = glm::mat3{source.transform};
+        glm::mat3 normal_matrix = glm::transpose(glm::inverse(basis));
+        /* mirroring transforms reverse the winding order */
+        bool flip = glm::determinant(basis) < 0.0f;
+
+        vertex_indices.clear();
+        for (uint32_t i = 0; i + 2 < mesh.num_indices; i += 3) {
+            uint32_t tri[3] = {
+                src_indices[mesh.start_index + i],
+                src_indices[mesh.start_index + i + (flip ? 2 : 1)],
+                src_indices[mesh.start_index + i + (flip ? 1 : 2)]
+            };
+
+            glm::vec3 centroid{0.0f};
+            for (uint32_t v : tri) {
+                centroid += glm::vec3{
+                    source.transform *
+                    glm::vec4{src_vertices[v].position, 1.0f}
+                };
+            }
+            centroid /= 3.0f;
+
+            /* triangles are assigned to the chunk of their centroid */
+            glm::ivec3 cell = glm::ivec3(
+                glm::floor(centroid / StaticBatches::CHUNK_SIZE)
+            );
+            uint64_t batch_key =
+                (static_cast<uint64_t>(material_index) << 48) |
+                (static_cast<uint64_t>(cell.x & 0xFFFF) << 32) |
+                (static_cast<uint64_t>(cell.y & 0xFFFF) << 16) |
+                static_cast<uint64_t>(cell.z & 0xFFFF);
+
+            auto batch_it = batch_indices.emplace(
+                batch_key,
+                static_cast<uint32_t>(batches.size())
+            );
+            if (batch_it.second) {
+                batches.push_back({material_index, {}, {}});
+            }
+            uint32_t batch_index = batch_it.first->second;
+            Batch & batch = batches[batch_index];
+
+            for (uint32_t v : tri) {
+                uint64_t vertex_key =
+                    (static_cast<uint64_t>(batch_index) << 32) | v;
+                auto vertex_it = vertex_indices.emplace(
+                    vertex_key,
+                    static_cast<uint32_t>(batch.vertices.size())
+                );
+                if (vertex_it.second) {
+                    Model::Vertex const & src = src_vertices[v];
+                    Model::Vertex vertex;
+                    vertex.position = glm::vec3{
+                        source.transform * glm::vec4{src.position, 1.0f}
+                    };
+                    vertex.normal = safe_normalize(normal_matrix * src.normal);
+                    vertex.texture_coordinate = src.texture_coordinate;
+                    vertex.tangent = safe_normalize(basis * src.tangent);
+                    vertex.bitangent = safe_normalize(basis * src.bitangent);
+                    batch.vertices.push_back(vertex);
+                }
+                batch.indices.push_back(vertex_it.first->second);
+            }
+        }
+    }
+
+    model.nodes().resize(1 + batches.size());
+    model.nodes()[0].name = "static batches";
+
+    for (uint32_t i = 0; i < batches.size(); ++i) {
+        Batch const & batch = batches[i];
+
+        uint32_t node_index = i + 1;
+        Model::Node & node = model.nodes()[node_index];
+        node.parent_index = 0;
+        node.mesh_index = static_cast<int32_t>(i);
+        node.name = "batch" + std::to_string(i);
+        model.nodes()[0].child_indices.push_back(node_index);
+
+        Model::Mesh mesh{};
+        mesh.start_index = model.index_buffer().size();
+        mesh.num_indices = batch.indices.size();
+        mesh.start_bone = -1;
+        mesh.num_bones = -1;
+        mesh.material_index = static_cast<int32_t>(batch.material_index);
+        mesh.node_index = node_index;
+        mesh.name = node.name;
+
+        uint32_t vertex_offset = model.vertex_buffer().size();
+        for (uint32_t index : batch.indices) {
+            model.index_buffer().push_back(vertex_offset + index);
+        }
+        model.vertex_buffer().insert(
+            model.vertex_buffer().end(),
+            batch.vertices.begin(),
+            batch.vertices.end()
+        );
+
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{std::numeric_limits<float>::lowest()};
+        for (Model::Vertex const & vertex : batch.vertices) {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+        mesh.bounds_center = 0.5f * (min + max);
+        for (Model::Vertex const & vertex : batch.vertices) {
+            mesh.bounds_radius = glm::max(
+                mesh.bounds_radius,
+                glm::distance(mesh.bounds_center, vertex.position)
+            );
+        }
+
+        model.meshes().push_back(mesh);
+    }
+}
+
+void StaticBatches::build(Scene & scene, std::string const & scene_path) {
+    clear();
+
+    ModelManager const & man = scene.model_manager();
+
+    std::vector<SourceMesh> sources;
+    for (StaticGeometry const & comp :
+         scene.get_all_components<StaticGeometry>()) {
+        NodeID id = comp.node_id();
+        /* streamed geometry has to be in memory to be merged */
+        scene.load_streamed_models(id);
+        if (collect_source_meshes(scene, id, sources)) {
+            if (m_batched.size() <= static_cast<size_t>(id)) {
+                m_batched.resize(id + 1, false);
+            }
+            m_batched[id] = true;
+        }
+    }
+
+    if (sources.empty()) {
+        return;
+    }
+
+    std::string cache_path;
+    std::string model_path = uncached_model_path;
+    std::vector<Dependency> dependencies;
+    if (!scene_path.empty()) {
+        cache_path = scene_path + cache_postfix;
+        model_path = cache_path + DOT_PRT3_MODEL_EXT;
+
+        AssetManifest & manifest = AssetManifest::instance();
+        dependencies.push_back({scene_path, manifest.checksum(scene_path)});
+        for (SourceMesh const & source : sources) {
+            std::string const & path = man.get_model(source.handle).path();
+            bool found = false;
+            for (Dependency const & dependency : dependencies) {
+                found = found || dependency.path == path;
+            }
+            if (!found) {
+                dependencies.push_back({path, manifest.checksum(path)});
+            }
+        }
+
+        if (cache_is_valid(cache_path, model_path, dependencies)) {
+            m_model_handle = scene.upload_model(model_path);
+            if (m_model_handle != NO_MODEL) {
+                return;
+            }
+        }
+    }
+
+    Model model;
+    merge_meshes(man, sources, model);
+    model.optimize_meshes();
+    model.set_path(model_path);
+
+    if (!cache_path.empty()) {
+        model.save_prt3model(model_path.c_str());
+        write_cache(cache_path, dependencies);
+    }
+
+    PRT3LOG(
+        "Merged %zu static meshes into %zu batches.\n",
+        sources.size(),
+        model.meshes().size()
+    );
+
+    m_model_handle = scene.register_model(
+        scene.model_manager().upload_model(std::move(model))
+    );
+}
+
+void StaticBatches::clear() {
+    m_model_handle = NO_MODEL;
+    m_batched.clear();
+    m_material_override = {};
+}
+
+static bool sphere_outside_frustum(
+    glm::mat4 const & view_projection,
+    glm::vec3 center,
+    float radius
+) {
+    glm::vec4 rows[4];
+    for (unsigned int i = 0; i < 4; ++i) {
+        rows[i] = glm::row(view_projection, i);
+    }
+
+    /* the near plane is left out, geometry behind the camera is
+     * conservatively kept
+     */
+    glm::vec4 planes[5] = {
+        rows[3] + rows[0],
+        rows[3] - rows[0],
+        rows[3] + rows[1],
+        rows[3] - rows[1],
+        rows[3] - rows[2]
+    };
+
+    for (glm::vec4 const & plane : planes) {
+        float length = glm::length(glm::vec3{plane});
+        if (glm::dot(glm::vec3{plane}, center) + plane.w < -radius * length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void StaticBatches::collect_render_data(
+    ModelManager const & man,
+    glm::mat4 const & view_projection,
+    std::vector<MeshRenderData> & mesh_data
+) const {
+    if (m_model_handle == NO_MODEL) {
+        return;
+    }
+
+    Model const & model = man.get_model(m_model_handle);
+    ModelResource const & resources = man.get_model_resource(m_model_handle);
+
+    for (size_t i = 0; i < resources.mesh_resource_ids.size(); ++i) {
+        Model::Mesh const & mesh = model.meshes()[i];
+        if (sphere_outside_frustum(
+                view_projection,
+                mesh.bounds_center,
+                mesh.bounds_radius
+            )) {
+            continue;
+        }
+
+        MeshRenderData data;
+        data.mesh_id = resources.mesh_resource_ids[i];
+        data.lod = 0;
+        data.material_id = resources.mesh_material_ids[i];
+        data.material_override = m_material_override;
+        data.node_data.id = NO_NODE;
+        data.node_data.selected = false;
+        data.transform = glm::mat4{1.0f};
+        mesh_data.push_back(data);
+    }
+}
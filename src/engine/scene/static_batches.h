@@ -0,0 +1,54 @@
+#ifndef PRT3_STATIC_BATCHES_H
+#define PRT3_STATIC_BATCHES_H
+
+#include "src/engine/scene/node.h"
+#include "src/engine/rendering/model_manager.h"
+#include "src/engine/rendering/render_data.h"
+
+#include <string>
+#include <vector>
+
+namespace prt3 {
+
+class Scene;
+
+/* Merges the meshes of nodes with a StaticGeometry component into one
+ * model. Geometry is pre-transformed into world space and grouped by
+ * material, and each group is split into chunks on a grid so that chunks
+ * outside of the view can be culled. Each chunk is a single draw call.
+ *
+ * The merged model is cached next to the scene file, together with the
+ * checksums of the scene and the models that it was built from.
+ */
+class StaticBatches {
+public:
+    static constexpr float CHUNK_SIZE = 16.0f;
+
+    /* scene_path may be empty, in which case nothing is cached */
+    void build(Scene & scene, std::string const & scene_path);
+    void clear();
+
+    bool is_batched(NodeID id) const
+    { return static_cast<size_t>(id) < m_batched.size() && m_batched[id]; }
+
+    ModelHandle model_handle() const { return m_model_handle; }
+
+    MaterialOverride & material_override() { return m_material_override; }
+    MaterialOverride const & material_override() const
+    { return m_material_override; }
+
+    void collect_render_data(
+        ModelManager const & man,
+        glm::mat4 const & view_projection,
+        std::vector<MeshRenderData> & mesh_data
+    ) const;
+
+private:
+    ModelHandle m_model_handle = NO_MODEL;
+    std::vector<bool> m_batched;
+    MaterialOverride m_material_override = {};
+};
+
+} // namespace prt3
+
+#endif
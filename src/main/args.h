@@ -12,6 +12,11 @@ class Args
 private:
     std::string m_project_path;
     bool m_force_cached = false;
+    std::string m_capture_path;
+    std::string m_replay_path;
+    bool m_replay_dummy = false;
+    std::string m_archive_path;
+    std::string m_texture_compression;
 
    Args() {}
 
@@ -28,6 +33,24 @@ public:
    inline static bool force_cached()
    { return instance().m_force_cached; }
 
+   inline static std::string const & capture_path()
+   { return instance().m_capture_path; }
+
+   inline static std::string const & replay_path()
+   { return instance().m_replay_path; }
+
+   inline static bool replay_dummy()
+   { return instance().m_replay_dummy; }
+
+   inline static std::string const & archive_path()
+   { return instance().m_archive_path; }
+
+   /* the CompressionPreset to cook textures with, "fast" or "quality".
+    * Textures are not compressed if empty.
+    */
+   inline static std::string const & texture_compression()
+   { return instance().m_texture_compression; }
+
    friend void ::parse_args(int, char**);
 };
 
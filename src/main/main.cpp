@@ -1,23 +1,29 @@
 #include "src/engine/core/engine.h"
 #include "src/main/args.h"
 #include "src/engine/audio/audio_manager.h"
+#include "src/backend/capture/render_capture_replayer.h"
 
 #include "src/util/file_util.h"
 #include "src/util/log.h"
+#include "src/util/virtual_file_system.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 #endif //  __EMSCRIPTEN__
 
+#include <filesystem>
 #include <functional>
 #include <iostream>
 #include <string>
 #include <cstring>
 #include <cstdlib>
 
-prt3::Engine engine;
+/* constructed after the arguments are parsed, since they configure the
+ * renderer
+ */
+prt3::Engine * engine;
 #ifdef __EMSCRIPTEN__
-void main_loop() { engine.execute_frame(); }
+void main_loop() { engine->execute_frame(); }
 #endif //  __EMSCRIPTEN__
 
 void parse_args(int argc, char** argv) {
@@ -41,14 +47,99 @@ void parse_args(int argc, char** argv) {
                 args.m_force_cached = true;
             }
         }
+
+        if (strstr(arg, "--capture=") != nullptr) {
+            args.m_capture_path = strchr(arg, '=') + 1;
+        }
+
+        if (strstr(arg, "--replay=") != nullptr) {
+            args.m_replay_path = strchr(arg, '=') + 1;
+        }
+
+        if (strstr(arg, "--replay-dummy") != nullptr) {
+            char const * val = strchr(arg, '=') + 1;
+            if (strcmp(val, "true") == 0 ||
+                strcmp(val, "1") == 0) {
+                args.m_replay_dummy = true;
+            }
+        }
+
+        if (strstr(arg, "--archive=") != nullptr) {
+            args.m_archive_path = strchr(arg, '=') + 1;
+        }
+
+        if (strstr(arg, "--texture-compression=") != nullptr) {
+            args.m_texture_compression = strchr(arg, '=') + 1;
+        }
+
     }
 }
 
+/* assets are read from the archive given with --archive, or from
+ * PRT3_ASSET_ARCHIVE_PATH if it exists, and otherwise from loose files
+ */
+void mount_archive() {
+    std::string const & path = prt3::Args::archive_path();
+    if (!path.empty()) {
+        prt3::VirtualFileSystem::instance().mount(path.c_str());
+    } else if (std::filesystem::exists(PRT3_ASSET_ARCHIVE_PATH)) {
+        prt3::VirtualFileSystem::instance().mount(PRT3_ASSET_ARCHIVE_PATH);
+    }
+}
+
+static void print_phase(
+    char const * name,
+    prt3::RenderReplayStats::Phase const & phase,
+    uint32_t n_frames
+) {
+    PRT3LOG(
+        "%-10s avg %8.3f ms  min %8.3f ms  max %8.3f ms\n",
+        name,
+        phase.total / n_frames,
+        phase.min,
+        phase.max
+    );
+}
+
+/* replays a render capture as fast as possible and reports CPU time */
+int replay_capture() {
+    prt3::BackendType backend_type = prt3::Args::replay_dummy() ?
+        prt3::BackendType::dummy : prt3::BackendType::wasm;
+    prt3::Context context{backend_type};
+
+    prt3::RenderCaptureReplayer replayer{context.renderer().backend()};
+    if (!replayer.open(prt3::Args::replay_path().c_str())) {
+        return EXIT_FAILURE;
+    }
+
+    while (replayer.replay_next()) {}
+
+    prt3::RenderReplayStats const & stats = replayer.stats();
+    if (stats.n_frames == 0) {
+        PRT3WARNING("Render capture contains no frames.\n");
+        return EXIT_SUCCESS;
+    }
+
+    PRT3LOG("Replayed %u frames.\n", stats.n_frames);
+    print_phase("read", stats.read, stats.n_frames);
+    print_phase("resources", stats.resources, stats.n_frames);
+    print_phase("render", stats.render, stats.n_frames);
+
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char** argv) {
     parse_args(argc, argv);
+    mount_archive();
+
+    if (!prt3::Args::replay_path().empty()) {
+        return replay_capture();
+    }
+
+    engine = new prt3::Engine();
 
     if (!prt3::Args::project_path().empty()) {
-        engine.set_project_from_path(prt3::Args::project_path());
+        engine->set_project_from_path(prt3::Args::project_path());
     }
 
     // init random
@@ -57,7 +148,8 @@ int main(int argc, char** argv) {
 #ifdef __EMSCRIPTEN__
     emscripten_set_main_loop(main_loop, 0, true);
 #else // __EMSCRIPTEN__
-    while (engine.execute_frame()) {}
+    while (engine->execute_frame()) {}
+    delete engine;
 #endif //  __EMSCRIPTEN__
 
     return EXIT_SUCCESS;
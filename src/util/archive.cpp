@@ -0,0 +1,139 @@
+#include "archive.h"
+
+#include "src/util/hash.h"
+#include "src/util/lz.h"
+
+#include <cstring>
+
+using namespace prt3;
+
+/* true if count elements of size bytes from offset lie within file_size */
+static bool in_bounds(
+    uint64_t offset,
+    uint64_t count,
+    uint64_t size,
+    uint64_t file_size
+) {
+    return offset <= file_size &&
+           (size == 0 || count <= (file_size - offset) / size);
+}
+
+bool Archive::open(char const * path) {
+    if (!m_file.map(path) || m_file.size() < sizeof(m_header)) {
+        m_file.unmap();
+        return false;
+    }
+
+    std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+
+    uint64_t file_size = m_file.size();
+    if (std::memcmp(m_header.magic, P3A_MAGIC, sizeof(P3A_MAGIC)) != 0 ||
+        m_header.version != P3A_VERSION ||
+        m_header.block_size == 0 ||
+        !in_bounds(m_header.entries_offset, m_header.n_entries,
+                   sizeof(P3AEntry), file_size) ||
+        !in_bounds(m_header.blocks_offset, m_header.n_blocks,
+                   sizeof(P3ABlock), file_size) ||
+        !in_bounds(m_header.paths_offset, m_header.paths_size,
+                   1, file_size)) {
+        m_file.unmap();
+        return false;
+    }
+    return true;
+}
+
+P3AEntry Archive::entry(uint32_t index) const {
+    P3AEntry entry;
+    std::memcpy(
+        &entry,
+        m_file.data() + m_header.entries_offset + index * sizeof(P3AEntry),
+        sizeof(entry)
+    );
+    return entry;
+}
+
+P3ABlock Archive::block(uint32_t index) const {
+    P3ABlock block;
+    std::memcpy(
+        &block,
+        m_file.data() + m_header.blocks_offset + index * sizeof(P3ABlock),
+        sizeof(block)
+    );
+    return block;
+}
+
+bool Archive::find(char const * path, P3AEntry & entry) const {
+    if (m_file.data() == nullptr) {
+        return false;
+    }
+
+    size_t path_length = std::strlen(path);
+    uint64_t path_hash = xxhash64(path, path_length);
+
+    /* first entry with a hash that is not less than path_hash */
+    uint32_t low = 0;
+    uint32_t high = m_header.n_entries;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (this->entry(mid).path_hash < path_hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    char const * paths = reinterpret_cast<char const *>(
+        m_file.data() + m_header.paths_offset
+    );
+    for (uint32_t i = low; i < m_header.n_entries; ++i) {
+        P3AEntry candidate = this->entry(i);
+        if (candidate.path_hash != path_hash) {
+            break;
+        }
+        if (candidate.path_length == path_length &&
+            uint64_t{candidate.path_offset} + path_length <=
+                m_header.paths_size &&
+            std::memcmp(paths + candidate.path_offset,
+                        path, path_length) == 0) {
+            entry = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Archive::read(P3AEntry const & entry, std::vector<char> & data) const {
+    uint64_t block_size = m_header.block_size;
+    uint64_t n_blocks = (entry.size + block_size - 1) / block_size;
+    if (n_blocks != entry.n_blocks ||
+        uint64_t{entry.first_block} + n_blocks > m_header.n_blocks) {
+        return false;
+    }
+
+    data.resize(entry.size);
+
+    uint64_t file_size = m_file.size();
+    uint64_t remaining = entry.size;
+    char * out = data.data();
+    for (uint32_t i = 0; i < entry.n_blocks; ++i) {
+        P3ABlock block = this->block(entry.first_block + i);
+        size_t out_size = remaining < block_size ? remaining : block_size;
+        if (!in_bounds(block.offset, block.size, 1, file_size)) {
+            return false;
+        }
+
+        uint8_t const * in = m_file.data() + block.offset;
+        if (block.flags & P3A_BLOCK_STORED) {
+            if (block.size != out_size) {
+                return false;
+            }
+            std::memcpy(out, in, out_size);
+        } else if (!lz_decompress(in, block.size, out, out_size)) {
+            return false;
+        }
+
+        out += out_size;
+        remaining -= out_size;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef PRT3_ARCHIVE_H
+#define PRT3_ARCHIVE_H
+
+#include "src/util/archive_format.h"
+#include "src/util/mapped_file.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+/* Read-only access to a memory mapped .p3a archive, see
+ * archive_format.h. Reading is thread safe.
+ */
+class Archive {
+public:
+    /* maps and validates the archive, returns false if it is unusable */
+    bool open(char const * path);
+
+    /* returns false if the archive does not contain path */
+    bool find(char const * path, P3AEntry & entry) const;
+
+    /* decompresses the contents of entry into data */
+    bool read(P3AEntry const & entry, std::vector<char> & data) const;
+
+    uint32_t n_entries() const { return m_header.n_entries; }
+
+private:
+    MappedFile m_file;
+    P3AHeader m_header;
+
+    P3AEntry entry(uint32_t index) const;
+    P3ABlock block(uint32_t index) const;
+};
+
+} // namespace prt3
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PRT3_ARCHIVE_FORMAT_H
+#define PRT3_ARCHIVE_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace prt3 {
+
+/* Layout of .p3a asset archives.
+ *
+ * A file starts with a P3AHeader, followed by the entry table, the block
+ * table, the path table and the block data, at the offsets given in the
+ * header. Tables are aligned to P3A_TABLE_ALIGNMENT, so that a memory
+ * mapped archive is read in place.
+ *
+ * Entries are sorted by path_hash, the xxhash64 of the path, so that a
+ * path is found with a binary search and then compared against the path
+ * table, in case two paths hash to the same value. Paths are relative to
+ * the working directory of the engine, e.g. "assets/models/box.fbx".
+ *
+ * The contents of an entry are split into consecutive blocks of
+ * block_size bytes, of which only the last may be shorter. Each block is
+ * compressed with lz_compress on its own, so that reading a file only
+ * decompresses the blocks of that file. Blocks that do not get smaller
+ * are stored as they are.
+ */
+static constexpr char P3A_MAGIC[4] = {'P', '3', 'A', '\0'};
+static constexpr uint32_t P3A_VERSION = 1;
+static constexpr uint32_t P3A_BLOCK_SIZE = 64 * 1024;
+static constexpr size_t P3A_TABLE_ALIGNMENT = 16;
+
+struct P3AHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t block_size;
+    uint32_t n_entries;
+    uint32_t n_blocks;
+    uint32_t reserved;
+    uint64_t entries_offset;
+    uint64_t blocks_offset;
+    uint64_t paths_offset;
+    uint64_t paths_size; // in bytes
+};
+
+struct P3AEntry {
+    uint64_t path_hash;
+    /* xxhash64 of the uncompressed contents */
+    uint64_t content_hash;
+    uint64_t size; // uncompressed, in bytes
+    uint32_t path_offset;
+    uint32_t path_length;
+    uint32_t first_block;
+    uint32_t n_blocks;
+};
+
+enum P3ABlockFlags : uint32_t {
+    P3A_BLOCK_STORED = 1 << 0
+};
+
+struct P3ABlock {
+    uint64_t offset;
+    uint32_t size; // in the archive, in bytes
+    uint32_t flags;
+};
+
+} // namespace prt3
+
+#endif
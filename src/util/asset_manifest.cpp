@@ -0,0 +1,156 @@
+#include "asset_manifest.h"
+
+#include "src/util/file_util.h"
+#include "src/util/serialization_util.h"
+#include "src/util/thread_pool.h"
+#include "src/util/virtual_file_system.h"
+
+#include <sys/stat.h>
+
+#include <fstream>
+#include <vector>
+
+using namespace prt3;
+
+static constexpr uint32_t ASSET_MANIFEST_VERSION = 2;
+
+static bool stat_file(
+    std::string const & path,
+    uint64_t & size,
+    int64_t & mtime_ns
+) {
+    struct stat st;
+    if (stat(path.c_str(), &st) == -1) {
+        return false;
+    }
+    size = static_cast<uint64_t>(st.st_size);
+    mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+               static_cast<int64_t>(st.st_mtim.tv_nsec);
+    return true;
+}
+
+AssetManifest::AssetManifest() {
+    std::ifstream in(PRT3_ASSET_MANIFEST_PATH, std::ios::binary);
+    if (!in) {
+        return;
+    }
+
+    uint32_t version;
+    size_t n_entries;
+    read_stream(in, version);
+    read_stream(in, n_entries);
+    if (!in || version != ASSET_MANIFEST_VERSION) {
+        return;
+    }
+
+    for (size_t i = 0; i < n_entries; ++i) {
+        std::string path;
+        Entry entry;
+        read_string(in, path);
+        read_stream(in, entry.size);
+        read_stream(in, entry.mtime_ns);
+        in.read(entry.checksum.data(), entry.checksum.writeable_size());
+        if (!in) {
+            /* a truncated manifest is rebuilt as files are hashed */
+            m_entries.clear();
+            return;
+        }
+        m_entries.emplace(std::move(path), entry);
+    }
+}
+
+XXH64String AssetManifest::checksum(std::string const & path) {
+    uint64_t size;
+    int64_t mtime_ns;
+    if (!stat_file(path, size, mtime_ns)) {
+        /* archived files were hashed when they were packed */
+        return VirtualFileSystem::instance().archived_checksum(path.c_str());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        auto it = m_entries.find(path);
+        if (it != m_entries.end() &&
+            it->second.size == size &&
+            it->second.mtime_ns == mtime_ns) {
+            return it->second.checksum;
+        }
+    }
+
+    /* the file is stat'ed before it is read, so a change in between is
+     * caught by the next call
+     */
+    XXH64String checksum = compute_xxh64(path.c_str());
+    if (checksum.len() == 0) {
+        return checksum;
+    }
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_entries[path] = Entry{size, mtime_ns, checksum};
+    m_dirty = true;
+    return checksum;
+}
+
+void AssetManifest::refresh(ThreadPool & pool) {
+    struct StaleEntry {
+        std::string path;
+        Entry entry;
+    };
+
+    std::vector<StaleEntry> stale;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        auto it = m_entries.begin();
+        while (it != m_entries.end()) {
+            uint64_t size;
+            int64_t mtime_ns;
+            if (!stat_file(it->first, size, mtime_ns)) {
+                it = m_entries.erase(it);
+                m_dirty = true;
+                continue;
+            }
+            if (it->second.size != size || it->second.mtime_ns != mtime_ns) {
+                stale.push_back({it->first, Entry{size, mtime_ns, {}}});
+            }
+            ++it;
+        }
+    }
+
+    pool.parallel_for(stale.size(), [&stale](size_t i) {
+        stale[i].entry.checksum = compute_xxh64(stale[i].path.c_str());
+    });
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (StaleEntry & stale_entry : stale) {
+        if (stale_entry.entry.checksum.len() > 0) {
+            m_entries[stale_entry.path] = stale_entry.entry;
+        } else {
+            m_entries.erase(stale_entry.path);
+        }
+        m_dirty = true;
+    }
+}
+
+void AssetManifest::save() {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (!m_dirty) {
+        return;
+    }
+
+    std::ofstream out(PRT3_ASSET_MANIFEST_PATH, std::ios::binary);
+    write_stream(out, ASSET_MANIFEST_VERSION);
+    write_stream(out, m_entries.size());
+    for (auto const & pair : m_entries) {
+        Entry const & entry = pair.second;
+        write_string(out, pair.first);
+        write_stream(out, entry.size);
+        write_stream(out, entry.mtime_ns);
+        out.write(entry.checksum.data(), entry.checksum.writeable_size());
+    }
+    out.close();
+    m_dirty = false;
+
+#ifdef __EMSCRIPTEN__
+    emscripten_save_file_via_put(PRT3_ASSET_MANIFEST_PATH);
+#endif // __EMSCRIPTEN__
+}
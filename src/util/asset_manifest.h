@@ -0,0 +1,64 @@
+#ifndef PRT3_ASSET_MANIFEST_H
+#define PRT3_ASSET_MANIFEST_H
+
+#include "src/util/checksum.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#define PRT3_ASSET_MANIFEST_PATH "assets/asset_manifest"
+
+namespace prt3 {
+
+class ThreadPool;
+
+/* Records the size, modification time and XXH64 of asset files, so that
+ * the checksum of a file only has to be computed again when its size or
+ * modification time has changed. The manifest is read from
+ * PRT3_ASSET_MANIFEST_PATH on first use. All member functions are thread
+ * safe.
+ */
+class AssetManifest {
+public:
+    static AssetManifest & instance() {
+        static AssetManifest INSTANCE;
+        return INSTANCE;
+    }
+
+    AssetManifest(AssetManifest const &) = delete;
+    AssetManifest & operator=(AssetManifest const &) = delete;
+
+    /* Returns the checksum of the file at path, which is only read if it
+     * is not in the manifest or has changed since it was recorded. Files
+     * that only exist in a mounted archive get the checksum recorded in
+     * the archive. Returns an empty string if the file can not be read.
+     */
+    XXH64String checksum(std::string const & path);
+
+    /* brings every recorded entry up to date, hashing the files that
+     * changed concurrently on pool
+     */
+    void refresh(ThreadPool & pool);
+
+    /* writes the manifest if it has changed since it was read or written */
+    void save();
+
+private:
+    struct Entry {
+        uint64_t size;
+        int64_t mtime_ns;
+        XXH64String checksum;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    bool m_dirty = false;
+
+    AssetManifest();
+};
+
+} // namespace prt3
+
+#endif
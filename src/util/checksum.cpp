@@ -1,5 +1,8 @@
 #include "checksum.h"
 
+#include "src/util/hash.h"
+#include "src/util/mapped_file.h"
+
 #include <iostream>
 #include <fstream>
 #include <array>
@@ -57,3 +60,51 @@ CRC32String prt3::compute_crc32(char const * path) {
     // show results
     return CRC32String{digest_crc32.getHash().c_str()};
 }
+
+/* maps the file, returns false if it can not be read. Empty files can not
+ * be mapped, but are readable
+ */
+static bool map_file(char const * path, MappedFile & file) {
+    if (file.map(path)) {
+        return true;
+    }
+
+    std::FILE * f = std::fopen(path, "rb");
+    if (!f) {
+        std::cerr << "prt3: Can't open '" << path << "'" << std::endl;
+        return false;
+    }
+    std::fclose(f);
+    return true;
+}
+
+CRC32CString prt3::compute_crc32c(char const * path) {
+    MappedFile file;
+    if (!map_file(path, file)) {
+        return "";
+    }
+
+    uint32_t crc = crc32c(file.data(), file.size());
+
+    char hex[2 * sizeof(uint32_t) + 1];
+    std::snprintf(hex, sizeof(hex), "%08x", crc);
+    return CRC32CString{hex};
+}
+
+XXH64String prt3::compute_xxh64(char const * path) {
+    MappedFile file;
+    if (!map_file(path, file)) {
+        return "";
+    }
+
+    uint64_t hash = xxhash64(file.data(), file.size());
+
+    char hex[2 * sizeof(uint64_t) + 1];
+    std::snprintf(
+        hex,
+        sizeof(hex),
+        "%016llx",
+        static_cast<unsigned long long>(hash)
+    );
+    return XXH64String{hex};
+}
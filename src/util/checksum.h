@@ -3,6 +3,8 @@
 
 #include "src/util/fixed_string.h"
 
+#include <cstdint>
+
 #include "md5.h"
 #include "crc32.h"
 
@@ -11,10 +13,18 @@ namespace prt3 {
 
 typedef FixedString<2 * MD5::HashBytes + 1> MD5String;
 typedef FixedString<2 * CRC32::HashBytes + 1> CRC32String;
+typedef FixedString<2 * sizeof(uint32_t) + 1> CRC32CString;
+typedef FixedString<2 * sizeof(uint64_t) + 1> XXH64String;
 
 MD5String compute_md5(char const * path);
 CRC32String compute_crc32(char const * path);
 
+/* hash the file in one pass over a memory mapping of it, see hash.h.
+ * Return an empty string if the file can not be read.
+ */
+CRC32CString compute_crc32c(char const * path);
+XXH64String compute_xxh64(char const * path);
+
 } // namespace prt3
 
 #endif
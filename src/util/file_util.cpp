@@ -1,6 +1,14 @@
 #include "file_util.h"
 
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
+#endif // __EMSCRIPTEN__
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 using namespace prt3;
 
@@ -33,7 +41,14 @@ void prt3::emscripten_save_file_via_put(
         + path +
         "')";
 
+#ifdef __EMSCRIPTEN_PTHREADS__
+    /* models may be cached from worker threads, which can not reach the
+     * page's scripts
+     */
+    MAIN_THREAD_EM_ASM({ eval(UTF8ToString($0)); }, arg.c_str());
+#else // __EMSCRIPTEN_PTHREADS__
     emscripten_run_script(arg.c_str());
+#endif // __EMSCRIPTEN_PTHREADS__
 }
 #endif // __EMSCRIPTEN__
 
@@ -42,3 +57,29 @@ char const * prt3::get_file_extension(char const * filename) {
     if(!dot || dot == filename) return "";
     return dot + 1;
 }
+
+bool prt3::write_file_atomic(
+    std::string const & path,
+    std::function<void(std::ostream &)> const & write
+) {
+    /* unique within the process, so that concurrent writers of the same
+     * file do not share a temporary file
+     */
+    static std::atomic<uint32_t> counter{0};
+    thread_local std::string tmp_path;
+    tmp_path = path + ".tmp" + std::to_string(counter++);
+
+    std::ofstream out{tmp_path, std::ios::binary};
+    write(out);
+    out.close();
+
+    if (!out || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+#ifdef __EMSCRIPTEN__
+    emscripten_save_file_via_put(path);
+#endif // __EMSCRIPTEN__
+    return true;
+}
@@ -1,6 +1,8 @@
 #ifndef PRT3_FILE_UTIL_H
 #define PRT3_FILE_UTIL_H
 
+#include <functional>
+#include <ostream>
 #include <string>
 
 namespace prt3 {
@@ -18,6 +20,16 @@ void emscripten_save_file_via_put(
 
 char const * get_file_extension(char const * filename);
 
+/* writes the file at path through a temporary file that is renamed into
+ * place once write has succeeded, so that readers, which may have the file
+ * mapped, never see it partially written. Returns false on failure, in
+ * which case the file at path is left as it was.
+ */
+bool write_file_atomic(
+    std::string const & path,
+    std::function<void(std::ostream &)> const & write
+);
+
 } // namespace prt3
 
 #endif
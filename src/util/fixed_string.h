@@ -2,6 +2,8 @@
 #define PRT3_FIXED_STRING_H
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
 
 namespace prt3 {
 
@@ -0,0 +1,171 @@
+#include "hash.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif // __SSE4_2__
+
+using namespace prt3;
+
+namespace {
+
+/* table i maps a byte to its crc after i further zero bytes */
+typedef std::array<std::array<uint32_t, 256>, 8> CRC32CTables;
+
+constexpr CRC32CTables make_crc32c_tables() {
+    constexpr uint32_t polynomial = 0x82f63b78; // reflected Castagnoli
+    CRC32CTables tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (size_t t = 1; t < 8; ++t) {
+            uint32_t prev = tables[t - 1][i];
+            tables[t][i] = (prev >> 8) ^ tables[0][prev & 0xff];
+        }
+    }
+    return tables;
+}
+
+constexpr CRC32CTables crc32c_tables = make_crc32c_tables();
+
+constexpr uint64_t XXH_PRIME64_1 = 0x9e3779b185ebca87ull;
+constexpr uint64_t XXH_PRIME64_2 = 0xc2b2ae3d27d4eb4full;
+constexpr uint64_t XXH_PRIME64_3 = 0x165667b19e3779f9ull;
+constexpr uint64_t XXH_PRIME64_4 = 0x85ebca77c2b2ae63ull;
+constexpr uint64_t XXH_PRIME64_5 = 0x27d4eb2f165667c5ull;
+
+} // namespace
+
+/* reads are little endian, which x86 and wasm both are */
+static inline uint64_t read_u64(unsigned char const * p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read_u32(unsigned char const * p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint32_t prt3::crc32c(void const * data, size_t n, uint32_t crc) {
+    unsigned char const * p = static_cast<unsigned char const *>(data);
+    crc = ~crc;
+
+#if defined(__SSE4_2__) && (defined(__x86_64__) || defined(_M_X64))
+    uint64_t crc64 = crc;
+    while (n >= 8) {
+        crc64 = _mm_crc32_u64(crc64, read_u64(p));
+        p += 8;
+        n -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while (n > 0) {
+        crc = _mm_crc32_u8(crc, *p);
+        ++p;
+        --n;
+    }
+#else // __SSE4_2__
+    CRC32CTables const & t = crc32c_tables;
+    while (n >= 8) {
+        uint32_t lo = read_u32(p) ^ crc;
+        uint32_t hi = read_u32(p + 4);
+        crc = t[7][lo & 0xff] ^
+              t[6][(lo >> 8) & 0xff] ^
+              t[5][(lo >> 16) & 0xff] ^
+              t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^
+              t[2][(hi >> 8) & 0xff] ^
+              t[1][(hi >> 16) & 0xff] ^
+              t[0][hi >> 24];
+        p += 8;
+        n -= 8;
+    }
+    while (n > 0) {
+        crc = t[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+        ++p;
+        --n;
+    }
+#endif // __SSE4_2__
+
+    return ~crc;
+}
+
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t val) {
+    acc ^= xxh64_round(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+uint64_t prt3::xxhash64(void const * data, size_t n, uint64_t seed) {
+    unsigned char const * p = static_cast<unsigned char const *>(data);
+    unsigned char const * end = p + n;
+
+    uint64_t h;
+    if (n >= 32) {
+        /* four independent lanes, which keeps the multipliers busy */
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+
+        unsigned char const * limit = end - 32;
+        do {
+            v1 = xxh64_round(v1, read_u64(p));
+            v2 = xxh64_round(v2, read_u64(p + 8));
+            v3 = xxh64_round(v3, read_u64(p + 16));
+            v4 = xxh64_round(v4, read_u64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh64_merge_round(h, v1);
+        h = xxh64_merge_round(h, v2);
+        h = xxh64_merge_round(h, v3);
+        h = xxh64_merge_round(h, v4);
+    } else {
+        h = seed + XXH_PRIME64_5;
+    }
+
+    h += static_cast<uint64_t>(n);
+
+    while (end - p >= 8) {
+        h ^= xxh64_round(0, read_u64(p));
+        h = rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+    }
+    if (end - p >= 4) {
+        h ^= static_cast<uint64_t>(read_u32(p)) * XXH_PRIME64_1;
+        h = rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= static_cast<uint64_t>(*p) * XXH_PRIME64_5;
+        h = rotl64(h, 11) * XXH_PRIME64_1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
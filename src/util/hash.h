@@ -0,0 +1,23 @@
+#ifndef PRT3_HASH_H
+#define PRT3_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace prt3 {
+
+/* CRC-32C (Castagnoli) of n bytes. Pass the result of a previous call as
+ * crc to continue a checksum over several buffers. Uses the SSE4.2 crc32
+ * instruction when the build targets it, and slicing-by-8 otherwise.
+ */
+uint32_t crc32c(void const * data, size_t n, uint32_t crc = 0);
+
+/* 64-bit XXH64 of n bytes. Not cryptographic, but fast and well
+ * distributed, which makes it suitable for detecting changed content and
+ * for deduplication.
+ */
+uint64_t xxhash64(void const * data, size_t n, uint64_t seed = 0);
+
+} // namespace prt3
+
+#endif
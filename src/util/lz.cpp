@@ -0,0 +1,254 @@
+#include "lz.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace prt3;
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+/* the last match has to start at least this many bytes before the end */
+constexpr size_t MATCH_FIND_LIMIT = 12;
+/* and the last bytes are always literals */
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 65535;
+
+constexpr uint32_t HASH_LOG = 14;
+
+} // namespace
+
+static inline uint32_t read_u32(uint8_t const * p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash_u32(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_LOG);
+}
+
+static inline uint8_t * write_length(uint8_t * op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = static_cast<uint8_t>(len);
+    return op;
+}
+
+/* writes the literals [anchor, anchor + n_literals) and, if match_len is
+ * non-zero, a match. Returns nullptr if the sequence does not fit.
+ */
+static uint8_t * write_sequence(
+    uint8_t * op,
+    uint8_t const * op_end,
+    uint8_t const * anchor,
+    size_t n_literals,
+    size_t offset,
+    size_t match_len
+) {
+    size_t worst_case = 1 + n_literals + n_literals / 255 + 1 +
+                        2 + match_len / 255 + 1;
+    if (static_cast<size_t>(op_end - op) < worst_case) {
+        return nullptr;
+    }
+
+    uint8_t * token = op++;
+    *token = static_cast<uint8_t>((n_literals < 15 ? n_literals : 15) << 4);
+    if (n_literals >= 15) {
+        op = write_length(op, n_literals - 15);
+    }
+    if (n_literals > 0) {
+        std::memcpy(op, anchor, n_literals);
+        op += n_literals;
+    }
+
+    if (match_len == 0) {
+        return op;
+    }
+
+    *op++ = static_cast<uint8_t>(offset & 0xff);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+
+    size_t len = match_len - MIN_MATCH;
+    *token |= static_cast<uint8_t>(len < 15 ? len : 15);
+    if (len >= 15) {
+        op = write_length(op, len - 15);
+    }
+    return op;
+}
+
+size_t prt3::lz_compress_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+size_t prt3::lz_compress(
+    void const * src,
+    size_t n,
+    void * dst,
+    size_t capacity
+) {
+    uint8_t const * in = static_cast<uint8_t const *>(src);
+    uint8_t * out = static_cast<uint8_t *>(dst);
+    uint8_t * op = out;
+    uint8_t const * op_end = out + capacity;
+
+    uint8_t const * anchor = in;
+
+    if (n > MATCH_FIND_LIMIT) {
+        /* positions are relative to in, stale entries are caught by
+         * comparing the bytes
+         */
+        thread_local std::vector<uint32_t> table;
+        table.assign(size_t{1} << HASH_LOG, 0);
+
+        uint8_t const * ip = in + 1;
+        uint8_t const * ip_limit = in + n - MATCH_FIND_LIMIT;
+        uint8_t const * match_limit = in + n - LAST_LITERALS;
+
+        while (ip < ip_limit) {
+            uint32_t h = hash_u32(read_u32(ip));
+            uint8_t const * ref = in + table[h];
+            table[h] = static_cast<uint32_t>(ip - in);
+
+            if (ref >= ip ||
+                static_cast<size_t>(ip - ref) > MAX_OFFSET ||
+                read_u32(ref) != read_u32(ip)) {
+                /* skip ahead faster through data that does not match */
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            while (ip > anchor && ref > in && ip[-1] == ref[-1]) {
+                --ip;
+                --ref;
+            }
+
+            uint8_t const * match_end = ip + MIN_MATCH;
+            uint8_t const * ref_end = ref + MIN_MATCH;
+            while (match_end < match_limit && *match_end == *ref_end) {
+                ++match_end;
+                ++ref_end;
+            }
+
+            op = write_sequence(
+                op,
+                op_end,
+                anchor,
+                static_cast<size_t>(ip - anchor),
+                static_cast<size_t>(ip - ref),
+                static_cast<size_t>(match_end - ip)
+            );
+            if (op == nullptr) {
+                return 0;
+            }
+
+            ip = match_end;
+            anchor = ip;
+            if (ip < ip_limit) {
+                table[hash_u32(read_u32(ip - 2))] =
+                    static_cast<uint32_t>(ip - 2 - in);
+            }
+        }
+    }
+
+    op = write_sequence(
+        op,
+        op_end,
+        anchor,
+        static_cast<size_t>(in + n - anchor),
+        0,
+        0
+    );
+    if (op == nullptr) {
+        return 0;
+    }
+    return static_cast<size_t>(op - out);
+}
+
+static inline bool read_length(
+    uint8_t const * & ip,
+    uint8_t const * ip_end,
+    size_t & len
+) {
+    uint8_t b;
+    do {
+        if (ip >= ip_end) {
+            return false;
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+bool prt3::lz_decompress(
+    void const * src,
+    size_t n,
+    void * dst,
+    size_t dst_size
+) {
+    uint8_t const * ip = static_cast<uint8_t const *>(src);
+    uint8_t const * ip_end = ip + n;
+    uint8_t * out = static_cast<uint8_t *>(dst);
+    uint8_t * op = out;
+    uint8_t * op_end = out + dst_size;
+
+    while (true) {
+        if (ip >= ip_end) {
+            return false;
+        }
+        uint8_t token = *ip++;
+
+        size_t n_literals = token >> 4;
+        if (n_literals == 15 && !read_length(ip, ip_end, n_literals)) {
+            return false;
+        }
+        if (n_literals > static_cast<size_t>(ip_end - ip) ||
+            n_literals > static_cast<size_t>(op_end - op)) {
+            return false;
+        }
+        if (n_literals > 0) {
+            std::memcpy(op, ip, n_literals);
+            ip += n_literals;
+            op += n_literals;
+        }
+
+        /* the last sequence has no match */
+        if (ip == ip_end) {
+            return op == op_end;
+        }
+
+        if (ip_end - ip < 2) {
+            return false;
+        }
+        size_t offset = size_t{ip[0]} | (size_t{ip[1]} << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - out)) {
+            return false;
+        }
+
+        size_t match_len = token & 0xf;
+        if (match_len == 15 && !read_length(ip, ip_end, match_len)) {
+            return false;
+        }
+        match_len += MIN_MATCH;
+        if (match_len > static_cast<size_t>(op_end - op)) {
+            return false;
+        }
+
+        uint8_t const * ref = op - offset;
+        if (offset >= match_len) {
+            std::memcpy(op, ref, match_len);
+            op += match_len;
+        } else {
+            /* overlapping matches repeat the last offset bytes */
+            uint8_t * match_end = op + match_len;
+            while (op < match_end) {
+                *op++ = *ref++;
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef PRT3_LZ_H
+#define PRT3_LZ_H
+
+#include <cstddef>
+
+namespace prt3 {
+
+/* Block compression in the LZ4 block format: sequences of literals
+ * followed by a match of at least four bytes within the last 64 KiB.
+ * Compression is greedy and single pass, which trades ratio for speed,
+ * and decompression is a loop of copies.
+ */
+
+/* the largest size that n bytes can compress to */
+size_t lz_compress_bound(size_t n);
+
+/* Compresses n bytes from src into dst. Returns the compressed size, or 0
+ * if it would exceed capacity, which is never the case for a capacity of
+ * lz_compress_bound(n).
+ */
+size_t lz_compress(
+    void const * src,
+    size_t n,
+    void * dst,
+    size_t capacity
+);
+
+/* Decompresses n bytes from src into exactly dst_size bytes at dst.
+ * Returns false if the input is malformed or does not decompress to
+ * dst_size bytes. Never reads or writes out of bounds.
+ */
+bool lz_decompress(
+    void const * src,
+    size_t n,
+    void * dst,
+    size_t dst_size
+);
+
+} // namespace prt3
+
+#endif
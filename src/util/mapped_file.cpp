@@ -0,0 +1,56 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace prt3;
+
+bool MappedFile::map(char const * path) {
+    unmap();
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void * data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    /* the mapping stays valid after the descriptor is closed */
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<uint8_t const *>(data);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::assign(std::vector<char> && contents) {
+    unmap();
+
+    m_contents = std::move(contents);
+    if (!m_contents.empty()) {
+        m_data = reinterpret_cast<uint8_t const *>(m_contents.data());
+        m_size = m_contents.size();
+    }
+}
+
+void MappedFile::unmap() {
+    if (!m_contents.empty()) {
+        m_contents = {};
+    } else if (m_data != nullptr) {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
@@ -0,0 +1,37 @@
+#ifndef PRT3_MAPPED_FILE_H
+#define PRT3_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace prt3 {
+
+/* read-only memory mapping of a whole file, or the contents of a file
+ * that has been read into memory
+ */
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { unmap(); }
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile & operator=(MappedFile const &) = delete;
+
+    bool map(char const * path);
+    /* holds contents that were read rather than mapped, e.g. archived files */
+    void assign(std::vector<char> && contents);
+    void unmap();
+
+    uint8_t const * data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    uint8_t const * m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<char> m_contents;
+};
+
+} // namespace prt3
+
+#endif
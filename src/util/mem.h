@@ -9,6 +9,31 @@ struct membuf: std::streambuf {
         char * p(const_cast<char*>(base));
         this->setg(p, p, p + size);
     }
+
+    /* lets seekg and tellg move within the memory */
+    pos_type seekoff(
+        off_type off,
+        std::ios_base::seekdir dir,
+        std::ios_base::openmode which = std::ios_base::in
+    ) override {
+        off_type base = dir == std::ios_base::beg ? 0 :
+                        dir == std::ios_base::cur ? gptr() - eback() :
+                                                    egptr() - eback();
+        off_type pos = base + off;
+        if (!(which & std::ios_base::in) ||
+            pos < 0 || pos > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        this->setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+
+    pos_type seekpos(
+        pos_type pos,
+        std::ios_base::openmode which = std::ios_base::in
+    ) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
 };
 
 struct imemstream: virtual membuf, std::istream {
@@ -57,6 +57,15 @@ inline void read_string(std::FILE * in, std::string & str) {
     std::fread(str.data(), sizeof(str[0]), len, in);
 }
 
+/* lets a std::istream read from memory without copying it */
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    MemoryStreamBuffer(void const * data, size_t size) {
+        char * begin = const_cast<char *>(static_cast<char const *>(data));
+        setg(begin, begin, begin + size);
+    }
+};
+
 inline void write_c_string(std::ostream & out, char const * s) {
     size_t len = strlen(s);
     write_stream(out, len);
@@ -0,0 +1,108 @@
+#ifndef PRT3_SIMD_H
+#define PRT3_SIMD_H
+
+/* Minimal four wide float vector. Uses SSE or WebAssembly SIMD when the
+ * compiler targets them (-msse2 / -msimd128) and falls back to plain loops,
+ * which compilers are generally able to auto-vectorize, otherwise.
+ */
+
+#if defined(__SSE2__)
+#define PRT3_SIMD_SSE
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#define PRT3_SIMD_WASM
+#include <wasm_simd128.h>
+#endif
+
+#include <cstdint>
+
+namespace prt3 {
+
+struct alignas(16) F32x4 {
+#if defined(PRT3_SIMD_SSE)
+    __m128 v;
+#elif defined(PRT3_SIMD_WASM)
+    v128_t v;
+#else
+    float v[4];
+#endif
+};
+
+/* loads four consecutive floats, no alignment required */
+inline F32x4 load4(float const * p) {
+#if defined(PRT3_SIMD_SSE)
+    return F32x4{ _mm_loadu_ps(p) };
+#elif defined(PRT3_SIMD_WASM)
+    return F32x4{ wasm_v128_load(p) };
+#else
+    return F32x4{ { p[0], p[1], p[2], p[3] } };
+#endif
+}
+
+/* stores four consecutive floats, no alignment required */
+inline void store4(float * p, F32x4 a) {
+#if defined(PRT3_SIMD_SSE)
+    _mm_storeu_ps(p, a.v);
+#elif defined(PRT3_SIMD_WASM)
+    wasm_v128_store(p, a.v);
+#else
+    for (unsigned int i = 0; i < 4; ++i) {
+        p[i] = a.v[i];
+    }
+#endif
+}
+
+inline F32x4 splat4(float f) {
+#if defined(PRT3_SIMD_SSE)
+    return F32x4{ _mm_set1_ps(f) };
+#elif defined(PRT3_SIMD_WASM)
+    return F32x4{ wasm_f32x4_splat(f) };
+#else
+    return F32x4{ { f, f, f, f } };
+#endif
+}
+
+#if defined(PRT3_SIMD_SSE)
+#define PRT3_SIMD_BINARY_OP(name, sse, wasm, expr) \
+    inline F32x4 name(F32x4 a, F32x4 b) { return F32x4{ sse(a.v, b.v) }; }
+#elif defined(PRT3_SIMD_WASM)
+#define PRT3_SIMD_BINARY_OP(name, sse, wasm, expr) \
+    inline F32x4 name(F32x4 a, F32x4 b) { return F32x4{ wasm(a.v, b.v) }; }
+#else
+#define PRT3_SIMD_BINARY_OP(name, sse, wasm, expr)     \
+    inline F32x4 name(F32x4 a, F32x4 b) {              \
+        F32x4 r;                                       \
+        for (unsigned int i = 0; i < 4; ++i) {         \
+            float x = a.v[i]; float y = b.v[i];        \
+            r.v[i] = expr;                             \
+        }                                              \
+        return r;                                      \
+    }
+#endif
+
+PRT3_SIMD_BINARY_OP(add4, _mm_add_ps, wasm_f32x4_add, x + y)
+PRT3_SIMD_BINARY_OP(sub4, _mm_sub_ps, wasm_f32x4_sub, x - y)
+PRT3_SIMD_BINARY_OP(mul4, _mm_mul_ps, wasm_f32x4_mul, x * y)
+PRT3_SIMD_BINARY_OP(max4, _mm_max_ps, wasm_f32x4_pmax, x > y ? x : y)
+PRT3_SIMD_BINARY_OP(min4, _mm_min_ps, wasm_f32x4_pmin, x < y ? x : y)
+
+#undef PRT3_SIMD_BINARY_OP
+
+/* returns a four bit mask where bit i is set if a[i] <= b[i] */
+inline uint32_t mask_le4(F32x4 a, F32x4 b) {
+#if defined(PRT3_SIMD_SSE)
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(a.v, b.v)));
+#elif defined(PRT3_SIMD_WASM)
+    return wasm_i32x4_bitmask(wasm_f32x4_le(a.v, b.v));
+#else
+    uint32_t mask = 0;
+    for (unsigned int i = 0; i < 4; ++i) {
+        mask |= (a.v[i] <= b.v[i] ? 1u : 0u) << i;
+    }
+    return mask;
+#endif
+}
+
+} // namespace prt3
+
+#endif
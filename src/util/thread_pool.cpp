@@ -0,0 +1,121 @@
+#include "thread_pool.h"
+
+using namespace prt3;
+
+ThreadPool::ThreadPool() {
+#ifdef PRT3_HAS_THREADS
+    unsigned int n_cores = std::thread::hardware_concurrency();
+    unsigned int n_workers = n_cores > 1 ? n_cores - 1 : 0;
+    m_workers.reserve(n_workers);
+    for (unsigned int i = 0; i < n_workers; ++i) {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+#endif // PRT3_HAS_THREADS
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stop = true;
+    }
+    m_job_available.notify_all();
+
+    for (std::thread & worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallel_for(
+    size_t n,
+    std::function<void(size_t)> const & job
+) {
+    if (n == 0) {
+        return;
+    }
+
+    if (m_workers.empty() || n == 1) {
+        for (size_t i = 0; i < n; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_job = &job;
+    m_n_iterations = n;
+    m_next_iteration = 0;
+    m_n_finished = 0;
+    ++m_generation;
+    m_job_available.notify_all();
+
+    run_iterations(lock);
+
+    m_job_done.wait(lock, [this]() { return m_n_finished == m_n_iterations; });
+    m_job = nullptr;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_tasks.push_back(std::move(task));
+    }
+    m_job_available.notify_one();
+}
+
+bool ThreadPool::run_task() {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (m_tasks.empty()) {
+            return false;
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::work() {
+    size_t generation = 0;
+    std::unique_lock<std::mutex> lock{m_mutex};
+    while (true) {
+        m_job_available.wait(lock, [&]() {
+            return m_stop ||
+                   (m_job != nullptr && m_generation != generation) ||
+                   !m_tasks.empty();
+        });
+        if (m_stop) {
+            return;
+        }
+
+        if (m_job != nullptr && m_generation != generation) {
+            generation = m_generation;
+            run_iterations(lock);
+        } else {
+            std::function<void()> task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+}
+
+void ThreadPool::run_iterations(std::unique_lock<std::mutex> & lock) {
+    std::function<void(size_t)> const & job = *m_job;
+    while (m_next_iteration < m_n_iterations) {
+        size_t i = m_next_iteration;
+        ++m_next_iteration;
+
+        lock.unlock();
+        job(i);
+        lock.lock();
+
+        ++m_n_finished;
+        if (m_n_finished == m_n_iterations) {
+            m_job_done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef PRT3_THREAD_POOL_H
+#define PRT3_THREAD_POOL_H
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define PRT3_HAS_THREADS
+#endif
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace prt3 {
+
+/* Fixed set of worker threads that run the iterations of parallel_for and
+ * submitted background tasks. Web builds without pthreads have no workers,
+ * in which case the calling thread runs every iteration, and submitted
+ * tasks wait until someone calls run_task().
+ */
+class ThreadPool {
+public:
+    /* one worker per core, in addition to the calling thread */
+    ThreadPool();
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool & operator=(ThreadPool const &) = delete;
+
+    /* runs job(i) for every i in [0, n), in no particular order, and
+     * returns once all of them have finished. The calling thread takes
+     * part. Not reentrant.
+     */
+    void parallel_for(size_t n, std::function<void(size_t)> const & job);
+
+    /* queues a task that runs on a worker, without waiting for it. Tasks
+     * that have not started when the pool is destroyed are dropped.
+     */
+    void submit(std::function<void()> task);
+
+    /* runs one queued task on the calling thread, returns false if there
+     * was none
+     */
+    bool run_task();
+
+    size_t n_threads() const { return m_workers.size() + 1; }
+    bool has_workers() const { return !m_workers.empty(); }
+
+private:
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_job_available;
+    std::condition_variable m_job_done;
+
+    std::function<void(size_t)> const * m_job = nullptr;
+    size_t m_n_iterations = 0;
+    size_t m_next_iteration = 0;
+    size_t m_n_finished = 0;
+    /* incremented for each job, so that workers do not run one twice */
+    size_t m_generation = 0;
+
+    /* parallel_for iterations take precedence over these */
+    std::deque<std::function<void()> > m_tasks;
+    bool m_stop = false;
+
+    void work();
+    /* runs iterations until there are none left, lock must be held */
+    void run_iterations(std::unique_lock<std::mutex> & lock);
+};
+
+} // namespace prt3
+
+#endif
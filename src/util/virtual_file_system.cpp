@@ -0,0 +1,118 @@
+#include "virtual_file_system.h"
+
+#include "src/util/log.h"
+#include "src/util/mapped_file.h"
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <mutex>
+
+using namespace prt3;
+
+static bool is_loose_file(char const * path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+static bool read_loose_file(char const * path, std::vector<char> & data) {
+    std::FILE * file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    std::fseek(file, 0l, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0l, SEEK_SET);
+    if (size < 0) {
+        std::fclose(file);
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(size));
+    size_t n_read = std::fread(data.data(), 1, data.size(), file);
+    std::fclose(file);
+    if (n_read != data.size()) {
+        data.clear();
+        return false;
+    }
+    return true;
+}
+
+bool VirtualFileSystem::mount(char const * path) {
+    auto archive = std::make_unique<Archive>();
+    if (!archive->open(path)) {
+        PRT3ERROR("Failed to mount archive %s.\n", path);
+        return false;
+    }
+
+    PRT3LOG("Mounted %s, %u files.\n", path, archive->n_entries());
+
+    std::unique_lock<std::shared_mutex> lock{m_mutex};
+    m_archives.push_back(std::move(archive));
+    return true;
+}
+
+Archive const * VirtualFileSystem::find(char const * path, P3AEntry & entry) {
+    /* archives are never unmounted, so the archive outlives the lock */
+    std::shared_lock<std::shared_mutex> lock{m_mutex};
+    for (auto it = m_archives.rbegin(); it != m_archives.rend(); ++it) {
+        if ((*it)->find(path, entry)) {
+            return it->get();
+        }
+    }
+    return nullptr;
+}
+
+bool VirtualFileSystem::exists(char const * path) {
+    P3AEntry entry;
+    return is_loose_file(path) || find(path, entry) != nullptr;
+}
+
+bool VirtualFileSystem::read_file(char const * path, std::vector<char> & data) {
+    data.clear();
+    if (is_loose_file(path)) {
+        return read_loose_file(path, data);
+    }
+
+    P3AEntry entry;
+    Archive const * archive = find(path, entry);
+    if (archive == nullptr) {
+        return false;
+    }
+    if (!archive->read(entry, data)) {
+        PRT3ERROR("Archived file %s is corrupt.\n", path);
+        data.clear();
+        return false;
+    }
+    return true;
+}
+
+bool VirtualFileSystem::map_file(char const * path, MappedFile & file) {
+    if (is_loose_file(path)) {
+        return file.map(path);
+    }
+
+    std::vector<char> data;
+    if (!read_file(path, data)) {
+        return false;
+    }
+    file.assign(std::move(data));
+    return true;
+}
+
+XXH64String VirtualFileSystem::archived_checksum(char const * path) {
+    P3AEntry entry;
+    if (find(path, entry) == nullptr) {
+        return "";
+    }
+
+    char hex[2 * sizeof(uint64_t) + 1];
+    std::snprintf(
+        hex,
+        sizeof(hex),
+        "%016llx",
+        static_cast<unsigned long long>(entry.content_hash)
+    );
+    return XXH64String{hex};
+}
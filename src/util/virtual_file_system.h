@@ -0,0 +1,65 @@
+#ifndef PRT3_VIRTUAL_FILE_SYSTEM_H
+#define PRT3_VIRTUAL_FILE_SYSTEM_H
+
+#include "src/util/archive.h"
+#include "src/util/checksum.h"
+
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#define PRT3_ASSET_ARCHIVE_PATH "assets.p3a"
+
+namespace prt3 {
+
+class MappedFile;
+
+/* Reads asset files from the mounted archives and the file system. A loose
+ * file takes precedence over an archived one, so that assets can be edited
+ * without repacking, and archives mounted later take precedence over
+ * earlier ones. All member functions are thread safe.
+ */
+class VirtualFileSystem {
+public:
+    static VirtualFileSystem & instance() {
+        static VirtualFileSystem INSTANCE;
+        return INSTANCE;
+    }
+
+    VirtualFileSystem(VirtualFileSystem const &) = delete;
+    VirtualFileSystem & operator=(VirtualFileSystem const &) = delete;
+
+    /* returns false if the archive at path can not be read */
+    bool mount(char const * path);
+
+    bool exists(char const * path);
+
+    /* reads the whole file at path into data, which is left empty if the
+     * file can not be read
+     */
+    bool read_file(char const * path, std::vector<char> & data);
+
+    /* Maps a loose file, or reads an archived one into file. Returns false
+     * if the file can not be read.
+     */
+    bool map_file(char const * path, MappedFile & file);
+
+    /* The checksum that was recorded for path when it was archived, or an
+     * empty string if path is not in a mounted archive.
+     */
+    XXH64String archived_checksum(char const * path);
+
+private:
+    std::shared_mutex m_mutex;
+    /* in the order that they were mounted */
+    std::vector<std::unique_ptr<Archive> > m_archives;
+
+    VirtualFileSystem() {}
+
+    /* returns the archive that holds path, or nullptr */
+    Archive const * find(char const * path, P3AEntry & entry);
+};
+
+} // namespace prt3
+
+#endif
@@ -0,0 +1,272 @@
+/* Packs the assets under a resource directory into a .p3a archive, see
+ * src/util/archive_format.h. Paths in the archive are relative to the
+ * resource directory, e.g. "assets/models/box.fbx", which is where the
+ * engine looks for them.
+ */
+
+#include "src/util/archive_format.h"
+#include "src/util/hash.h"
+#include "src/util/lz.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace prt3;
+
+namespace fs = std::filesystem;
+
+/* files that the engine never reads */
+static char const * const excluded_extensions[] = {
+    ".afphoto",
+    ".blend",
+    ".blend1",
+};
+
+static char const * const excluded_names[] = {
+    ".DS_Store",
+    "asset_manifest",
+};
+
+static char const * const excluded_suffixes[] = {
+    "_prt3cache",
+};
+
+struct PackedFile {
+    std::string path;
+    P3AEntry entry;
+};
+
+struct PackedBlock {
+    std::vector<uint8_t> data;
+    uint32_t flags;
+};
+
+static void print_usage(FILE * stream, char const * bin_name) {
+    char const * usage_string = \
+        "usage: %s resource-dir out-file\n"\
+        "\n"\
+        "Packs every file under resource-dir/assets into the archive\n"\
+        "out-file, e.g. %s resources assets.p3a\n";
+    fprintf(stream, usage_string, bin_name, bin_name);
+}
+
+static bool ends_with(std::string const & s, char const * suffix) {
+    size_t len = std::strlen(suffix);
+    return s.size() >= len && s.compare(s.size() - len, len, suffix) == 0;
+}
+
+static bool is_excluded(fs::path const & path) {
+    std::string extension = path.extension().string();
+    for (char const * excluded : excluded_extensions) {
+        if (extension == excluded) {
+            return true;
+        }
+    }
+
+    std::string name = path.filename().string();
+    for (char const * excluded : excluded_names) {
+        if (name == excluded) {
+            return true;
+        }
+    }
+    for (char const * excluded : excluded_suffixes) {
+        if (ends_with(name, excluded)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool read_file(fs::path const & path, std::vector<uint8_t> & data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    data.resize(fs::file_size(path));
+    in.read(reinterpret_cast<char *>(data.data()), data.size());
+    return static_cast<bool>(in);
+}
+
+static void pack_blocks(
+    std::vector<uint8_t> const & data,
+    std::vector<PackedBlock> & blocks
+) {
+    std::vector<uint8_t> compressed(lz_compress_bound(P3A_BLOCK_SIZE));
+    for (size_t offset = 0; offset < data.size(); offset += P3A_BLOCK_SIZE) {
+        size_t size = std::min(data.size() - offset, size_t{P3A_BLOCK_SIZE});
+        uint8_t const * src = data.data() + offset;
+
+        size_t compressed_size = lz_compress(
+            src,
+            size,
+            compressed.data(),
+            compressed.size()
+        );
+
+        PackedBlock block;
+        if (compressed_size == 0 || compressed_size >= size) {
+            block.data.assign(src, src + size);
+            block.flags = P3A_BLOCK_STORED;
+        } else {
+            block.data.assign(
+                compressed.begin(),
+                compressed.begin() + compressed_size
+            );
+            block.flags = 0;
+        }
+        blocks.push_back(std::move(block));
+    }
+}
+
+static uint64_t align(uint64_t offset) {
+    return (offset + P3A_TABLE_ALIGNMENT - 1) & ~(P3A_TABLE_ALIGNMENT - 1);
+}
+
+static void pad_to(std::ofstream & out, uint64_t offset) {
+    static char const zeros[P3A_TABLE_ALIGNMENT] = {};
+    uint64_t pos = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, offset - pos);
+}
+
+int main(int argc, char * argv[]) {
+    if (argc != 3) {
+        print_usage(stderr, argv[0]);
+        return 1;
+    }
+
+    typedef std::chrono::high_resolution_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    fs::path root = argv[1];
+    fs::path asset_dir = root / "assets";
+    if (!fs::is_directory(asset_dir)) {
+        fprintf(stderr, "ERROR: \"%s\" is not a directory.\n",
+                asset_dir.string().c_str());
+        return 1;
+    }
+
+    std::vector<PackedFile> files;
+    std::vector<PackedBlock> blocks;
+    std::vector<uint8_t> data;
+    uint64_t total_size = 0;
+
+    for (fs::directory_entry const & dir_entry :
+         fs::recursive_directory_iterator(asset_dir)) {
+        if (!dir_entry.is_regular_file() || is_excluded(dir_entry.path())) {
+            continue;
+        }
+
+        if (!read_file(dir_entry.path(), data)) {
+            fprintf(stderr, "ERROR: failed to read \"%s\".\n",
+                    dir_entry.path().string().c_str());
+            return 1;
+        }
+
+        PackedFile file{};
+        file.path = dir_entry.path().lexically_relative(root).generic_string();
+
+        P3AEntry & entry = file.entry;
+        entry.path_hash = xxhash64(file.path.data(), file.path.size());
+        entry.content_hash = xxhash64(data.data(), data.size());
+        entry.size = data.size();
+        entry.path_length = static_cast<uint32_t>(file.path.size());
+        entry.first_block = static_cast<uint32_t>(blocks.size());
+        pack_blocks(data, blocks);
+        entry.n_blocks =
+            static_cast<uint32_t>(blocks.size()) - entry.first_block;
+
+        total_size += data.size();
+        files.push_back(std::move(file));
+    }
+
+    std::sort(files.begin(), files.end(),
+        [](PackedFile const & a, PackedFile const & b) {
+            if (a.entry.path_hash != b.entry.path_hash) {
+                return a.entry.path_hash < b.entry.path_hash;
+            }
+            return a.path < b.path;
+        }
+    );
+
+    std::string paths;
+    for (PackedFile & file : files) {
+        file.entry.path_offset = static_cast<uint32_t>(paths.size());
+        paths += file.path;
+    }
+
+    P3AHeader header{};
+    std::memcpy(header.magic, P3A_MAGIC, sizeof(header.magic));
+    header.version = P3A_VERSION;
+    header.block_size = P3A_BLOCK_SIZE;
+    header.n_entries = static_cast<uint32_t>(files.size());
+    header.n_blocks = static_cast<uint32_t>(blocks.size());
+    header.entries_offset = align(sizeof(header));
+    header.blocks_offset =
+        align(header.entries_offset + files.size() * sizeof(P3AEntry));
+    header.paths_offset =
+        align(header.blocks_offset + blocks.size() * sizeof(P3ABlock));
+    header.paths_size = paths.size();
+
+    std::ofstream out(argv[2], std::ios::binary);
+    if (!out) {
+        fprintf(stderr, "ERROR: failed to open \"%s\".\n", argv[2]);
+        return 1;
+    }
+
+    out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+    pad_to(out, header.entries_offset);
+    for (PackedFile const & file : files) {
+        out.write(
+            reinterpret_cast<char const *>(&file.entry),
+            sizeof(file.entry)
+        );
+    }
+
+    pad_to(out, header.blocks_offset);
+    uint64_t block_offset = align(header.paths_offset + paths.size());
+    for (PackedBlock const & packed : blocks) {
+        P3ABlock block;
+        block.offset = block_offset;
+        block.size = static_cast<uint32_t>(packed.data.size());
+        block.flags = packed.flags;
+        out.write(reinterpret_cast<char const *>(&block), sizeof(block));
+        block_offset += packed.data.size();
+    }
+
+    pad_to(out, header.paths_offset);
+    out.write(paths.data(), paths.size());
+
+    pad_to(out, align(header.paths_offset + paths.size()));
+    for (PackedBlock const & packed : blocks) {
+        out.write(
+            reinterpret_cast<char const *>(packed.data.data()),
+            packed.data.size()
+        );
+    }
+
+    out.close();
+    if (!out) {
+        fprintf(stderr, "ERROR: failed to write \"%s\".\n", argv[2]);
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(
+        Clock::now() - start
+    ).count();
+    printf(
+        "Packed %zu files, %llu bytes into %llu bytes (%.1f%%) in %.2f s.\n",
+        files.size(),
+        static_cast<unsigned long long>(total_size),
+        static_cast<unsigned long long>(block_offset),
+        total_size > 0 ? 100.0 * block_offset / total_size : 0.0,
+        seconds
+    );
+    return 0;
+}
@@ -0,0 +1,102 @@
+/* Compares the throughput of the hash functions of the engine with those
+ * of hash-library, on the contents of a file, in memory and through the
+ * checksum functions that read it from the file system.
+ */
+
+#include "src/util/checksum.h"
+#include "src/util/hash.h"
+#include "src/util/mapped_file.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+using namespace prt3;
+
+static void print_usage(FILE * stream, char const * bin_name) {
+    char const * usage_string = \
+        "usage: %s file\n"\
+        "\n"\
+        "Hashes file with each hash function for about a second and\n"\
+        "reports the throughput, e.g. %s resources/assets.p3a\n";
+    fprintf(stream, usage_string, bin_name, bin_name);
+}
+
+/* runs hash over size bytes until about a second has passed and reports
+ * the throughput
+ */
+static void measure_hash(
+    char const * name,
+    size_t size,
+    std::function<uint64_t()> const & hash
+) {
+    typedef std::chrono::high_resolution_clock Clock;
+
+    uint64_t sink = 0;
+    uint32_t n_runs = 0;
+    Clock::time_point start = Clock::now();
+    double seconds = 0.0;
+    do {
+        sink += hash();
+        ++n_runs;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (seconds < 1.0);
+
+    double gb_per_s = static_cast<double>(size) * n_runs / seconds * 1e-9;
+    printf(
+        "%-24s %8.3f GB/s  (%u runs, %016llx)\n",
+        name,
+        gb_per_s,
+        n_runs,
+        static_cast<unsigned long long>(sink)
+    );
+}
+
+int main(int argc, char ** argv) {
+    if (argc != 2) {
+        print_usage(stderr, argv[0]);
+        return EXIT_FAILURE;
+    }
+    char const * path = argv[1];
+
+    MappedFile file;
+    if (!file.map(path)) {
+        fprintf(stderr, "Failed to map %s.\n", path);
+        return EXIT_FAILURE;
+    }
+    uint8_t const * data = file.data();
+    size_t size = file.size();
+
+    printf("%s, %zu bytes\n", path, size);
+
+    measure_hash("hash-library crc32", size, [&]() {
+        CRC32 digest;
+        digest.add(data, size);
+        return static_cast<uint64_t>(digest.getHash().size());
+    });
+    measure_hash("hash-library md5", size, [&]() {
+        MD5 digest;
+        digest.add(data, size);
+        return static_cast<uint64_t>(digest.getHash().size());
+    });
+    measure_hash("crc32c", size, [&]() {
+        return static_cast<uint64_t>(crc32c(data, size));
+    });
+    measure_hash("xxhash64", size, [&]() {
+        return xxhash64(data, size);
+    });
+
+    measure_hash("compute_crc32 (file)", size, [&]() {
+        return static_cast<uint64_t>(compute_crc32(path).len());
+    });
+    measure_hash("compute_crc32c (file)", size, [&]() {
+        return static_cast<uint64_t>(compute_crc32c(path).len());
+    });
+    measure_hash("compute_xxh64 (file)", size, [&]() {
+        return static_cast<uint64_t>(compute_xxh64(path).len());
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/* Reports the vertex cache efficiency of the models under a directory, as
+ * imported and after the mesh optimization that the engine applies when
+ * it caches them, see src/engine/rendering/mesh_optimization.h.
+ */
+
+#include "src/engine/rendering/mesh_optimization.h"
+#include "src/engine/rendering/model.h"
+#include "src/util/file_util.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+using namespace prt3;
+
+static void print_usage(FILE * stream, char const * bin_name) {
+    char const * usage_string = \
+        "usage: %s model-dir\n"\
+        "\n"\
+        "Reports the average cache miss ratio (ACMR) and the average\n"\
+        "transform to vertex ratio (ATVR) of every model under model-dir,\n"\
+        "before and after mesh optimization, e.g. %s resources/assets\n";
+    fprintf(stream, usage_string, bin_name, bin_name);
+}
+
+static VertexCacheStatistics analyze_model(Model const & model) {
+    VertexCacheStatistics total{};
+    for (Model::Mesh const & mesh : model.meshes()) {
+        VertexCacheStatistics stats = analyze_vertex_cache(
+            model.index_buffer().data() + mesh.start_index,
+            mesh.num_indices,
+            model.vertex_buffer().size()
+        );
+        total.vertices_transformed += stats.vertices_transformed;
+        total.unique_vertices += stats.unique_vertices;
+        total.triangles += stats.triangles;
+    }
+    return total;
+}
+
+static void print_cache_statistics(
+    char const * name,
+    VertexCacheStatistics const & before,
+    VertexCacheStatistics const & after
+) {
+    printf(
+        "%-40s %8u tris  ACMR %6.3f -> %6.3f  ATVR %6.3f -> %6.3f\n",
+        name,
+        before.triangles,
+        before.acmr(),
+        after.acmr(),
+        before.atvr(),
+        after.atvr()
+    );
+}
+
+static bool is_model(char const * path) {
+    char const * extension = get_file_extension(path);
+    return strcmp(extension, "fbx") == 0 ||
+           strcmp(extension, "gltf") == 0 ||
+           strcmp(extension, "glb") == 0 ||
+           strcmp(extension, "obj") == 0 ||
+           strcmp(extension, "dae") == 0 ||
+           strcmp(extension, PRT3_MODEL_EXT) == 0;
+}
+
+int main(int argc, char ** argv) {
+    if (argc != 2) {
+        print_usage(stderr, argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::error_code error;
+    std::filesystem::recursive_directory_iterator it{argv[1], error};
+    if (error) {
+        fprintf(stderr, "Failed to open directory %s.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    VertexCacheStatistics total_before{};
+    VertexCacheStatistics total_after{};
+
+    for (auto const & entry : it) {
+        std::string path = entry.path().string();
+        if (!entry.is_regular_file() || !is_model(path.c_str())) {
+            continue;
+        }
+
+        /* as stored in the source file, bypassing the cache */
+        Model model{path.c_str(), false};
+        if (!model.valid()) {
+            continue;
+        }
+
+        VertexCacheStatistics before = analyze_model(model);
+        model.optimize_meshes();
+        VertexCacheStatistics after = analyze_model(model);
+
+        print_cache_statistics(path.c_str(), before, after);
+
+        total_before.vertices_transformed += before.vertices_transformed;
+        total_before.unique_vertices += before.unique_vertices;
+        total_before.triangles += before.triangles;
+        total_after.vertices_transformed += after.vertices_transformed;
+        total_after.unique_vertices += after.unique_vertices;
+        total_after.triangles += after.triangles;
+    }
+
+    print_cache_statistics("total", total_before, total_after);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/* Compresses the PNG images under a directory into every block format that
+ * textures are cooked into, with every preset, and reports the quality of
+ * the result and the encoding speed, see
+ * src/engine/rendering/texture_compression.h.
+ */
+
+#include "src/engine/rendering/texture_compression.h"
+#include "src/util/file_util.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace prt3;
+
+static void print_usage(FILE * stream, char const * bin_name) {
+    char const * usage_string = \
+        "usage: %s image-dir\n"\
+        "\n"\
+        "Compresses every PNG under image-dir in each format and preset\n"\
+        "and reports PSNR and speed, e.g. %s resources/assets/textures\n";
+    fprintf(stream, usage_string, bin_name, bin_name);
+}
+
+struct TextureBenchmarkResult {
+    double psnr_sum = 0.0;
+    double worst_psnr = std::numeric_limits<double>::infinity();
+    uint32_t n_textures = 0;
+    double seconds = 0.0;
+    double n_texels = 0.0;
+};
+
+/* compresses the images under a directory in every format and with every
+ * preset, and reports the quality of the result and the encoding speed
+ */
+static int benchmark_texture_compression(char const * dir) {
+    typedef std::chrono::high_resolution_clock Clock;
+
+    static constexpr TextureFormat formats[] = {
+        TextureFormat::bc1,
+        TextureFormat::bc3,
+        TextureFormat::bc5,
+        TextureFormat::etc2_rgb,
+        TextureFormat::etc2_rgba,
+        TextureFormat::eac_rg11,
+    };
+    static constexpr char const * format_names[] = {
+        "bc1", "bc3", "bc5", "etc2_rgb", "etc2_rgba", "eac_rg11"
+    };
+    static constexpr size_t n_formats = sizeof(formats) / sizeof(formats[0]);
+    static constexpr CompressionPreset presets[] = {
+        CompressionPreset::fast,
+        CompressionPreset::quality,
+    };
+    static constexpr char const * preset_names[] = { "fast", "quality" };
+
+    std::error_code error;
+    std::filesystem::recursive_directory_iterator it{dir, error};
+    if (error) {
+        fprintf(stderr, "Failed to open directory %s.\n", dir);
+        return EXIT_FAILURE;
+    }
+
+    TextureBenchmarkResult results[2][n_formats];
+    std::vector<unsigned char> blocks;
+    std::vector<unsigned char> decoded;
+
+    for (auto const & entry : it) {
+        std::string path = entry.path().string();
+        if (!entry.is_regular_file() ||
+            strcmp(get_file_extension(path.c_str()), "png") != 0) {
+            continue;
+        }
+
+        int width, height, channels;
+        unsigned char * texels =
+            stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (texels == nullptr) {
+            continue;
+        }
+        decoded.resize(static_cast<size_t>(width) * height * 4);
+
+        for (size_t p = 0; p < 2; ++p) {
+            for (size_t f = 0; f < n_formats; ++f) {
+                blocks.resize(
+                    texture_level_size(formats[f], width, height, 4)
+                );
+
+                Clock::time_point start = Clock::now();
+                compress_texture(
+                    texels, width, height, 4,
+                    formats[f],
+                    presets[p],
+                    blocks.data()
+                );
+                double seconds = std::chrono::duration<double>(
+                    Clock::now() - start
+                ).count();
+
+                decompress_texture(
+                    blocks.data(), width, height, formats[f], decoded.data()
+                );
+                double psnr = texture_psnr(
+                    texels, decoded.data(), width, height, formats[f]
+                );
+                /* lossless blocks would dominate the average */
+                psnr = std::min(psnr, 99.0);
+
+                TextureBenchmarkResult & result = results[p][f];
+                result.psnr_sum += psnr;
+                result.worst_psnr = std::min(result.worst_psnr, psnr);
+                ++result.n_textures;
+                result.seconds += seconds;
+                result.n_texels += static_cast<double>(width) * height;
+            }
+        }
+
+        stbi_image_free(texels);
+    }
+
+    for (size_t p = 0; p < 2; ++p) {
+        for (size_t f = 0; f < n_formats; ++f) {
+            TextureBenchmarkResult const & result = results[p][f];
+            if (result.n_textures == 0) {
+                continue;
+            }
+            printf(
+                "%-8s %-10s PSNR avg %6.2f dB  min %6.2f dB  %8.2f MPix/s\n",
+                preset_names[p],
+                format_names[f],
+                result.psnr_sum / result.n_textures,
+                result.worst_psnr,
+                result.n_texels / result.seconds * 1e-6
+            );
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char ** argv) {
+    if (argc != 2) {
+        print_usage(stderr, argv[0]);
+        return EXIT_FAILURE;
+    }
+    return benchmark_texture_compression(argv[1]);
+}